@@ -0,0 +1,54 @@
+/**
+ * @file cap_bits.h
+ * @brief GPIO引脚掩码展开 - GD32C2x1版本
+ * @version 1.0
+ * @date 2025-11-01
+ *
+ * 本文件只依赖stdint，固件(cap_fast.h)和上位机测试(host/cap_gpio_bench.cpp)共用。
+ *
+ * GPIO的CTL/PUD寄存器每个引脚占2位，AFSEL0/AFSEL1每个引脚占4位。把16位引脚掩码
+ * 的第n位移到第2n位(或第4n位)，乘以字段值即得到寄存器中所有选中引脚的掩码和设置值，
+ * 不需要逐个引脚循环。展开用固定的移位/与/或完成，与掩码中的引脚数无关。
+ */
+
+#ifndef CAP_BITS_H_
+#define CAP_BITS_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 16位引脚掩码展开为2位字段: 第n位 -> 第2n位
+ */
+static inline uint32_t cap_bits_spread2(uint32_t pins)
+{
+    uint32_t x = pins & 0xFFFFU;
+
+    x = (x | (x << 8)) & 0x00FF00FFU;
+    x = (x | (x << 4)) & 0x0F0F0F0FU;
+    x = (x | (x << 2)) & 0x33333333U;
+    x = (x | (x << 1)) & 0x55555555U;
+    return x;
+}
+
+/**
+ * @brief 8位引脚掩码展开为4位字段: 第n位 -> 第4n位
+ */
+static inline uint32_t cap_bits_spread4(uint32_t pins)
+{
+    uint32_t x = pins & 0xFFU;
+
+    x = (x | (x << 12)) & 0x000F000FU;
+    x = (x | (x << 6)) & 0x03030303U;
+    x = (x | (x << 3)) & 0x11111111U;
+    return x;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CAP_BITS_H_ */
@@ -0,0 +1,381 @@
+/**
+ * @file cap_cmd.c
+ * @brief 电容触摸串口命令通道实现 - GD32C2x1版本
+ * @version 1.0
+ * @date 2025-11-01
+ *
+ * 接收流程(参考Examples/USART/IDLE_receiver_interrupt):
+ * 1. DMA_CH1以循环模式把USART0接收数据写入环形缓冲区，无需CPU参与
+ * 2. USART0空闲中断只置位事件标志，不搬运数据
+ * 3. 主循环中cap_cmd_poll()根据DMA剩余传输数计算写位置，
+ *    直接在环形缓冲区中按cap_proto帧格式解析命令，执行后发送应答
+ *
+ * 命令帧很短，主循环每个扫描节拍(167us)都会检查，环形缓冲区不会被DMA追上。
+ */
+
+#include "cap_cmd.h"
+#include "cap_touch.h"
+#include <stddef.h>
+
+/** 环形缓冲区下标掩码 */
+#define CAP_CMD_RX_MASK (CAP_CMD_RX_BUF_SIZE - 1U)
+
+/** 接收环形缓冲区(DMA写入) */
+static uint8_t g_cmd_rx_buf[CAP_CMD_RX_BUF_SIZE];
+
+/** 读位置 */
+static uint16_t g_cmd_rx_rd = 0;
+
+/** 空闲中断事件标志 */
+static volatile uint8_t g_cmd_rx_idle = 0;
+
+/** CRC错误次数 */
+static uint32_t g_cmd_crc_errors = 0;
+
+/** 应答帧缓冲区 */
+static uint8_t g_cmd_tx_frame[CAP_PROTO_HEADER_SIZE + sizeof(cap_proto_ack_t) + CAP_PROTO_CRC_SIZE];
+
+/** 应答发送函数和应用参数处理函数 */
+static cap_cmd_send_t          g_cmd_send          = NULL;
+static cap_cmd_param_handler_t g_cmd_param_handler = NULL;
+
+/**
+ * @brief 读取环形缓冲区中的一个字节
+ */
+static inline uint8_t cap_cmd_rx_at(uint16_t pos)
+{
+    return g_cmd_rx_buf[pos & CAP_CMD_RX_MASK];
+}
+
+/**
+ * @brief 读取环形缓冲区中的小端32位数
+ */
+static uint32_t cap_cmd_rx_u32(uint16_t pos)
+{
+    return (uint32_t)cap_cmd_rx_at(pos) | ((uint32_t)cap_cmd_rx_at(pos + 1U) << 8) |
+           ((uint32_t)cap_cmd_rx_at(pos + 2U) << 16) | ((uint32_t)cap_cmd_rx_at(pos + 3U) << 24);
+}
+
+/**
+ * @brief 计算环形缓冲区中一段数据的CRC(可能跨越缓冲区末尾)
+ */
+static uint16_t cap_cmd_rx_crc(uint16_t pos, uint16_t length)
+{
+    uint16_t start = pos & CAP_CMD_RX_MASK;
+    uint16_t first = CAP_CMD_RX_BUF_SIZE - start;
+    uint16_t crc;
+
+    if (first >= length) { return cap_proto_crc16_update(CAP_PROTO_CRC_INIT, &g_cmd_rx_buf[start], length); }
+
+    crc = cap_proto_crc16_update(CAP_PROTO_CRC_INIT, &g_cmd_rx_buf[start], first);
+    return cap_proto_crc16_update(crc, &g_cmd_rx_buf[0], length - first);
+}
+
+/**
+ * @brief 获取DMA写位置
+ */
+static inline uint16_t cap_cmd_rx_wr(void)
+{
+    return (uint16_t)((CAP_CMD_RX_BUF_SIZE - dma_transfer_number_get(DMA_CH1)) & CAP_CMD_RX_MASK);
+}
+
+/**
+ * @brief 读取或设置cap_touch参数
+ * @return uint8_t CAP_PROTO_STATUS_xxx
+ */
+static uint8_t cap_cmd_touch_param(uint8_t set, cap_proto_param_t *param)
+{
+    uint32_t  value = param->value;
+    cap_err_t err   = CAP_OK;
+    uint16_t  idle_ticks;
+    uint8_t   idle_mask;
+    uint16_t  quiet_frames;
+
+    cap_touch_get_scan_rate_config(&idle_ticks, &idle_mask, &quiet_frames);
+
+    switch (param->param) {
+    case CAP_PROTO_PARAM_THRESHOLD:
+        if (param->index >= CAP_TOUCH_CHANNEL_COUNT) { return CAP_PROTO_STATUS_INVALID_VALUE; }
+        if (set) { err = (value > 0xFFFF) ? CAP_ERROR : cap_touch_set_threshold(param->index, (uint16_t)value); }
+        param->value = cap_touch_get_threshold(param->index);
+        break;
+
+    case CAP_PROTO_PARAM_BURST_SHIFT:
+        if (param->index >= CAP_TOUCH_CHANNEL_COUNT) { return CAP_PROTO_STATUS_INVALID_VALUE; }
+        if (set) { err = (value > 0xFF) ? CAP_ERROR : cap_touch_set_burst_shift(param->index, (uint8_t)value); }
+        param->value = cap_touch_get_burst_shift(param->index);
+        break;
+
+    case CAP_PROTO_PARAM_TIMER_PRESCALER:
+        if (set) { err = (value > 0xFFFF) ? CAP_ERROR : cap_touch_set_timer_prescaler((uint16_t)value); }
+        param->value = cap_touch_get_timer_prescaler();
+        break;
+
+    case CAP_PROTO_PARAM_CAPTURE_TIMEOUT:
+        if (set) { err = (value > 0xFFFF) ? CAP_ERROR : cap_touch_set_capture_timeout((uint16_t)value); }
+        param->value = cap_touch_get_capture_timeout();
+        break;
+
+    case CAP_PROTO_PARAM_IC_FILTER:
+        if (set) { err = (value > 0xFF) ? CAP_ERROR : cap_touch_set_ic_filter((uint8_t)value); }
+        param->value = cap_touch_get_ic_filter();
+        break;
+
+    case CAP_PROTO_PARAM_SCAN_IDLE_TICKS:
+        if (set) { err = (value > 0xFFFF) ? CAP_ERROR : cap_touch_scan_rate_config((uint16_t)value, idle_mask, quiet_frames); }
+        cap_touch_get_scan_rate_config(&idle_ticks, NULL, NULL);
+        param->value = idle_ticks;
+        break;
+
+    case CAP_PROTO_PARAM_SCAN_IDLE_MASK:
+        if (set) { err = (value > 0xFF) ? CAP_ERROR : cap_touch_scan_rate_config(idle_ticks, (uint8_t)value, quiet_frames); }
+        cap_touch_get_scan_rate_config(NULL, &idle_mask, NULL);
+        param->value = idle_mask;
+        break;
+
+    case CAP_PROTO_PARAM_SCAN_QUIET_FRAMES:
+        if (set) { err = (value > 0xFFFF) ? CAP_ERROR : cap_touch_scan_rate_config(idle_ticks, idle_mask, (uint16_t)value); }
+        cap_touch_get_scan_rate_config(NULL, NULL, &quiet_frames);
+        param->value = quiet_frames;
+        break;
+
+    case CAP_PROTO_PARAM_PROX_ENABLE:
+        if (set) { cap_touch_proximity_enable(value ? CAP_TRUE : CAP_FALSE); }
+        param->value = cap_touch_is_proximity_enabled();
+        break;
+
+    case CAP_PROTO_PARAM_PROX_THRESHOLD:
+        if (set) { err = (value > 0xFFFF) ? CAP_ERROR : cap_touch_set_proximity_threshold((uint16_t)value); }
+        param->value = cap_touch_get_proximity_threshold();
+        break;
+
+    default:
+        /* 交给应用处理 */
+        if (g_cmd_param_handler == NULL) { return CAP_PROTO_STATUS_UNKNOWN_PARAM; }
+        return g_cmd_param_handler(set, param);
+    }
+
+    return (err == CAP_OK) ? CAP_PROTO_STATUS_OK : CAP_PROTO_STATUS_INVALID_VALUE;
+}
+
+/**
+ * @brief 执行一个命令并发送应答
+ * @param type 帧类型
+ * @param request 命令参数，负载长度不正确时为NULL
+ */
+static void cap_cmd_execute(uint8_t type, const cap_proto_param_t *request)
+{
+    cap_proto_ack_t *ack = (cap_proto_ack_t *)cap_proto_payload(g_cmd_tx_frame);
+    uint16_t         frame_length;
+
+    ack->command     = type;
+    ack->param.param = 0;
+    ack->param.index = 0;
+    ack->param.value = 0;
+
+    if ((type != CAP_PROTO_TYPE_CMD_GET && type != CAP_PROTO_TYPE_CMD_SET) || request == NULL) {
+        ack->status = CAP_PROTO_STATUS_BAD_COMMAND;
+    } else {
+        ack->param  = *request;
+        ack->status = cap_cmd_touch_param((type == CAP_PROTO_TYPE_CMD_SET) ? 1 : 0, &ack->param);
+    }
+
+    frame_length = cap_proto_finalize(g_cmd_tx_frame, CAP_PROTO_TYPE_CMD_ACK, sizeof(cap_proto_ack_t));
+    if (g_cmd_send != NULL) { g_cmd_send(g_cmd_tx_frame, frame_length); }
+}
+
+/**
+ * @brief USART0空闲中断回调函数
+ */
+void cap_cmd_usart_idle_callback(void)
+{
+    g_cmd_rx_idle = 1;
+}
+
+/**
+ * @brief 解析并执行已接收的命令
+ */
+void cap_cmd_poll(void)
+{
+    uint16_t          wr    = cap_cmd_rx_wr();
+    uint16_t          avail = (uint16_t)((wr - g_cmd_rx_rd) & CAP_CMD_RX_MASK);
+    cap_proto_param_t request;
+
+    /* 数据未接收完(未检测到空闲)且缓冲区未过半时，等待整帧 */
+    if (avail == 0) { return; }
+    if (!g_cmd_rx_idle && avail < CAP_CMD_RX_BUF_SIZE / 2) { return; }
+    g_cmd_rx_idle = 0;
+
+    while (avail > 0) {
+        uint16_t pos = g_cmd_rx_rd;
+        uint16_t length;
+        uint16_t total;
+        uint16_t crc;
+
+        /* 搜索同步字 */
+        if (cap_cmd_rx_at(pos) != CAP_PROTO_SYNC0) {
+            g_cmd_rx_rd = (pos + 1U) & CAP_CMD_RX_MASK;
+            avail--;
+            continue;
+        }
+
+        if (avail < CAP_PROTO_HEADER_SIZE) { break; }
+
+        length = (uint16_t)(cap_cmd_rx_at(pos + 6U) | (cap_cmd_rx_at(pos + 7U) << 8));
+        if (cap_cmd_rx_at(pos + 1U) != CAP_PROTO_SYNC1 || cap_cmd_rx_at(pos + 2U) != CAP_PROTO_VERSION ||
+            length > CAP_CMD_MAX_PAYLOAD) {
+            g_cmd_rx_rd = (pos + 1U) & CAP_CMD_RX_MASK;
+            avail--;
+            continue;
+        }
+
+        total = (uint16_t)(CAP_PROTO_HEADER_SIZE + length + CAP_PROTO_CRC_SIZE);
+        if (avail < total) { break; }
+
+        crc = (uint16_t)(cap_cmd_rx_at(pos + total - 2U) | (cap_cmd_rx_at(pos + total - 1U) << 8));
+        if (crc != cap_cmd_rx_crc(pos, CAP_PROTO_HEADER_SIZE + length)) {
+            g_cmd_crc_errors++;
+            g_cmd_rx_rd = (pos + 1U) & CAP_CMD_RX_MASK;
+            avail--;
+            continue;
+        }
+
+        /* 直接从环形缓冲区读取参数 */
+        if (length == sizeof(cap_proto_param_t)) {
+            request.param = cap_cmd_rx_at(pos + CAP_PROTO_HEADER_SIZE);
+            request.index = cap_cmd_rx_at(pos + CAP_PROTO_HEADER_SIZE + 1U);
+            request.value = cap_cmd_rx_u32(pos + CAP_PROTO_HEADER_SIZE + 2U);
+        }
+        cap_cmd_execute(cap_cmd_rx_at(pos + 3U), (length == sizeof(cap_proto_param_t)) ? &request : NULL);
+
+        g_cmd_rx_rd = (pos + total) & CAP_CMD_RX_MASK;
+        avail -= total;
+    }
+}
+
+/**
+ * @brief 解析并执行一段连续缓冲区中的命令
+ */
+void cap_cmd_process(const uint8_t *data, uint16_t length)
+{
+    uint16_t          pos = 0;
+    cap_proto_param_t request;
+
+    while (length - pos >= CAP_PROTO_HEADER_SIZE + CAP_PROTO_CRC_SIZE) {
+        const uint8_t *frame = &data[pos];
+        uint16_t       payload_length;
+        uint16_t       total;
+        uint16_t       crc;
+
+        /* 填充字节(通常为0)逐字节跳过 */
+        if (frame[0] != CAP_PROTO_SYNC0 || frame[1] != CAP_PROTO_SYNC1 || frame[2] != CAP_PROTO_VERSION) {
+            pos++;
+            continue;
+        }
+
+        payload_length = (uint16_t)(frame[6] | (frame[7] << 8));
+        if (payload_length > CAP_CMD_MAX_PAYLOAD) {
+            pos++;
+            continue;
+        }
+
+        total = (uint16_t)(CAP_PROTO_HEADER_SIZE + payload_length + CAP_PROTO_CRC_SIZE);
+        if (total > length - pos) { break; }
+
+        crc = (uint16_t)(frame[total - 2U] | (frame[total - 1U] << 8));
+        if (crc != cap_proto_crc16_update(CAP_PROTO_CRC_INIT, frame, CAP_PROTO_HEADER_SIZE + payload_length)) {
+            g_cmd_crc_errors++;
+            pos++;
+            continue;
+        }
+
+        if (payload_length == sizeof(cap_proto_param_t)) {
+            const uint8_t *payload = &frame[CAP_PROTO_HEADER_SIZE];
+
+            request.param = payload[0];
+            request.index = payload[1];
+            request.value = (uint32_t)payload[2] | ((uint32_t)payload[3] << 8) | ((uint32_t)payload[4] << 16) |
+                            ((uint32_t)payload[5] << 24);
+        }
+        cap_cmd_execute(frame[3], (payload_length == sizeof(cap_proto_param_t)) ? &request : NULL);
+
+        pos += total;
+    }
+}
+
+/**
+ * @brief 配置DMA_CH1循环接收USART0数据
+ */
+static void cap_cmd_dma_config(void)
+{
+    dma_parameter_struct dma_init_struct;
+
+    rcu_periph_clock_enable(RCU_DMA);
+    rcu_periph_clock_enable(RCU_DMAMUX);
+
+    dma_deinit(DMA_CH1);
+    dma_struct_para_init(&dma_init_struct);
+
+    dma_init_struct.request      = DMA_REQUEST_USART0_RX;          /* USART0_RX请求 */
+    dma_init_struct.direction    = DMA_PERIPHERAL_TO_MEMORY;       /* 外设到内存 */
+    dma_init_struct.memory_addr  = (uint32_t)g_cmd_rx_buf;         /* 内存地址 */
+    dma_init_struct.memory_inc   = DMA_MEMORY_INCREASE_ENABLE;     /* 内存地址自增 */
+    dma_init_struct.memory_width = DMA_MEMORY_WIDTH_8BIT;          /* 内存数据宽度8位 */
+    dma_init_struct.number       = CAP_CMD_RX_BUF_SIZE;            /* 环形缓冲区大小 */
+    dma_init_struct.periph_addr  = (uint32_t)&USART_RDATA(USART0); /* 外设地址 */
+    dma_init_struct.periph_inc   = DMA_PERIPH_INCREASE_DISABLE;    /* 外设地址不变 */
+    dma_init_struct.periph_width = DMA_PERIPHERAL_WIDTH_8BIT;      /* 外设数据宽度8位 */
+    dma_init_struct.priority     = DMA_PRIORITY_HIGH;              /* 低于发送通道 */
+
+    dma_init(DMA_CH1, &dma_init_struct);
+
+    /* 循环模式: 传输数减到0后自动重装，不需要在中断中重新配置 */
+    dma_circulation_enable(DMA_CH1);
+    dma_memory_to_memory_disable(DMA_CH1);
+    dmamux_synchronization_disable(DMAMUX_MUXCH1);
+
+    dma_channel_enable(DMA_CH1);
+}
+
+/**
+ * @brief 初始化命令通道
+ */
+void cap_cmd_init(void)
+{
+    g_cmd_rx_rd   = 0;
+    g_cmd_rx_idle = 0;
+
+    cap_cmd_dma_config();
+
+    /* 使能USART的DMA接收 */
+    usart_dma_receive_config(USART0, USART_RECEIVE_DMA_ENABLE);
+
+    /* 使能空闲中断 */
+    usart_interrupt_flag_clear(USART0, USART_INT_FLAG_IDLE);
+    usart_interrupt_enable(USART0, USART_INT_IDLE);
+    nvic_irq_enable(USART0_IRQn, 3);
+}
+
+/**
+ * @brief 注册应答帧发送函数
+ */
+void cap_cmd_register_send(cap_cmd_send_t send)
+{
+    g_cmd_send = send;
+}
+
+/**
+ * @brief 注册应用参数处理函数
+ */
+void cap_cmd_register_param_handler(cap_cmd_param_handler_t handler)
+{
+    g_cmd_param_handler = handler;
+}
+
+/**
+ * @brief 获取CRC错误的命令帧数
+ */
+uint32_t cap_cmd_get_crc_errors(void)
+{
+    return g_cmd_crc_errors;
+}
@@ -0,0 +1,87 @@
+/**
+ * @file cap_cmd.h
+ * @brief 电容触摸串口命令通道头文件 - GD32C2x1版本
+ * @version 1.0
+ * @date 2025-11-01
+ */
+
+#ifndef CAP_CMD_H_
+#define CAP_CMD_H_
+
+#include "cap_proto.h"
+#include "gd32c2x1.h"
+#include <stdint.h>
+
+/** 接收环形缓冲区大小(2的幂) */
+#define CAP_CMD_RX_BUF_SIZE 128
+
+/** 命令帧最大负载长度，超过时视为帧头错误 */
+#define CAP_CMD_MAX_PAYLOAD 16
+
+/**
+ * @brief 应答帧发送函数类型
+ * @param frame 完整帧
+ * @param length 帧长度
+ */
+typedef void (*cap_cmd_send_t)(const uint8_t *frame, uint16_t length);
+
+/**
+ * @brief 应用参数处理函数类型，处理命令模块不认识的参数(例如数据流参数)
+ * @param set 1: 设置参数; 0: 读取参数
+ * @param param 参数，设置时value为新值，返回时value填写当前值
+ * @return uint8_t CAP_PROTO_STATUS_xxx
+ */
+typedef uint8_t (*cap_cmd_param_handler_t)(uint8_t set, cap_proto_param_t *param);
+
+/**
+ * @brief 初始化命令通道
+ *
+ * 配置DMA_CH1以循环模式接收USART0数据，并使能USART0空闲中断。
+ * 需在usart_config()之后调用
+ */
+void cap_cmd_init(void);
+
+/**
+ * @brief USART0空闲中断回调函数
+ *
+ * 需要在USART0中断处理函数中调用
+ */
+void cap_cmd_usart_idle_callback(void);
+
+/**
+ * @brief 解析并执行已接收的命令
+ *
+ * 在主循环中调用。收到空闲中断或缓冲区中积累了半个缓冲区以上的数据时，
+ * 直接在DMA环形缓冲区中解析命令帧(不复制)，执行后通过发送函数应答
+ */
+void cap_cmd_poll(void);
+
+/**
+ * @brief 解析并执行一段连续缓冲区中的命令
+ *
+ * 用于不经过USART接收的传输方式(例如SPI全双工事务中主机发送的数据)。
+ * 缓冲区中命令帧以外的字节(例如填充的0)被跳过，应答通过发送函数发出
+ *
+ * @param data 数据
+ * @param length 数据长度
+ */
+void cap_cmd_process(const uint8_t *data, uint16_t length);
+
+/**
+ * @brief 注册应答帧发送函数
+ */
+void cap_cmd_register_send(cap_cmd_send_t send);
+
+/**
+ * @brief 注册应用参数处理函数
+ */
+void cap_cmd_register_param_handler(cap_cmd_param_handler_t handler);
+
+/**
+ * @brief 获取CRC错误的命令帧数
+ *
+ * @return uint32_t CRC错误次数
+ */
+uint32_t cap_cmd_get_crc_errors(void);
+
+#endif /* CAP_CMD_H_ */
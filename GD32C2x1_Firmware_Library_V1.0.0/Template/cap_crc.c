@@ -0,0 +1,229 @@
+/**
+ * @file cap_crc.c
+ * @brief 硬件CRC单元仲裁和DMA异步计算实现 - GD32C2x1版本
+ * @version 1.0
+ * @date 2025-11-01
+ *
+ * 占用标志在关中断时检查和设置，中断和主循环都可以调用cap_crc_claim()。
+ * 异步计算在开始时占用CRC单元，在完成中断中写入剩余字节、读取结果后释放。
+ */
+
+#include "cap_crc.h"
+#include <stddef.h>
+
+/**
+ * @brief 异步计算状态
+ */
+typedef struct {
+    volatile uint8_t   busy;     /*!< 1: 计算进行中 */
+    uint8_t            width;    /*!< 每次DMA传输的字节数(1/2/4) */
+    uint8_t            tail;     /*!< DMA传输完后剩余的字节数(小于width) */
+    uint32_t           addr;     /*!< 下一段DMA传输的地址 */
+    uint32_t           count;    /*!< 还未开始的DMA传输数 */
+    uint32_t           result;   /*!< 上一次计算结果 */
+    cap_crc_callback_t callback; /*!< 完成回调函数 */
+    void              *context;  /*!< 回调函数参数 */
+} cap_crc_job_t;
+
+const cap_crc_config_t cap_crc_config_crc32 = {CRC_CTL_PS_32, 0x04C11DB7U, 0xFFFFFFFFU, CRC_INPUT_DATA_NOT, 0};
+
+static volatile uint8_t        g_crc_claimed = 0;    /* CRC单元已被占用 */
+static const cap_crc_config_t *g_crc_config  = NULL; /* CRC单元当前的配置 */
+static cap_crc_job_t           g_crc_job;
+
+/* 按数据格式(INPUT_FORMAT_WORD/HALFWORD/BYTE)的传输宽度，CRC单元按写入宽度决定输入数据的位数 */
+static const uint8_t  g_crc_width[3]        = {4U, 2U, 1U};
+static const uint32_t g_crc_memory_width[3] = {DMA_MEMORY_WIDTH_32BIT, DMA_MEMORY_WIDTH_16BIT, DMA_MEMORY_WIDTH_8BIT};
+static const uint32_t g_crc_periph_width[3] = {DMA_PERIPHERAL_WIDTH_32BIT, DMA_PERIPHERAL_WIDTH_16BIT,
+                                               DMA_PERIPHERAL_WIDTH_8BIT};
+
+/**
+ * @brief 初始化: 使能CRC单元和DMA时钟，使能DMA_CH2中断
+ */
+void cap_crc_init(void)
+{
+    rcu_periph_clock_enable(RCU_CRC);
+    rcu_periph_clock_enable(RCU_DMA);
+    rcu_periph_clock_enable(RCU_DMAMUX);
+
+    crc_deinit();
+    g_crc_config   = NULL;
+    g_crc_claimed  = 0;
+    g_crc_job.busy = 0;
+
+    nvic_irq_enable(CAP_CRC_DMA_IRQn, 3);
+}
+
+/**
+ * @brief 独占CRC单元并复位数据寄存器
+ */
+uint8_t cap_crc_claim(const cap_crc_config_t *config)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    if (g_crc_claimed) {
+        __set_PRIMASK(primask);
+        return 0;
+    }
+    g_crc_claimed = 1;
+    __set_PRIMASK(primask);
+
+    /* 占用后再配置，期间其他调用者已改用软件CRC */
+    if (config != g_crc_config) {
+        crc_polynomial_size_set(config->poly_size);
+        crc_polynomial_set(config->poly);
+        crc_init_data_register_write(config->init);
+        crc_input_data_reverse_config(config->in_reverse);
+        if (config->out_reverse) {
+            crc_reverse_output_data_enable();
+        } else {
+            crc_reverse_output_data_disable();
+        }
+        g_crc_config = config;
+    }
+    crc_data_register_reset();
+
+    return 1;
+}
+
+/**
+ * @brief 释放CRC单元
+ */
+void cap_crc_release(void)
+{
+    g_crc_claimed = 0;
+}
+
+/**
+ * @brief 开始下一段DMA传输(不超过CHxCNT的最大值)
+ */
+static void cap_crc_dma_next(void)
+{
+    uint32_t count = (g_crc_job.count > CAP_CRC_DMA_MAX_COUNT) ? CAP_CRC_DMA_MAX_COUNT : g_crc_job.count;
+
+    dma_memory_address_config(CAP_CRC_DMA_CH, g_crc_job.addr);
+    dma_transfer_number_config(CAP_CRC_DMA_CH, count);
+    g_crc_job.addr += count * g_crc_job.width;
+    g_crc_job.count -= count;
+
+    dma_channel_enable(CAP_CRC_DMA_CH);
+}
+
+/**
+ * @brief 写入剩余的半字和字节，读取结果并释放CRC单元
+ */
+static void cap_crc_job_finish(void)
+{
+    const uint8_t     *tail     = (const uint8_t *)g_crc_job.addr;
+    cap_crc_callback_t callback = g_crc_job.callback;
+
+    if (g_crc_job.tail >= 2U) {
+        REG16(CRC) = *(const uint16_t *)tail;
+        tail += 2;
+    }
+    if (g_crc_job.tail & 1U) { REG8(CRC) = *tail; }
+
+    g_crc_job.result = crc_data_register_read();
+    g_crc_job.busy   = 0;
+    cap_crc_release();
+
+    /* 回调函数中可以开始下一次计算 */
+    if (callback != NULL) { callback(g_crc_job.result, g_crc_job.context); }
+}
+
+/**
+ * @brief 开始异步计算
+ */
+uint8_t cap_crc_start(const cap_crc_config_t *config, const void *data, uint32_t length, uint32_t data_format,
+                      cap_crc_callback_t callback, void *context)
+{
+    dma_parameter_struct dma_init_struct;
+    uint8_t              width;
+
+    if (data_format > INPUT_FORMAT_BYTE) { return 0; }
+    width = g_crc_width[data_format];
+    if (((uint32_t)data & (width - 1U)) != 0U) { return 0; }
+
+    /* DMA通道被其他模块使能时不能占用 */
+    if (DMA_CHCTL(CAP_CRC_DMA_CH) & DMA_CHXCTL_CHEN) { return 0; }
+    if (!cap_crc_claim(config)) { return 0; }
+
+    g_crc_job.busy     = 1;
+    g_crc_job.width    = width;
+    g_crc_job.tail     = (uint8_t)(length & (width - 1U));
+    g_crc_job.addr     = (uint32_t)data;
+    g_crc_job.count    = length / width;
+    g_crc_job.callback = callback;
+    g_crc_job.context  = context;
+
+    /* 不足一个数据单位时直接写入 */
+    if (g_crc_job.count == 0U) {
+        cap_crc_job_finish();
+        return 1;
+    }
+
+    dma_deinit(CAP_CRC_DMA_CH);
+    dma_struct_para_init(&dma_init_struct);
+
+    dma_init_struct.request      = DMA_REQUEST_M2M;                 /* 存储器到存储器，不等待请求 */
+    dma_init_struct.direction    = DMA_MEMORY_TO_PERIPHERAL;        /* 从内存地址读，写入外设地址 */
+    dma_init_struct.memory_addr  = (uint32_t)data;                  /* 内存地址(每段传输时设置) */
+    dma_init_struct.memory_inc   = DMA_MEMORY_INCREASE_ENABLE;      /* 内存地址自增 */
+    dma_init_struct.periph_addr  = (uint32_t)&CRC_DATA;             /* CRC数据寄存器 */
+    dma_init_struct.periph_inc   = DMA_PERIPH_INCREASE_DISABLE;     /* 外设地址不变 */
+    dma_init_struct.memory_width = g_crc_memory_width[data_format]; /* 内存数据宽度按数据格式 */
+    dma_init_struct.periph_width = g_crc_periph_width[data_format]; /* 外设数据宽度与内存相同 */
+    dma_init_struct.priority     = DMA_PRIORITY_LOW;                /* 低于串口/SPI/I2C */
+
+    dma_init(CAP_CRC_DMA_CH, &dma_init_struct);
+
+    dma_circulation_disable(CAP_CRC_DMA_CH);
+    dma_memory_to_memory_enable(CAP_CRC_DMA_CH);
+    dmamux_synchronization_disable(CAP_CRC_DMA_MUXCH);
+
+    dma_interrupt_flag_clear(CAP_CRC_DMA_CH, DMA_INT_FLAG_FTF);
+    dma_interrupt_enable(CAP_CRC_DMA_CH, DMA_INT_FTF);
+
+    cap_crc_dma_next();
+
+    return 1;
+}
+
+/**
+ * @brief 查询异步计算是否进行中
+ */
+uint8_t cap_crc_busy(void)
+{
+    return g_crc_job.busy;
+}
+
+/**
+ * @brief 读取上一次异步计算的结果
+ */
+uint32_t cap_crc_result(void)
+{
+    return g_crc_job.result;
+}
+
+/**
+ * @brief DMA_CH2传输完成中断处理函数
+ */
+void cap_crc_dma_irq_handler(void)
+{
+    if (!g_crc_job.busy) { return; }
+    if (dma_interrupt_flag_get(CAP_CRC_DMA_CH, DMA_INT_FLAG_FTF) == RESET) { return; }
+    dma_interrupt_flag_clear(CAP_CRC_DMA_CH, DMA_INT_FLAG_FTF);
+
+    /* 传输数为0后关闭通道，下一段重新使能时装入新的传输数 */
+    dma_channel_disable(CAP_CRC_DMA_CH);
+
+    if (g_crc_job.count != 0U) {
+        cap_crc_dma_next();
+        return;
+    }
+
+    /* 通道交还给其他模块前关闭中断 */
+    dma_interrupt_disable(CAP_CRC_DMA_CH, DMA_INT_FTF);
+    cap_crc_job_finish();
+}
@@ -0,0 +1,113 @@
+/**
+ * @file cap_crc.h
+ * @brief 硬件CRC单元仲裁和DMA异步计算头文件 - GD32C2x1版本
+ * @version 1.0
+ * @date 2025-11-01
+ *
+ * CRC单元由帧协议(中断和主循环)和大块数据校验(启动时校验Flash映像等)共用:
+ * - cap_crc_claim()/cap_crc_release() 独占CRC单元，按需切换多项式等配置。
+ *   CRC单元已被占用时(DMA计算中，或主循环的计算被中断打断)返回0，调用者改用软件CRC
+ * - cap_crc_start() 以存储器到存储器DMA把缓冲区写入CRC_DATA，CPU不参与，完成后在
+ *   DMA中断中调用回调函数。主体按数据格式(字/半字/字节)由DMA写入，
+ *   长度不是整数倍时剩余的半字和字节在完成中断中写入
+ *
+ * DMA_CH0/DMA_CH1用于USART(或SPI)，本模块使用的DMA_CH2与I2C寄存器接口共用:
+ * 只能在cap_i2c_init()之前使用(启动时校验)，或在不使用I2C接口时使用。
+ */
+
+#ifndef CAP_CRC_H_
+#define CAP_CRC_H_
+
+#include "gd32c2x1.h"
+#include <stdint.h>
+
+/** 异步计算使用的DMA通道 */
+#define CAP_CRC_DMA_CH     DMA_CH2
+#define CAP_CRC_DMA_MUXCH  DMAMUX_MUXCH2
+#define CAP_CRC_DMA_IRQn   DMA_Channel2_IRQn
+
+/** 每次DMA传输的最大数量(CHxCNT为16位)，更长的数据在完成中断中继续 */
+#define CAP_CRC_DMA_MAX_COUNT 0xFFFFU
+
+/**
+ * @brief CRC单元配置
+ */
+typedef struct {
+    uint32_t poly_size;   /*!< CRC_CTL_PS_32 / CRC_CTL_PS_16 / CRC_CTL_PS_8 / CRC_CTL_PS_7 */
+    uint32_t poly;        /*!< 多项式 */
+    uint32_t init;        /*!< 初始值 */
+    uint32_t in_reverse;  /*!< CRC_INPUT_DATA_NOT / CRC_INPUT_DATA_BYTE / CRC_INPUT_DATA_HALFWORD / CRC_INPUT_DATA_WORD */
+    uint8_t  out_reverse; /*!< 1: 输出按位反转 */
+} cap_crc_config_t;
+
+/** 硬件默认配置: CRC-32/MPEG-2(多项式0x04C11DB7，初始值0xFFFFFFFF，不反转) */
+extern const cap_crc_config_t cap_crc_config_crc32;
+
+/**
+ * @brief 异步计算完成回调函数类型(在DMA中断中调用)
+ *
+ * @param crc 计算结果
+ * @param context cap_crc_start()传入的参数
+ */
+typedef void (*cap_crc_callback_t)(uint32_t crc, void *context);
+
+/**
+ * @brief 初始化: 使能CRC单元和DMA时钟，使能DMA_CH2中断
+ */
+void cap_crc_init(void);
+
+/**
+ * @brief 独占CRC单元并复位数据寄存器
+ *
+ * 可在中断中调用。配置与上一次使用的不同时重新写入多项式等
+ *
+ * @param config 配置(需为静态常量，按地址判断是否需要重新配置)
+ * @return uint8_t 1: 成功; 0: CRC单元正在使用
+ */
+uint8_t cap_crc_claim(const cap_crc_config_t *config);
+
+/**
+ * @brief 释放CRC单元
+ */
+void cap_crc_release(void);
+
+/**
+ * @brief 开始异步计算
+ *
+ * 数据格式与crc_block_data_calculate()相同: INPUT_FORMAT_WORD时按小端32位字写入，
+ * 剩余的2字节按半字、1字节按字节写入；INPUT_FORMAT_HALFWORD时剩余1字节按字节写入。
+ * 数据地址需按数据格式对齐，计算完成前不能修改
+ *
+ * @param config 配置
+ * @param data 数据
+ * @param length 长度(字节)
+ * @param data_format INPUT_FORMAT_WORD / INPUT_FORMAT_HALFWORD / INPUT_FORMAT_BYTE
+ * @param callback 完成回调函数(可为NULL，用cap_crc_busy()/cap_crc_result()查询)
+ * @param context 回调函数参数
+ * @return uint8_t 1: 已开始; 0: CRC单元或DMA通道正在使用，或地址未对齐
+ */
+uint8_t cap_crc_start(const cap_crc_config_t *config, const void *data, uint32_t length, uint32_t data_format,
+                      cap_crc_callback_t callback, void *context);
+
+/**
+ * @brief 查询异步计算是否进行中
+ *
+ * @return uint8_t 1: 进行中
+ */
+uint8_t cap_crc_busy(void);
+
+/**
+ * @brief 读取上一次异步计算的结果
+ *
+ * @return uint32_t CRC
+ */
+uint32_t cap_crc_result(void);
+
+/**
+ * @brief DMA_CH2传输完成中断处理函数
+ *
+ * 需要在DMA_Channel2_IRQHandler中调用
+ */
+void cap_crc_dma_irq_handler(void);
+
+#endif /* CAP_CRC_H_ */
@@ -0,0 +1,199 @@
+/**
+ * @file cap_fast.h
+ * @brief 捕获热路径使用的内联定时器/GPIO访问函数 - GD32C2x1版本
+ * @version 1.0
+ * @date 2025-11-01
+ *
+ * 标准外设库的 timer_interrupt_flag_get()、timer_channel_capture_value_register_read()、
+ * gpio_mode_set() 等为外部函数，按通道号switch或逐个引脚循环。本文件提供只用于
+ * 已知参数范围的内联版本，每个函数展开为一到两次寄存器读写，参数为常量时地址和掩码在编译时算出:
+ * - 定时器通道只支持 TIMER_CH_0 - TIMER_CH_3(CHxCV 寄存器、CHxEN 位按通道号等间距排列)
+ * - 中断标志只支持使能位与标志位同一位置的 TIMER_INT_FLAG_UP / TIMER_INT_FLAG_CHx
+ * - GPIO模式/复用功能的引脚掩码按 cap_bits.h 展开为字段掩码，任意多个引脚都是一次读改写
+ *
+ * 不检查参数，不经过 FW_DEBUG_ERR_REPORT。其他场合继续使用标准外设库。
+ */
+
+#ifndef CAP_FAST_H_
+#define CAP_FAST_H_
+
+#include "cap_bits.h"
+#include "gd32c2x1.h"
+#include <stdint.h>
+
+/**
+ * @brief 读取定时器中断标志(标志置位且中断已使能)，等同 timer_interrupt_flag_get()
+ */
+static inline FlagStatus cap_timer_int_flag_get(uint32_t timer_periph, uint32_t int_flag)
+{
+    return (TIMER_INTF(timer_periph) & TIMER_DMAINTEN(timer_periph) & int_flag) ? SET : RESET;
+}
+
+/**
+ * @brief 清除定时器中断/状态标志(写0清除)，等同 timer_interrupt_flag_clear() / timer_flag_clear()
+ */
+static inline void cap_timer_int_flag_clear(uint32_t timer_periph, uint32_t int_flag)
+{
+    TIMER_INTF(timer_periph) = ~int_flag;
+}
+
+/**
+ * @brief 读取定时器状态标志(不检查中断使能)，等同 timer_flag_get()
+ */
+static inline FlagStatus cap_timer_flag_get(uint32_t timer_periph, uint32_t flag)
+{
+    return (TIMER_INTF(timer_periph) & flag) ? SET : RESET;
+}
+
+/**
+ * @brief 使能定时器中断，等同 timer_interrupt_enable()
+ */
+static inline void cap_timer_int_enable(uint32_t timer_periph, uint32_t interrupt)
+{
+    TIMER_DMAINTEN(timer_periph) |= interrupt & 0xFFU;
+}
+
+/**
+ * @brief 禁用定时器中断，等同 timer_interrupt_disable()
+ */
+static inline void cap_timer_int_disable(uint32_t timer_periph, uint32_t interrupt)
+{
+    TIMER_DMAINTEN(timer_periph) &= ~(interrupt & 0xFFU);
+}
+
+/**
+ * @brief 读取定时器计数值，等同 timer_counter_read()
+ */
+static inline uint16_t cap_timer_counter_read(uint32_t timer_periph)
+{
+    return (uint16_t)TIMER_CNT(timer_periph);
+}
+
+/**
+ * @brief 设置定时器计数值，等同 timer_counter_value_config()
+ */
+static inline void cap_timer_counter_write(uint32_t timer_periph, uint16_t counter)
+{
+    TIMER_CNT(timer_periph) = counter;
+}
+
+/**
+ * @brief 读取通道捕获值，等同 timer_channel_capture_value_register_read()
+ *
+ * CH0CV-CH3CV 连续排列，按通道号计算地址，不需要switch
+ */
+static inline uint16_t cap_timer_capture_read(uint32_t timer_periph, uint16_t channel)
+{
+    return (uint16_t)REG32(timer_periph + 0x34U + ((uint32_t)channel << 2));
+}
+
+/**
+ * @brief 使能/禁用通道，等同 timer_channel_output_state_config()
+ *
+ * CHxEN 位于 CHCTL2 的 4 * x 位
+ */
+static inline void cap_timer_channel_state(uint32_t timer_periph, uint16_t channel, uint32_t state)
+{
+    uint32_t shift = (uint32_t)channel << 2;
+
+    TIMER_CHCTL2(timer_periph) = (TIMER_CHCTL2(timer_periph) & ~(TIMER_CHCTL2_CH0EN << shift)) |
+                                 ((state & TIMER_CHCTL2_CH0EN) << shift);
+}
+
+/**
+ * @brief 引脚输出高电平
+ */
+static inline void cap_gpio_set(uint32_t gpio_periph, uint32_t pin)
+{
+    GPIO_BOP(gpio_periph) = pin & GPIO_PIN_ALL;
+}
+
+/**
+ * @brief 引脚输出低电平
+ */
+static inline void cap_gpio_reset(uint32_t gpio_periph, uint32_t pin)
+{
+    GPIO_BC(gpio_periph) = pin & GPIO_PIN_ALL;
+}
+
+/**
+ * @brief 写引脚输出，等同 gpio_bit_write()
+ */
+static inline void cap_gpio_write(uint32_t gpio_periph, uint32_t pin, bit_status bit_value)
+{
+    if (RESET != bit_value) {
+        cap_gpio_set(gpio_periph, pin);
+    } else {
+        cap_gpio_reset(gpio_periph, pin);
+    }
+}
+
+/**
+ * @brief 设置引脚的模式和上下拉，等同 gpio_mode_set()
+ *
+ * @param pin 一个或多个引脚 GPIO_PIN_x
+ */
+static inline void cap_gpio_mode_set(uint32_t gpio_periph, uint32_t mode, uint32_t pull_up_down, uint32_t pin)
+{
+    uint32_t field = cap_bits_spread2(pin);
+
+    GPIO_CTL(gpio_periph) = (GPIO_CTL(gpio_periph) & ~(field * 0x3U)) | (field * (mode & 0x3U));
+    GPIO_PUD(gpio_periph) = (GPIO_PUD(gpio_periph) & ~(field * 0x3U)) | (field * (pull_up_down & 0x3U));
+}
+
+/**
+ * @brief 设置引脚的复用功能，等同 gpio_af_set()
+ *
+ * 引脚0-7在AFSEL0，引脚8-15在AFSEL1，只写有选中引脚的寄存器
+ *
+ * @param pin 一个或多个引脚 GPIO_PIN_x
+ */
+static inline void cap_gpio_af_set(uint32_t gpio_periph, uint32_t alt_func_num, uint32_t pin)
+{
+    uint32_t af = alt_func_num & 0xFU;
+
+    if (pin & 0x00FFU) {
+        uint32_t field = cap_bits_spread4(pin);
+
+        GPIO_AFSEL0(gpio_periph) = (GPIO_AFSEL0(gpio_periph) & ~(field * 0xFU)) | (field * af);
+    }
+    if (pin & 0xFF00U) {
+        uint32_t field = cap_bits_spread4(pin >> 8);
+
+        GPIO_AFSEL1(gpio_periph) = (GPIO_AFSEL1(gpio_periph) & ~(field * 0xFU)) | (field * af);
+    }
+}
+
+/**
+ * @brief 引脚切换为复用功能(开始充电)
+ *
+ * 选择复用功能后再切换模式，CTL只写一次，所有引脚同时切换。
+ * 上下拉保持初始化时的配置(触摸引脚为GPIO_PUPD_NONE)
+ *
+ * @param pin 一个或多个引脚 GPIO_PIN_x
+ */
+static inline void cap_gpio_pins_af(uint32_t gpio_periph, uint32_t alt_func_num, uint32_t pin)
+{
+    uint32_t field = cap_bits_spread2(pin);
+
+    cap_gpio_af_set(gpio_periph, alt_func_num, pin);
+    GPIO_CTL(gpio_periph) = (GPIO_CTL(gpio_periph) & ~(field * 0x3U)) | (field * GPIO_MODE_AF);
+}
+
+/**
+ * @brief 引脚切换为输出低电平(放电)
+ *
+ * 先清除输出数据，切换模式后引脚直接输出低电平，CTL只写一次。
+ * 复用功能选择在输出模式下不起作用，保持不变，下一次切换为复用功能时重新写入
+ *
+ * @param pin 一个或多个引脚 GPIO_PIN_x
+ */
+static inline void cap_gpio_pins_output_low(uint32_t gpio_periph, uint32_t pin)
+{
+    uint32_t field = cap_bits_spread2(pin);
+
+    cap_gpio_reset(gpio_periph, pin);
+    GPIO_CTL(gpio_periph) = (GPIO_CTL(gpio_periph) & ~(field * 0x3U)) | (field * GPIO_MODE_OUTPUT);
+}
+
+#endif /* CAP_FAST_H_ */
@@ -0,0 +1,338 @@
+/**
+ * @file cap_flash.c
+ * @brief Flash流式写入实现 - GD32C2x1版本
+ * @version 1.0
+ * @date 2025-11-01
+ *
+ * 追加的数据先放入环形缓冲区，每次编程操作从缓冲区取一行(快速编程)或一个双字。
+ * 非阻塞模式下主循环只向缓冲区尾部追加，FMC中断只从头部取出，
+ * 待编程字节数的修改和空闲时启动编程在关中断时进行。
+ */
+
+#include "cap_flash.h"
+#include <stddef.h>
+
+/** 每次编程前清除的状态标志(写1清除) */
+#define CAP_FLASH_STAT_CLEAR (FMC_STAT_ENDF | FMC_STAT_OPRERR | FMC_STAT_PGERR | FMC_STAT_WPERR | FMC_STAT_PGAERR | \
+                              FMC_STAT_PGMERR | FMC_STAT_PGSERR | FMC_STAT_FSTPERR)
+
+/**
+ * @brief 写入过程状态
+ */
+typedef struct {
+    volatile uint8_t        active;   /*!< 1: 写入过程未结束 */
+    volatile uint8_t        running;  /*!< 1: 非阻塞模式下编程操作进行中 */
+    uint8_t                 flushing; /*!< 1: 已调用cap_flash_end()，不足一行的数据也要写入 */
+    uint32_t                addr;     /*!< 下一次编程的Flash地址 */
+    uint16_t                head;     /*!< 缓冲区中第一个待编程字节的位置 */
+    volatile uint16_t       count;    /*!< 缓冲区中待编程的字节数 */
+    volatile fmc_state_enum state;    /*!< 第一个编程错误(FMC_READY: 无错误) */
+    cap_flash_callback_t    callback; /*!< 非阻塞模式的完成回调函数，NULL为阻塞模式 */
+} cap_flash_writer_t;
+
+static uint8_t            g_flash_buf[CAP_FLASH_BUF_SIZE];
+static cap_flash_writer_t g_flash;
+
+/**
+ * @brief 擦除覆盖指定范围的所有页(阻塞)
+ */
+fmc_state_enum cap_flash_erase(uint32_t address, uint32_t length)
+{
+    fmc_state_enum state = FMC_READY;
+    uint32_t       page;
+    uint32_t       last;
+
+    if (g_flash.active) { return FMC_BUSY; }
+    if (length == 0U) { return FMC_READY; }
+
+    page = (address - MAIN_FLASH_BASE_ADDRESS) / MAIN_FLASH_PAGE_SIZE;
+    last = (address + length - 1U - MAIN_FLASH_BASE_ADDRESS) / MAIN_FLASH_PAGE_SIZE;
+    if (last >= MAIN_FLASH_PAGE_TOTAL_NUM) { return FMC_UNDEFINEDERR; }
+
+    fmc_unlock();
+    for (; page <= last && state == FMC_READY; page++) {
+        FMC_STAT = CAP_FLASH_STAT_CLEAR;
+        state    = fmc_page_erase(page);
+    }
+    fmc_lock();
+
+    return state;
+}
+
+/**
+ * @brief 下一次编程操作的字节数，0表示等待更多数据
+ *
+ * 行边界处凑满一行才用快速编程，不在行边界时按双字编程到行边界
+ */
+static uint32_t cap_flash_next_size(void)
+{
+    if ((g_flash.addr & (CAP_FLASH_ROW_SIZE - 1U)) == 0U) {
+        if (g_flash.count >= CAP_FLASH_ROW_SIZE) { return CAP_FLASH_ROW_SIZE; }
+        if (!g_flash.flushing) { return 0U; }
+    }
+    if (g_flash.count >= 8U) { return 8U; }
+    return (g_flash.flushing && g_flash.count != 0U) ? 8U : 0U;
+}
+
+/**
+ * @brief 从缓冲区取出数据开始一次编程操作
+ *
+ * 阻塞模式下等待完成并返回结果；非阻塞模式下返回FMC_BUSY，完成后进入FMC中断
+ */
+static fmc_state_enum cap_flash_program(uint32_t size)
+{
+    uint32_t       words[CAP_FLASH_ROW_SIZE / 4U];
+    uint8_t       *bytes = (uint8_t *)words;
+    uint32_t       n     = (g_flash.count < size) ? g_flash.count : size;
+    uint32_t       head  = g_flash.head;
+    uint32_t       primask;
+    uint32_t       i;
+    fmc_state_enum state;
+
+    for (i = 0U; i < n; i++) {
+        bytes[i] = g_flash_buf[head];
+        if (++head == CAP_FLASH_BUF_SIZE) { head = 0U; }
+    }
+    for (; i < size; i++) { bytes[i] = 0xFFU; }
+    g_flash.head = (uint16_t)head;
+    g_flash.count -= (uint16_t)n;
+
+    FMC_STAT = CAP_FLASH_STAT_CLEAR;
+    if (size == CAP_FLASH_ROW_SIZE) {
+        /* 一行的字需连续写入，中间不能插入中断中的Flash写操作 */
+        primask = __get_PRIMASK();
+        __disable_irq();
+        FMC_CTL |= FMC_CTL_FSTPG;
+        for (i = 0U; i < CAP_FLASH_ROW_SIZE / 4U; i++) { REG32(g_flash.addr + 4U * i) = words[i]; }
+        __set_PRIMASK(primask);
+    } else {
+        FMC_CTL |= FMC_CTL_PG;
+        REG32(g_flash.addr)      = words[0];
+        REG32(g_flash.addr + 4U) = words[1];
+    }
+    g_flash.addr += size;
+
+    if (g_flash.callback != NULL) {
+        g_flash.running = 1;
+        return FMC_BUSY;
+    }
+
+    state = fmc_ready_wait(FMC_TIMEOUT_COUNT);
+    FMC_CTL &= ~(FMC_CTL_PG | FMC_CTL_FSTPG);
+
+    return state;
+}
+
+/**
+ * @brief 结束写入过程: 锁定FMC，非阻塞模式下关闭中断并调用回调函数
+ */
+static void cap_flash_finish(void)
+{
+    cap_flash_callback_t callback = g_flash.callback;
+
+    if (callback != NULL) { fmc_interrupt_disable(FMC_INT_END | FMC_INT_ERR); }
+    fmc_lock();
+    g_flash.count  = 0U;
+    g_flash.active = 0;
+
+    /* 回调函数中可以开始下一次写入 */
+    if (callback != NULL) { callback(g_flash.state); }
+}
+
+/**
+ * @brief 阻塞模式: 编程缓冲区中可以写入的数据
+ */
+static fmc_state_enum cap_flash_drain(void)
+{
+    uint32_t       size;
+    fmc_state_enum state;
+
+    while ((size = cap_flash_next_size()) != 0U) {
+        state = cap_flash_program(size);
+        if (state != FMC_READY) {
+            g_flash.state = state;
+            g_flash.count = 0U;
+            return state;
+        }
+    }
+    return FMC_READY;
+}
+
+/**
+ * @brief 开始写入，解锁FMC
+ */
+fmc_state_enum cap_flash_begin(uint32_t address, cap_flash_callback_t callback)
+{
+    if (g_flash.active) { return FMC_BUSY; }
+    if ((address & 7U) != 0U) { return FMC_PGAERR; }
+
+    g_flash.addr     = address;
+    g_flash.head     = 0U;
+    g_flash.count    = 0U;
+    g_flash.flushing = 0;
+    g_flash.running  = 0;
+    g_flash.state    = FMC_READY;
+    g_flash.callback = callback;
+    g_flash.active   = 1;
+
+    fmc_unlock();
+    FMC_STAT = CAP_FLASH_STAT_CLEAR;
+    if (callback != NULL) {
+        fmc_interrupt_enable(FMC_INT_END | FMC_INT_ERR);
+        nvic_irq_enable(FMC_IRQn, 3);
+    }
+
+    return FMC_READY;
+}
+
+/**
+ * @brief 复制数据到缓冲区尾部(调用前已确认空间足够)
+ */
+static void cap_flash_buf_put(const uint8_t *src, uint32_t length, uint32_t tail)
+{
+    while (length--) {
+        g_flash_buf[tail] = *src++;
+        if (++tail == CAP_FLASH_BUF_SIZE) { tail = 0U; }
+    }
+}
+
+/**
+ * @brief 追加数据
+ */
+fmc_state_enum cap_flash_write(const void *data, uint32_t length)
+{
+    const uint8_t *src = (const uint8_t *)data;
+    uint32_t       primask;
+    uint32_t       tail;
+    uint32_t       chunk;
+    uint32_t       size;
+
+    if (!g_flash.active || g_flash.flushing) { return FMC_PGSERR; }
+    if (g_flash.state != FMC_READY) { return g_flash.state; }
+
+    if (g_flash.callback == NULL) {
+        /* 每次复制后编程，缓冲区中只剩不足一次编程的数据 */
+        while (length != 0U) {
+            chunk = CAP_FLASH_BUF_SIZE - g_flash.count;
+            if (chunk > length) { chunk = length; }
+            tail = (g_flash.head + g_flash.count) % CAP_FLASH_BUF_SIZE;
+            cap_flash_buf_put(src, chunk, tail);
+            g_flash.count += (uint16_t)chunk;
+            src += chunk;
+            length -= chunk;
+            if (cap_flash_drain() != FMC_READY) { return g_flash.state; }
+        }
+        return FMC_READY;
+    }
+
+    /* 非阻塞模式: 中断只增加head、减少count，尾部位置不变 */
+    primask = __get_PRIMASK();
+    __disable_irq();
+    chunk = CAP_FLASH_BUF_SIZE - g_flash.count;
+    tail  = (g_flash.head + g_flash.count) % CAP_FLASH_BUF_SIZE;
+    __set_PRIMASK(primask);
+
+    if (length > CAP_FLASH_BUF_SIZE) { return FMC_UNDEFINEDERR; }
+    if (length > chunk) { return FMC_BUSY; }
+    cap_flash_buf_put(src, length, tail);
+
+    __disable_irq();
+    g_flash.count += (uint16_t)length;
+    if (!g_flash.running && g_flash.state == FMC_READY) {
+        size = cap_flash_next_size();
+        if (size != 0U) { cap_flash_program(size); }
+    }
+    __set_PRIMASK(primask);
+
+    return g_flash.state;
+}
+
+/**
+ * @brief 写入剩余数据并结束
+ */
+fmc_state_enum cap_flash_end(void)
+{
+    uint32_t primask;
+    uint32_t size;
+
+    if (!g_flash.active || g_flash.flushing) { return g_flash.active ? FMC_BUSY : g_flash.state; }
+
+    if (g_flash.callback == NULL) {
+        g_flash.flushing = 1;
+        if (g_flash.state == FMC_READY) { cap_flash_drain(); }
+        cap_flash_finish();
+        return g_flash.state;
+    }
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    g_flash.flushing = 1;
+    if (!g_flash.running) {
+        size = (g_flash.state == FMC_READY) ? cap_flash_next_size() : 0U;
+        if (size != 0U) {
+            cap_flash_program(size);
+        } else {
+            cap_flash_finish();
+        }
+    }
+    __set_PRIMASK(primask);
+
+    return g_flash.active ? FMC_BUSY : g_flash.state;
+}
+
+/**
+ * @brief 查询写入状态
+ */
+fmc_state_enum cap_flash_state(void)
+{
+    return g_flash.active ? FMC_BUSY : g_flash.state;
+}
+
+/**
+ * @brief 下一个写入字节的地址
+ */
+uint32_t cap_flash_address(void)
+{
+    uint32_t primask = __get_PRIMASK();
+    uint32_t address;
+
+    __disable_irq();
+    address = g_flash.addr + g_flash.count;
+    __set_PRIMASK(primask);
+
+    return address;
+}
+
+/**
+ * @brief FMC中断处理函数: 一次编程操作结束，开始下一次或结束写入过程
+ */
+void cap_flash_irq_handler(void)
+{
+    fmc_state_enum state;
+    uint32_t       size;
+
+    if (!g_flash.running || (FMC_STAT & FMC_STAT_BUSY)) {
+        FMC_STAT = FMC_STAT_ENDF;
+        return;
+    }
+
+    state = fmc_state_get();
+    FMC_STAT = CAP_FLASH_STAT_CLEAR;
+    FMC_CTL &= ~(FMC_CTL_PG | FMC_CTL_FSTPG);
+    g_flash.running = 0;
+
+    if (state != FMC_READY) {
+        /* 出错后丢弃剩余数据，cap_flash_end()后结束 */
+        g_flash.state = state;
+        g_flash.count = 0U;
+        if (g_flash.flushing) { cap_flash_finish(); }
+        return;
+    }
+
+    size = cap_flash_next_size();
+    if (size != 0U) {
+        cap_flash_program(size);
+    } else if (g_flash.flushing) {
+        cap_flash_finish();
+    }
+}
@@ -0,0 +1,101 @@
+/**
+ * @file cap_flash.h
+ * @brief Flash流式写入头文件 - GD32C2x1版本
+ * @version 1.0
+ * @date 2025-11-01
+ *
+ * 标准外设库的 fmc_doubleword_program() 每8字节等待一次编程完成，fmc_fast_program()
+ * 需要调用者准备好整行数据并在 fmc_ready_wait() 中等待。本模块按字节流写入:
+ * - cap_flash_write() 追加任意长度的数据到内部缓冲区，凑满一行(DOUBLEWORD_CNT_IN_ROW个双字，
+ *   64字节)且地址按行对齐时用快速编程(FSTPG)一次写入，起始地址不在行边界时先按双字编程到行边界
+ * - cap_flash_end() 写入剩余数据，最后不足一个双字的部分以0xFF填充
+ * - 阻塞模式下在调用中等待编程完成；非阻塞模式下编程由FMC操作结束中断推进，
+ *   cap_flash_write() 只复制数据，缓冲区满时返回FMC_BUSY(不写入任何数据)，调用者稍后重试
+ *
+ * 编程期间从Flash取指和读数据的总线访问被暂停(快速编程一行约160us)，
+ * 非阻塞模式只省去轮询，不能让Flash中的代码与编程并行执行。
+ * 写入前需要已擦除(cap_flash_erase())，一次只能有一个写入过程。
+ */
+
+#ifndef CAP_FLASH_H_
+#define CAP_FLASH_H_
+
+#include "gd32c2x1.h"
+#include <stdint.h>
+
+/** 快速编程一行的字节数 */
+#define CAP_FLASH_ROW_SIZE (DOUBLEWORD_CNT_IN_ROW * 8U)
+
+/** 待编程数据缓冲区大小(字节)，需为行大小的整数倍且不小于两行 */
+#ifndef CAP_FLASH_BUF_SIZE
+#define CAP_FLASH_BUF_SIZE 256U
+#endif
+
+/**
+ * @brief 非阻塞写入完成回调函数类型(在FMC中断中调用)
+ *
+ * @param state FMC_READY: 全部数据已写入; 其他: 出错时的状态，之后的数据被丢弃
+ */
+typedef void (*cap_flash_callback_t)(fmc_state_enum state);
+
+/**
+ * @brief 擦除覆盖 [address, address + length) 的所有页(阻塞)
+ *
+ * @param address 起始地址
+ * @param length 长度(字节)
+ * @return fmc_state_enum FMC_READY: 成功; FMC_BUSY: 正在写入; 其他: 错误
+ */
+fmc_state_enum cap_flash_erase(uint32_t address, uint32_t length);
+
+/**
+ * @brief 开始写入，解锁FMC
+ *
+ * @param address 起始地址(需按双字对齐)
+ * @param callback NULL: 阻塞模式; 非NULL: 非阻塞模式，cap_flash_end()的数据全部写入后调用
+ * @return fmc_state_enum FMC_READY: 成功; FMC_BUSY: 上一次写入未结束; FMC_PGAERR: 地址未对齐
+ */
+fmc_state_enum cap_flash_begin(uint32_t address, cap_flash_callback_t callback);
+
+/**
+ * @brief 追加数据
+ *
+ * 非阻塞模式下一次追加的长度不能超过CAP_FLASH_BUF_SIZE
+ *
+ * @param data 数据
+ * @param length 长度(字节)
+ * @return fmc_state_enum FMC_READY: 成功(非阻塞模式为已复制); FMC_BUSY: 缓冲区空间不足(非阻塞模式);
+ *         FMC_UNDEFINEDERR: 长度超过缓冲区(非阻塞模式);
+ *         其他: 编程错误(之后的写入均返回该错误，直到cap_flash_end())
+ */
+fmc_state_enum cap_flash_write(const void *data, uint32_t length);
+
+/**
+ * @brief 写入剩余数据并结束
+ *
+ * 阻塞模式下等待编程完成后锁定FMC；非阻塞模式下立即返回，最后一次编程完成后
+ * 在中断中锁定FMC并调用回调函数
+ *
+ * @return fmc_state_enum 阻塞模式: 写入结果; 非阻塞模式: FMC_BUSY或已发生的错误
+ */
+fmc_state_enum cap_flash_end(void);
+
+/**
+ * @brief 查询写入状态
+ *
+ * @return fmc_state_enum FMC_BUSY: 写入过程未结束; FMC_READY: 空闲; 其他: 上一次写入的错误
+ */
+fmc_state_enum cap_flash_state(void);
+
+/**
+ * @brief 下一个写入字节的地址(已追加、包括尚未编程的数据)
+ */
+uint32_t cap_flash_address(void);
+
+/**
+ * @brief FMC中断处理函数
+ *
+ * 需要在FMC_IRQHandler中调用
+ */
+void cap_flash_irq_handler(void);
+
+#endif /* CAP_FLASH_H_ */
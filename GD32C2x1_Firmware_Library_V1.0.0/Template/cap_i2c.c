@@ -0,0 +1,454 @@
+/**
+ * @file cap_i2c.c
+ * @brief 电容触摸I2C从机寄存器接口实现 - GD32C2x1版本
+ * @version 1.0
+ * @date 2025-11-01
+ *
+ * 数据路径(参考Examples/I2C/Master_transmitter&slave_receiver_dma):
+ * 1. 每次扫描完成后，在数据就绪回调中把状态、事件和通道数据写入后台寄存器快照
+ * 2. 主机读操作时，地址匹配中断只配置一次DMA_CH2，之后由DMA直接从前台快照
+ *    发送，每字节无CPU参与；读操作进行中到达的新快照在STOP后再切换为前台
+ * 3. 主机写操作(寄存器地址和少量配置)按字节在接收中断中处理，
+ *    配置在STOP后交给主循环中的cap_i2c_poll()调用cap_touch接口应用
+ *
+ * I2C0中断与触摸捕获中断优先级相同，不会互相抢占，快照和事件FIFO无需加锁。
+ */
+
+#include "cap_i2c.h"
+#include <string.h>
+
+/** 事件FIFO下标掩码 */
+#define CAP_I2C_EVENT_MASK (CAP_I2C_EVENT_FIFO_SIZE - 1U)
+
+/** 可写寄存器数 */
+#define CAP_I2C_WRITE_SIZE (CAP_I2C_REG_WRITE_LAST - CAP_I2C_REG_WRITE_FIRST + 1)
+
+/** 寄存器快照(双缓冲: 一个由DMA发送，另一个写入下一帧) */
+static uint8_t g_i2c_regs[2][CAP_I2C_REG_MAP_SIZE];
+static uint8_t g_i2c_front = 0;
+
+/** 读操作进行中 / 有待切换的快照 */
+static uint8_t g_i2c_reading      = 0;
+static uint8_t g_i2c_swap_pending = 0;
+
+/** 寄存器地址和本次写操作已接收字节数 */
+static uint8_t g_i2c_pointer  = 0;
+static uint8_t g_i2c_rx_count = 0;
+
+/** 写操作缓冲区和待主循环应用的配置 */
+static uint8_t          g_i2c_wbuf[CAP_I2C_WRITE_SIZE];
+static uint8_t          g_i2c_wdirty = 0;
+static uint8_t          g_i2c_cfg[CAP_I2C_WRITE_SIZE];
+static volatile uint8_t g_i2c_cfg_pending = 0;
+
+/** 事件FIFO: 低8位为事件码，高8位为帧序号 */
+static uint16_t g_i2c_events[CAP_I2C_EVENT_FIFO_SIZE];
+static uint8_t  g_i2c_event_head = 0;
+static uint8_t  g_i2c_event_tail = 0;
+static uint8_t  g_i2c_event_overflow = 0;
+static uint32_t g_i2c_event_overflows = 0;
+
+/** 帧序号、数据就绪标志和上一帧的触摸/接近状态 */
+static uint8_t g_i2c_frame_seq  = 0;
+static uint8_t g_i2c_data_ready = 0;
+static uint8_t g_i2c_last_mask  = 0;
+static uint8_t g_i2c_last_prox  = 0;
+
+/** 中断请求使能 */
+static volatile uint8_t g_i2c_irq_enable = CAP_I2C_IRQ_EVENT;
+
+/**
+ * @brief 写入小端16位数
+ */
+static inline void cap_i2c_put_u16(uint8_t *p, uint16_t value)
+{
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+}
+
+/**
+ * @brief 读取小端16位数
+ */
+static inline uint16_t cap_i2c_get_u16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+/**
+ * @brief 获取事件FIFO中的事件数
+ */
+static inline uint8_t cap_i2c_event_used(void)
+{
+    return (uint8_t)((g_i2c_event_head - g_i2c_event_tail) & CAP_I2C_EVENT_MASK);
+}
+
+/**
+ * @brief 向事件FIFO写入一个事件，FIFO满时丢弃并置位溢出标志
+ */
+static void cap_i2c_event_push(uint8_t code)
+{
+    if (cap_i2c_event_used() == CAP_I2C_EVENT_FIFO_SIZE - 1U) {
+        g_i2c_event_overflow = 1;
+        g_i2c_event_overflows++;
+        return;
+    }
+
+    g_i2c_events[g_i2c_event_head] = (uint16_t)(code | (g_i2c_frame_seq << 8));
+    g_i2c_event_head = (g_i2c_event_head + 1U) & CAP_I2C_EVENT_MASK;
+}
+
+/**
+ * @brief 从事件FIFO移除主机已处理的事件
+ */
+static void cap_i2c_event_ack(uint8_t count)
+{
+    uint8_t used = cap_i2c_event_used();
+
+    if (count > used) { count = used; }
+    g_i2c_event_tail = (g_i2c_event_tail + count) & CAP_I2C_EVENT_MASK;
+
+    if (cap_i2c_event_used() == 0) { g_i2c_event_overflow = 0; }
+}
+
+/**
+ * @brief 把状态位和事件块写入寄存器快照
+ */
+static void cap_i2c_fill_events(uint8_t *regs)
+{
+    uint8_t used  = cap_i2c_event_used();
+    uint8_t count = (used > CAP_I2C_EVENT_SLOTS) ? CAP_I2C_EVENT_SLOTS : used;
+    uint8_t status;
+
+    status = regs[CAP_I2C_REG_STATUS] & (CAP_I2C_STATUS_PROXIMITY | CAP_I2C_STATUS_GUARD | CAP_I2C_STATUS_IDLE);
+    if (g_i2c_data_ready) { status |= CAP_I2C_STATUS_DATA_READY; }
+    if (used) { status |= CAP_I2C_STATUS_EVENT; }
+    if (g_i2c_event_overflow) { status |= CAP_I2C_STATUS_OVERFLOW; }
+    regs[CAP_I2C_REG_STATUS] = status;
+
+    regs[CAP_I2C_REG_EVENT_COUNT] = count;
+    for (uint8_t i = 0; i < CAP_I2C_EVENT_SLOTS; i++) {
+        uint16_t event = (i < count) ? g_i2c_events[(g_i2c_event_tail + i) & CAP_I2C_EVENT_MASK] : 0;
+
+        cap_i2c_put_u16(&regs[CAP_I2C_REG_EVENTS + 2U * i], event);
+    }
+}
+
+/**
+ * @brief 根据数据就绪标志和事件FIFO更新中断请求引脚
+ */
+static void cap_i2c_irq_update(void)
+{
+    uint8_t assert = 0;
+
+    if ((g_i2c_irq_enable & CAP_I2C_IRQ_DATA_READY) && g_i2c_data_ready) { assert = 1; }
+    if ((g_i2c_irq_enable & CAP_I2C_IRQ_EVENT) && cap_i2c_event_used()) { assert = 1; }
+
+    /* 低电平有效 */
+    gpio_bit_write(CAP_I2C_IRQ_PORT, CAP_I2C_IRQ_PIN, assert ? RESET : SET);
+}
+
+/**
+ * @brief 用新的扫描数据更新寄存器快照
+ */
+void cap_i2c_update(const capture_data_t *data)
+{
+    uint8_t *regs = g_i2c_regs[g_i2c_front ^ 1];
+    uint8_t  mask = cap_touch_get_touch_mask();
+    uint8_t  prox = cap_touch_is_proximity() ? 1 : 0;
+    uint8_t  changed;
+    uint8_t  status = 0;
+
+    g_i2c_frame_seq++;
+    g_i2c_data_ready = 1;
+
+    /* 触摸和接近状态的变化写入事件FIFO */
+    changed = mask ^ g_i2c_last_mask;
+    for (uint8_t i = 0; i < CAP_TOUCH_CHANNEL_COUNT; i++) {
+        if (changed & (1U << i)) { cap_i2c_event_push((uint8_t)(i | ((mask & (1U << i)) ? CAP_I2C_EVENT_PRESS : 0))); }
+    }
+    if (prox != g_i2c_last_prox) { cap_i2c_event_push(CAP_I2C_EVENT_PROXIMITY | (prox ? CAP_I2C_EVENT_PRESS : 0)); }
+    g_i2c_last_mask = mask;
+    g_i2c_last_prox = prox;
+
+    /* 状态和事件 */
+    if (prox) { status |= CAP_I2C_STATUS_PROXIMITY; }
+    if (cap_touch_is_guard_veto()) { status |= CAP_I2C_STATUS_GUARD; }
+    if (cap_touch_get_scan_mode() == CAP_SCAN_IDLE) { status |= CAP_I2C_STATUS_IDLE; }
+    regs[CAP_I2C_REG_STATUS]     = status;
+    regs[CAP_I2C_REG_TOUCH_MASK] = mask;
+    regs[CAP_I2C_REG_FRAME_SEQ]  = g_i2c_frame_seq;
+    cap_i2c_fill_events(regs);
+
+    /* 通道块: 原始值、基线、差值，超出16位时饱和 */
+    for (uint8_t i = 0; i < CAP_TOUCH_CHANNEL_COUNT; i++) {
+        uint8_t *ch       = &regs[CAP_I2C_REG_CHANNELS + CAP_I2C_CHANNEL_STRIDE * i];
+        uint32_t raw      = data->values[i];
+        uint32_t baseline = cap_touch_get_baseline(i);
+        int32_t  delta    = cap_touch_get_delta(i);
+
+        if (raw > 0xFFFF) { raw = 0xFFFF; }
+        if (baseline > 0xFFFF) { baseline = 0xFFFF; }
+        if (delta > 32767) { delta = 32767; }
+        if (delta < -32768) { delta = -32768; }
+
+        cap_i2c_put_u16(&ch[0], (uint16_t)raw);
+        cap_i2c_put_u16(&ch[2], (uint16_t)baseline);
+        cap_i2c_put_u16(&ch[4], (uint16_t)(int16_t)delta);
+    }
+
+    /* 配置寄存器回读当前值 */
+    for (uint8_t i = 0; i < CAP_TOUCH_CHANNEL_COUNT; i++) {
+        cap_i2c_put_u16(&regs[CAP_I2C_REG_THRESHOLD + 2U * i], cap_touch_get_threshold(i));
+    }
+    cap_i2c_put_u16(&regs[CAP_I2C_REG_PROX_THRESH], cap_touch_get_proximity_threshold());
+    regs[CAP_I2C_REG_PROX_ENABLE] = cap_touch_is_proximity_enabled() ? 1 : 0;
+    regs[CAP_I2C_REG_IRQ_ENABLE]  = g_i2c_irq_enable;
+    regs[CAP_I2C_REG_EVENT_ACK]   = 0;
+
+    /* 读操作进行中时等STOP后切换，否则立即切换 */
+    if (g_i2c_reading) {
+        g_i2c_swap_pending = 1;
+    } else {
+        g_i2c_front ^= 1;
+    }
+
+    cap_i2c_irq_update();
+}
+
+/**
+ * @brief 地址匹配: 主机读时启动DMA发送，主机写时准备接收
+ */
+static void cap_i2c_address_match(void)
+{
+    uint8_t *regs = g_i2c_regs[g_i2c_front];
+    uint8_t  ptr  = (g_i2c_pointer < CAP_I2C_REG_MAP_SIZE) ? g_i2c_pointer : 0;
+
+    if (i2c_flag_get(I2C0, I2C_FLAG_TR) == SET) {
+        /* 丢弃上次读操作预取到I2C_TDATA中的字节 */
+        I2C_STAT(I2C0) |= I2C_STAT_TBE;
+
+        /* DMA循环模式: 主机读过寄存器表末尾时从起始地址重复，不会因DMA结束而拉低SCL */
+        dma_channel_disable(DMA_CH2);
+        dma_memory_address_config(DMA_CH2, (uint32_t)&regs[ptr]);
+        dma_transfer_number_config(DMA_CH2, CAP_I2C_REG_MAP_SIZE - ptr);
+        dma_channel_enable(DMA_CH2);
+        g_i2c_reading = 1;
+
+        /* 读取STATUS即清除数据就绪 */
+        if (ptr == CAP_I2C_REG_STATUS) {
+            g_i2c_data_ready = 0;
+            cap_i2c_irq_update();
+        }
+    } else {
+        /* 以当前配置为底，主机只写部分字节时其余保持不变 */
+        memcpy(g_i2c_wbuf, &regs[CAP_I2C_REG_WRITE_FIRST], CAP_I2C_WRITE_SIZE);
+        g_i2c_wbuf[CAP_I2C_REG_EVENT_ACK - CAP_I2C_REG_WRITE_FIRST] = 0;
+        g_i2c_rx_count = 0;
+    }
+
+    i2c_interrupt_flag_clear(I2C0, I2C_INT_FLAG_ADDSEND);
+}
+
+/**
+ * @brief 接收主机写入的一个字节: 第一个字节为寄存器地址，之后为数据
+ */
+static void cap_i2c_receive(uint8_t byte)
+{
+    if (g_i2c_rx_count++ == 0) {
+        g_i2c_pointer = byte;
+        return;
+    }
+
+    if (g_i2c_pointer >= CAP_I2C_REG_WRITE_FIRST && g_i2c_pointer <= CAP_I2C_REG_WRITE_LAST) {
+        g_i2c_wbuf[g_i2c_pointer - CAP_I2C_REG_WRITE_FIRST] = byte;
+        g_i2c_wdirty = 1;
+    }
+
+    if (g_i2c_pointer < CAP_I2C_REG_MAP_SIZE) { g_i2c_pointer++; }
+}
+
+/**
+ * @brief STOP: 结束DMA发送，切换快照，处理写入的配置和事件确认
+ */
+static void cap_i2c_stop(void)
+{
+    uint8_t *regs;
+
+    if (g_i2c_reading) {
+        dma_channel_disable(DMA_CH2);
+        g_i2c_reading = 0;
+
+        if (g_i2c_swap_pending) {
+            g_i2c_front ^= 1;
+            g_i2c_swap_pending = 0;
+        }
+    }
+
+    /* 此时DMA已停止，可以直接修改前台快照 */
+    regs = g_i2c_regs[g_i2c_front];
+
+    if (g_i2c_wdirty) {
+        g_i2c_wdirty = 0;
+        cap_i2c_event_ack(g_i2c_wbuf[CAP_I2C_REG_EVENT_ACK - CAP_I2C_REG_WRITE_FIRST]);
+        g_i2c_wbuf[CAP_I2C_REG_EVENT_ACK - CAP_I2C_REG_WRITE_FIRST] = 0;
+
+        memcpy(g_i2c_cfg, g_i2c_wbuf, CAP_I2C_WRITE_SIZE);
+        g_i2c_cfg_pending = 1;
+
+        /* 回读立即反映写入值，下一帧快照中为实际生效值 */
+        memcpy(&regs[CAP_I2C_REG_WRITE_FIRST], g_i2c_wbuf, CAP_I2C_WRITE_SIZE);
+    }
+
+    /* 数据就绪和事件可能已被本次读写清除 */
+    cap_i2c_fill_events(regs);
+    cap_i2c_irq_update();
+}
+
+/**
+ * @brief I2C0事件中断处理函数
+ */
+void cap_i2c_event_irq_handler(void)
+{
+    /* 重复起始时先处理写操作的最后一个字节，再处理读操作的地址匹配 */
+    if (i2c_interrupt_flag_get(I2C0, I2C_INT_FLAG_RBNE)) { cap_i2c_receive(i2c_data_receive(I2C0)); }
+
+    if (i2c_interrupt_flag_get(I2C0, I2C_INT_FLAG_ADDSEND)) { cap_i2c_address_match(); }
+
+    if (i2c_interrupt_flag_get(I2C0, I2C_INT_FLAG_STPDET)) {
+        i2c_interrupt_flag_clear(I2C0, I2C_INT_FLAG_STPDET);
+        /* 主机读结束时对最后一个字节回复NACK */
+        i2c_flag_clear(I2C0, I2C_FLAG_NACK);
+        cap_i2c_stop();
+    }
+}
+
+/**
+ * @brief I2C0错误中断处理函数
+ *
+ * 清除错误标志后按STOP处理，从机等待主机的下一次传输
+ */
+void cap_i2c_error_irq_handler(void)
+{
+    if (i2c_interrupt_flag_get(I2C0, I2C_INT_FLAG_BERR)) { i2c_interrupt_flag_clear(I2C0, I2C_INT_FLAG_BERR); }
+    if (i2c_interrupt_flag_get(I2C0, I2C_INT_FLAG_LOSTARB)) { i2c_interrupt_flag_clear(I2C0, I2C_INT_FLAG_LOSTARB); }
+    if (i2c_interrupt_flag_get(I2C0, I2C_INT_FLAG_OUERR)) { i2c_interrupt_flag_clear(I2C0, I2C_INT_FLAG_OUERR); }
+
+    g_i2c_wdirty = 0;
+    cap_i2c_stop();
+}
+
+/**
+ * @brief 应用主机写入的配置寄存器
+ */
+void cap_i2c_poll(void)
+{
+    uint8_t cfg[CAP_I2C_WRITE_SIZE];
+
+    if (!g_i2c_cfg_pending) { return; }
+
+    /* 复制时屏蔽I2C0事件中断，避免与下一次写操作交错 */
+    nvic_irq_disable(I2C0_EV_IRQn);
+    memcpy(cfg, g_i2c_cfg, CAP_I2C_WRITE_SIZE);
+    g_i2c_cfg_pending = 0;
+    nvic_irq_enable(I2C0_EV_IRQn, 3);
+
+    /* 非法值(例如阈值为0)由cap_touch拒绝，下一帧回读为实际值 */
+    for (uint8_t i = 0; i < CAP_TOUCH_CHANNEL_COUNT; i++) {
+        cap_touch_set_threshold(i, cap_i2c_get_u16(&cfg[CAP_I2C_REG_THRESHOLD + 2U * i - CAP_I2C_REG_WRITE_FIRST]));
+    }
+    cap_touch_set_proximity_threshold(cap_i2c_get_u16(&cfg[CAP_I2C_REG_PROX_THRESH - CAP_I2C_REG_WRITE_FIRST]));
+    cap_touch_proximity_enable(cfg[CAP_I2C_REG_PROX_ENABLE - CAP_I2C_REG_WRITE_FIRST] ? CAP_TRUE : CAP_FALSE);
+    g_i2c_irq_enable = cfg[CAP_I2C_REG_IRQ_ENABLE - CAP_I2C_REG_WRITE_FIRST] & (CAP_I2C_IRQ_DATA_READY | CAP_I2C_IRQ_EVENT);
+}
+
+/**
+ * @brief 配置I2C0引脚和中断请求引脚
+ */
+static void cap_i2c_gpio_config(void)
+{
+    rcu_periph_clock_enable(RCU_GPIOB);
+    rcu_periph_clock_enable(CAP_I2C_IRQ_RCU);
+
+    /* PB8为I2C0_SCL, PB9为I2C0_SDA */
+    gpio_af_set(GPIOB, GPIO_AF_6, GPIO_PIN_8 | GPIO_PIN_9);
+    gpio_mode_set(GPIOB, GPIO_MODE_AF, GPIO_PUPD_PULLUP, GPIO_PIN_8 | GPIO_PIN_9);
+    gpio_output_options_set(GPIOB, GPIO_OTYPE_OD, GPIO_OSPEED_LEVEL_1, GPIO_PIN_8 | GPIO_PIN_9);
+
+    /* 中断请求引脚推挽输出，初始为高电平(无请求) */
+    gpio_bit_write(CAP_I2C_IRQ_PORT, CAP_I2C_IRQ_PIN, SET);
+    gpio_mode_set(CAP_I2C_IRQ_PORT, GPIO_MODE_OUTPUT, GPIO_PUPD_NONE, CAP_I2C_IRQ_PIN);
+    gpio_output_options_set(CAP_I2C_IRQ_PORT, GPIO_OTYPE_PP, GPIO_OSPEED_LEVEL_0, CAP_I2C_IRQ_PIN);
+}
+
+/**
+ * @brief 配置DMA_CH2从寄存器快照发送到I2C0
+ */
+static void cap_i2c_dma_config(void)
+{
+    dma_parameter_struct dma_init_struct;
+
+    rcu_periph_clock_enable(RCU_DMA);
+    rcu_periph_clock_enable(RCU_DMAMUX);
+
+    dma_deinit(DMA_CH2);
+    dma_struct_para_init(&dma_init_struct);
+
+    dma_init_struct.request      = DMA_REQUEST_I2C0_TX;           /* I2C0_TX请求 */
+    dma_init_struct.direction    = DMA_MEMORY_TO_PERIPHERAL;      /* 内存到外设 */
+    dma_init_struct.memory_addr  = (uint32_t)g_i2c_regs[0];       /* 内存地址(读操作时重新设置) */
+    dma_init_struct.memory_inc   = DMA_MEMORY_INCREASE_ENABLE;    /* 内存地址自增 */
+    dma_init_struct.memory_width = DMA_MEMORY_WIDTH_8BIT;         /* 内存数据宽度8位 */
+    dma_init_struct.number       = CAP_I2C_REG_MAP_SIZE;          /* 传输数量(读操作时重新设置) */
+    dma_init_struct.periph_addr  = (uint32_t)&I2C_TDATA(I2C0);    /* 外设地址 */
+    dma_init_struct.periph_inc   = DMA_PERIPH_INCREASE_DISABLE;   /* 外设地址不变 */
+    dma_init_struct.periph_width = DMA_PERIPHERAL_WIDTH_8BIT;     /* 外设数据宽度8位 */
+    dma_init_struct.priority     = DMA_PRIORITY_MEDIUM;           /* 低于串口 */
+
+    dma_init(DMA_CH2, &dma_init_struct);
+
+    dma_circulation_enable(DMA_CH2);
+    dma_memory_to_memory_disable(DMA_CH2);
+    dmamux_synchronization_disable(DMAMUX_MUXCH2);
+}
+
+/**
+ * @brief 初始化I2C从机接口
+ */
+void cap_i2c_init(void)
+{
+    memset(g_i2c_regs, 0, sizeof(g_i2c_regs));
+    g_i2c_front      = 0;
+    g_i2c_reading    = 0;
+    g_i2c_pointer    = 0;
+    g_i2c_event_head = 0;
+    g_i2c_event_tail = 0;
+
+    cap_i2c_gpio_config();
+    cap_i2c_dma_config();
+
+    /* I2C时钟选择CK_SYS(48MHz)，Fm+需要在SYSCFG中同时使能I2C0和引脚的大电流驱动 */
+    rcu_periph_clock_enable(RCU_SYSCFG);
+    rcu_periph_clock_enable(RCU_I2C0);
+    rcu_i2c_clock_config(IDX_I2C0, RCU_I2CSRC_CKSYS);
+    syscfg_i2c_fast_mode_plus_enable(SYSCFG_I2C0_FMPEN | SYSCFG_PB8_FMPEN | SYSCFG_PB9_FMPEN);
+
+    i2c_deinit(I2C0);
+
+    /* 从机只需数据建立时间: SCLDELY=(3+1)/48MHz=83ns，满足Fm+的50ns要求 */
+    i2c_timing_config(I2C0, 0x0, 0x3, 0);
+    i2c_address_config(I2C0, CAP_I2C_SLAVE_ADDRESS7 << 1, I2C_ADDFORMAT_7BITS);
+    i2c_dma_enable(I2C0, I2C_DMA_TRANSMIT);
+    i2c_enable(I2C0);
+
+    i2c_interrupt_enable(I2C0, I2C_INT_ADDM | I2C_INT_RBNE | I2C_INT_STPDET | I2C_INT_ERR);
+    nvic_irq_enable(I2C0_EV_IRQn, 3);
+    nvic_irq_enable(I2C0_ER_IRQn, 3);
+}
+
+/**
+ * @brief 获取因FIFO满而丢失的事件数
+ */
+uint32_t cap_i2c_get_event_overflows(void)
+{
+    return g_i2c_event_overflows;
+}
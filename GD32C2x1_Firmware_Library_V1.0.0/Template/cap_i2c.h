@@ -0,0 +1,120 @@
+/**
+ * @file cap_i2c.h
+ * @brief 电容触摸I2C从机寄存器接口头文件 - GD32C2x1版本
+ * @version 1.0
+ * @date 2025-11-01
+ *
+ * 作为主机SoC旁的触摸协处理器使用: I2C0从机(PB8=SCL, PB9=SDA, Fm+ 1MHz)，
+ * PA9为低电平有效的中断请求输出。
+ *
+ * 访问方式与常见I2C器件相同:
+ * - 写: [地址+W] [寄存器地址] [数据...]，寄存器地址自动递增
+ * - 读: [地址+W] [寄存器地址] [重复起始] [地址+R] [数据...]，
+ *   读操作由DMA直接从快照缓冲区发送，读到寄存器表末尾后从起始寄存器地址重复
+ * - 读操作不改变寄存器地址，设置一次后可直接重复读取同一数据块
+ *
+ * 一次读取0x00-0x43即可得到完整的一帧数据(状态、事件和所有通道)。
+ */
+
+#ifndef CAP_I2C_H_
+#define CAP_I2C_H_
+
+#include "cap_touch.h"
+#include "gd32c2x1.h"
+#include <stdint.h>
+
+/** 7位从机地址 */
+#define CAP_I2C_SLAVE_ADDRESS7 0x2A
+
+/** 中断请求引脚(低电平有效) */
+#define CAP_I2C_IRQ_PORT       GPIOA
+#define CAP_I2C_IRQ_PIN        GPIO_PIN_9
+#define CAP_I2C_IRQ_RCU        RCU_GPIOA
+
+/** 事件FIFO深度(2的幂)和寄存器表中的事件槽数 */
+#define CAP_I2C_EVENT_FIFO_SIZE 16
+#define CAP_I2C_EVENT_SLOTS     8
+
+/* ---------------- 寄存器表 ---------------- */
+
+#define CAP_I2C_REG_STATUS      0x00 /*!< 状态(只读)，CAP_I2C_STATUS_xxx */
+#define CAP_I2C_REG_TOUCH_MASK  0x01 /*!< 触摸掩码(只读) */
+#define CAP_I2C_REG_FRAME_SEQ   0x02 /*!< 帧序号(只读)，每次扫描完成加1 */
+#define CAP_I2C_REG_EVENT_COUNT 0x03 /*!< 事件块中的有效事件数(只读) */
+#define CAP_I2C_REG_EVENTS      0x04 /*!< 事件块(只读)，每个事件2字节: 事件码、帧序号 */
+#define CAP_I2C_REG_CHANNELS    0x20 /*!< 通道块(只读)，每通道6字节: 原始值u16、基线u16、差值i16 */
+#define CAP_I2C_REG_THRESHOLD   0x50 /*!< 各通道触摸阈值u16(读写) */
+#define CAP_I2C_REG_PROX_THRESH 0x5C /*!< 接近阈值u16(读写) */
+#define CAP_I2C_REG_PROX_ENABLE 0x5E /*!< 接近检测使能(读写) */
+#define CAP_I2C_REG_IRQ_ENABLE  0x5F /*!< 中断请求使能(读写)，CAP_I2C_IRQ_xxx */
+#define CAP_I2C_REG_EVENT_ACK   0x60 /*!< 写入已处理的事件数，从FIFO中移除(只写，读为0) */
+#define CAP_I2C_REG_MAP_SIZE    0x64
+
+/** 通道块中每通道字节数 */
+#define CAP_I2C_CHANNEL_STRIDE  6
+
+/** 可写寄存器范围 */
+#define CAP_I2C_REG_WRITE_FIRST CAP_I2C_REG_THRESHOLD
+#define CAP_I2C_REG_WRITE_LAST  CAP_I2C_REG_EVENT_ACK
+
+/* STATUS寄存器位 */
+#define CAP_I2C_STATUS_DATA_READY 0x01 /*!< 上次读取STATUS后有新的扫描帧 */
+#define CAP_I2C_STATUS_EVENT      0x02 /*!< 事件FIFO非空 */
+#define CAP_I2C_STATUS_PROXIMITY  0x04 /*!< 检测到接近 */
+#define CAP_I2C_STATUS_GUARD      0x08 /*!< 防误触屏蔽中 */
+#define CAP_I2C_STATUS_IDLE       0x10 /*!< 空闲扫描模式 */
+#define CAP_I2C_STATUS_OVERFLOW   0x80 /*!< 事件FIFO溢出，有事件丢失(确认全部事件后清除) */
+
+/* IRQ_ENABLE寄存器位 */
+#define CAP_I2C_IRQ_DATA_READY 0x01 /*!< 每帧数据就绪时请求中断 */
+#define CAP_I2C_IRQ_EVENT      0x02 /*!< 有未确认事件时请求中断 */
+
+/* 事件码: bit7为1表示按下/进入接近，为0表示释放/离开；低4位为通道号 */
+#define CAP_I2C_EVENT_PRESS     0x80
+#define CAP_I2C_EVENT_PROXIMITY 0x0F /*!< 接近事件的通道号 */
+
+/**
+ * @brief 初始化I2C从机接口
+ *
+ * 配置I2C0(Fm+)、DMA_CH2和中断请求引脚
+ */
+void cap_i2c_init(void);
+
+/**
+ * @brief 用新的扫描数据更新寄存器快照
+ *
+ * 在数据就绪回调中调用。快照写入后台缓冲区，主机读操作进行中时延迟到读操作结束后切换
+ *
+ * @param data 扫描数据
+ */
+void cap_i2c_update(const capture_data_t *data);
+
+/**
+ * @brief 应用主机写入的配置寄存器
+ *
+ * 在主循环中调用
+ */
+void cap_i2c_poll(void);
+
+/**
+ * @brief I2C0事件中断处理函数
+ *
+ * 需要在I2C0_EV_IRQHandler中调用
+ */
+void cap_i2c_event_irq_handler(void);
+
+/**
+ * @brief I2C0错误中断处理函数
+ *
+ * 需要在I2C0_ER_IRQHandler中调用
+ */
+void cap_i2c_error_irq_handler(void);
+
+/**
+ * @brief 获取因FIFO满而丢失的事件数
+ *
+ * @return uint32_t 丢失事件数
+ */
+uint32_t cap_i2c_get_event_overflows(void);
+
+#endif /* CAP_I2C_H_ */
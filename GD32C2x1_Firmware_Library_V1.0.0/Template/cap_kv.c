@@ -0,0 +1,304 @@
+/**
+ * @file cap_kv.c
+ * @brief Flash键值存储(日志结构，按页轮换)实现 - GD32C2x1版本
+ * @version 1.0
+ * @date 2025-11-01
+ *
+ * 页格式: 页头(8字节) + 记录 + 擦除状态(0xFF)。
+ * 记录格式: 记录头(8字节，CRC + 键 + 长度 + 长度取反) + 值，按双字补齐0xFF。
+ * CRC为CRC-16/CCITT-FALSE(与帧协议相同)，覆盖记录头中CRC之后的6字节和值，
+ * 写入时用软件计算(记录头和值不连续)，校验时记录在Flash中连续，由硬件CRC单元计算。
+ */
+
+#include "cap_kv.h"
+#include "cap_flash.h"
+#include "cap_proto.h"
+#include <stddef.h>
+#include <string.h>
+
+/** 页头魔数 "CPKV" */
+#define CAP_KV_MAGIC       0x564B5043U
+
+#define CAP_KV_PAGE_SIZE   MAIN_FLASH_PAGE_SIZE
+#define CAP_KV_END         (CAP_KV_BASE + CAP_KV_PAGE_COUNT * CAP_KV_PAGE_SIZE)
+
+/** 记录占用的空间: 记录头 + 值(按双字补齐) */
+#define CAP_KV_RECORD_SIZE(length) (sizeof(cap_kv_record_t) + (((uint32_t)(length) + 7U) & ~7U))
+
+/**
+ * @brief 页头
+ */
+typedef struct {
+    uint32_t magic;   /*!< CAP_KV_MAGIC */
+    uint16_t seq;     /*!< 序号，每次整理加1 */
+    uint16_t seq_inv; /*!< ~seq，检查页头是否完整写入 */
+} cap_kv_page_t;
+
+/**
+ * @brief 记录头
+ */
+typedef struct {
+    uint16_t crc;        /*!< 其后6字节和值的CRC-16 */
+    uint16_t key;        /*!< 键 */
+    uint16_t length;     /*!< 值的长度(0为删除) */
+    uint16_t length_inv; /*!< ~length，检查记录头是否完整写入 */
+} cap_kv_record_t;
+
+static const uint8_t g_kv_pad[8] = {0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU};
+
+static uint32_t g_kv_page = 0U;                /* 当前页地址，0为未初始化 */
+static uint16_t g_kv_seq  = 0U;                /* 当前页序号 */
+static uint32_t g_kv_end  = 0U;                /* 下一条记录的地址 */
+static uint16_t g_kv_index[CAP_KV_KEY_COUNT];  /* 各键最后一条记录在页内的偏移，0为不存在 */
+
+/**
+ * @brief 页头是否有效
+ */
+static uint8_t cap_kv_page_valid(const cap_kv_page_t *page)
+{
+    return page->magic == CAP_KV_MAGIC && (uint16_t)(page->seq ^ page->seq_inv) == 0xFFFFU;
+}
+
+/**
+ * @brief 记录的CRC是否正确
+ */
+static uint8_t cap_kv_record_crc_ok(const cap_kv_record_t *rec)
+{
+    return cap_proto_crc16((const uint8_t *)&rec->key, 6U + rec->length) == rec->crc;
+}
+
+/**
+ * @brief 沿记录头扫描当前页的 [页头, limit) 范围，建立索引和写入位置
+ *
+ * @param last 返回最后一条记录的偏移(0为没有记录)
+ * @return uint8_t 1: 遇到不完整的记录头(需要整理)
+ */
+static uint8_t cap_kv_scan(uint32_t limit, uint32_t *last)
+{
+    const cap_kv_record_t *rec;
+    uint32_t               off  = sizeof(cap_kv_page_t);
+    uint8_t                torn = 0;
+
+    memset(g_kv_index, 0, sizeof(g_kv_index));
+    *last = 0U;
+
+    while (off + sizeof(cap_kv_record_t) <= limit) {
+        rec = (const cap_kv_record_t *)(g_kv_page + off);
+
+        /* 擦除状态: 记录结束 */
+        if (((const uint32_t *)rec)[0] == 0xFFFFFFFFU && ((const uint32_t *)rec)[1] == 0xFFFFFFFFU) { break; }
+
+        if ((uint16_t)(rec->length ^ rec->length_inv) != 0xFFFFU || rec->length > CAP_KV_VALUE_MAX ||
+            rec->key >= CAP_KV_KEY_COUNT || off + CAP_KV_RECORD_SIZE(rec->length) > CAP_KV_PAGE_SIZE) {
+            torn = 1;
+            break;
+        }
+
+        g_kv_index[rec->key] = (uint16_t)off;
+        *last = off;
+        off += CAP_KV_RECORD_SIZE(rec->length);
+    }
+
+    g_kv_end = g_kv_page + off;
+    return torn;
+}
+
+/**
+ * @brief 写入页头
+ */
+static uint8_t cap_kv_write_page_header(uint32_t page, uint16_t seq)
+{
+    cap_kv_page_t header = {CAP_KV_MAGIC, seq, (uint16_t)~seq};
+
+    if (cap_flash_begin(page, NULL) != FMC_READY) { return 0; }
+    cap_flash_write(&header, sizeof(header));
+    return cap_flash_end() == FMC_READY;
+}
+
+/**
+ * @brief 在已开始的写入过程中追加一条记录
+ */
+static void cap_kv_put_record(uint8_t key, const void *data, uint16_t length)
+{
+    cap_kv_record_t rec;
+
+    rec.key        = key;
+    rec.length     = length;
+    rec.length_inv = (uint16_t)~length;
+    rec.crc        = cap_proto_crc16_update(CAP_PROTO_CRC_INIT, (const uint8_t *)&rec.key, 6U);
+    rec.crc        = cap_proto_crc16_update(rec.crc, (const uint8_t *)data, length);
+
+    cap_flash_write(&rec, sizeof(rec));
+    cap_flash_write(data, length);
+
+    /* 下一条记录从双字边界开始 */
+    cap_flash_write(g_kv_pad, CAP_KV_RECORD_SIZE(length) - sizeof(rec) - length);
+}
+
+/**
+ * @brief 整理: 各键的有效记录和新记录复制到下一页，写入页头后成为当前页
+ *
+ * @param key 新记录的键，CAP_KV_KEY_COUNT为没有新记录
+ * @param data 新记录的值
+ * @param length 新记录的长度(0为删除该键)
+ */
+static uint8_t cap_kv_compact(uint8_t key, const void *data, uint16_t length)
+{
+    const cap_kv_record_t *rec;
+    uint32_t               next = g_kv_page + CAP_KV_PAGE_SIZE;
+    uint32_t               used = sizeof(cap_kv_page_t);
+    uint32_t               copy = 0U;
+    uint32_t               last;
+    uint8_t                k;
+
+    if (next == CAP_KV_END) { next = CAP_KV_BASE; }
+    if (key < CAP_KV_KEY_COUNT && length != 0U) { used += CAP_KV_RECORD_SIZE(length); }
+
+    /* 已删除和CRC错误的记录不复制 */
+    for (k = 0; k < CAP_KV_KEY_COUNT; k++) {
+        if (k == key || g_kv_index[k] == 0U) { continue; }
+        rec = (const cap_kv_record_t *)(g_kv_page + g_kv_index[k]);
+        if (rec->length == 0U || !cap_kv_record_crc_ok(rec)) { continue; }
+        used += CAP_KV_RECORD_SIZE(rec->length);
+        copy |= 1UL << k;
+    }
+    if (used > CAP_KV_PAGE_SIZE) { return 0; }
+
+    if (cap_flash_erase(next, CAP_KV_PAGE_SIZE) != FMC_READY) { return 0; }
+    if (cap_flash_begin(next + sizeof(cap_kv_page_t), NULL) != FMC_READY) { return 0; }
+    for (k = 0; k < CAP_KV_KEY_COUNT; k++) {
+        if (!(copy & (1UL << k))) { continue; }
+        rec = (const cap_kv_record_t *)(g_kv_page + g_kv_index[k]);
+        cap_flash_write(rec, CAP_KV_RECORD_SIZE(rec->length));
+    }
+    if (key < CAP_KV_KEY_COUNT && length != 0U) { cap_kv_put_record(key, data, length); }
+    if (cap_flash_end() != FMC_READY) { return 0; }
+
+    /* 页头最后写入: 在此之前断电，旧页仍为当前页 */
+    if (!cap_kv_write_page_header(next, (uint16_t)(g_kv_seq + 1U))) { return 0; }
+
+    g_kv_page = next;
+    g_kv_seq++;
+    cap_kv_scan(CAP_KV_PAGE_SIZE, &last);
+    return 1;
+}
+
+/**
+ * @brief 启动: 找到当前页并建立索引
+ */
+uint8_t cap_kv_init(void)
+{
+    const cap_kv_page_t *page;
+    const cap_kv_page_t *best = NULL;
+    uint32_t             last;
+    uint8_t              torn;
+    uint32_t             n;
+
+    for (n = 0; n < CAP_KV_PAGE_COUNT; n++) {
+        page = (const cap_kv_page_t *)(CAP_KV_BASE + n * CAP_KV_PAGE_SIZE);
+        if (!cap_kv_page_valid(page)) { continue; }
+        if (best == NULL || (int16_t)(page->seq - best->seq) > 0) { best = page; }
+    }
+
+    /* 没有有效页: 格式化第一页 */
+    if (best == NULL) {
+        g_kv_page = 0U;
+        if (cap_flash_erase(CAP_KV_BASE, CAP_KV_PAGE_SIZE) != FMC_READY) { return 0; }
+        if (!cap_kv_write_page_header(CAP_KV_BASE, 0U)) { return 0; }
+        best = (const cap_kv_page_t *)CAP_KV_BASE;
+    }
+
+    g_kv_page = (uint32_t)best;
+    g_kv_seq  = best->seq;
+    torn      = cap_kv_scan(CAP_KV_PAGE_SIZE, &last);
+
+    /* 最后一条记录写入时断电: 之前的记录重新建立索引。该记录之后追加新记录时
+       启动只校验新记录，会把它当作该键的有效记录，所以同样整理到下一页 */
+    if (last != 0U && !cap_kv_record_crc_ok((const cap_kv_record_t *)(g_kv_page + last))) {
+        cap_kv_scan(last, &last);
+        torn = 1;
+    }
+
+    /* 记录头不完整时无法确定之后的空间是否可用 */
+    if (torn) { return cap_kv_compact(CAP_KV_KEY_COUNT, NULL, 0); }
+
+    return 1;
+}
+
+/**
+ * @brief 查找键的值
+ */
+const void *cap_kv_find(uint8_t key, uint16_t *length)
+{
+    const cap_kv_record_t *rec;
+
+    if (g_kv_page == 0U || key >= CAP_KV_KEY_COUNT || g_kv_index[key] == 0U) { return NULL; }
+
+    rec = (const cap_kv_record_t *)(g_kv_page + g_kv_index[key]);
+    if (rec->length == 0U || !cap_kv_record_crc_ok(rec)) { return NULL; }
+
+    if (length != NULL) { *length = rec->length; }
+    return rec + 1;
+}
+
+/**
+ * @brief 读取键的值
+ */
+uint8_t cap_kv_get(uint8_t key, void *data, uint16_t size)
+{
+    uint16_t    length = 0;
+    const void *value  = cap_kv_find(key, &length);
+
+    if (value == NULL || length != size) { return 0; }
+
+    memcpy(data, value, size);
+    return 1;
+}
+
+/**
+ * @brief 写入键的值
+ */
+uint8_t cap_kv_set(uint8_t key, const void *data, uint16_t length)
+{
+    uint32_t       off;
+    fmc_state_enum state;
+
+    if (g_kv_page == 0U || key >= CAP_KV_KEY_COUNT || length > CAP_KV_VALUE_MAX) { return 0; }
+
+    /* 删除不存在的键 */
+    if (length == 0U && g_kv_index[key] == 0U) { return 1; }
+
+    if (g_kv_end + CAP_KV_RECORD_SIZE(length) > g_kv_page + CAP_KV_PAGE_SIZE) {
+        return cap_kv_compact(key, data, length);
+    }
+
+    off = g_kv_end - g_kv_page;
+    if (cap_flash_begin(g_kv_end, NULL) != FMC_READY) { return 0; }
+    cap_kv_put_record(key, data, length);
+    state = cap_flash_end();
+
+    /* 编程失败时该记录占用的空间也不再使用 */
+    g_kv_end += CAP_KV_RECORD_SIZE(length);
+    if (state != FMC_READY) { return 0; }
+
+    g_kv_index[key] = (uint16_t)off;
+    return 1;
+}
+
+/**
+ * @brief 删除键
+ */
+uint8_t cap_kv_delete(uint8_t key)
+{
+    return cap_kv_set(key, NULL, 0);
+}
+
+/**
+ * @brief 当前页剩余空间
+ */
+uint32_t cap_kv_free(void)
+{
+    if (g_kv_page == 0U) { return 0U; }
+
+    return g_kv_page + CAP_KV_PAGE_SIZE - g_kv_end;
+}
@@ -0,0 +1,92 @@
+/**
+ * @file cap_kv.h
+ * @brief Flash键值存储(日志结构，按页轮换)头文件 - GD32C2x1版本
+ * @version 1.0
+ * @date 2025-11-01
+ *
+ * 在主Flash末尾保留CAP_KV_PAGE_COUNT个1KB页保存校准和配置:
+ * - 当前页中按写入顺序追加记录(记录头 + 值)，同一个键的最后一条记录有效，
+ *   写入不需要擦除；当前页写满时把各键的有效记录复制到下一页(整理)，各页轮流擦除
+ * - 页头(魔数 + 序号)在整理的记录全部写入后才写入，序号最大的有效页为当前页。
+ *   整理中断电时旧页仍为当前页，未写页头的页下次整理前擦除
+ * - 记录头和值由CRC-16保护。断电只会损坏最后一条记录: 启动时只校验最后一条记录，
+ *   读取时校验被读取的记录；最后一条记录损坏时启动时整理到下一页(只复制之前的记录)
+ * - 启动时只沿记录头跳转，在RAM中建立键到记录位置的索引，读取不需要搜索
+ *
+ * 写入和整理以阻塞方式编程(cap_flash.h)，擦除一页约3ms，期间CPU从Flash取指暂停。
+ * 固件映像(链接地址范围和启动校验范围)需要排除保留的页。
+ */
+
+#ifndef CAP_KV_H_
+#define CAP_KV_H_
+
+#include "gd32c2x1.h"
+#include <stdint.h>
+
+/** 保留的页数(至少2页) */
+#ifndef CAP_KV_PAGE_COUNT
+#define CAP_KV_PAGE_COUNT 4U
+#endif
+
+/** 保留区域起始地址(主Flash最后CAP_KV_PAGE_COUNT页) */
+#define CAP_KV_BASE (MAIN_FLASH_BASE_ADDRESS + MAIN_FLASH_SIZE - CAP_KV_PAGE_COUNT * MAIN_FLASH_PAGE_SIZE)
+
+/** 键的数量(键为0 - CAP_KV_KEY_COUNT-1) */
+#define CAP_KV_KEY_COUNT 16U
+
+/** 值的最大长度(字节) */
+#define CAP_KV_VALUE_MAX 256U
+
+/** 键分配 */
+#define CAP_KV_KEY_TOUCH_CALIB 0x01U /*!< 触摸校准(cap_touch_calib_t) */
+
+/**
+ * @brief 启动: 找到当前页并建立索引，没有有效页时格式化第一页
+ *
+ * @return uint8_t 1: 成功; 0: Flash擦除/编程失败
+ */
+uint8_t cap_kv_init(void);
+
+/**
+ * @brief 查找键的值(直接指向Flash，校验CRC)
+ *
+ * @param key 键
+ * @param length 返回值的长度(可为NULL)
+ * @return const void* 值的地址; NULL: 不存在、已删除或CRC错误
+ */
+const void *cap_kv_find(uint8_t key, uint16_t *length);
+
+/**
+ * @brief 读取键的值
+ *
+ * @param key 键
+ * @param data 缓冲区
+ * @param size 缓冲区大小，值的长度必须相同
+ * @return uint8_t 1: 成功; 0: 不存在或长度不同
+ */
+uint8_t cap_kv_get(uint8_t key, void *data, uint16_t size);
+
+/**
+ * @brief 写入键的值，当前页空间不足时整理到下一页
+ *
+ * @param key 键
+ * @param data 值
+ * @param length 长度(0为删除)
+ * @return uint8_t 1: 成功; 0: 参数错误、所有有效记录放不下一页或Flash擦除/编程失败
+ */
+uint8_t cap_kv_set(uint8_t key, const void *data, uint16_t length);
+
+/**
+ * @brief 删除键
+ *
+ * @param key 键
+ * @return uint8_t 1: 成功
+ */
+uint8_t cap_kv_delete(uint8_t key);
+
+/**
+ * @brief 当前页剩余空间(字节，包括记录头)
+ */
+uint32_t cap_kv_free(void);
+
+#endif /* CAP_KV_H_ */
@@ -0,0 +1,277 @@
+/**
+ * @file cap_lp.c
+ * @brief 低功耗扫描(帧间深度睡眠，RTC亚秒闹钟唤醒)实现 - GD32C2x1版本
+ * @version 1.0
+ * @date 2025-11-01
+ *
+ * 睡眠过程(关中断执行，唤醒源的中断在恢复时钟之后处理):
+ * 1. 读取亚秒计数器，闹钟设置为当前值减去睡眠的计数(ALRM0SS只能在闹钟关闭时写入)
+ * 2. 使能唤醒引脚的EXTI下降沿中断，进入深度睡眠(WFI)
+ * 3. 唤醒后恢复系统时钟，关闭唤醒引脚的EXTI，由亚秒计数器之差得到睡眠时长
+ * 闹钟在引脚唤醒后仍会到达一次，中断处理函数只清除标志。
+ */
+
+#include "cap_lp.h"
+
+/** 亚秒计数器的一个计数 = 31.25us = 125/4us */
+#define CAP_LP_SS_US_NUM 125U
+#define CAP_LP_SS_US_DEN 4U
+
+/** 单次睡眠的最大计数(留出设置闹钟和唤醒的余量，不超过亚秒计数器周期) */
+#define CAP_LP_SLEEP_MAX_TICKS (CAP_LP_SS_RANGE - 64U)
+
+/** 唤醒引脚唤醒后保持不睡眠的计数 */
+#define CAP_LP_HOLD_TICKS (CAP_LP_LINK_HOLD_MS * (CAP_LP_SS_RANGE / 1000U))
+
+/**
+ * @brief 唤醒引脚
+ */
+typedef struct {
+    uint32_t gpio_periph; /*!< GPIOx */
+    uint32_t pin;         /*!< GPIO_PIN_x */
+} cap_lp_pin_t;
+
+/**
+ * @brief 低功耗扫描状态
+ */
+typedef struct {
+    uint8_t        ready;                       /*!< RTC已初始化 */
+    uint8_t        hold;                        /*!< 引脚唤醒后的保持时间内 */
+    uint8_t        pin_count;                   /*!< 唤醒引脚数 */
+    uint16_t       hold_ss;                     /*!< 引脚唤醒时的亚秒计数器 */
+    uint32_t       lines;                       /*!< 唤醒引脚的EXTI线掩码 */
+    cap_lp_pin_t   pins[CAP_LP_WAKE_PIN_MAX];   /*!< 唤醒引脚 */
+    cap_lp_stats_t stats;                       /*!< 运行统计 */
+} cap_lp_t;
+
+static cap_lp_t g_lp = {0};
+
+/**
+ * @brief 读取亚秒计数器(旁路影子寄存器，RTC时钟异步，读到相同的值为止)
+ */
+static uint32_t cap_lp_ss(void)
+{
+    uint32_t ss;
+
+    do {
+        ss = RTC_SS & RTC_SS_SSC;
+    } while (ss != (RTC_SS & RTC_SS_SSC));
+
+    return ss;
+}
+
+/**
+ * @brief 亚秒计数器从from到to经过的计数(向下计数，按周期回绕)
+ */
+static uint32_t cap_lp_ss_elapsed(uint32_t from, uint32_t to)
+{
+    return (from + CAP_LP_SS_RANGE - to) % CAP_LP_SS_RANGE;
+}
+
+/**
+ * @brief 唤醒后恢复系统时钟: IRC48M不分频作为系统时钟
+ */
+static void cap_lp_clock_restore(void)
+{
+    RCU_CTL0 |= RCU_CTL0_IRC48MEN;
+    while ((RCU_CTL0 & RCU_CTL0_IRC48MSTB) == 0U) {}
+
+    rcu_irc48mdiv_sys_clock_config(RCU_IRC48MDIV_SYS_1);
+
+    if ((RCU_CFG0 & RCU_CFG0_SCSS) != RCU_SCSS_IRC48MDIV) {
+        RCU_CFG0 = (RCU_CFG0 & ~RCU_CFG0_SCS) | RCU_CKSYSSRC_IRC48MDIV_SYS;
+        while ((RCU_CFG0 & RCU_CFG0_SCSS) != RCU_SCSS_IRC48MDIV) {}
+    }
+}
+
+/**
+ * @brief 初始化: IRC32K作为RTC时钟，配置亚秒闹钟、EXTI_16和RTC闹钟中断
+ */
+uint8_t cap_lp_init(void)
+{
+    rtc_parameter_struct rtc_initpara;
+    rtc_alarm_struct     rtc_alarm = {0};
+
+    g_lp.ready = 0;
+
+    /* 允许写入备份域(RTC) */
+    rcu_periph_clock_enable(RCU_PMU);
+    pmu_backup_write_enable();
+
+    /* IRC32K作为RTC时钟 */
+    rcu_osci_on(RCU_IRC32K);
+    if (rcu_osci_stab_wait(RCU_IRC32K) != SUCCESS) { return 0; }
+    rcu_rtc_clock_config(RCU_RTCSRC_IRC32K);
+    rcu_periph_clock_enable(RCU_RTC);
+
+    /* 异步预分频1、同步预分频32000: 亚秒计数器31.25us一个计数；日历不使用 */
+    rtc_initpara.factor_asyn    = 0U;
+    rtc_initpara.factor_syn     = CAP_LP_SS_RANGE - 1U;
+    rtc_initpara.year           = 0x25U;
+    rtc_initpara.month          = RTC_JAN;
+    rtc_initpara.date           = 0x01U;
+    rtc_initpara.day_of_week    = RTC_SUNDAY;
+    rtc_initpara.hour           = 0x00U;
+    rtc_initpara.minute         = 0x00U;
+    rtc_initpara.second         = 0x00U;
+    rtc_initpara.display_format = RTC_24HOUR;
+    rtc_initpara.am_pm          = RTC_AM;
+    if (rtc_init(&rtc_initpara) != SUCCESS) { return 0; }
+
+    /* 直接读取亚秒计数器，不等待影子寄存器同步 */
+    rtc_bypass_shadow_enable();
+
+    /* 闹钟屏蔽日期和时间，只比较全部15位亚秒计数器(睡眠时设置) */
+    if (rtc_alarm_disable() != SUCCESS) { return 0; }
+    rtc_alarm.alarm_mask      = RTC_ALARM_ALL_MASK;
+    rtc_alarm.weekday_or_date = RTC_ALARM_DATE_SELECTED;
+    rtc_alarm.alarm_day       = 0x01U;
+    rtc_alarm.am_pm           = RTC_AM;
+    rtc_alarm_config(&rtc_alarm);
+    rtc_interrupt_enable(RTC_INT_ALARM0);
+    rtc_flag_clear(RTC_FLAG_ALARM0);
+
+    /* 闹钟经EXTI_16上升沿唤醒深度睡眠 */
+    exti_init(EXTI_16, EXTI_INTERRUPT, EXTI_TRIG_RISING);
+    exti_interrupt_flag_clear(EXTI_16);
+    nvic_irq_enable(RTC_Alarm_IRQn, 3);
+
+    g_lp.ready = 1;
+
+    return 1;
+}
+
+/**
+ * @brief 注册唤醒引脚(下降沿唤醒)
+ */
+uint8_t cap_lp_wake_pin_add(uint32_t gpio_periph, uint32_t pin)
+{
+    uint8_t line = 0;
+
+    if (g_lp.pin_count >= CAP_LP_WAKE_PIN_MAX || (g_lp.lines & pin) != 0U || pin == 0U) { return 0; }
+
+    while ((pin & (1U << line)) == 0U) { line++; }
+
+    rcu_periph_clock_enable(RCU_SYSCFG);
+    syscfg_exti_line_config((uint8_t)((gpio_periph - GPIOA) / (GPIOB - GPIOA)), line);
+
+    /* 中断和触发沿只在睡眠期间使能 */
+    exti_interrupt_flag_clear((exti_line_enum)pin);
+
+    if (line <= 4U) {
+        nvic_irq_enable((IRQn_Type)(EXTI0_IRQn + line), 3);
+    } else if (line <= 9U) {
+        nvic_irq_enable(EXTI5_9_IRQn, 3);
+    } else {
+        nvic_irq_enable(EXTI10_15_IRQn, 3);
+    }
+
+    g_lp.pins[g_lp.pin_count].gpio_periph = gpio_periph;
+    g_lp.pins[g_lp.pin_count].pin         = pin;
+    g_lp.pin_count++;
+    g_lp.lines |= pin;
+
+    return 1;
+}
+
+/**
+ * @brief 链路是否活动
+ */
+uint8_t cap_lp_link_active(void)
+{
+    for (uint8_t i = 0; i < g_lp.pin_count; i++) {
+        if (gpio_input_bit_get(g_lp.pins[i].gpio_periph, g_lp.pins[i].pin) == RESET) { return 1; }
+    }
+
+    if (g_lp.hold) {
+        if (cap_lp_ss_elapsed(g_lp.hold_ss, cap_lp_ss()) < CAP_LP_HOLD_TICKS) { return 1; }
+        g_lp.hold = 0;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief 深度睡眠指定时间，RTC闹钟或唤醒引脚唤醒
+ */
+uint32_t cap_lp_sleep(uint32_t us)
+{
+    uint32_t primask;
+    uint32_t ticks;
+    uint32_t ss_start;
+    uint32_t ss_end;
+    uint32_t woken;
+
+    if (!g_lp.ready || us < CAP_LP_MIN_SLEEP_US || cap_lp_link_active()) { return 0; }
+
+    ticks = (us >= CAP_LP_SLEEP_MAX_TICKS * CAP_LP_SS_US_NUM / CAP_LP_SS_US_DEN) ? CAP_LP_SLEEP_MAX_TICKS
+                                                                                 : us * CAP_LP_SS_US_DEN / CAP_LP_SS_US_NUM;
+
+    /* 闹钟: 亚秒计数器向下计数到ss_start - ticks */
+    ss_start = cap_lp_ss();
+    rtc_alarm_disable();
+    rtc_alarm_subsecond_config(RTC_MSKSSC_NONE, (ss_start + CAP_LP_SS_RANGE - ticks) % CAP_LP_SS_RANGE);
+    rtc_flag_clear(RTC_FLAG_ALARM0);
+    exti_interrupt_flag_clear(EXTI_16);
+    rtc_alarm_enable();
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    /* 唤醒引脚下降沿 */
+    EXTI_PD = g_lp.lines;
+    EXTI_FTEN |= g_lp.lines;
+    EXTI_INTEN |= g_lp.lines;
+
+    pmu_to_deepsleepmode(WFI_CMD, PMU_DEEPSLEEP);
+
+    cap_lp_clock_restore();
+
+    woken = EXTI_PD & g_lp.lines;
+    EXTI_INTEN &= ~g_lp.lines;
+    EXTI_FTEN &= ~g_lp.lines;
+    EXTI_PD = g_lp.lines;
+
+    ss_end = cap_lp_ss();
+
+    __set_PRIMASK(primask);
+
+    if (woken != 0U) {
+        /* 主机开始传输: 保持唤醒一段时间 */
+        g_lp.hold    = 1;
+        g_lp.hold_ss = (uint16_t)ss_end;
+        g_lp.stats.pin_wakeups++;
+    }
+
+    us = cap_lp_ss_elapsed(ss_start, ss_end) * CAP_LP_SS_US_NUM / CAP_LP_SS_US_DEN;
+    g_lp.stats.sleep_us += us;
+    g_lp.stats.wakeups++;
+
+    return us;
+}
+
+/**
+ * @brief 获取运行统计
+ */
+void cap_lp_get_stats(cap_lp_stats_t *stats)
+{
+    *stats = g_lp.stats;
+}
+
+/**
+ * @brief RTC闹钟中断处理函数
+ */
+void cap_lp_rtc_irq_handler(void)
+{
+    if (rtc_flag_get(RTC_FLAG_ALARM0) != RESET) { rtc_flag_clear(RTC_FLAG_ALARM0); }
+    exti_interrupt_flag_clear(EXTI_16);
+}
+
+/**
+ * @brief 唤醒引脚EXTI中断处理函数
+ */
+void cap_lp_exti_irq_handler(void)
+{
+    /* 睡眠后已经关闭并清除，这里只清除醒着时残留的标志 */
+    EXTI_PD = g_lp.lines;
+}
@@ -0,0 +1,112 @@
+/**
+ * @file cap_lp.h
+ * @brief 低功耗扫描(帧间深度睡眠，RTC亚秒闹钟唤醒)头文件 - GD32C2x1版本
+ * @version 1.0
+ * @date 2025-11-01
+ *
+ * 空闲扫描的帧间等待期间(cap_touch_get_idle_wait_us())进入深度睡眠，而不是轮询扫描节拍:
+ * - RTC由IRC32K驱动(异步预分频1，同步预分频32000)，亚秒计数器每31.25us减1、每秒回绕。
+ *   闹钟只比较亚秒计数器，每次睡眠前设置为当前值减去睡眠的计数，单次睡眠不超过1秒
+ * - 深度睡眠中CPU、TIMER、DMA和USART的时钟停止，GPIO保持输出(触摸通道保持放电)。
+ *   唤醒后系统时钟为IRC48M，重新选择不分频的CK_IRC48MDIV_SYS(与SystemInit相同)
+ * - 实际睡眠时长由睡眠前后的亚秒计数器之差得到(IRC32K精度)，用于推进扫描时间
+ *
+ * 主机链路引脚可注册为唤醒引脚(EXTI下降沿，只在睡眠期间使能，醒着时不产生中断):
+ * 引脚为低电平(传输中)时不睡眠；引脚唤醒后CAP_LP_LINK_HOLD_MS内不再睡眠，
+ * 唤醒时正在传输的第一帧可能丢失，由主机重发。
+ *
+ * 统计睡眠时间和唤醒次数: 活动时间占比 = 1 - 睡眠时间 / 总时间，作为平均电流的近似。
+ */
+
+#ifndef CAP_LP_H_
+#define CAP_LP_H_
+
+#include "gd32c2x1.h"
+#include <stdint.h>
+
+/** 最短睡眠时间(微秒)，更短的等待不值得设置闹钟 */
+#ifndef CAP_LP_MIN_SLEEP_US
+#define CAP_LP_MIN_SLEEP_US 1000U
+#endif
+
+/** 提前唤醒的时间(微秒): 唤醒延迟和闹钟的计数误差 */
+#ifndef CAP_LP_WAKEUP_US
+#define CAP_LP_WAKEUP_US 100U
+#endif
+
+/** 唤醒引脚唤醒后保持不睡眠的时间(毫秒，小于1000) */
+#ifndef CAP_LP_LINK_HOLD_MS
+#define CAP_LP_LINK_HOLD_MS 200U
+#endif
+
+/** 唤醒引脚的最大数量 */
+#define CAP_LP_WAKE_PIN_MAX 4U
+
+/** RTC亚秒计数器周期(同步预分频值 + 1)，IRC32K下为1秒 */
+#define CAP_LP_SS_RANGE 32000U
+
+/**
+ * @brief 运行统计(从上电开始累计)
+ */
+typedef struct {
+    uint64_t sleep_us;    /*!< 深度睡眠的总时间(微秒) */
+    uint32_t wakeups;     /*!< 深度睡眠(唤醒)次数 */
+    uint32_t pin_wakeups; /*!< 其中由唤醒引脚唤醒的次数 */
+} cap_lp_stats_t;
+
+/**
+ * @brief 初始化: IRC32K作为RTC时钟，配置亚秒闹钟、EXTI_16和RTC闹钟中断
+ *
+ * @return uint8_t 1: 成功; 0: RTC初始化失败(不能睡眠)
+ */
+uint8_t cap_lp_init(void);
+
+/**
+ * @brief 注册唤醒引脚(下降沿唤醒)，引脚的模式由链路配置
+ *
+ * 不同引脚的引脚号必须不同(EXTI线按引脚号共用)
+ *
+ * @param gpio_periph GPIOx
+ * @param pin GPIO_PIN_x(单个引脚)
+ * @return uint8_t 1: 成功; 0: 数量超过CAP_LP_WAKE_PIN_MAX或引脚号已使用
+ */
+uint8_t cap_lp_wake_pin_add(uint32_t gpio_periph, uint32_t pin);
+
+/**
+ * @brief 链路是否活动(唤醒引脚为低电平，或引脚唤醒后的保持时间内)
+ *
+ * @return uint8_t 1: 活动，不应睡眠
+ */
+uint8_t cap_lp_link_active(void);
+
+/**
+ * @brief 深度睡眠指定时间，RTC闹钟或唤醒引脚唤醒
+ *
+ * 在主循环中调用(不能在中断中调用)，睡眠期间停止的外设(USART发送等)由调用者先停止。
+ * 等待短于CAP_LP_MIN_SLEEP_US、链路活动或RTC未初始化时直接返回0
+ *
+ * @param us 睡眠时间(微秒)，超过1秒时只睡眠1秒以内
+ * @return uint32_t 实际睡眠时间(微秒)
+ */
+uint32_t cap_lp_sleep(uint32_t us);
+
+/**
+ * @brief 获取运行统计
+ */
+void cap_lp_get_stats(cap_lp_stats_t *stats);
+
+/**
+ * @brief RTC闹钟中断处理函数
+ *
+ * 需要在RTC_Alarm_IRQHandler中调用
+ */
+void cap_lp_rtc_irq_handler(void);
+
+/**
+ * @brief 唤醒引脚EXTI中断处理函数
+ *
+ * 需要在唤醒引脚所在EXTI线的中断处理函数中调用
+ */
+void cap_lp_exti_irq_handler(void);
+
+#endif /* CAP_LP_H_ */
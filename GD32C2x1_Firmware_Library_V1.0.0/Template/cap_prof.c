@@ -0,0 +1,124 @@
+/**
+ * @file cap_prof.c
+ * @brief 中断/回调执行时间统计(性能分析)实现 - GD32C2x1版本
+ * @version 1.0
+ * @date 2025-11-01
+ *
+ * 每个区段保存执行次数、最短/最长周期数和周期数累加和，记录时关中断，
+ * 主循环中的区段和中断中的区段可以共用同一条统计。
+ * 平均值在发送性能分析帧时计算，中断中只做比较和加法。
+ */
+
+#include "cap_prof.h"
+
+#if CAP_PROF_ENABLE
+
+/** 测量探针开销的次数(取最小值) */
+#define CAP_PROF_CALIBRATE_ROUNDS 8
+
+/**
+ * @brief 单个区段的统计
+ */
+typedef struct {
+    uint32_t count; /*!< 执行次数 */
+    uint16_t min;   /*!< 最短周期数 */
+    uint16_t max;   /*!< 最长周期数 */
+    uint64_t sum;   /*!< 周期数累加和 */
+} cap_prof_entry_t;
+
+static cap_prof_entry_t g_prof[CAP_PROF_REGION_COUNT];
+static uint16_t         g_prof_overhead = 0; /* 一对空探针的计数值之差 */
+
+/**
+ * @brief 记录一次区段执行时间
+ */
+void cap_prof_record(cap_prof_region_t region, uint16_t cycles)
+{
+    cap_prof_entry_t *entry   = &g_prof[region];
+    uint32_t          primask = __get_PRIMASK();
+
+    cycles = (cycles > g_prof_overhead) ? (uint16_t)(cycles - g_prof_overhead) : 0U;
+
+    __disable_irq();
+    if (entry->count == 0 || cycles < entry->min) { entry->min = cycles; }
+    if (cycles > entry->max) { entry->max = cycles; }
+    entry->sum += cycles;
+    entry->count++;
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief 初始化性能分析: 启动TIMER16自由计数并测量探针开销
+ */
+void cap_prof_init(void)
+{
+    timer_parameter_struct timer_initpara;
+    uint16_t               overhead = 0xFFFF;
+
+    rcu_periph_clock_enable(CAP_PROF_TIMER_RCU);
+    timer_deinit(CAP_PROF_TIMER);
+
+    /* 预分频0: 计数时钟等于CPU时钟48MHz，16位回绕 */
+    timer_initpara.prescaler         = 0;
+    timer_initpara.alignedmode       = TIMER_COUNTER_EDGE;
+    timer_initpara.counterdirection  = TIMER_COUNTER_UP;
+    timer_initpara.period            = 0xFFFF;
+    timer_initpara.clockdivision     = TIMER_CKDIV_DIV1;
+    timer_initpara.repetitioncounter = 0;
+    timer_init(CAP_PROF_TIMER, &timer_initpara);
+    timer_enable(CAP_PROF_TIMER);
+
+    /* 探针开销: 两次读计数器之间没有代码时的计数值之差 */
+    for (uint8_t i = 0; i < CAP_PROF_CALIBRATE_ROUNDS; i++) {
+        uint16_t start  = cap_prof_now();
+        uint16_t cycles = (uint16_t)(cap_prof_now() - start);
+
+        if (cycles < overhead) { overhead = cycles; }
+    }
+    g_prof_overhead = overhead;
+
+    cap_prof_reset();
+}
+
+/**
+ * @brief 清除所有区段的统计
+ */
+void cap_prof_reset(void)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    for (uint8_t i = 0; i < CAP_PROF_REGION_COUNT; i++) {
+        g_prof[i].count = 0;
+        g_prof[i].min   = 0;
+        g_prof[i].max   = 0;
+        g_prof[i].sum   = 0;
+    }
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief 读取所有区段的统计
+ */
+uint16_t cap_prof_report(cap_proto_profile_t *entries)
+{
+    for (uint8_t i = 0; i < CAP_PROF_REGION_COUNT; i++) {
+        cap_prof_entry_t entry;
+        uint32_t         primask = __get_PRIMASK();
+
+        /* 复制一份再计算平均值，64位除法不在关中断期间进行 */
+        __disable_irq();
+        entry = g_prof[i];
+        __set_PRIMASK(primask);
+
+        entries[i].region     = i;
+        entries[i].count      = entry.count;
+        entries[i].min_cycles = entry.min;
+        entries[i].max_cycles = entry.max;
+        entries[i].avg_cycles = entry.count ? (uint16_t)(entry.sum / entry.count) : 0U;
+    }
+
+    return CAP_PROF_REGION_COUNT * sizeof(cap_proto_profile_t);
+}
+
+#endif /* CAP_PROF_ENABLE */
@@ -0,0 +1,101 @@
+/**
+ * @file cap_prof.h
+ * @brief 中断/回调执行时间统计(性能分析)头文件 - GD32C2x1版本
+ * @version 1.0
+ * @date 2025-11-01
+ *
+ * Cortex-M23没有DWT周期计数器，本模块以TIMER16(预分频0，48MHz自由计数)作为周期计数器，
+ * 在代码区段的入口和出口读取计数值，按区段统计执行次数和最短/最长/平均周期数，
+ * 随遥测帧以CAP_PROTO_TYPE_PROFILE帧发送。
+ *
+ * 用法:
+ *
+ *   CAP_PROF_ENTER(CAP_PROF_TIMER0_ISR);
+ *   ...
+ *   CAP_PROF_EXIT(CAP_PROF_TIMER0_ISR);
+ *
+ * ENTER在当前作用域定义一个保存起始计数值的局部变量，同一区段可以被中断重入。
+ * 计数器为16位，区段执行时间不能超过65535周期(1.36ms)；统计时间包含期间被
+ * 更高优先级中断抢占的时间，并已减去一对探针本身的开销。
+ *
+ * CAP_PROF_ENABLE为0(默认)时探针展开为空语句，本模块不占用TIMER16、不编译任何代码。
+ */
+
+#ifndef CAP_PROF_H_
+#define CAP_PROF_H_
+
+#include "gd32c2x1.h"
+#include "cap_proto.h"
+#include <stdint.h>
+
+/** 性能分析使能: 1启用探针和TIMER16，0探针展开为空 */
+#ifndef CAP_PROF_ENABLE
+#define CAP_PROF_ENABLE 0
+#endif
+
+/** 周期计数器使用的定时器 */
+#define CAP_PROF_TIMER     TIMER16
+#define CAP_PROF_TIMER_RCU RCU_TIMER16
+
+/** 性能分析帧长度 */
+#define CAP_PROF_FRAME_SIZE \
+    (CAP_PROTO_HEADER_SIZE + CAP_PROTO_PROF_REGIONS * sizeof(cap_proto_profile_t) + CAP_PROTO_CRC_SIZE)
+
+/**
+ * @brief 统计的代码区段
+ */
+typedef enum {
+    CAP_PROF_TIMER0_ISR     = CAP_PROTO_PROF_TIMER0_ISR,     /*!< TIMER0通道中断(PA0-PA3捕获) */
+    CAP_PROF_TIMER2_ISR     = CAP_PROTO_PROF_TIMER2_ISR,     /*!< TIMER2中断(PA6-PA7捕获) */
+    CAP_PROF_FINISH_CAPTURE = CAP_PROTO_PROF_FINISH_CAPTURE, /*!< 结束捕获并切换通道(含帧完成) */
+    CAP_PROF_DATA_READY     = CAP_PROTO_PROF_DATA_READY,     /*!< 数据就绪回调(编码和发送数据帧) */
+    CAP_PROF_REGION_COUNT   = CAP_PROTO_PROF_REGIONS
+} cap_prof_region_t;
+
+#if CAP_PROF_ENABLE
+
+/**
+ * @brief 读取周期计数器
+ */
+static inline uint16_t cap_prof_now(void)
+{
+    return (uint16_t)TIMER_CNT(CAP_PROF_TIMER);
+}
+
+/**
+ * @brief 记录一次区段执行时间(由CAP_PROF_EXIT调用，可在中断中调用)
+ *
+ * @param region 区段
+ * @param cycles 入口到出口的计数值之差(含探针开销)
+ */
+void cap_prof_record(cap_prof_region_t region, uint16_t cycles);
+
+#define CAP_PROF_ENTER(region) uint16_t cap_prof_start_##region = cap_prof_now()
+#define CAP_PROF_EXIT(region)  cap_prof_record(region, (uint16_t)(cap_prof_now() - cap_prof_start_##region))
+
+/**
+ * @brief 初始化性能分析: 启动TIMER16自由计数并测量探针开销
+ */
+void cap_prof_init(void);
+
+/**
+ * @brief 清除所有区段的统计
+ */
+void cap_prof_reset(void);
+
+/**
+ * @brief 读取所有区段的统计
+ *
+ * @param entries 输出，CAP_PROF_REGION_COUNT条(可直接指向帧负载)
+ * @return uint16_t 负载长度(字节)
+ */
+uint16_t cap_prof_report(cap_proto_profile_t *entries);
+
+#else
+
+#define CAP_PROF_ENTER(region) ((void)0)
+#define CAP_PROF_EXIT(region)  ((void)0)
+
+#endif /* CAP_PROF_ENABLE */
+
+#endif /* CAP_PROF_H_ */
@@ -0,0 +1,524 @@
+/**
+ * @file cap_proto.c
+ * @brief 电容触摸数据帧协议实现 - GD32C2x1版本
+ * @version 1.0
+ * @date 2025-11-01
+ *
+ * 帧编码和接收解析均不依赖外设，可在上位机直接编译。
+ * 固件中(定义了USE_STDPERIPH_DRIVER)发送帧的CRC由硬件CRC单元计算(经cap_crc.h仲裁)；
+ * 解析器始终使用软件CRC，避免与发送路径(中断上下文)争用CRC单元。
+ */
+
+#include "cap_proto.h"
+#include <string.h>
+
+#ifdef USE_STDPERIPH_DRIVER
+#include "cap_crc.h"
+#include "gd32c2x1.h"
+#endif
+
+/** 发送帧序号 */
+static uint16_t g_proto_seq = 0;
+
+/**
+ * @brief 分配帧序号
+ *
+ * 应答帧在主循环中完成，数据帧在中断中完成，关中断保证序号不重复
+ */
+static uint16_t cap_proto_seq_next(uint16_t count)
+{
+    uint16_t seq;
+#ifdef USE_STDPERIPH_DRIVER
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+#endif
+    seq = g_proto_seq;
+    g_proto_seq += count;
+#ifdef USE_STDPERIPH_DRIVER
+    __set_PRIMASK(primask);
+#endif
+    return seq;
+}
+
+#ifdef USE_STDPERIPH_DRIVER
+/**
+ * @brief 软件分段计算CRC-16/CCITT-FALSE(逐位，不占用查表的Flash)
+ */
+uint16_t cap_proto_crc16_update(uint16_t crc, const uint8_t *data, uint32_t length)
+{
+    while (length--) {
+        crc ^= (uint16_t)(*data++) << 8;
+        for (uint8_t i = 0; i < 8; i++) {
+            crc = (crc & 0x8000U) ? (uint16_t)((crc << 1) ^ CAP_PROTO_CRC_POLY) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+#else
+/** 上位机CRC查找表，第一次使用时生成 */
+static uint16_t g_crc_table[256];
+static uint8_t  g_crc_table_ready = 0;
+
+/**
+ * @brief 软件分段计算CRC-16/CCITT-FALSE(查表，上位机解码长时间记录时每字节一次查表)
+ */
+uint16_t cap_proto_crc16_update(uint16_t crc, const uint8_t *data, uint32_t length)
+{
+    if (!g_crc_table_ready) {
+        for (uint16_t n = 0; n < 256; n++) {
+            uint16_t c = (uint16_t)(n << 8);
+            for (uint8_t i = 0; i < 8; i++) {
+                c = (c & 0x8000U) ? (uint16_t)((c << 1) ^ CAP_PROTO_CRC_POLY) : (uint16_t)(c << 1);
+            }
+            g_crc_table[n] = c;
+        }
+        g_crc_table_ready = 1;
+    }
+
+    while (length--) {
+        crc = (uint16_t)((crc << 8) ^ g_crc_table[(uint8_t)(crc >> 8) ^ *data++]);
+    }
+    return crc;
+}
+#endif /* USE_STDPERIPH_DRIVER */
+
+/**
+ * @brief 软件计算CRC-16/CCITT-FALSE
+ */
+static uint16_t cap_proto_crc16_sw(const uint8_t *data, uint32_t length)
+{
+    return cap_proto_crc16_update(CAP_PROTO_CRC_INIT, data, length);
+}
+
+#ifdef USE_STDPERIPH_DRIVER
+/** 硬件CRC单元配置: CRC-16/CCITT-FALSE，按字节输入 */
+static const cap_crc_config_t g_proto_crc_config = {CRC_CTL_PS_16, CAP_PROTO_CRC_POLY, CAP_PROTO_CRC_INIT,
+                                                    CRC_INPUT_DATA_NOT, 0};
+
+/**
+ * @brief 初始化协议模块：使能硬件CRC单元(首次计算时配置为CRC-16/CCITT-FALSE)
+ */
+void cap_proto_init(void)
+{
+    cap_crc_init();
+}
+
+/**
+ * @brief 使用硬件CRC单元计算CRC-16/CCITT-FALSE
+ *
+ * CRC单元被占用时(DMA异步计算中，或主循环的计算被中断打断)改用软件CRC
+ */
+uint16_t cap_proto_crc16(const uint8_t *data, uint32_t length)
+{
+    uint16_t crc;
+
+    if (!cap_crc_claim(&g_proto_crc_config)) { return cap_proto_crc16_sw(data, length); }
+    crc = (uint16_t)crc_block_data_calculate((void *)data, length, INPUT_FORMAT_BYTE);
+    cap_crc_release();
+
+    return crc;
+}
+#else
+/**
+ * @brief 初始化协议模块(上位机无需初始化)
+ */
+void cap_proto_init(void)
+{
+}
+
+/**
+ * @brief 计算CRC-16/CCITT-FALSE
+ */
+uint16_t cap_proto_crc16(const uint8_t *data, uint32_t length)
+{
+    return cap_proto_crc16_sw(data, length);
+}
+#endif /* USE_STDPERIPH_DRIVER */
+
+/**
+ * @brief 填写帧头、序号和CRC，完成一帧
+ */
+uint16_t cap_proto_finalize(uint8_t *frame, uint8_t type, uint16_t length)
+{
+    uint16_t crc;
+    uint16_t seq;
+
+    if (length > CAP_PROTO_MAX_PAYLOAD) { return 0; }
+
+    seq = cap_proto_seq_next(1);
+
+    frame[0] = CAP_PROTO_SYNC0;
+    frame[1] = CAP_PROTO_SYNC1;
+    frame[2] = CAP_PROTO_VERSION;
+    frame[3] = type;
+    frame[4] = (uint8_t)(seq & 0xFF);
+    frame[5] = (uint8_t)(seq >> 8);
+    frame[6] = (uint8_t)(length & 0xFF);
+    frame[7] = (uint8_t)(length >> 8);
+
+    crc = cap_proto_crc16(frame, CAP_PROTO_HEADER_SIZE + length);
+    frame[CAP_PROTO_HEADER_SIZE + length]     = (uint8_t)(crc & 0xFF);
+    frame[CAP_PROTO_HEADER_SIZE + length + 1] = (uint8_t)(crc >> 8);
+
+    return (uint16_t)(CAP_PROTO_HEADER_SIZE + length + CAP_PROTO_CRC_SIZE);
+}
+
+/**
+ * @brief 跳过帧序号
+ */
+void cap_proto_seq_skip(uint16_t count)
+{
+    (void)cap_proto_seq_next(count);
+}
+
+/**
+ * @brief 按varint写入无符号数(每字节7位，最高位为延续位)
+ * @return uint8_t* 写入后的位置
+ */
+static uint8_t *cap_proto_put_varint(uint8_t *p, uint32_t value)
+{
+    while (value >= 0x80U) {
+        *p++ = (uint8_t)(value | 0x80U);
+        value >>= 7;
+    }
+    *p++ = (uint8_t)value;
+    return p;
+}
+
+/**
+ * @brief 读取varint
+ * @param p 读取位置，成功时移动到varint之后
+ * @param end 数据结束位置
+ * @param max_bytes varint最大字节数
+ * @param value 读出的值
+ * @return uint8_t 1: 成功; 0: 数据不完整或超长
+ */
+static uint8_t cap_proto_get_varint(const uint8_t **p, const uint8_t *end, uint8_t max_bytes, uint32_t *value)
+{
+    const uint8_t *q = *p;
+    uint32_t       v = 0;
+    uint8_t        byte;
+
+    for (uint8_t n = 0;; n++) {
+        if (q >= end || n >= max_bytes) { return 0; }
+        byte = *q++;
+        v |= (uint32_t)(byte & 0x7FU) << (7U * n);
+        if (!(byte & 0x80U)) { break; }
+    }
+
+    *p     = q;
+    *value = v;
+    return 1;
+}
+
+/**
+ * @brief 开始一个差分压缩帧
+ */
+void cap_proto_delta_begin(cap_proto_delta_enc_t *enc, uint8_t *frame, uint8_t max_scans)
+{
+    enc->frame     = frame;
+    enc->length    = 1; /* count */
+    enc->count     = 0;
+    enc->max_scans = max_scans;
+
+    cap_proto_payload(frame)[0] = 0;
+}
+
+/**
+ * @brief 向差分压缩帧添加一次扫描
+ */
+uint8_t cap_proto_delta_add(cap_proto_delta_enc_t *enc, const cap_proto_raw_t *scan)
+{
+    uint8_t *out = cap_proto_payload(enc->frame) + enc->length;
+    uint8_t *p   = out;
+
+    if (enc->count == 0) {
+        /* 关键帧: 完整数据 */
+        memcpy(p, scan, sizeof(cap_proto_raw_t));
+        p += sizeof(cap_proto_raw_t);
+    } else {
+        uint8_t *ctrl = p++;
+
+        *ctrl = 0;
+        if (scan->touch_mask != enc->prev.touch_mask || scan->flags != enc->prev.flags) {
+            *ctrl |= CAP_PROTO_REC_STATE;
+            *p++ = scan->touch_mask;
+            *p++ = scan->flags;
+        }
+
+        for (uint8_t i = 0; i < CAP_PROTO_CHANNELS; i++) {
+            int32_t delta = (int32_t)scan->values[i] - (int32_t)enc->prev.values[i];
+
+            p = cap_proto_put_varint(p, ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31));
+        }
+    }
+
+    enc->prev = *scan;
+    enc->length += (uint16_t)(p - out);
+    enc->count++;
+    cap_proto_payload(enc->frame)[0] = enc->count;
+
+    return (enc->count >= enc->max_scans ||
+            CAP_PROTO_MAX_PAYLOAD - enc->length < CAP_PROTO_DELTA_REC_MAX) ? 1 : 0;
+}
+
+/**
+ * @brief 结束差分压缩帧，填写帧头和CRC
+ */
+uint16_t cap_proto_delta_finish(cap_proto_delta_enc_t *enc)
+{
+    if (enc->count == 0) { return 0; }
+
+    return cap_proto_finalize(enc->frame, CAP_PROTO_TYPE_DELTA, enc->length);
+}
+
+/**
+ * @brief 解码差分压缩帧负载
+ */
+uint8_t cap_proto_delta_decode(const uint8_t *payload, uint16_t length, cap_proto_raw_t *scans, uint8_t max_scans)
+{
+    const uint8_t *p   = payload;
+    const uint8_t *end = payload + length;
+    uint8_t        count;
+
+    if (length < 1 + sizeof(cap_proto_raw_t)) { return 0; }
+
+    count = *p++;
+    if (count == 0 || count > max_scans) { return 0; }
+
+    memcpy(&scans[0], p, sizeof(cap_proto_raw_t));
+    p += sizeof(cap_proto_raw_t);
+
+    for (uint8_t n = 1; n < count; n++) {
+        cap_proto_raw_t *scan = &scans[n];
+        uint8_t          ctrl;
+
+        *scan = scans[n - 1];
+
+        if (p >= end) { return 0; }
+        ctrl = *p++;
+        if (ctrl & CAP_PROTO_REC_STATE) {
+            if (end - p < 2) { return 0; }
+            scan->touch_mask = *p++;
+            scan->flags      = *p++;
+        }
+
+        for (uint8_t i = 0; i < CAP_PROTO_CHANNELS; i++) {
+            uint32_t zz;
+
+            if (!cap_proto_get_varint(&p, end, 3, &zz)) { return 0; }
+            scan->values[i] = (uint16_t)(scan->values[i] + (int32_t)((zz >> 1) ^ (0U - (zz & 1U))));
+        }
+    }
+
+    return (p == end) ? count : 0;
+}
+
+/**
+ * @brief 开始一个批量帧
+ */
+void cap_proto_batch_begin(cap_proto_batch_enc_t *enc, uint8_t *frame, uint8_t max_scans)
+{
+    enc->frame     = frame;
+    enc->length    = 1 + 4; /* count + base_us */
+    enc->count     = 0;
+    enc->max_scans = max_scans;
+
+    cap_proto_payload(frame)[0] = 0;
+}
+
+/**
+ * @brief 向批量帧添加一次扫描
+ */
+uint8_t cap_proto_batch_add(cap_proto_batch_enc_t *enc, const cap_proto_raw_t *scan, uint32_t time_us)
+{
+    uint8_t *payload = cap_proto_payload(enc->frame);
+    uint8_t *out     = payload + enc->length;
+    uint8_t *p       = out;
+
+    if (enc->count == 0) {
+        /* 第一次扫描的时间戳作为基准 */
+        payload[1] = (uint8_t)(time_us & 0xFF);
+        payload[2] = (uint8_t)(time_us >> 8);
+        payload[3] = (uint8_t)(time_us >> 16);
+        payload[4] = (uint8_t)(time_us >> 24);
+    } else {
+        p = cap_proto_put_varint(p, time_us - enc->last_us);
+    }
+
+    memcpy(p, scan, sizeof(cap_proto_raw_t));
+    p += sizeof(cap_proto_raw_t);
+
+    enc->last_us = time_us;
+    enc->length += (uint16_t)(p - out);
+    enc->count++;
+    payload[0] = enc->count;
+
+    return (enc->count >= enc->max_scans ||
+            CAP_PROTO_MAX_PAYLOAD - enc->length < CAP_PROTO_BATCH_REC_MAX) ? 1 : 0;
+}
+
+/**
+ * @brief 结束批量帧，填写帧头和CRC
+ */
+uint16_t cap_proto_batch_finish(cap_proto_batch_enc_t *enc)
+{
+    if (enc->count == 0) { return 0; }
+
+    return cap_proto_finalize(enc->frame, CAP_PROTO_TYPE_BATCH, enc->length);
+}
+
+/**
+ * @brief 解码批量帧负载
+ */
+uint8_t cap_proto_batch_decode(const uint8_t *payload, uint16_t length, cap_proto_raw_t *scans, uint32_t *times_us,
+                               uint8_t max_scans)
+{
+    const uint8_t *p   = payload;
+    const uint8_t *end = payload + length;
+    uint8_t        count;
+    uint32_t       time_us;
+
+    if (length < 1 + 4) { return 0; }
+
+    count = *p++;
+    if (count == 0 || count > max_scans) { return 0; }
+
+    time_us = (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+    p += 4;
+
+    for (uint8_t n = 0; n < count; n++) {
+        if (n > 0) {
+            uint32_t dt;
+
+            if (!cap_proto_get_varint(&p, end, 5, &dt)) { return 0; }
+            time_us += dt;
+        }
+
+        if (end - p < (int32_t)sizeof(cap_proto_raw_t)) { return 0; }
+        memcpy(&scans[n], p, sizeof(cap_proto_raw_t));
+        p += sizeof(cap_proto_raw_t);
+        times_us[n] = time_us;
+    }
+
+    return (p == end) ? count : 0;
+}
+
+/**
+ * @brief 初始化接收解析器
+ */
+void cap_proto_parser_init(cap_proto_parser_t *parser)
+{
+    memset(parser, 0, sizeof(*parser));
+}
+
+/**
+ * @brief 丢弃缓冲区首字节，并移动到下一个可能的同步字
+ */
+static void cap_proto_parser_slip(cap_proto_parser_t *parser)
+{
+    uint16_t i;
+
+    for (i = 1; i < parser->fill; i++) {
+        if (parser->buf[i] == CAP_PROTO_SYNC0) { break; }
+    }
+
+    memmove(parser->buf, parser->buf + i, parser->fill - i);
+    parser->fill = (uint16_t)(parser->fill - i);
+    parser->skipped += i;
+}
+
+/**
+ * @brief 检查缓冲区中的数据
+ * @return uint32_t 解析出的完整帧数量
+ *
+ * 帧头非法或CRC错误时在缓冲区内重新同步，直到缓冲区内容是一个合法帧的前缀。
+ * 一个损坏的长帧头可能使缓冲区中积累了后续的完整帧，因此处理完一帧后继续检查剩余数据
+ */
+static uint32_t cap_proto_parser_check(cap_proto_parser_t *parser, cap_proto_frame_handler_t handler, void *ctx)
+{
+    uint32_t count = 0;
+
+    while (parser->fill > 0) {
+        uint16_t length;
+        uint16_t total;
+        uint16_t crc;
+
+        if ((parser->fill >= 2 && parser->buf[1] != CAP_PROTO_SYNC1) ||
+            (parser->fill >= 3 && parser->buf[2] != CAP_PROTO_VERSION)) {
+            cap_proto_parser_slip(parser);
+            continue;
+        }
+
+        if (parser->fill < CAP_PROTO_HEADER_SIZE) { break; }
+
+        length = (uint16_t)(parser->buf[6] | (parser->buf[7] << 8));
+        if (length > CAP_PROTO_MAX_PAYLOAD) {
+            cap_proto_parser_slip(parser);
+            continue;
+        }
+
+        total = (uint16_t)(CAP_PROTO_HEADER_SIZE + length + CAP_PROTO_CRC_SIZE);
+        if (parser->fill < total) { break; }
+
+        crc = (uint16_t)(parser->buf[total - 2] | (parser->buf[total - 1] << 8));
+        if (crc != cap_proto_crc16_sw(parser->buf, CAP_PROTO_HEADER_SIZE + length)) {
+            parser->crc_errors++;
+            cap_proto_parser_slip(parser);
+            continue;
+        }
+
+        parser->frames++;
+        count++;
+        if (handler != NULL) {
+            handler((const cap_proto_header_t *)parser->buf, cap_proto_payload(parser->buf), ctx);
+        }
+
+        memmove(parser->buf, parser->buf + total, parser->fill - total);
+        parser->fill = (uint16_t)(parser->fill - total);
+    }
+
+    return count;
+}
+
+/**
+ * @brief 向解析器输入接收数据
+ */
+uint32_t cap_proto_parser_feed(cap_proto_parser_t *parser, const uint8_t *data, uint32_t length,
+                               cap_proto_frame_handler_t handler, void *ctx)
+{
+    uint32_t count = 0;
+
+    while (length > 0) {
+        uint32_t need;
+
+        /* 空闲时只接受同步字首字节 */
+        if (parser->fill == 0) {
+            const uint8_t *sync = (const uint8_t *)memchr(data, CAP_PROTO_SYNC0, length);
+            uint32_t       skip = (sync != NULL) ? (uint32_t)(sync - data) : length;
+
+            parser->skipped += skip;
+            data += skip;
+            length -= skip;
+            if (length == 0) { break; }
+        }
+
+        /* 缓冲区总是合法帧的前缀: 先补齐帧头，再补齐整帧，检查结果与逐字节输入相同 */
+        if (parser->fill < CAP_PROTO_HEADER_SIZE) {
+            need = CAP_PROTO_HEADER_SIZE - parser->fill;
+        } else {
+            need = CAP_PROTO_HEADER_SIZE + (parser->buf[6] | (parser->buf[7] << 8)) + CAP_PROTO_CRC_SIZE - parser->fill;
+        }
+        if (need > length) { need = length; }
+
+        memcpy(&parser->buf[parser->fill], data, need);
+        parser->fill = (uint16_t)(parser->fill + need);
+        data += need;
+        length -= need;
+
+        count += cap_proto_parser_check(parser, handler, ctx);
+    }
+
+    return count;
+}
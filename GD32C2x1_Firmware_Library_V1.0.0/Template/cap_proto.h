@@ -0,0 +1,432 @@
+/**
+ * @file cap_proto.h
+ * @brief 电容触摸数据帧协议定义 - GD32C2x1版本
+ * @version 1.0
+ * @date 2025-11-01
+ *
+ * 本文件只依赖stdint，固件和上位机工具共用同一份协议定义。
+ *
+ * 帧格式(小端):
+ *
+ * | 偏移 | 长度 | 字段    | 说明                                  |
+ * |------|------|---------|---------------------------------------|
+ * | 0    | 2    | sync    | 0xA5 0x5A                             |
+ * | 2    | 1    | version | 协议版本 CAP_PROTO_VERSION            |
+ * | 3    | 1    | type    | 帧类型 CAP_PROTO_TYPE_xxx             |
+ * | 4    | 2    | seq     | 帧序号，每发送一帧加1                 |
+ * | 6    | 2    | length  | 负载长度(字节)，不超过CAP_PROTO_MAX_PAYLOAD |
+ * | 8    | N    | payload | 负载                                  |
+ * | 8+N  | 2    | crc     | CRC-16/CCITT-FALSE，覆盖sync到payload |
+ *
+ * 接收方按字节搜索sync，校验version/length后等待整帧，CRC错误时丢弃首字节
+ * 并在已接收的数据中重新搜索sync，因此任何损坏最多影响一帧长度的数据。
+ *
+ * 差分压缩帧(CAP_PROTO_TYPE_DELTA)负载:
+ *
+ * | 长度 | 字段  | 说明                                                  |
+ * |------|-------|-------------------------------------------------------|
+ * | 1    | count | 本帧扫描次数                                          |
+ * | 14   | key   | 第一次扫描的完整数据(cap_proto_raw_t)，即关键帧        |
+ * | 变长 | rec   | 其余 count-1 次扫描，每次一条记录                     |
+ *
+ * 记录: ctrl(1字节) [+ touch_mask + flags，仅当ctrl含CAP_PROTO_REC_STATE]
+ *       + 6个通道相对上一次扫描的差值，zig-zag编码后按varint(每字节7位，最高位为延续位)存放。
+ * 相邻扫描的差值通常只有几个LSB，每个通道1字节。每帧都以关键帧开始，
+ * 丢失或损坏一帧不影响后续帧的解码。
+ *
+ * 批量帧(CAP_PROTO_TYPE_BATCH)负载，多次扫描共用一个帧头和CRC:
+ *
+ * | 长度 | 字段    | 说明                                               |
+ * |------|---------|----------------------------------------------------|
+ * | 1    | count   | 本帧扫描次数                                       |
+ * | 4    | base_us | 第一次扫描的时间戳(微秒，低32位)                   |
+ * | 变长 | rec     | count条记录: [dt_us] + cap_proto_raw_t             |
+ *
+ * 除第一条外，每条记录前有相对上一次扫描的时间差dt_us(varint)。
+ *
+ * 所有设备发出的帧共用一个序号计数器(16位，回绕)。因发送缓冲区不足而丢弃的帧
+ * 同样占用序号，上位机根据序号的间隔统计丢失的帧数。
+ *
+ * 遥测帧(CAP_PROTO_TYPE_TELEMETRY)负载为cap_proto_telemetry_t，按
+ * CAP_PROTO_PARAM_TELEMETRY_MS周期发送，所有计数从上电开始累计(32位，回绕)，
+ * 上位机取相邻两帧的差值。active_us与time_us之差的比例为活动时间占比(平均电流的近似)，
+ * wakeups之差除以时间差为每秒唤醒次数。
+ *
+ * 性能分析帧(CAP_PROTO_TYPE_PROFILE)仅在固件以CAP_PROF_ENABLE编译时随遥测帧发送，
+ * 负载为若干条cap_proto_profile_t(条数 = length / sizeof)，时间单位为CPU周期。
+ *
+ * 扫描时序帧(CAP_PROTO_TYPE_TIMING)仅在固件以CAP_TOUCH_TIMING_ENABLE编译时随遥测帧发送，
+ * 负载为cap_proto_timing_t: 三个对数刻度直方图，区间0为0us，区间k(1-16)为[2^(k-1), 2^k)us，
+ * 最后一个区间为65536us及以上，计数从上电或上一次清除开始累计。
+ *
+ * 命令帧(上位机 -> 设备)使用相同的帧格式:
+ * - CAP_PROTO_TYPE_CMD_GET / CAP_PROTO_TYPE_CMD_SET，负载为cap_proto_param_t
+ * - 设备以CAP_PROTO_TYPE_CMD_ACK应答，负载为cap_proto_ack_t，其中value为参数的当前值
+ */
+
+#ifndef CAP_PROTO_H_
+#define CAP_PROTO_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** 帧同步字 */
+#define CAP_PROTO_SYNC0 0xA5
+#define CAP_PROTO_SYNC1 0x5A
+
+/** 协议版本 */
+#define CAP_PROTO_VERSION 1
+
+/** 帧类型定义 */
+#define CAP_PROTO_TYPE_RAW       0x01 /*!< 原始数据帧: cap_proto_raw_t */
+#define CAP_PROTO_TYPE_DELTA     0x02 /*!< 差分压缩帧: 关键帧 + 差分记录 */
+#define CAP_PROTO_TYPE_BATCH     0x03 /*!< 批量帧: 多次扫描 + 时间差 */
+#define CAP_PROTO_TYPE_TELEMETRY 0x04 /*!< 遥测帧: cap_proto_telemetry_t */
+#define CAP_PROTO_TYPE_PROFILE   0x05 /*!< 性能分析帧: cap_proto_profile_t[] */
+#define CAP_PROTO_TYPE_TIMING    0x06 /*!< 扫描时序帧: cap_proto_timing_t */
+
+/** 命令帧类型定义 */
+#define CAP_PROTO_TYPE_CMD_GET 0x40 /*!< 读取参数: cap_proto_param_t(value忽略) */
+#define CAP_PROTO_TYPE_CMD_SET 0x41 /*!< 设置参数: cap_proto_param_t */
+#define CAP_PROTO_TYPE_CMD_ACK 0x42 /*!< 命令应答: cap_proto_ack_t */
+
+/** 命令参数定义，index为通道号的参数标注(ch) */
+#define CAP_PROTO_PARAM_THRESHOLD          0x01 /*!< 触摸阈值(ch) */
+#define CAP_PROTO_PARAM_BURST_SHIFT        0x02 /*!< 过采样次数的对数(ch) */
+#define CAP_PROTO_PARAM_TIMER_PRESCALER    0x03 /*!< 捕获定时器预分频值 */
+#define CAP_PROTO_PARAM_CAPTURE_TIMEOUT    0x04 /*!< 捕获超时时间(计数值) */
+#define CAP_PROTO_PARAM_IC_FILTER          0x05 /*!< 输入捕获数字滤波 */
+#define CAP_PROTO_PARAM_SCAN_IDLE_TICKS    0x06 /*!< 空闲模式帧周期(节拍) */
+#define CAP_PROTO_PARAM_SCAN_IDLE_MASK     0x07 /*!< 空闲模式扫描通道掩码 */
+#define CAP_PROTO_PARAM_SCAN_QUIET_FRAMES  0x08 /*!< 进入空闲模式的无触摸帧数 */
+#define CAP_PROTO_PARAM_PROX_ENABLE        0x09 /*!< 接近检测使能 */
+#define CAP_PROTO_PARAM_PROX_THRESHOLD     0x0A /*!< 接近阈值 */
+#define CAP_PROTO_PARAM_STREAM_ENABLE      0x10 /*!< 数据流开始(1)/停止(0) */
+#define CAP_PROTO_PARAM_STREAM_MODE        0x11 /*!< 数据流模式: 0原始 1差分 2批量 */
+#define CAP_PROTO_PARAM_STREAM_BATCH_SCANS 0x12 /*!< 差分/批量模式每帧扫描次数 */
+#define CAP_PROTO_PARAM_STREAM_LATENCY_US  0x13 /*!< 差分/批量模式最大延迟(微秒) */
+#define CAP_PROTO_PARAM_TELEMETRY_MS       0x14 /*!< 遥测帧周期(毫秒)，0为不发送 */
+#define CAP_PROTO_PARAM_PROFILE_RESET      0x15 /*!< 写入任意值清除性能分析统计 */
+#define CAP_PROTO_PARAM_TIMING_RESET       0x16 /*!< 写入任意值清除扫描时序直方图 */
+#define CAP_PROTO_PARAM_IMAGE_CRC          0x17 /*!< 启动时计算的固件映像CRC-32(只读) */
+#define CAP_PROTO_PARAM_CALIB_SAVE         0x18 /*!< 写入1保存当前校准到Flash，0删除；读取1为已保存 */
+#define CAP_PROTO_PARAM_LOW_POWER          0x19 /*!< 低功耗扫描(空闲扫描帧间深度睡眠)使能 */
+
+/** 性能分析区段(cap_proto_profile_t.region) */
+#define CAP_PROTO_PROF_TIMER0_ISR      0x00 /*!< TIMER0_Channel_IRQHandler */
+#define CAP_PROTO_PROF_TIMER2_ISR      0x01 /*!< TIMER2_IRQHandler */
+#define CAP_PROTO_PROF_FINISH_CAPTURE  0x02 /*!< cap_touch_finish_capture() */
+#define CAP_PROTO_PROF_DATA_READY      0x03 /*!< 数据就绪回调(on_touch_data_ready) */
+#define CAP_PROTO_PROF_REGIONS         4
+
+/** 扫描时序直方图区间数(与CAP_TOUCH_TIMING_BINS一致) */
+#define CAP_PROTO_TIMING_BINS 18
+
+/** 命令应答状态 */
+#define CAP_PROTO_STATUS_OK            0x00 /*!< 成功 */
+#define CAP_PROTO_STATUS_UNKNOWN_PARAM 0x01 /*!< 未知参数 */
+#define CAP_PROTO_STATUS_INVALID_VALUE 0x02 /*!< 参数值或通道号无效 */
+#define CAP_PROTO_STATUS_BAD_COMMAND   0x03 /*!< 未知命令或负载长度错误 */
+#define CAP_PROTO_STATUS_FAILED        0x04 /*!< 执行失败(Flash编程错误等) */
+
+/** 通道数量(与CAP_TOUCH_CHANNEL_COUNT一致) */
+#define CAP_PROTO_CHANNELS 6
+
+/** 长度定义 */
+#define CAP_PROTO_HEADER_SIZE 8
+#define CAP_PROTO_CRC_SIZE    2
+#define CAP_PROTO_MAX_PAYLOAD 240
+#define CAP_PROTO_MAX_FRAME   (CAP_PROTO_HEADER_SIZE + CAP_PROTO_MAX_PAYLOAD + CAP_PROTO_CRC_SIZE)
+
+/** CRC-16/CCITT-FALSE 参数 */
+#define CAP_PROTO_CRC_POLY 0x1021
+#define CAP_PROTO_CRC_INIT 0xFFFF
+
+/** 原始数据帧标志位 */
+#define CAP_PROTO_FLAG_IDLE      0x01 /*!< 空闲扫描模式 */
+#define CAP_PROTO_FLAG_PROXIMITY 0x02 /*!< 检测到接近 */
+#define CAP_PROTO_FLAG_GUARD     0x04 /*!< 保护通道屏蔽 */
+
+/** 差分记录控制字节 */
+#define CAP_PROTO_REC_STATE 0x01 /*!< 记录中包含touch_mask和flags */
+
+/** 单条差分记录最大长度: ctrl + 状态 + 每通道最多3字节varint */
+#define CAP_PROTO_DELTA_REC_MAX (1 + 2 + CAP_PROTO_CHANNELS * 3)
+
+/** 单条批量记录最大长度: 5字节varint时间差 + 原始数据 */
+#define CAP_PROTO_BATCH_REC_MAX (5 + 2 * CAP_PROTO_CHANNELS + 2)
+
+#pragma pack(1)
+/**
+ * @brief 帧头
+ */
+typedef struct {
+    uint8_t  sync[2]; /*!< 同步字 0xA5 0x5A */
+    uint8_t  version; /*!< 协议版本 */
+    uint8_t  type;    /*!< 帧类型 */
+    uint16_t seq;     /*!< 帧序号 */
+    uint16_t length;  /*!< 负载长度 */
+} cap_proto_header_t;
+
+/**
+ * @brief 原始数据帧负载
+ */
+typedef struct {
+    uint16_t values[CAP_PROTO_CHANNELS]; /*!< 各通道触摸值 */
+    uint8_t  touch_mask;                 /*!< 触摸通道掩码 */
+    uint8_t  flags;                      /*!< CAP_PROTO_FLAG_xxx */
+} cap_proto_raw_t;
+
+/**
+ * @brief 遥测帧负载
+ */
+typedef struct {
+    uint32_t time_us;          /*!< 设备时间(微秒，低32位) */
+    uint32_t frames;           /*!< 完成的扫描帧数 */
+    uint32_t scan_overruns;    /*!< 处理时间超过扫描节拍的次数 */
+    uint32_t capture_timeouts; /*!< 软件超时的捕获次数 */
+    uint32_t tx_overflows;     /*!< 发送缓冲区满而丢弃的帧数(SPI链路为数据页数) */
+    uint32_t event_overflows;  /*!< I2C事件FIFO溢出次数 */
+    uint32_t dma_restarts;     /*!< 链路DMA重新启动的次数 */
+    uint32_t cmd_crc_errors;   /*!< 命令帧CRC错误次数 */
+    uint32_t active_us;        /*!< 活动时间(微秒，低32位): 设备时间减去深度睡眠时间 */
+    uint32_t wakeups;          /*!< 深度睡眠唤醒次数 */
+} cap_proto_telemetry_t;
+
+/**
+ * @brief 性能分析帧中的一条区段统计(从上电或上一次清除开始)
+ */
+typedef struct {
+    uint8_t  region;     /*!< CAP_PROTO_PROF_xxx */
+    uint32_t count;      /*!< 执行次数 */
+    uint16_t min_cycles; /*!< 最短执行时间(CPU周期) */
+    uint16_t max_cycles; /*!< 最长执行时间(CPU周期) */
+    uint16_t avg_cycles; /*!< 平均执行时间(CPU周期) */
+} cap_proto_profile_t;
+
+/**
+ * @brief 扫描时序帧负载(各区间的次数)
+ */
+typedef struct {
+    uint32_t scan[CAP_PROTO_TIMING_BINS];   /*!< 扫描时间: 一帧第一个通道开始充电到数据就绪 */
+    uint32_t dead[CAP_PROTO_TIMING_BINS];   /*!< 死区时间: 一帧内捕获结束到下一次开始充电 */
+    uint32_t period[CAP_PROTO_TIMING_BINS]; /*!< 帧周期: 相邻两帧数据就绪的间隔 */
+} cap_proto_timing_t;
+
+/**
+ * @brief 命令参数
+ */
+typedef struct {
+    uint8_t  param; /*!< CAP_PROTO_PARAM_xxx */
+    uint8_t  index; /*!< 通道号(仅按通道设置的参数) */
+    uint32_t value; /*!< 参数值 */
+} cap_proto_param_t;
+
+/**
+ * @brief 命令应答
+ */
+typedef struct {
+    uint8_t           command; /*!< 应答的命令帧类型 */
+    uint8_t           status;  /*!< CAP_PROTO_STATUS_xxx */
+    cap_proto_param_t param;   /*!< 参数及当前值 */
+} cap_proto_ack_t;
+#pragma pack()
+
+/**
+ * @brief 差分压缩帧编码器
+ */
+typedef struct {
+    uint8_t        *frame;     /*!< 帧缓冲区，至少CAP_PROTO_MAX_FRAME字节 */
+    uint16_t        length;    /*!< 已写入的负载长度 */
+    uint8_t         count;     /*!< 已写入的扫描次数 */
+    uint8_t         max_scans; /*!< 每帧最多扫描次数 */
+    cap_proto_raw_t prev;      /*!< 上一次扫描，作为差分参考 */
+} cap_proto_delta_enc_t;
+
+/**
+ * @brief 批量帧编码器
+ */
+typedef struct {
+    uint8_t *frame;     /*!< 帧缓冲区，至少CAP_PROTO_MAX_FRAME字节 */
+    uint16_t length;    /*!< 已写入的负载长度 */
+    uint8_t  count;     /*!< 已写入的扫描次数 */
+    uint8_t  max_scans; /*!< 每帧最多扫描次数 */
+    uint32_t last_us;   /*!< 上一次扫描的时间戳 */
+} cap_proto_batch_enc_t;
+
+/**
+ * @brief 接收解析器
+ */
+typedef struct {
+    uint8_t  buf[CAP_PROTO_MAX_FRAME]; /*!< 帧缓冲区 */
+    uint16_t fill;                     /*!< 缓冲区已有字节数 */
+    uint32_t frames;                   /*!< 成功解析的帧数 */
+    uint32_t crc_errors;               /*!< CRC错误次数 */
+    uint32_t skipped;                  /*!< 重新同步时丢弃的字节数 */
+} cap_proto_parser_t;
+
+/**
+ * @brief 完整帧回调函数类型
+ * @param header 帧头
+ * @param payload 负载(指向解析器缓冲区，回调返回后失效)
+ * @param ctx 用户参数
+ */
+typedef void (*cap_proto_frame_handler_t)(const cap_proto_header_t *header, const uint8_t *payload, void *ctx);
+
+/**
+ * @brief 初始化协议模块(固件中配置硬件CRC单元)
+ */
+void cap_proto_init(void);
+
+/**
+ * @brief 获取帧缓冲区中负载的起始地址
+ *
+ * @param frame 帧缓冲区，至少 CAP_PROTO_HEADER_SIZE + 负载长度 + CAP_PROTO_CRC_SIZE 字节
+ * @return uint8_t* 负载起始地址，调用者直接在此填写负载(零拷贝)
+ */
+static inline uint8_t *cap_proto_payload(uint8_t *frame)
+{
+    return frame + CAP_PROTO_HEADER_SIZE;
+}
+
+/**
+ * @brief 填写帧头、序号和CRC，完成一帧
+ *
+ * @param frame 帧缓冲区，负载已填写在 cap_proto_payload(frame)
+ * @param type 帧类型
+ * @param length 负载长度
+ * @return uint16_t 整帧长度，负载过长时返回0
+ */
+uint16_t cap_proto_finalize(uint8_t *frame, uint8_t type, uint16_t length);
+
+/**
+ * @brief 跳过帧序号
+ *
+ * 帧在填写帧头之前被丢弃时调用，使上位机能从序号间隔发现丢失
+ *
+ * @param count 跳过的帧数
+ */
+void cap_proto_seq_skip(uint16_t count);
+
+/**
+ * @brief 计算CRC-16/CCITT-FALSE
+ *
+ * @param data 数据
+ * @param length 数据长度
+ * @return uint16_t CRC值(固件中由硬件CRC单元计算)
+ */
+uint16_t cap_proto_crc16(const uint8_t *data, uint32_t length);
+
+/**
+ * @brief 软件分段计算CRC-16/CCITT-FALSE
+ *
+ * @param crc 上一段的CRC值，第一段传入CAP_PROTO_CRC_INIT
+ * @param data 数据
+ * @param length 数据长度
+ * @return uint16_t 累计CRC值，用于计算环形缓冲区中跨越边界的数据
+ */
+uint16_t cap_proto_crc16_update(uint16_t crc, const uint8_t *data, uint32_t length);
+
+/**
+ * @brief 开始一个差分压缩帧
+ *
+ * @param enc 编码器
+ * @param frame 帧缓冲区
+ * @param max_scans 每帧最多扫描次数，负载空间不足时提前结束
+ */
+void cap_proto_delta_begin(cap_proto_delta_enc_t *enc, uint8_t *frame, uint8_t max_scans);
+
+/**
+ * @brief 向差分压缩帧添加一次扫描
+ *
+ * @param enc 编码器
+ * @param scan 扫描数据
+ * @return uint8_t 1: 帧已满，需调用cap_proto_delta_finish; 0: 可继续添加
+ */
+uint8_t cap_proto_delta_add(cap_proto_delta_enc_t *enc, const cap_proto_raw_t *scan);
+
+/**
+ * @brief 结束差分压缩帧，填写帧头和CRC
+ *
+ * @param enc 编码器
+ * @return uint16_t 整帧长度，没有扫描数据时返回0
+ */
+uint16_t cap_proto_delta_finish(cap_proto_delta_enc_t *enc);
+
+/**
+ * @brief 解码差分压缩帧负载
+ *
+ * @param payload 负载
+ * @param length 负载长度
+ * @param scans 输出扫描数据
+ * @param max_scans scans数组大小
+ * @return uint8_t 解码出的扫描次数，格式错误时返回0
+ */
+uint8_t cap_proto_delta_decode(const uint8_t *payload, uint16_t length, cap_proto_raw_t *scans, uint8_t max_scans);
+
+/**
+ * @brief 开始一个批量帧
+ *
+ * @param enc 编码器
+ * @param frame 帧缓冲区
+ * @param max_scans 每帧最多扫描次数，负载空间不足时提前结束
+ */
+void cap_proto_batch_begin(cap_proto_batch_enc_t *enc, uint8_t *frame, uint8_t max_scans);
+
+/**
+ * @brief 向批量帧添加一次扫描
+ *
+ * @param enc 编码器
+ * @param scan 扫描数据
+ * @param time_us 扫描时间戳(微秒)
+ * @return uint8_t 1: 帧已满，需调用cap_proto_batch_finish; 0: 可继续添加
+ */
+uint8_t cap_proto_batch_add(cap_proto_batch_enc_t *enc, const cap_proto_raw_t *scan, uint32_t time_us);
+
+/**
+ * @brief 结束批量帧，填写帧头和CRC
+ *
+ * @param enc 编码器
+ * @return uint16_t 整帧长度，没有扫描数据时返回0
+ */
+uint16_t cap_proto_batch_finish(cap_proto_batch_enc_t *enc);
+
+/**
+ * @brief 解码批量帧负载
+ *
+ * @param payload 负载
+ * @param length 负载长度
+ * @param scans 输出扫描数据
+ * @param times_us 输出各次扫描的时间戳(微秒，低32位)
+ * @param max_scans scans/times_us数组大小
+ * @return uint8_t 解码出的扫描次数，格式错误时返回0
+ */
+uint8_t cap_proto_batch_decode(const uint8_t *payload, uint16_t length, cap_proto_raw_t *scans, uint32_t *times_us,
+                               uint8_t max_scans);
+
+/**
+ * @brief 初始化接收解析器
+ */
+void cap_proto_parser_init(cap_proto_parser_t *parser);
+
+/**
+ * @brief 向解析器输入接收数据
+ *
+ * @param parser 解析器
+ * @param data 接收数据
+ * @param length 数据长度
+ * @param handler 完整帧回调函数
+ * @param ctx 回调用户参数
+ * @return uint32_t 本次解析出的完整帧数量
+ */
+uint32_t cap_proto_parser_feed(cap_proto_parser_t *parser, const uint8_t *data, uint32_t length,
+                               cap_proto_frame_handler_t handler, void *ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CAP_PROTO_H_ */
@@ -0,0 +1,340 @@
+/**
+ * @file cap_spi.c
+ * @brief 电容触摸SPI从机数据流实现 - GD32C2x1版本
+ * @version 1.0
+ * @date 2025-11-01
+ *
+ * 数据路径(参考Examples/SPI/SPI_slave_fullduplex_dma):
+ * 1. 三个数据页轮流作为填写页、就绪页和发送页。扫描完成后原始数据帧直接
+ *    写入填写页(帧头和CRC在原位置填写，不复制)
+ * 2. 填写页满或超过最大延迟时变为就绪页；发送页空闲时立即配置DMA发送，
+ *    并拉低数据就绪引脚。主机读取不及时时丢弃较旧的就绪页，只保留最新数据
+ * 3. 接收DMA传输完成(事务结束)时中断一次，释放发送页并配置下一页，
+ *    接收到的主机数据交给主循环按命令帧解析
+ *
+ * 每页只在事务结束时有一次中断，传输过程中无CPU参与。
+ * DMA_CH1中断与触摸捕获中断优先级相同，主循环访问数据页时关中断。
+ */
+
+#include "cap_spi.h"
+#include "cap_cmd.h"
+#include "cap_touch.h"
+#include <string.h>
+
+/** 原始数据帧长度 */
+#define CAP_SPI_RAW_FRAME_SIZE ((uint16_t)(CAP_PROTO_HEADER_SIZE + sizeof(cap_proto_raw_t) + CAP_PROTO_CRC_SIZE))
+
+/** 数据页数 */
+#define CAP_SPI_PAGE_COUNT 3
+
+/** 无数据页 */
+#define CAP_SPI_PAGE_NONE 0xFF
+
+/** 数据页和接收缓冲区(双缓冲: 一个由DMA写入，另一个由主循环解析) */
+__attribute__((aligned(4))) static uint8_t g_spi_pages[CAP_SPI_PAGE_COUNT][CAP_SPI_PAGE_SIZE];
+__attribute__((aligned(4))) static uint8_t g_spi_rx_buf[2][CAP_SPI_PAGE_SIZE];
+
+/** 填写页、就绪页、发送页 */
+static uint8_t  g_spi_fill_page   = 0;
+static uint16_t g_spi_fill        = 0;
+static uint8_t  g_spi_ready_page  = CAP_SPI_PAGE_NONE;
+static uint8_t  g_spi_flight_page = CAP_SPI_PAGE_NONE;
+
+/** 填写页中第一帧的时间戳和上次提交的时间戳 */
+static uint64_t g_spi_first_us   = 0;
+static uint64_t g_spi_publish_us = 0;
+
+/** 接收缓冲区: DMA写入的缓冲区，待主循环解析的缓冲区 */
+static uint8_t          g_spi_rx_index   = 0;
+static uint8_t          g_spi_rx_done    = 0;
+static volatile uint8_t g_spi_rx_pending = 0;
+
+/** 统计 */
+static uint32_t g_spi_transactions  = 0;
+static uint32_t g_spi_dropped_pages = 0;
+static uint32_t g_spi_resyncs       = 0;
+
+/**
+ * @brief 配置SPI0为全双工从机，使能DMA收发
+ */
+static void cap_spi_periph_config(void)
+{
+    spi_parameter_struct spi_init_struct;
+
+    spi_i2s_deinit(SPI0);
+    spi_struct_para_init(&spi_init_struct);
+
+    spi_init_struct.trans_mode           = SPI_TRANSMODE_FULLDUPLEX;
+    spi_init_struct.device_mode          = SPI_SLAVE;
+    spi_init_struct.frame_size           = SPI_FRAMESIZE_8BIT;
+    spi_init_struct.clock_polarity_phase = SPI_CK_PL_LOW_PH_1EDGE; /* 模式0 */
+    spi_init_struct.prescale             = SPI_PSC_2;              /* 从机模式下不使用 */
+    spi_init_struct.endian               = SPI_ENDIAN_MSB;
+    spi_init_struct.nss                  = SPI_NSS_HARD;
+    spi_init(SPI0, &spi_init_struct);
+
+    spi_dma_enable(SPI0, SPI_DMA_TRANSMIT);
+    spi_dma_enable(SPI0, SPI_DMA_RECEIVE);
+    spi_enable(SPI0);
+}
+
+/**
+ * @brief 配置发送页并启动事务，拉低数据就绪引脚
+ *
+ * 在发送页空闲且有就绪页时调用(中断上下文或关中断)
+ */
+static void cap_spi_arm(void)
+{
+    g_spi_flight_page = g_spi_ready_page;
+    g_spi_ready_page  = CAP_SPI_PAGE_NONE;
+
+    dma_channel_disable(DMA_CH0);
+    dma_channel_disable(DMA_CH1);
+
+    /* 主机多传输了字节时发送缓冲区中残留上一页的数据，复位SPI重新对齐 */
+    if (spi_i2s_flag_get(SPI0, SPI_FLAG_TBE) == RESET) {
+        g_spi_resyncs++;
+        cap_spi_periph_config();
+    }
+    if (spi_i2s_flag_get(SPI0, SPI_FLAG_RBNE) == SET) { (void)spi_i2s_data_receive(SPI0); }
+
+    dma_memory_address_config(DMA_CH1, (uint32_t)g_spi_rx_buf[g_spi_rx_index]);
+    dma_transfer_number_config(DMA_CH1, CAP_SPI_PAGE_SIZE);
+    dma_memory_address_config(DMA_CH0, (uint32_t)g_spi_pages[g_spi_flight_page]);
+    dma_transfer_number_config(DMA_CH0, CAP_SPI_PAGE_SIZE);
+
+    /* 先使能接收通道，发送通道使能后立即预装第一个字节 */
+    dma_channel_enable(DMA_CH1);
+    dma_channel_enable(DMA_CH0);
+
+    gpio_bit_write(CAP_SPI_DRDY_PORT, CAP_SPI_DRDY_PIN, RESET);
+}
+
+/**
+ * @brief 提交填写页，剩余部分填0
+ *
+ * 已有就绪页(主机读取不及时)时丢弃旧的就绪页，用它作为新的填写页
+ */
+static void cap_spi_publish(void)
+{
+    uint8_t page = g_spi_fill_page;
+
+    memset(&g_spi_pages[page][g_spi_fill], 0, CAP_SPI_PAGE_SIZE - g_spi_fill);
+
+    if (g_spi_ready_page != CAP_SPI_PAGE_NONE) {
+        g_spi_fill_page = g_spi_ready_page;
+        g_spi_dropped_pages++;
+    } else {
+        /* 三个页中既不是当前填写页也不是发送页的一个 */
+        g_spi_fill_page = (uint8_t)((page + 1U) % CAP_SPI_PAGE_COUNT);
+        if (g_spi_fill_page == g_spi_flight_page) { g_spi_fill_page = (uint8_t)((g_spi_fill_page + 1U) % CAP_SPI_PAGE_COUNT); }
+    }
+
+    g_spi_ready_page = page;
+    g_spi_fill       = 0;
+    g_spi_publish_us = cap_touch_get_time_us();
+
+    if (g_spi_flight_page == CAP_SPI_PAGE_NONE) { cap_spi_arm(); }
+}
+
+/**
+ * @brief 在当前数据页中开始一个原始数据帧
+ */
+cap_proto_raw_t *cap_spi_raw_begin(void)
+{
+    if (CAP_SPI_PAGE_SIZE - g_spi_fill < CAP_SPI_RAW_FRAME_SIZE) { cap_spi_publish(); }
+
+    return (cap_proto_raw_t *)cap_proto_payload(&g_spi_pages[g_spi_fill_page][g_spi_fill]);
+}
+
+/**
+ * @brief 完成原始数据帧，数据页满时提交发送
+ */
+void cap_spi_raw_commit(void)
+{
+    if (g_spi_fill == 0) { g_spi_first_us = cap_touch_get_time_us(); }
+
+    g_spi_fill += cap_proto_finalize(&g_spi_pages[g_spi_fill_page][g_spi_fill], CAP_PROTO_TYPE_RAW, sizeof(cap_proto_raw_t));
+
+    if (CAP_SPI_PAGE_SIZE - g_spi_fill < CAP_SPI_RAW_FRAME_SIZE) { cap_spi_publish(); }
+}
+
+/**
+ * @brief 把一个完整帧加入数据页
+ */
+void cap_spi_send(const uint8_t *frame, uint16_t length)
+{
+    if (length > CAP_SPI_PAGE_SIZE) { return; }
+
+    __disable_irq();
+
+    if (CAP_SPI_PAGE_SIZE - g_spi_fill < length) { cap_spi_publish(); }
+    if (g_spi_fill == 0) { g_spi_first_us = cap_touch_get_time_us(); }
+
+    memcpy(&g_spi_pages[g_spi_fill_page][g_spi_fill], frame, length);
+    g_spi_fill += length;
+
+    __enable_irq();
+}
+
+/**
+ * @brief 处理主机发送的命令，检查数据页延迟
+ */
+void cap_spi_poll(void)
+{
+    uint64_t now;
+
+    if (g_spi_rx_pending) {
+        cap_cmd_process(g_spi_rx_buf[g_spi_rx_done], CAP_SPI_PAGE_SIZE);
+        g_spi_rx_pending = 0;
+    }
+
+    now = cap_touch_get_time_us();
+
+    __disable_irq();
+
+    if (g_spi_fill > 0) {
+        /* 空闲扫描或数据流停止时按最大延迟提交 */
+        if (now - g_spi_first_us >= CAP_SPI_LATENCY_US) { cap_spi_publish(); }
+    } else if (g_spi_ready_page == CAP_SPI_PAGE_NONE && g_spi_flight_page == CAP_SPI_PAGE_NONE) {
+        /* 长时间无数据时提交空页，让主机有机会发送命令 */
+        if (now - g_spi_publish_us >= CAP_SPI_HEARTBEAT_US) { cap_spi_publish(); }
+    }
+
+    __enable_irq();
+}
+
+/**
+ * @brief DMA_CH1(SPI0接收)中断处理函数，事务结束时调用
+ */
+void cap_spi_dma_irq_handler(void)
+{
+    if (dma_interrupt_flag_get(DMA_CH1, DMA_INT_FLAG_FTF) == RESET) { return; }
+    dma_interrupt_flag_clear(DMA_CH1, DMA_INT_FLAG_FTF);
+
+    gpio_bit_write(CAP_SPI_DRDY_PORT, CAP_SPI_DRDY_PIN, SET);
+    g_spi_transactions++;
+
+    /* 接收缓冲区交给主循环解析，下一事务写入另一个缓冲区 */
+    g_spi_rx_done    = g_spi_rx_index;
+    g_spi_rx_pending = 1;
+    g_spi_rx_index ^= 1;
+
+    g_spi_flight_page = CAP_SPI_PAGE_NONE;
+    if (g_spi_ready_page != CAP_SPI_PAGE_NONE) { cap_spi_arm(); }
+}
+
+/**
+ * @brief 配置SPI0引脚和数据就绪引脚
+ */
+static void cap_spi_gpio_config(void)
+{
+    rcu_periph_clock_enable(RCU_GPIOA);
+    rcu_periph_clock_enable(CAP_SPI_DRDY_RCU);
+
+    gpio_af_set(GPIOA, GPIO_AF_0, CAP_SPI_NSS_PIN | CAP_SPI_SCK_PIN | CAP_SPI_MISO_PIN | CAP_SPI_MOSI_PIN);
+    gpio_mode_set(GPIOA, GPIO_MODE_AF, GPIO_PUPD_NONE, CAP_SPI_NSS_PIN | CAP_SPI_SCK_PIN | CAP_SPI_MISO_PIN | CAP_SPI_MOSI_PIN);
+    gpio_output_options_set(GPIOA, GPIO_OTYPE_PP, GPIO_OSPEED_LEVEL_1, CAP_SPI_NSS_PIN | CAP_SPI_SCK_PIN | CAP_SPI_MISO_PIN | CAP_SPI_MOSI_PIN);
+
+    /* 数据就绪引脚推挽输出，初始为高电平(无数据) */
+    gpio_bit_write(CAP_SPI_DRDY_PORT, CAP_SPI_DRDY_PIN, SET);
+    gpio_mode_set(CAP_SPI_DRDY_PORT, GPIO_MODE_OUTPUT, GPIO_PUPD_NONE, CAP_SPI_DRDY_PIN);
+    gpio_output_options_set(CAP_SPI_DRDY_PORT, GPIO_OTYPE_PP, GPIO_OSPEED_LEVEL_0, CAP_SPI_DRDY_PIN);
+}
+
+/**
+ * @brief 配置DMA_CH0(SPI0发送)和DMA_CH1(SPI0接收)
+ */
+static void cap_spi_dma_config(void)
+{
+    dma_parameter_struct dma_init_struct;
+
+    rcu_periph_clock_enable(RCU_DMA);
+    rcu_periph_clock_enable(RCU_DMAMUX);
+
+    dma_deinit(DMA_CH0);
+    dma_struct_para_init(&dma_init_struct);
+
+    dma_init_struct.request      = DMA_REQUEST_SPI0_TX;           /* SPI0_TX请求 */
+    dma_init_struct.direction    = DMA_MEMORY_TO_PERIPHERAL;      /* 内存到外设 */
+    dma_init_struct.memory_addr  = (uint32_t)g_spi_pages[0];      /* 内存地址(启动事务时设置) */
+    dma_init_struct.memory_inc   = DMA_MEMORY_INCREASE_ENABLE;    /* 内存地址自增 */
+    dma_init_struct.memory_width = DMA_MEMORY_WIDTH_8BIT;         /* 内存数据宽度8位 */
+    dma_init_struct.number       = CAP_SPI_PAGE_SIZE;             /* 每次事务一页 */
+    dma_init_struct.periph_addr  = (uint32_t)&SPI_DATA(SPI0);     /* 外设地址 */
+    dma_init_struct.periph_inc   = DMA_PERIPH_INCREASE_DISABLE;   /* 外设地址不变 */
+    dma_init_struct.periph_width = DMA_PERIPHERAL_WIDTH_8BIT;     /* 外设数据宽度8位 */
+    dma_init_struct.priority     = DMA_PRIORITY_ULTRA_HIGH;       /* 超高优先级 */
+    dma_init(DMA_CH0, &dma_init_struct);
+
+    dma_circulation_disable(DMA_CH0);
+    dma_memory_to_memory_disable(DMA_CH0);
+    dmamux_synchronization_disable(DMAMUX_MUXCH0);
+
+    dma_deinit(DMA_CH1);
+    dma_struct_para_init(&dma_init_struct);
+
+    dma_init_struct.request      = DMA_REQUEST_SPI0_RX;           /* SPI0_RX请求 */
+    dma_init_struct.direction    = DMA_PERIPHERAL_TO_MEMORY;      /* 外设到内存 */
+    dma_init_struct.memory_addr  = (uint32_t)g_spi_rx_buf[0];     /* 内存地址(启动事务时设置) */
+    dma_init_struct.memory_inc   = DMA_MEMORY_INCREASE_ENABLE;    /* 内存地址自增 */
+    dma_init_struct.memory_width = DMA_MEMORY_WIDTH_8BIT;         /* 内存数据宽度8位 */
+    dma_init_struct.number       = CAP_SPI_PAGE_SIZE;             /* 每次事务一页 */
+    dma_init_struct.periph_addr  = (uint32_t)&SPI_DATA(SPI0);     /* 外设地址 */
+    dma_init_struct.periph_inc   = DMA_PERIPH_INCREASE_DISABLE;   /* 外设地址不变 */
+    dma_init_struct.periph_width = DMA_PERIPHERAL_WIDTH_8BIT;     /* 外设数据宽度8位 */
+    dma_init_struct.priority     = DMA_PRIORITY_ULTRA_HIGH;       /* 超高优先级 */
+    dma_init(DMA_CH1, &dma_init_struct);
+
+    dma_circulation_disable(DMA_CH1);
+    dma_memory_to_memory_disable(DMA_CH1);
+    dmamux_synchronization_disable(DMAMUX_MUXCH1);
+
+    /* 接收完成即事务结束 */
+    dma_interrupt_flag_clear(DMA_CH1, DMA_INT_FLAG_FTF);
+    dma_interrupt_enable(DMA_CH1, DMA_INT_FTF);
+    nvic_irq_enable(DMA_Channel1_IRQn, 3);
+}
+
+/**
+ * @brief 初始化SPI从机数据流
+ */
+void cap_spi_init(void)
+{
+    g_spi_fill_page   = 0;
+    g_spi_fill        = 0;
+    g_spi_ready_page  = CAP_SPI_PAGE_NONE;
+    g_spi_flight_page = CAP_SPI_PAGE_NONE;
+    g_spi_rx_index    = 0;
+    g_spi_rx_pending  = 0;
+
+    cap_spi_gpio_config();
+    cap_spi_dma_config();
+
+    rcu_periph_clock_enable(RCU_SPI0);
+    cap_spi_periph_config();
+}
+
+/**
+ * @brief 获取完成的事务数
+ */
+uint32_t cap_spi_get_transactions(void)
+{
+    return g_spi_transactions;
+}
+
+/**
+ * @brief 获取主机读取不及时而被丢弃的数据页数
+ */
+uint32_t cap_spi_get_dropped_pages(void)
+{
+    return g_spi_dropped_pages;
+}
+
+/**
+ * @brief 获取SPI复位重新对齐的次数
+ */
+uint32_t cap_spi_get_resyncs(void)
+{
+    return g_spi_resyncs;
+}
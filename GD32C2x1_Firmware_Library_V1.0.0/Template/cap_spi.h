@@ -0,0 +1,116 @@
+/**
+ * @file cap_spi.h
+ * @brief 电容触摸SPI从机数据流头文件 - GD32C2x1版本
+ * @version 1.0
+ * @date 2025-11-01
+ *
+ * 用于特性测试时以高于串口(921600波特)的速率导出原始数据: SPI0从机，
+ * 主机以固定长度的全双工事务读取数据页，同一事务中发送的数据按命令帧解析。
+ *
+ * 事务流程:
+ * 1. 数据页就绪后设备配置DMA，拉低数据就绪引脚
+ * 2. 主机检测到数据就绪后拉低NSS，传输CAP_SPI_PAGE_SIZE字节后拉高NSS
+ * 3. MISO上为数据页: 若干完整的cap_proto帧，其余字节为0
+ *    MOSI上为主机的命令帧(见cap_cmd.h)，其余字节填0，应答放在后续数据页中
+ *
+ * 主机只能在数据就绪时发起事务，且每次必须传输完整的一页。
+ * SPI传输使用DMA_CH0(发送)和DMA_CH1(接收)，与USART数据流和命令通道不能同时使用。
+ */
+
+#ifndef CAP_SPI_H_
+#define CAP_SPI_H_
+
+#include "cap_proto.h"
+#include "gd32c2x1.h"
+#include <stdint.h>
+
+/** 每次事务的传输字节数(数据页大小) */
+#define CAP_SPI_PAGE_SIZE 256
+
+/** 数据页中第一帧到发送的最大延迟(微秒) */
+#define CAP_SPI_LATENCY_US 5000
+
+/** 无数据时发送空页的间隔(微秒)，保证数据流停止时主机仍能发送命令 */
+#define CAP_SPI_HEARTBEAT_US 20000
+
+/** SPI0引脚: NSS=PA4, SCK=PA5, MISO=PA11, MOSI=PA12 (AF0) */
+#define CAP_SPI_NSS_PIN  GPIO_PIN_4
+#define CAP_SPI_SCK_PIN  GPIO_PIN_5
+#define CAP_SPI_MISO_PIN GPIO_PIN_11
+#define CAP_SPI_MOSI_PIN GPIO_PIN_12
+
+/** 数据就绪引脚(低电平有效) */
+#define CAP_SPI_DRDY_PORT GPIOA
+#define CAP_SPI_DRDY_PIN  GPIO_PIN_15
+#define CAP_SPI_DRDY_RCU  RCU_GPIOA
+
+/**
+ * @brief 初始化SPI从机数据流
+ *
+ * 配置SPI0、DMA_CH0/DMA_CH1和数据就绪引脚
+ */
+void cap_spi_init(void);
+
+/**
+ * @brief 在当前数据页中开始一个原始数据帧
+ *
+ * 在数据就绪回调中调用，返回的负载直接位于数据页中(不复制)，
+ * 填写后调用cap_spi_raw_commit()
+ *
+ * @return cap_proto_raw_t* 原始数据帧负载
+ */
+cap_proto_raw_t *cap_spi_raw_begin(void);
+
+/**
+ * @brief 完成原始数据帧(填写帧头和CRC)，数据页满时提交发送
+ */
+void cap_spi_raw_commit(void);
+
+/**
+ * @brief 把一个完整帧(例如命令应答)加入数据页
+ *
+ * 在主循环中调用，可注册为命令通道的应答发送函数
+ *
+ * @param frame 完整帧
+ * @param length 帧长度
+ */
+void cap_spi_send(const uint8_t *frame, uint16_t length);
+
+/**
+ * @brief 处理主机发送的命令，检查数据页延迟
+ *
+ * 在主循环中调用
+ */
+void cap_spi_poll(void);
+
+/**
+ * @brief DMA_CH1(SPI0接收)中断处理函数，事务结束时调用
+ *
+ * 需要在DMA_Channel1_IRQHandler中调用
+ */
+void cap_spi_dma_irq_handler(void);
+
+/**
+ * @brief 获取完成的事务数
+ *
+ * @return uint32_t 事务数
+ */
+uint32_t cap_spi_get_transactions(void);
+
+/**
+ * @brief 获取主机读取不及时而被丢弃的数据页数
+ *
+ * @return uint32_t 丢弃的数据页数
+ */
+uint32_t cap_spi_get_dropped_pages(void);
+
+/**
+ * @brief 获取SPI复位重新对齐的次数
+ *
+ * 主机传输的字节数多于一页时，下一次事务前需要复位SPI并重新启动DMA
+ *
+ * @return uint32_t 复位次数
+ */
+uint32_t cap_spi_get_resyncs(void);
+
+#endif /* CAP_SPI_H_ */
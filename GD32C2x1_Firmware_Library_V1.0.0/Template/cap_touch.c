@@ -15,8 +15,13 @@
  */
 
 #include "cap_touch.h"
+#include "cap_fast.h"
+#include "cap_prof.h"
+#include "cap_touch_comp.h"
+#include "cap_touch_proc.h"
 #include <stddef.h>
 #include <stdint.h>
+#include <string.h>
 
 /** 捕获超时时间(定时器计数值)
  * 8MHz定时器，每计数0.125us
@@ -27,6 +32,48 @@
  */
 #define CAPTURE_TIMEOUT 0x7FFF /* 2ms超时，平衡速度和稳定性 */
 
+/** 捕获定时器默认预分频值(TIMER0/TIMER2计数时钟 = 48MHz / (预分频值 + 1)) */
+#define CAP_TOUCH_TIMER_PRESCALER_DEFAULT 5
+
+/** 默认过采样(多次充放电)次数: N = 1 << CAP_TOUCH_BURST_SHIFT_DEFAULT
+ * 0 = 每帧单次捕获(原有行为)
+ * 2 = 每帧4次捕获，累加后右移1位，获得约1位额外分辨率
+ * 4 = 每帧16次捕获，累加后右移2位，获得约2位额外分辨率
+ * 每增加一次捕获，该通道在一帧内多占用一个扫描节拍(约167us)
+ */
+#define CAP_TOUCH_BURST_SHIFT_DEFAULT 0
+
+/** 自适应扫描速率默认配置
+ * CAP_SCAN_TICK_US          扫描节拍周期，与main.c中TIMER13周期一致
+ * CAP_SCAN_IDLE_FRAME_TICKS 空闲模式帧周期(节拍数)，300 * 167us ≈ 50ms，即20Hz
+ * CAP_SCAN_IDLE_PAD_MASK    空闲模式下扫描的通道掩码(bit n 对应通道n)
+ * 回到空闲模式的无候选触摸帧数见 CAP_PROC_QUIET_FRAMES_DEFAULT
+ */
+#define CAP_SCAN_TICK_US          167
+#define CAP_SCAN_IDLE_FRAME_TICKS (50000 / CAP_SCAN_TICK_US)
+#define CAP_SCAN_IDLE_PAD_MASK    CAP_TOUCH_ALL_PADS
+
+/** 接近检测(多通道并联为一个大电极)配置，滤波和判定参数见 cap_touch_proc.h
+ * CAP_PROX_PAD_MASK         参与并联充电的通道掩码，必须位于同一定时器和同一GPIO端口
+ * CAP_PROX_SLOT             接近检测在扫描序列中的位置(排在所有触摸通道之后)
+ */
+#define CAP_PROX_PAD_MASK 0x0F /* 通道0-3: TIMER0 CH0-CH3 */
+#define CAP_PROX_SLOT     CAP_TOUCH_CHANNEL_COUNT
+
+#if CAP_TOUCH_TIMING_ENABLE
+#if CAP_PROF_ENABLE
+#error "CAP_TOUCH_TIMING_ENABLE and CAP_PROF_ENABLE both use TIMER16"
+#endif
+
+/** 扫描时序统计配置
+ * CAP_TIMING_TIMER          时基定时器，预分频47，1MHz自由计数(16位，65.5ms回绕)
+ * CAP_TIMING_COARSE_US      节拍时间的间隔超过此值时改用节拍时间，避免16位计数回绕
+ */
+#define CAP_TIMING_TIMER     TIMER16
+#define CAP_TIMING_TIMER_RCU RCU_TIMER16
+#define CAP_TIMING_COARSE_US 0xC000
+#endif
+
 /**
  * @brief 触摸传感器状态枚举
  */
@@ -37,6 +84,14 @@ typedef enum {
     CAP_STATE_DONE          /*!< 完成状态 */
 } cap_touch_state_t;
 
+/**
+ * @brief 触摸通道角色枚举
+ */
+typedef enum {
+    CAP_PAD_ROLE_SENSE = 0, /*!< 普通触摸通道 */
+    CAP_PAD_ROLE_GUARD      /*!< 防水保护通道: 其增量超过阈值时屏蔽所有触摸通道 */
+} cap_pad_role_t;
+
 /**
  * @brief 触摸传感器参数结构体
  */
@@ -50,6 +105,12 @@ typedef struct {
     uint32_t                   gpio_pin;       /*!< GPIO引脚号 */
     uint32_t                   gpio_af;        /*!< GPIO复用功能 */
     IRQn_Type                  timer_irq;      /*!< 定时器IRQ编号 */
+    uint32_t                   shield_port;    /*!< 驱动屏蔽输出GPIO端口(0 = 不使用) */
+    uint32_t                   shield_pin;     /*!< 驱动屏蔽输出GPIO引脚 */
+    cap_pad_role_t             role;           /*!< 通道角色 */
+    uint8_t                    burst_shift;    /*!< 过采样次数 N = 1 << burst_shift */
+    uint8_t                    burst_count;    /*!< 本轮已完成的捕获次数 */
+    uint32_t                   burst_accum;    /*!< 本轮捕获值累加和 */
     volatile cap_touch_state_t state;          /*!< 当前状态 */
 } cap_touch_pad_t;
 
@@ -82,6 +143,14 @@ static const uint32_t g_indicator_pins[6] = {
  * Channel 3: PA3  - TIMER0_CH3  (AF2) - TOUCH_IN4
  * Channel 4: PA6  - TIMER2_CH0  (AF1) - TOUCH_IN5
  * Channel 5: PA7  - TIMER2_CH1  (AF1) - TOUCH_IN6
+ *
+ * 防水配置(可选):
+ * - .role = CAP_PAD_ROLE_GUARD 将该通道设为保护通道，其增量超过自身阈值时，
+ *   同一帧内屏蔽所有其他通道的触摸判定(水膜覆盖时保护电极同样产生大增量)
+ * - .shield_port/.shield_pin 指定驱动屏蔽输出引脚，放电时输出低电平，
+ *   开始充电时输出高电平；引脚串联与触摸上拉电阻相当的电阻后接屏蔽铜箔，
+ *   使屏蔽电压跟随触摸电极的充电波形，例如:
+ *   .shield_port = GPIOB, .shield_pin = GPIO_PIN_8
  */
 cap_touch_pad_t g_touch_pads[CAP_TOUCH_CHANNEL_COUNT] = {
     [0] = {.gpio_pin       = GPIO_PIN_0,
@@ -93,6 +162,8 @@ cap_touch_pad_t g_touch_pads[CAP_TOUCH_CHANNEL_COUNT] = {
            .timer_int_flag = TIMER_INT_FLAG_CH0,
            .timer_irq      = TIMER0_Channel_IRQn,
            .gpio_af        = GPIO_AF_5,
+           .role           = CAP_PAD_ROLE_SENSE,
+           .burst_shift    = CAP_TOUCH_BURST_SHIFT_DEFAULT,
            .state          = CAP_STATE_INIT},
     [1] = {.gpio_pin       = GPIO_PIN_1,
            .gpio_port      = GPIOA,
@@ -103,6 +174,8 @@ cap_touch_pad_t g_touch_pads[CAP_TOUCH_CHANNEL_COUNT] = {
            .timer_int_flag = TIMER_INT_FLAG_CH1,
            .timer_irq      = TIMER0_Channel_IRQn,
            .gpio_af        = GPIO_AF_5,
+           .role           = CAP_PAD_ROLE_SENSE,
+           .burst_shift    = CAP_TOUCH_BURST_SHIFT_DEFAULT,
            .state          = CAP_STATE_INIT},
     [2] = {.gpio_pin       = GPIO_PIN_2,
            .gpio_port      = GPIOA,
@@ -113,6 +186,8 @@ cap_touch_pad_t g_touch_pads[CAP_TOUCH_CHANNEL_COUNT] = {
            .timer_int_flag = TIMER_INT_FLAG_CH2,
            .timer_irq      = TIMER0_Channel_IRQn,
            .gpio_af        = GPIO_AF_5,
+           .role           = CAP_PAD_ROLE_SENSE,
+           .burst_shift    = CAP_TOUCH_BURST_SHIFT_DEFAULT,
            .state          = CAP_STATE_INIT},
     [3] = {.gpio_pin       = GPIO_PIN_3,
            .gpio_port      = GPIOA,
@@ -123,6 +198,8 @@ cap_touch_pad_t g_touch_pads[CAP_TOUCH_CHANNEL_COUNT] = {
            .timer_int_flag = TIMER_INT_FLAG_CH3,
            .timer_irq      = TIMER0_Channel_IRQn,
            .gpio_af        = GPIO_AF_5,
+           .role           = CAP_PAD_ROLE_SENSE,
+           .burst_shift    = CAP_TOUCH_BURST_SHIFT_DEFAULT,
            .state          = CAP_STATE_INIT},
     [4] = {.gpio_pin       = GPIO_PIN_6,
            .gpio_port      = GPIOA,
@@ -133,6 +210,8 @@ cap_touch_pad_t g_touch_pads[CAP_TOUCH_CHANNEL_COUNT] = {
            .timer_int_flag = TIMER_INT_FLAG_CH0,
            .timer_irq      = TIMER2_IRQn,
            .gpio_af        = GPIO_AF_1,
+           .role           = CAP_PAD_ROLE_SENSE,
+           .burst_shift    = CAP_TOUCH_BURST_SHIFT_DEFAULT,
            .state          = CAP_STATE_INIT},
     [5] = {.gpio_pin       = GPIO_PIN_7,
            .gpio_port      = GPIOA,
@@ -143,12 +222,38 @@ cap_touch_pad_t g_touch_pads[CAP_TOUCH_CHANNEL_COUNT] = {
            .timer_int_flag = TIMER_INT_FLAG_CH1,
            .timer_irq      = TIMER2_IRQn,
            .gpio_af        = GPIO_AF_1,
+           .role           = CAP_PAD_ROLE_SENSE,
+           .burst_shift    = CAP_TOUCH_BURST_SHIFT_DEFAULT,
            .state          = CAP_STATE_INIT}
 };
 
 /** 当前处理的触摸通道索引 */
 static uint8_t g_current_channel = 0;
 
+/** 数据处理(基线、触摸判定、保护通道、接近检测、扫描模式)，见 cap_touch_proc.h */
+static cap_touch_proc_t g_proc;
+
+/** 自适应扫描速率的帧定时(扫描模式由g_proc切换) */
+static volatile uint16_t g_scan_holdoff     = 0; /*!< 剩余等待节拍数 */
+static uint16_t          g_frame_ticks      = 0; /*!< 本帧已用节拍数 */
+static uint16_t          g_idle_frame_ticks = CAP_SCAN_IDLE_FRAME_TICKS;
+
+/**
+ * @brief 接近检测并联捕获状态
+ */
+typedef struct {
+    volatile cap_touch_state_t state;    /*!< 并联捕获状态 */
+    volatile uint8_t           pending;  /*!< 尚未捕获完成的通道掩码 */
+    uint32_t                   raw;      /*!< 本帧各通道捕获值之和 */
+    uint32_t                   pin_mask; /*!< 并联通道的GPIO引脚掩码 */
+} cap_touch_prox_t;
+
+/** 接近检测实例 */
+static cap_touch_prox_t g_prox = {.state = CAP_STATE_DISCHARGE};
+
+/** 接近状态变化回调函数指针 */
+static cap_touch_proximity_callback_t g_proximity_callback = NULL;
+
 /** 触摸数据实例 */
 capture_data_t g_touch_data = {.values = {0}, .timestamp = 0};
 
@@ -158,6 +263,36 @@ static cap_touch_data_ready_callback_t g_data_ready_callback = NULL;
 /** 系统时间戳(微秒) */
 static volatile uint64_t g_system_us = 0;
 
+/** 扫描节拍计数，每次调用cap_touch_process加1 */
+static uint32_t g_scan_ticks = 0;
+
+/** 运行统计: 完成的帧数和软件超时的捕获次数 */
+static cap_touch_stats_t g_touch_stats = {0};
+
+#if CAP_TOUCH_TIMING_ENABLE
+/**
+ * @brief 扫描时序统计状态
+ */
+typedef struct {
+    cap_touch_timing_t hist;         /*!< 直方图 */
+    uint16_t           finish_us;    /*!< 上一次捕获结束时间 */
+    uint16_t           scan_us;      /*!< 本帧开始时间 */
+    uint16_t           ready_us;     /*!< 上一帧数据就绪时间 */
+    uint64_t           scan_coarse;  /*!< 本帧开始的节拍时间 */
+    uint64_t           ready_coarse; /*!< 上一帧数据就绪的节拍时间 */
+    uint8_t            finish_valid; /*!< finish_us有效(同一帧内) */
+    uint8_t            scan_valid;   /*!< 本帧已开始 */
+    uint8_t            ready_valid;  /*!< 已有上一帧 */
+} cap_touch_timing_state_t;
+
+/** 扫描时序统计实例 */
+static cap_touch_timing_state_t g_timing;
+#endif
+
+/** 捕获超时时间和定时器预分频值(运行时可调) */
+static uint16_t g_capture_timeout = CAPTURE_TIMEOUT;
+static uint16_t g_timer_prescaler = CAP_TOUCH_TIMER_PRESCALER_DEFAULT;
+
 /** 定时器输入捕获参数配置(全局静态,只需初始化一次) */
 static timer_ic_parameter_struct g_timer_icinitpara = {.icpolarity  = TIMER_IC_POLARITY_RISING,
                                                        .icselection = TIMER_IC_SELECTION_DIRECTTI,
@@ -178,10 +313,22 @@ static void cap_touch_pad_start_capture(cap_touch_pad_t *touch_pad);
 static void cap_touch_pad_stop_capture(cap_touch_pad_t *touch_pad);
 static void cap_touch_scan_next(void);
 
+#if CAP_TOUCH_TIMING_ENABLE
+static void cap_touch_timing_init(void);
+static void cap_touch_timing_start(void);
+static void cap_touch_timing_finish(void);
+static void cap_touch_timing_frame(void);
+#else
+static inline void cap_touch_timing_init(void) {}
+static inline void cap_touch_timing_start(void) {}
+static inline void cap_touch_timing_finish(void) {}
+static inline void cap_touch_timing_frame(void) {}
+#endif
+
 /**
  * @brief 内联函数：结束捕获并准备下一个通道
- * @param timer_periph 定时器外设
  * @param touch_pad 当前触摸板指针
+ * @param sample 本次捕获值(超时时为捕获超时时间)
  *
  * 此函数执行以下操作：
  * 1. 检查状态防止重入
@@ -189,9 +336,10 @@ static void cap_touch_scan_next(void);
  * 3. 清除定时器所有中断标志
  * 4. 配置GPIO为输出模式（放电）
  * 5. 设置状态为DISCHARGE
- * 6. 扫描下一个通道
+ * 6. 累加捕获值，过采样未完成时保持当前通道，下一个节拍重新充电
+ * 7. 过采样完成后保存结果并扫描下一个通道
  */
-static inline void cap_touch_finish_capture(uint32_t timer_periph, cap_touch_pad_t *touch_pad)
+static inline void cap_touch_finish_capture(cap_touch_pad_t *touch_pad, uint32_t sample)
 {
     /* 防止重入：如果状态已经不是 WAIT_CAPTURE，直接返回 */
     if (touch_pad->state != CAP_STATE_WAIT_CAPTURE) { return; }
@@ -199,21 +347,49 @@ static inline void cap_touch_finish_capture(uint32_t timer_periph, cap_touch_pad
     /* 立即改变状态，防止后续重入 */
     touch_pad->state = CAP_STATE_DISCHARGE;
 
+    CAP_PROF_ENTER(CAP_PROF_FINISH_CAPTURE);
+    cap_touch_timing_finish();
+
+    /* 停止捕获并放电 */
+    cap_touch_pad_discharge(touch_pad);
+
+    /* 累加本次捕获值，过采样未完成时停留在当前通道 */
+    touch_pad->burst_accum += sample;
+    if (++touch_pad->burst_count < (1U << touch_pad->burst_shift)) {
+        CAP_PROF_EXIT(CAP_PROF_FINISH_CAPTURE);
+        return;
+    }
+
+    /* N次累加后右移log2(N)/2位: 保留过采样带来的额外分辨率，同时限制数值范围 */
+    g_touch_data.values[g_current_channel] = touch_pad->burst_accum >> (touch_pad->burst_shift >> 1);
+    touch_pad->burst_accum                 = 0;
+    touch_pad->burst_count                 = 0;
+
+    /* 扫描下一个通道 */
+    cap_touch_scan_next();
+
+    CAP_PROF_EXIT(CAP_PROF_FINISH_CAPTURE);
+}
+
+/**
+ * @brief 停止触摸板的捕获通道并切换为输出低电平(放电)
+ */
+static void cap_touch_pad_discharge(cap_touch_pad_t *touch_pad)
+{
     /* 禁用该定时器捕获中断 */
-    timer_interrupt_disable(timer_periph, touch_pad->timer_int_flag);
+    cap_timer_int_disable(touch_pad->timer, touch_pad->timer_int_flag);
 
     /* 清除该定时器中断标志 */
-    timer_interrupt_flag_clear(timer_periph, touch_pad->timer_int_flag);
+    cap_timer_int_flag_clear(touch_pad->timer, touch_pad->timer_int_flag);
 
     /* 禁用捕获通道 */
-    timer_channel_output_state_config(timer_periph, touch_pad->timer_channel, TIMER_CCX_DISABLE);
+    cap_timer_channel_state(touch_pad->timer, touch_pad->timer_channel, TIMER_CCX_DISABLE);
 
-    /* 配置GPIO为输出模式（放电） */
-    gpio_bit_write(touch_pad->gpio_port, touch_pad->gpio_pin, RESET);
-    gpio_mode_set(touch_pad->gpio_port, GPIO_MODE_OUTPUT, GPIO_PUPD_NONE, touch_pad->gpio_pin);
+    /* 配置GPIO为输出低电平（放电） */
+    cap_gpio_pins_output_low(touch_pad->gpio_port, touch_pad->gpio_pin);
 
-    /* 扫描下一个通道 */
-    cap_touch_scan_next();
+    /* 驱动屏蔽跟随放电 */
+    if (touch_pad->shield_port != 0) { cap_gpio_write(touch_pad->shield_port, touch_pad->shield_pin, RESET); }
 }
 
 /**
@@ -227,6 +403,13 @@ static void cap_touch_pad_init(cap_touch_pad_t *touch_pad)
     /* 使用最低速度，降低噪声 */
     gpio_output_options_set(touch_pad->gpio_port, GPIO_OTYPE_PP, GPIO_OSPEED_LEVEL_0, touch_pad->gpio_pin);
 
+    /* 驱动屏蔽输出初始为低电平 */
+    if (touch_pad->shield_port != 0) {
+        gpio_bit_write(touch_pad->shield_port, touch_pad->shield_pin, RESET);
+        gpio_mode_set(touch_pad->shield_port, GPIO_MODE_OUTPUT, GPIO_PUPD_NONE, touch_pad->shield_pin);
+        gpio_output_options_set(touch_pad->shield_port, GPIO_OTYPE_PP, GPIO_OSPEED_LEVEL_0, touch_pad->shield_pin);
+    }
+
     /* 进入放电状态 */
     touch_pad->state = CAP_STATE_DISCHARGE;
 }
@@ -236,40 +419,44 @@ static void cap_touch_pad_init(cap_touch_pad_t *touch_pad)
  */
 static void cap_touch_pad_start_capture(cap_touch_pad_t *touch_pad)
 {
+    cap_touch_timing_start();
+
     /* 进入等待捕获状态 */
     touch_pad->state = CAP_STATE_WAIT_CAPTURE;
     // 先设置状态，再配置定时器，因为可能中断马上就来
 
     // timer_disable(touch_pad->timer);
     /* 1. 禁用定时器输入捕获通道（配置前必须禁用） */
-    timer_channel_output_state_config(touch_pad->timer, touch_pad->timer_channel, TIMER_CCX_DISABLE);
+    cap_timer_channel_state(touch_pad->timer, touch_pad->timer_channel, TIMER_CCX_DISABLE);
 
     /* 2. 清零计数器 */
-    timer_counter_value_config(touch_pad->timer, 0);
+    cap_timer_counter_write(touch_pad->timer, 0);
 
     /* 3. 配置定时器输入捕获参数(使用全局配置) */
     timer_input_capture_config(touch_pad->timer, touch_pad->timer_channel, &g_timer_icinitpara);
 
     /* 4. 清除中断标志（清除可能残留的标志） */
-    timer_interrupt_flag_clear(touch_pad->timer, touch_pad->timer_int_flag);
+    cap_timer_int_flag_clear(touch_pad->timer, touch_pad->timer_int_flag);
     // timer_interrupt_flag_clear(touch_pad->timer, TIMER_INT_FLAG_UP);
 
     /* 5. 使能定时器中断（捕获中断 + 更新中断） */
-    timer_interrupt_enable(touch_pad->timer, touch_pad->timer_int_flag);
+    cap_timer_int_enable(touch_pad->timer, touch_pad->timer_int_flag);
     // timer_interrupt_enable(touch_pad->timer, TIMER_INT_UP);
 
     // timer_update_source_config(touch_pad->timer, TIMER_UPDATE_SRC_GLOBAL);
 
     /* 6. 使能定时器输入捕获通道（此时GPIO和定时器都已准备好）*/
-    timer_channel_output_state_config(touch_pad->timer, touch_pad->timer_channel, TIMER_CCX_ENABLE);
+    cap_timer_channel_state(touch_pad->timer, touch_pad->timer_channel, TIMER_CCX_ENABLE);
 
     // timer_enable(touch_pad->timer);
 
     /* 7. 配置GPIO为AF模式（在通道使能后立即配置GPIO）*/
     /* 注意：外部已有上拉电阻，GPIO无需内部上拉 */
-    gpio_bit_write(touch_pad->gpio_port, touch_pad->gpio_pin, RESET); /* 初始为低电平 */
-    gpio_af_set(touch_pad->gpio_port, touch_pad->gpio_af, touch_pad->gpio_pin);
-    gpio_mode_set(touch_pad->gpio_port, GPIO_MODE_AF, GPIO_PUPD_NONE, touch_pad->gpio_pin);
+    /* 放电时输出数据已清零，上下拉在初始化时配置为无 */
+    cap_gpio_pins_af(touch_pad->gpio_port, touch_pad->gpio_af, touch_pad->gpio_pin);
+
+    /* 8. 驱动屏蔽与触摸电极同时开始充电 */
+    if (touch_pad->shield_port != 0) { cap_gpio_write(touch_pad->shield_port, touch_pad->shield_pin, SET); }
 }
 
 /**
@@ -292,23 +479,181 @@ static void cap_touch_pad_stop_capture(cap_touch_pad_t *touch_pad)
     timer_counter_value_config(touch_pad->timer, 0);
 }
 
+/**
+ * @brief 接近检测：同时启动并联通道的输入捕获
+ *
+ * 各通道已在各自捕获结束时放电，此处统一清零计数器后同时切换为AF模式，
+ * 使所有电极同时开始充电，相当于一个大电极
+ */
+static void cap_touch_prox_start_capture(void)
+{
+    const cap_touch_pad_t *first = NULL;
+
+    cap_touch_timing_start();
+
+    g_prox.state   = CAP_STATE_WAIT_CAPTURE;
+    g_prox.pending = CAP_PROX_PAD_MASK;
+    g_prox.raw     = 0;
+
+    for (uint8_t i = 0; i < CAP_TOUCH_CHANNEL_COUNT; i++) {
+        cap_touch_pad_t *pad = &g_touch_pads[i];
+
+        if (!(CAP_PROX_PAD_MASK & (1U << i))) { continue; }
+        if (first == NULL) { first = pad; }
+
+        cap_timer_channel_state(pad->timer, pad->timer_channel, TIMER_CCX_DISABLE);
+        timer_input_capture_config(pad->timer, pad->timer_channel, &g_timer_icinitpara);
+        cap_timer_int_flag_clear(pad->timer, pad->timer_int_flag);
+        cap_timer_int_enable(pad->timer, pad->timer_int_flag);
+        cap_timer_channel_state(pad->timer, pad->timer_channel, TIMER_CCX_ENABLE);
+    }
+
+    /* 清零计数器后一次性切换所有引脚，保证同时开始充电 */
+    cap_timer_counter_write(first->timer, 0);
+    cap_gpio_pins_af(first->gpio_port, first->gpio_af, g_prox.pin_mask);
+
+    for (uint8_t i = 0; i < CAP_TOUCH_CHANNEL_COUNT; i++) {
+        const cap_touch_pad_t *pad = &g_touch_pads[i];
+
+        if ((CAP_PROX_PAD_MASK & (1U << i)) && pad->shield_port != 0) { cap_gpio_write(pad->shield_port, pad->shield_pin, SET); }
+    }
+}
+
+/**
+ * @brief 接近检测：记录单个并联通道的捕获值
+ * @param index 通道号
+ * @param sample 捕获值(超时时为捕获超时时间)
+ */
+static void cap_touch_prox_sample(uint8_t index, uint32_t sample)
+{
+    if (!(g_prox.pending & (1U << index))) { return; }
+
+    g_prox.pending &= (uint8_t)~(1U << index);
+    g_prox.raw += sample;
+    cap_touch_pad_discharge(&g_touch_pads[index]);
+
+    /* 所有并联通道完成后进入下一帧 */
+    if (g_prox.pending == 0 && g_prox.state == CAP_STATE_WAIT_CAPTURE) {
+        g_prox.state = CAP_STATE_DISCHARGE;
+        cap_touch_scan_next();
+    }
+}
+
+/**
+ * @brief 接近检测：定时器捕获中断处理
+ */
+static void cap_touch_prox_capture(uint32_t timer_periph, uint16_t channel)
+{
+    for (uint8_t i = 0; i < CAP_TOUCH_CHANNEL_COUNT; i++) {
+        if ((CAP_PROX_PAD_MASK & (1U << i)) && g_touch_pads[i].timer == timer_periph &&
+            g_touch_pads[i].timer_channel == channel) {
+            cap_touch_prox_sample(i, cap_timer_capture_read(timer_periph, channel));
+            return;
+        }
+    }
+}
+
+/**
+ * @brief 接近检测状态机
+ */
+static void cap_touch_process_prox(void)
+{
+    const cap_touch_pad_t *first = NULL;
+
+    if (g_prox.state == CAP_STATE_DISCHARGE) {
+        cap_touch_prox_start_capture();
+        return;
+    }
+
+    for (uint8_t i = 0; i < CAP_TOUCH_CHANNEL_COUNT && first == NULL; i++) {
+        if (CAP_PROX_PAD_MASK & (1U << i)) { first = &g_touch_pads[i]; }
+    }
+
+    /* 软件超时：先关闭剩余通道的捕获中断，再以超时值补齐 */
+    if (cap_timer_counter_read(first->timer) < g_capture_timeout) { return; }
+
+    for (uint8_t i = 0; i < CAP_TOUCH_CHANNEL_COUNT; i++) {
+        if (CAP_PROX_PAD_MASK & (1U << i)) { cap_timer_int_disable(g_touch_pads[i].timer, g_touch_pads[i].timer_int_flag); }
+    }
+    for (uint8_t i = 0; i < CAP_TOUCH_CHANNEL_COUNT; i++) {
+        if (g_prox.pending & (1U << i)) {
+            g_touch_stats.capture_timeouts++;
+            cap_touch_prox_sample(i, g_capture_timeout);
+        }
+    }
+}
+
+/**
+ * @brief 获取当前扫描模式下需要扫描的通道掩码
+ */
+static inline uint8_t cap_touch_scan_mask(void)
+{
+    return cap_touch_proc_scan_mask(&g_proc);
+}
+
+/**
+ * @brief 一帧采集完成处理
+ *
+ * 触摸判定、接近检测和扫描模式切换由 cap_touch_proc_frame() 完成(使用本帧的扫描掩码)，
+ * 接近也会唤醒全速扫描。空闲模式下补足帧周期后再开始下一帧
+ */
+static void cap_touch_frame_complete(void)
+{
+    uint32_t values[CAP_TOUCH_CHANNEL_COUNT];
+
+    /* 更新时间戳 */
+    g_touch_data.timestamp = cap_touch_get_time_us();
+    g_touch_stats.frames++;
+    cap_touch_timing_frame();
+
+    /* g_touch_data为紧凑结构体，复制到对齐的数组 */
+    memcpy(values, g_touch_data.values, sizeof(values));
+
+    if (cap_touch_proc_frame(&g_proc, values, cap_touch_scan_mask(), g_prox.raw, cap_touch_comp_get_gain(),
+                             cap_touch_comp_get_inv_gain())) {
+        /* 接近状态变化时通知上层(唤醒主机) */
+        if (g_proximity_callback != NULL) { g_proximity_callback(g_proc.prox.near ? CAP_TRUE : CAP_FALSE); }
+    }
+
+    if (g_proc.idle && g_frame_ticks < g_idle_frame_ticks) {
+        g_scan_holdoff = g_idle_frame_ticks - g_frame_ticks;
+    } else {
+        g_scan_holdoff = 0;
+    }
+    g_frame_ticks = 0;
+
+    /* 调用回调函数通知数据采集完成 */
+    if (g_data_ready_callback != NULL) {
+        CAP_PROF_ENTER(CAP_PROF_DATA_READY);
+        g_data_ready_callback(&g_touch_data);
+        CAP_PROF_EXIT(CAP_PROF_DATA_READY);
+    }
+}
+
 /**
  * @brief 扫描下一个通道
+ *
+ * 跳过当前扫描模式下未启用的通道，所有触摸通道之后是接近检测(若已使能)，
+ * 越过扫描序列末尾时完成一帧
  */
 static void cap_touch_scan_next(void)
 {
-#if 1
-    g_current_channel = (g_current_channel + 1) % CAP_TOUCH_CHANNEL_COUNT;
-
-    /* 当完成一轮6个通道的采集后 */
-    if (g_current_channel == 0) {
-        /* 更新时间戳 */
-        g_touch_data.timestamp = g_system_us;
+    g_current_channel++;
+
+    while (1) {
+        if (g_current_channel < CAP_TOUCH_CHANNEL_COUNT) {
+            if (cap_touch_scan_mask() & (1U << g_current_channel)) { break; }
+        } else if (g_current_channel == CAP_PROX_SLOT) {
+            if (g_proc.prox.enabled) { break; }
+        } else {
+            /* 当完成一轮通道的采集后 */
+            g_current_channel = 0;
+            cap_touch_frame_complete();
+            continue;
+        }
 
-        /* 调用回调函数通知数据采集完成 */
-        if (g_data_ready_callback != NULL) { g_data_ready_callback(&g_touch_data); }
+        g_current_channel++;
     }
-#endif
 }
 
 /**
@@ -321,6 +666,12 @@ void cap_touch_timer_capture_callback(uint32_t timer_periph, uint16_t channel)
 {
     uint8_t i = g_current_channel;
 
+    /* 接近检测时多个通道同时捕获 */
+    if (i == CAP_PROX_SLOT) {
+        cap_touch_prox_capture(timer_periph, channel);
+        return;
+    }
+
     /* 条件1: 检查是否是当前通道的定时器 */
     if (g_touch_pads[i].timer != timer_periph) { return; }
 
@@ -330,11 +681,8 @@ void cap_touch_timer_capture_callback(uint32_t timer_periph, uint16_t channel)
     /* 条件3: 检查状态是否为等待捕获（防止重复处理） */
     if (g_touch_pads[i].state != CAP_STATE_WAIT_CAPTURE) { return; }
 
-    /* 所有条件满足，读取并保存捕获值 */
-    g_touch_data.values[i] = timer_channel_capture_value_register_read(timer_periph, channel);
-
-    /* 结束捕获并准备下一个通道 */
-    cap_touch_finish_capture(timer_periph, &g_touch_pads[i]);
+    /* 所有条件满足，读取捕获值，结束捕获并准备下一个通道 */
+    cap_touch_finish_capture(&g_touch_pads[i], cap_timer_capture_read(timer_periph, channel));
 }
 
 /**
@@ -350,21 +698,19 @@ static cap_bool_t cap_touch_process_pad(cap_touch_pad_t *touch_pad)
     case CAP_STATE_WAIT_CAPTURE: {
         /* 软件超时检查(作为硬件中断的备份) */
         uint8_t  i       = g_current_channel;
-        uint32_t counter = timer_counter_read(touch_pad->timer);
+        uint32_t counter = cap_timer_counter_read(touch_pad->timer);
         
         /* 多重条件判断，确保超时判断准确 */
         /* 条件1: 定时器计数器达到或超过超时值 */
         /* 条件2: 当前通道指针匹配 */
         /* 条件3: 状态仍为等待捕获 */
-        if (counter >= CAPTURE_TIMEOUT && 
+        if (counter >= g_capture_timeout && 
             &g_touch_pads[i] == touch_pad && 
             touch_pad->state == CAP_STATE_WAIT_CAPTURE) {
             
-            /* 所有条件满足，设置超时值 */
-            g_touch_data.values[i] = CAPTURE_TIMEOUT;
-            
-            /* 软件超时：完成当前通道并切换到下一个 */
-            cap_touch_finish_capture(touch_pad->timer, touch_pad);
+            /* 软件超时：以超时值作为本次捕获结果，完成当前通道并切换到下一个 */
+            g_touch_stats.capture_timeouts++;
+            cap_touch_finish_capture(touch_pad, g_capture_timeout);
         }
         return CAP_FALSE;
     }
@@ -380,7 +726,22 @@ static cap_bool_t cap_touch_process_pad(cap_touch_pad_t *touch_pad)
  */
 void cap_touch_process(void)
 {
-    cap_touch_process_pad(&g_touch_pads[g_current_channel]);
+    g_scan_ticks++;
+
+    /* 空闲模式帧间等待 */
+    if (g_scan_holdoff != 0) {
+        g_scan_holdoff--;
+        return;
+    }
+
+    /* 统计本帧扫描耗用的节拍数，用于空闲模式下补足帧周期 */
+    if (g_frame_ticks < 0xFFFF) { g_frame_ticks++; }
+
+    if (g_current_channel == CAP_PROX_SLOT) {
+        cap_touch_process_prox();
+    } else {
+        cap_touch_process_pad(&g_touch_pads[g_current_channel]);
+    }
 }
 
 /**
@@ -394,7 +755,7 @@ static void timer_config(uint32_t timer_periph)
     timer_deinit(timer_periph);
 
     /* 配置定时器基本参数 */
-    timer_initpara.prescaler         = 5; /* 48MHz，每计数约0.021us */
+    timer_initpara.prescaler         = g_timer_prescaler; /* 默认5: 8MHz，每计数0.125us */
     timer_initpara.alignedmode       = TIMER_COUNTER_EDGE;
     timer_initpara.counterdirection  = TIMER_COUNTER_UP;
     timer_initpara.period            = 0xFFFF; /* 使用完整16位范围，溢出时间约1.37ms */
@@ -430,12 +791,338 @@ void cap_touch_init(void)
     nvic_irq_enable(TIMER0_Channel_IRQn, 3);
     nvic_irq_enable(TIMER2_IRQn, 3);
 
+    /* 扫描时序统计时基(未启用时为空) */
+    cap_touch_timing_init();
+
+    /* 数据处理使用默认配置，空闲模式扫描通道按本文件配置 */
+    cap_touch_proc_init(&g_proc);
+    g_proc.idle_pad_mask = CAP_SCAN_IDLE_PAD_MASK;
+
     /* 初始化第一个通道 */
     for (uint8_t i = 0; i < CAP_TOUCH_CHANNEL_COUNT; i++) {
         cap_touch_pad_init(&g_touch_pads[i]);
+
+        if (g_touch_pads[i].role == CAP_PAD_ROLE_GUARD) { g_proc.guard_mask |= (uint8_t)(1U << i); }
+        if (CAP_PROX_PAD_MASK & (1U << i)) { g_prox.pin_mask |= g_touch_pads[i].gpio_pin; }
     }
 }
 
+/**
+ * @brief 设置指定通道的过采样次数
+ */
+cap_err_t cap_touch_set_burst_shift(uint8_t channel, uint8_t burst_shift)
+{
+    if (channel >= CAP_TOUCH_CHANNEL_COUNT || burst_shift > CAP_TOUCH_BURST_SHIFT_MAX) { return CAP_ERROR; }
+
+    g_touch_pads[channel].burst_shift = burst_shift;
+
+    /* 输出量程随过采样次数变化，重新建立基线 */
+    g_proc.track[channel].baseline_ok = 0;
+    return CAP_OK;
+}
+
+/**
+ * @brief 获取指定通道的过采样次数
+ */
+uint8_t cap_touch_get_burst_shift(uint8_t channel)
+{
+    if (channel >= CAP_TOUCH_CHANNEL_COUNT) { return 0; }
+
+    return g_touch_pads[channel].burst_shift;
+}
+
+/**
+ * @brief 设置指定通道的触摸阈值
+ */
+cap_err_t cap_touch_set_threshold(uint8_t channel, uint16_t threshold)
+{
+    if (channel >= CAP_TOUCH_CHANNEL_COUNT || threshold == 0) { return CAP_ERROR; }
+
+    g_proc.track[channel].threshold = threshold;
+    return CAP_OK;
+}
+
+/**
+ * @brief 获取指定通道的触摸阈值
+ */
+uint16_t cap_touch_get_threshold(uint8_t channel)
+{
+    if (channel >= CAP_TOUCH_CHANNEL_COUNT) { return 0; }
+
+    return g_proc.track[channel].threshold;
+}
+
+/**
+ * @brief 获取指定通道的基线值
+ */
+uint32_t cap_touch_get_baseline(uint8_t channel)
+{
+    if (channel >= CAP_TOUCH_CHANNEL_COUNT) { return 0; }
+
+    return cap_touch_proc_get_baseline(&g_proc, channel, cap_touch_comp_get_gain());
+}
+
+/**
+ * @brief 获取指定通道相对基线的增量
+ */
+int32_t cap_touch_get_delta(uint8_t channel)
+{
+    if (channel >= CAP_TOUCH_CHANNEL_COUNT) { return 0; }
+
+    return g_proc.track[channel].delta;
+}
+
+/**
+ * @brief 读取当前校准数据
+ */
+void cap_touch_get_calibration(cap_touch_calib_t *calib)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    /* 基线在帧处理中更新，关中断读取同一帧的值 */
+    __disable_irq();
+    for (uint8_t i = 0; i < CAP_TOUCH_CHANNEL_COUNT; i++) {
+        calib->baseline_q[i]  = g_proc.track[i].baseline_ok ? g_proc.track[i].baseline_q : 0;
+        calib->threshold[i]   = g_proc.track[i].threshold;
+        calib->burst_shift[i] = g_touch_pads[i].burst_shift;
+    }
+    __set_PRIMASK(primask);
+
+    calib->timer_prescaler = g_timer_prescaler;
+    calib->prox_threshold  = g_proc.prox.threshold;
+    calib->ic_filter       = (uint8_t)g_timer_icinitpara.icfilter;
+    calib->reserved        = 0;
+}
+
+/**
+ * @brief 恢复校准数据
+ */
+cap_err_t cap_touch_set_calibration(const cap_touch_calib_t *calib)
+{
+    uint32_t primask;
+
+    if (calib->ic_filter > 0x0F || calib->prox_threshold == 0) { return CAP_ERROR; }
+    for (uint8_t i = 0; i < CAP_TOUCH_CHANNEL_COUNT; i++) {
+        if (calib->threshold[i] == 0 || calib->burst_shift[i] > CAP_TOUCH_BURST_SHIFT_MAX) { return CAP_ERROR; }
+    }
+
+    g_timer_prescaler = calib->timer_prescaler;
+    timer_prescaler_config(TIMER0, g_timer_prescaler, TIMER_PSC_RELOAD_NOW);
+    timer_prescaler_config(TIMER2, g_timer_prescaler, TIMER_PSC_RELOAD_NOW);
+    g_timer_icinitpara.icfilter = calib->ic_filter;
+    g_proc.prox.threshold       = calib->prox_threshold;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    for (uint8_t i = 0; i < CAP_TOUCH_CHANNEL_COUNT; i++) {
+        g_touch_pads[i].burst_shift = calib->burst_shift[i];
+        g_proc.track[i].threshold   = calib->threshold[i];
+        g_proc.track[i].baseline_q  = calib->baseline_q[i];
+        g_proc.track[i].baseline_ok = (calib->baseline_q[i] != 0) ? 1 : 0;
+    }
+    __set_PRIMASK(primask);
+
+    return CAP_OK;
+}
+
+/**
+ * @brief 获取当前触摸通道掩码
+ */
+uint8_t cap_touch_get_touch_mask(void)
+{
+    return g_proc.touch_mask;
+}
+
+/**
+ * @brief 获取保护通道屏蔽状态
+ */
+cap_bool_t cap_touch_is_guard_veto(void)
+{
+    return g_proc.guard_veto ? CAP_TRUE : CAP_FALSE;
+}
+
+/**
+ * @brief 所有通道和接近检测重新建立基线
+ */
+static void cap_touch_reset_baselines(void)
+{
+    cap_touch_proc_reset_baselines(&g_proc);
+}
+
+/**
+ * @brief 设置捕获超时时间
+ */
+cap_err_t cap_touch_set_capture_timeout(uint16_t timeout)
+{
+    if (timeout == 0 || timeout == 0xFFFF) { return CAP_ERROR; }
+
+    g_capture_timeout = timeout;
+    return CAP_OK;
+}
+
+/**
+ * @brief 获取捕获超时时间
+ */
+uint16_t cap_touch_get_capture_timeout(void)
+{
+    return g_capture_timeout;
+}
+
+/**
+ * @brief 设置捕获定时器预分频值
+ */
+cap_err_t cap_touch_set_timer_prescaler(uint16_t prescaler)
+{
+    g_timer_prescaler = prescaler;
+    timer_prescaler_config(TIMER0, prescaler, TIMER_PSC_RELOAD_NOW);
+    timer_prescaler_config(TIMER2, prescaler, TIMER_PSC_RELOAD_NOW);
+
+    /* 计数值量程改变，重新建立基线 */
+    cap_touch_reset_baselines();
+    return CAP_OK;
+}
+
+/**
+ * @brief 获取捕获定时器预分频值
+ */
+uint16_t cap_touch_get_timer_prescaler(void)
+{
+    return g_timer_prescaler;
+}
+
+/**
+ * @brief 设置输入捕获数字滤波
+ */
+cap_err_t cap_touch_set_ic_filter(uint8_t filter)
+{
+    if (filter > 0x0F) { return CAP_ERROR; }
+
+    /* 下一次启动捕获时生效 */
+    g_timer_icinitpara.icfilter = filter;
+    cap_touch_reset_baselines();
+    return CAP_OK;
+}
+
+/**
+ * @brief 获取输入捕获数字滤波
+ */
+uint8_t cap_touch_get_ic_filter(void)
+{
+    return (uint8_t)g_timer_icinitpara.icfilter;
+}
+
+/**
+ * @brief 配置自适应扫描速率
+ */
+cap_err_t cap_touch_scan_rate_config(uint16_t idle_frame_ticks, uint8_t idle_pad_mask, uint16_t quiet_frames)
+{
+    if (quiet_frames == 0) { return CAP_ERROR; }
+
+    g_idle_frame_ticks = idle_frame_ticks;
+    g_proc.idle_pad_mask    = idle_pad_mask & CAP_TOUCH_ALL_PADS;
+    g_proc.quiet_frames_max = quiet_frames;
+    return CAP_OK;
+}
+
+/**
+ * @brief 获取自适应扫描速率配置
+ */
+void cap_touch_get_scan_rate_config(uint16_t *idle_frame_ticks, uint8_t *idle_pad_mask, uint16_t *quiet_frames)
+{
+    if (idle_frame_ticks != NULL) { *idle_frame_ticks = g_idle_frame_ticks; }
+    if (idle_pad_mask != NULL) { *idle_pad_mask = g_proc.idle_pad_mask; }
+    if (quiet_frames != NULL) { *quiet_frames = g_proc.quiet_frames_max; }
+}
+
+/**
+ * @brief 使能/禁用接近检测
+ */
+void cap_touch_proximity_enable(cap_bool_t enable)
+{
+    if (enable && !g_proc.prox.enabled) { g_proc.prox.baseline_ok = 0; }
+    g_proc.prox.enabled = enable ? 1 : 0;
+}
+
+/**
+ * @brief 设置接近阈值
+ */
+cap_err_t cap_touch_set_proximity_threshold(uint16_t threshold)
+{
+    if (threshold == 0) { return CAP_ERROR; }
+
+    g_proc.prox.threshold = threshold;
+    return CAP_OK;
+}
+
+/**
+ * @brief 获取接近阈值
+ */
+uint16_t cap_touch_get_proximity_threshold(void)
+{
+    return g_proc.prox.threshold;
+}
+
+/**
+ * @brief 获取接近检测使能状态
+ */
+cap_bool_t cap_touch_is_proximity_enabled(void)
+{
+    return g_proc.prox.enabled ? CAP_TRUE : CAP_FALSE;
+}
+
+/**
+ * @brief 获取接近检测增量
+ */
+int32_t cap_touch_get_proximity_delta(void)
+{
+    return g_proc.prox.delta;
+}
+
+/**
+ * @brief 获取当前是否检测到接近
+ */
+cap_bool_t cap_touch_is_proximity(void)
+{
+    return g_proc.prox.near ? CAP_TRUE : CAP_FALSE;
+}
+
+/**
+ * @brief 注册接近状态变化回调函数
+ */
+void cap_touch_register_proximity_callback(cap_touch_proximity_callback_t callback)
+{
+    g_proximity_callback = callback;
+}
+
+/**
+ * @brief 获取当前扫描模式
+ */
+cap_scan_mode_t cap_touch_get_scan_mode(void)
+{
+    return g_proc.idle ? CAP_SCAN_IDLE : CAP_SCAN_ACTIVE;
+}
+
+/**
+ * @brief 获取空闲模式帧间剩余的等待时间
+ */
+uint32_t cap_touch_get_idle_wait_us(void)
+{
+    return (uint32_t)g_scan_holdoff * CAP_SCAN_TICK_US;
+}
+
+/**
+ * @brief 扫描节拍停止期间经过的时间: 推进时间并缩短帧间等待
+ *
+ * 不足一个节拍的部分只推进时间，帧周期按节拍补足
+ */
+void cap_touch_skip_idle_wait(uint32_t elapsed_us)
+{
+    uint32_t ticks = elapsed_us / CAP_SCAN_TICK_US;
+
+    g_system_us += elapsed_us;
+    g_scan_holdoff = (ticks < g_scan_holdoff) ? (uint16_t)(g_scan_holdoff - ticks) : 0U;
+}
+
 /**
  * @brief 注册数据采集完成回调函数
  */
@@ -453,6 +1140,160 @@ void cap_touch_systick_handler(void)
     g_system_us += 1000;
 }
 
+/**
+ * @brief 获取触摸模块时间(微秒)
+ *
+ * SysTick中断禁用后(示例程序在开始扫描前禁用)由扫描节拍推进
+ */
+uint64_t cap_touch_get_time_us(void)
+{
+    return g_system_us + (uint64_t)g_scan_ticks * CAP_SCAN_TICK_US;
+}
+
+/**
+ * @brief 获取运行统计
+ */
+void cap_touch_get_stats(cap_touch_stats_t *stats)
+{
+    *stats = g_touch_stats;
+}
+
+#if CAP_TOUCH_TIMING_ENABLE
+/**
+ * @brief 读取扫描时序时基(微秒，16位回绕)
+ */
+static inline uint16_t cap_touch_timing_now(void)
+{
+    return (uint16_t)TIMER_CNT(CAP_TIMING_TIMER);
+}
+
+/**
+ * @brief 把一个时间间隔计入直方图
+ *
+ * Cortex-M23没有CLZ指令，逐位移位求有效位数，最多17次
+ */
+static void cap_touch_timing_add(uint32_t *hist, uint32_t us)
+{
+    uint8_t bin = 0;
+
+    while (bin < CAP_TOUCH_TIMING_BINS - 1U && (us >> bin) != 0) {
+        bin++;
+    }
+    hist[bin]++;
+}
+
+/**
+ * @brief 计算从start开始的时间间隔
+ *
+ * 节拍时间的间隔较短时使用1MHz时基，否则16位计数可能已经回绕，改用节拍时间
+ */
+static uint32_t cap_touch_timing_elapsed(uint16_t start_us, uint64_t start_coarse, uint16_t now_us, uint64_t now_coarse)
+{
+    uint64_t coarse = now_coarse - start_coarse;
+
+    if (coarse >= CAP_TIMING_COARSE_US) { return (coarse > 0xFFFFFFFFU) ? 0xFFFFFFFFU : (uint32_t)coarse; }
+    return (uint16_t)(now_us - start_us);
+}
+
+/**
+ * @brief 初始化扫描时序时基: TIMER16以1MHz自由计数
+ */
+static void cap_touch_timing_init(void)
+{
+    timer_parameter_struct timer_initpara;
+
+    rcu_periph_clock_enable(CAP_TIMING_TIMER_RCU);
+    timer_deinit(CAP_TIMING_TIMER);
+
+    timer_initpara.prescaler         = 47; /* 48MHz / 48 = 1MHz，每计数1us */
+    timer_initpara.alignedmode       = TIMER_COUNTER_EDGE;
+    timer_initpara.counterdirection  = TIMER_COUNTER_UP;
+    timer_initpara.period            = 0xFFFF;
+    timer_initpara.clockdivision     = TIMER_CKDIV_DIV1;
+    timer_initpara.repetitioncounter = 0;
+    timer_init(CAP_TIMING_TIMER, &timer_initpara);
+    timer_enable(CAP_TIMING_TIMER);
+
+    memset(&g_timing, 0, sizeof(g_timing));
+}
+
+/**
+ * @brief 通道开始充电: 记录本帧开始时间和死区时间(主循环中调用)
+ */
+static void cap_touch_timing_start(void)
+{
+    uint16_t now = cap_touch_timing_now();
+
+    if (!g_timing.scan_valid) {
+        g_timing.scan_us     = now;
+        g_timing.scan_coarse = cap_touch_get_time_us();
+        g_timing.scan_valid  = 1;
+    }
+
+    /* 帧间等待(空闲模式补足帧周期)不计入死区时间 */
+    if (g_timing.finish_valid) {
+        cap_touch_timing_add(g_timing.hist.dead, (uint16_t)(now - g_timing.finish_us));
+        g_timing.finish_valid = 0;
+    }
+}
+
+/**
+ * @brief 通道捕获结束(捕获中断或主循环超时处理中调用)
+ */
+static void cap_touch_timing_finish(void)
+{
+    g_timing.finish_us    = cap_touch_timing_now();
+    g_timing.finish_valid = 1;
+}
+
+/**
+ * @brief 一帧数据就绪: 记录扫描时间和帧周期
+ */
+static void cap_touch_timing_frame(void)
+{
+    uint16_t now = cap_touch_timing_now();
+
+    if (g_timing.scan_valid) {
+        cap_touch_timing_add(g_timing.hist.scan, cap_touch_timing_elapsed(g_timing.scan_us, g_timing.scan_coarse, now,
+                                                                          g_touch_data.timestamp));
+    }
+    if (g_timing.ready_valid) {
+        cap_touch_timing_add(g_timing.hist.period, cap_touch_timing_elapsed(g_timing.ready_us, g_timing.ready_coarse,
+                                                                            now, g_touch_data.timestamp));
+    }
+
+    g_timing.ready_us     = now;
+    g_timing.ready_coarse = g_touch_data.timestamp;
+    g_timing.ready_valid  = 1;
+    g_timing.scan_valid   = 0;
+    g_timing.finish_valid = 0;
+}
+
+/**
+ * @brief 获取扫描时序直方图
+ */
+void cap_touch_get_timing(cap_touch_timing_t *timing)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    *timing = g_timing.hist;
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief 清除扫描时序直方图
+ */
+void cap_touch_reset_timing(void)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    memset(&g_timing.hist, 0, sizeof(g_timing.hist));
+    __set_PRIMASK(primask);
+}
+#endif
+
 /**
  * @brief 初始化触摸指示GPIO
  *
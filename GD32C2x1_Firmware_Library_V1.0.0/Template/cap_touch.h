@@ -15,12 +15,34 @@
 /** 触摸通道数量定义 */
 #define CAP_TOUCH_CHANNEL_COUNT 6 /* 启用6个通道 */
 
+/** 全部通道掩码 */
+#define CAP_TOUCH_ALL_PADS ((uint8_t)((1U << CAP_TOUCH_CHANNEL_COUNT) - 1U))
+
+/** 过采样次数上限: N最大为 1 << CAP_TOUCH_BURST_SHIFT_MAX */
+#define CAP_TOUCH_BURST_SHIFT_MAX 6
+
+/** 扫描时序统计使能: 1以TIMER16作为1MHz时基统计扫描时间、通道死区时间和帧周期的直方图，
+ *  0不占用TIMER16、不编译统计代码。TIMER16同时用于性能分析，不能与CAP_PROF_ENABLE同时启用 */
+#ifndef CAP_TOUCH_TIMING_ENABLE
+#define CAP_TOUCH_TIMING_ENABLE 0
+#endif
+
+/** 扫描时序直方图区间数(对数刻度，单位微秒):
+ *  区间0为0us，区间k(1-16)为[2^(k-1), 2^k)，区间17为65536us及以上 */
+#define CAP_TOUCH_TIMING_BINS 18
+
 /** 返回值定义 */
 typedef enum { CAP_OK = 0, CAP_ERROR = 1 } cap_err_t;
 
 /** 布尔类型定义 */
 typedef enum { CAP_FALSE = 0, CAP_TRUE = 1 } cap_bool_t;
 
+/** 扫描模式定义 */
+typedef enum {
+    CAP_SCAN_ACTIVE = 0, /*!< 活动模式: 每个节拍推进状态机，扫描全部通道 */
+    CAP_SCAN_IDLE   = 1  /*!< 空闲模式: 低帧率，仅扫描空闲通道掩码中的通道 */
+} cap_scan_mode_t;
+
 #pragma pack(1)
 /**
  * @brief 触摸数据结构体，包含所有通道值和时间戳
@@ -31,12 +53,51 @@ typedef struct {
 } capture_data_t;
 #pragma pack()
 
+/**
+ * @brief 运行统计
+ */
+typedef struct {
+    uint32_t frames;           /*!< 完成的帧数 */
+    uint32_t capture_timeouts; /*!< 软件超时的捕获次数(触摸通道和接近检测) */
+} cap_touch_stats_t;
+
+/**
+ * @brief 扫描时序直方图(各区间的次数)
+ */
+typedef struct {
+    uint32_t scan[CAP_TOUCH_TIMING_BINS];   /*!< 扫描时间: 一帧第一个通道开始充电到数据就绪 */
+    uint32_t dead[CAP_TOUCH_TIMING_BINS];   /*!< 死区时间: 一帧内捕获结束到下一次开始充电 */
+    uint32_t period[CAP_TOUCH_TIMING_BINS]; /*!< 帧周期: 相邻两帧数据就绪的间隔 */
+} cap_touch_timing_t;
+
+/**
+ * @brief 校准数据(保存到Flash，复位后恢复)
+ *
+ * 基线为温度/电压补偿参考条件下的值，量程由过采样次数、定时器预分频值和输入滤波决定，
+ * 这些配置与基线一起保存和恢复。接近检测的基线未经补偿，不保存
+ */
+typedef struct {
+    uint32_t baseline_q[CAP_TOUCH_CHANNEL_COUNT];  /*!< 各通道基线(Q4定点，参考条件)，0为未建立 */
+    uint16_t threshold[CAP_TOUCH_CHANNEL_COUNT];   /*!< 各通道触摸阈值 */
+    uint8_t  burst_shift[CAP_TOUCH_CHANNEL_COUNT]; /*!< 各通道过采样次数的对数 */
+    uint16_t timer_prescaler;                      /*!< 捕获定时器预分频值 */
+    uint16_t prox_threshold;                       /*!< 接近阈值 */
+    uint8_t  ic_filter;                            /*!< 输入捕获数字滤波 */
+    uint8_t  reserved;                             /*!< 保留(0) */
+} cap_touch_calib_t;
+
 /**
  * @brief 数据采集完成回调函数类型
  * @param data_packet 指向完整数据包的指针
  */
 typedef void (*cap_touch_data_ready_callback_t)(capture_data_t *data_packet);
 
+/**
+ * @brief 接近状态变化回调函数类型
+ * @param near CAP_TRUE: 检测到接近; CAP_FALSE: 接近解除
+ */
+typedef void (*cap_touch_proximity_callback_t)(cap_bool_t near);
+
 /**
  * @brief 初始化电容触摸模块
  */
@@ -78,12 +139,273 @@ capture_data_t *cap_touch_get_data_packet(void);
  */
 void cap_touch_register_data_ready_callback(cap_touch_data_ready_callback_t callback);
 
+/**
+ * @brief 设置指定通道的过采样次数
+ *
+ * @param channel 通道号(0-5)
+ * @param burst_shift 过采样次数的对数，每帧对该通道充放电 N = 1 << burst_shift 次
+ * @return cap_err_t 参数越界时返回CAP_ERROR
+ *
+ * N次捕获值累加后右移 burst_shift/2 位输出，额外分辨率约为 log2(N)/2 位；
+ * 该通道每帧耗时增加为 N 个扫描节拍。修改后的第一帧可能包含一次过渡值。
+ */
+cap_err_t cap_touch_set_burst_shift(uint8_t channel, uint8_t burst_shift);
+
+/**
+ * @brief 获取指定通道的过采样次数的对数
+ *
+ * @param channel 通道号(0-5)
+ * @return uint8_t burst_shift，通道越界时返回0
+ */
+uint8_t cap_touch_get_burst_shift(uint8_t channel);
+
+/**
+ * @brief 设置指定通道的触摸阈值
+ *
+ * @param channel 通道号(0-5)
+ * @param threshold 触摸阈值(相对基线的增量)，增量的1/2作为候选触摸阈值，3/4作为释放阈值
+ * @return cap_err_t 参数无效时返回CAP_ERROR
+ */
+cap_err_t cap_touch_set_threshold(uint8_t channel, uint16_t threshold);
+
+/**
+ * @brief 获取指定通道的触摸阈值
+ *
+ * @param channel 通道号(0-5)
+ * @return uint16_t 触摸阈值，通道越界时返回0
+ */
+uint16_t cap_touch_get_threshold(uint8_t channel);
+
+/**
+ * @brief 获取指定通道的基线值
+ *
+ * @param channel 通道号(0-5)
+ * @return uint32_t 基线值(与触摸值同量程，已按当前温度/电压补偿)
+ */
+uint32_t cap_touch_get_baseline(uint8_t channel);
+
+/**
+ * @brief 获取指定通道相对基线的增量
+ *
+ * @param channel 通道号(0-5)
+ * @return int32_t 增量，正值表示电容增大
+ */
+int32_t cap_touch_get_delta(uint8_t channel);
+
+/**
+ * @brief 读取当前校准数据
+ *
+ * @param calib 校准数据，尚未建立基线的通道baseline_q为0
+ */
+void cap_touch_get_calibration(cap_touch_calib_t *calib);
+
+/**
+ * @brief 恢复校准数据
+ *
+ * 在cap_touch_init()之后调用。基线不为0的通道从第一帧开始以恢复的基线判定触摸，
+ * 不需要重新建立基线(上电时已有手指按住的通道也能检测到)
+ *
+ * @param calib 校准数据
+ * @return cap_err_t 参数无效时返回CAP_ERROR，不做任何修改
+ */
+cap_err_t cap_touch_set_calibration(const cap_touch_calib_t *calib);
+
+/**
+ * @brief 获取当前触摸通道掩码
+ *
+ * @return uint8_t bit n 为1表示通道n处于触摸状态
+ */
+uint8_t cap_touch_get_touch_mask(void);
+
+/**
+ * @brief 获取保护通道屏蔽状态
+ *
+ * @return cap_bool_t CAP_TRUE: 保护通道(触摸板映射表中role为GUARD的通道)增量超过阈值，
+ *         本帧所有触摸通道的触摸判定被屏蔽
+ */
+cap_bool_t cap_touch_is_guard_veto(void);
+
+/**
+ * @brief 配置自适应扫描速率
+ *
+ * @param idle_frame_ticks 空闲模式帧周期(扫描节拍数，每节拍约167us)
+ * @param idle_pad_mask 空闲模式下扫描的通道掩码，为0时空闲模式仅进行接近检测
+ * @param quiet_frames 活动模式下连续无候选触摸多少帧后进入空闲模式
+ * @return cap_err_t 参数无效时返回CAP_ERROR
+ *
+ * 空闲模式下任一扫描通道的增量超过候选阈值，下一帧立即以最高速率扫描全部通道
+ */
+cap_err_t cap_touch_scan_rate_config(uint16_t idle_frame_ticks, uint8_t idle_pad_mask, uint16_t quiet_frames);
+
+/**
+ * @brief 获取自适应扫描速率配置
+ *
+ * @param idle_frame_ticks 空闲模式帧周期，可为NULL
+ * @param idle_pad_mask 空闲模式扫描通道掩码，可为NULL
+ * @param quiet_frames 进入空闲模式的连续无候选触摸帧数，可为NULL
+ */
+void cap_touch_get_scan_rate_config(uint16_t *idle_frame_ticks, uint8_t *idle_pad_mask, uint16_t *quiet_frames);
+
+/**
+ * @brief 设置捕获超时时间
+ *
+ * @param timeout 超时时间(捕获定时器计数值，1-0xFFFE)
+ * @return cap_err_t 参数无效时返回CAP_ERROR
+ */
+cap_err_t cap_touch_set_capture_timeout(uint16_t timeout);
+
+/**
+ * @brief 获取捕获超时时间
+ *
+ * @return uint16_t 超时时间(捕获定时器计数值)
+ */
+uint16_t cap_touch_get_capture_timeout(void);
+
+/**
+ * @brief 设置捕获定时器预分频值
+ *
+ * @param prescaler TIMER0/TIMER2预分频值，计数时钟 = 48MHz / (prescaler + 1)
+ * @return cap_err_t 设置结果
+ *
+ * 计数值量程随之改变，所有通道重新建立基线，捕获超时时间需相应调整
+ */
+cap_err_t cap_touch_set_timer_prescaler(uint16_t prescaler);
+
+/**
+ * @brief 获取捕获定时器预分频值
+ *
+ * @return uint16_t 预分频值
+ */
+uint16_t cap_touch_get_timer_prescaler(void);
+
+/**
+ * @brief 设置输入捕获数字滤波
+ *
+ * @param filter 滤波参数(0x00-0x0F)，下一次捕获生效，所有通道重新建立基线
+ * @return cap_err_t 参数越界时返回CAP_ERROR
+ */
+cap_err_t cap_touch_set_ic_filter(uint8_t filter);
+
+/**
+ * @brief 获取输入捕获数字滤波
+ *
+ * @return uint8_t 滤波参数
+ */
+uint8_t cap_touch_get_ic_filter(void);
+
+/**
+ * @brief 使能/禁用接近检测
+ *
+ * @param enable CAP_TRUE: 每帧末尾将通道0-3并联充电一次，测量其捕获值之和
+ *
+ * 接近检测使用更强的滤波和更慢的基线跟踪，检测到接近时立即切换到全速扫描，
+ * 并通过接近回调通知上层(例如唤醒主机)
+ */
+void cap_touch_proximity_enable(cap_bool_t enable);
+
+/**
+ * @brief 设置接近阈值
+ *
+ * @param threshold 接近阈值(滤波后和值相对基线的增量)，释放阈值为其3/4
+ * @return cap_err_t 阈值为0时返回CAP_ERROR
+ */
+cap_err_t cap_touch_set_proximity_threshold(uint16_t threshold);
+
+/**
+ * @brief 获取接近阈值
+ *
+ * @return uint16_t 接近阈值
+ */
+uint16_t cap_touch_get_proximity_threshold(void);
+
+/**
+ * @brief 获取接近检测使能状态
+ *
+ * @return cap_bool_t CAP_TRUE: 已使能
+ */
+cap_bool_t cap_touch_is_proximity_enabled(void);
+
+/**
+ * @brief 获取接近检测增量
+ *
+ * @return int32_t 滤波后和值相对接近基线的增量
+ */
+int32_t cap_touch_get_proximity_delta(void);
+
+/**
+ * @brief 获取当前是否检测到接近
+ *
+ * @return cap_bool_t CAP_TRUE: 检测到接近
+ */
+cap_bool_t cap_touch_is_proximity(void);
+
+/**
+ * @brief 注册接近状态变化回调函数
+ *
+ * @param callback 回调函数指针，接近状态变化时在帧处理中调用
+ */
+void cap_touch_register_proximity_callback(cap_touch_proximity_callback_t callback);
+
+/**
+ * @brief 获取当前扫描模式
+ *
+ * @return cap_scan_mode_t 当前扫描模式
+ */
+cap_scan_mode_t cap_touch_get_scan_mode(void);
+
+/**
+ * @brief 获取空闲模式帧间剩余的等待时间
+ *
+ * @return uint32_t 等待时间(微秒)，正在扫描一帧或全速扫描时为0
+ */
+uint32_t cap_touch_get_idle_wait_us(void);
+
+/**
+ * @brief 扫描节拍停止期间(深度睡眠)经过的时间: 推进时间并缩短帧间等待
+ *
+ * @param elapsed_us 经过的时间(微秒)，不应超过cap_touch_get_idle_wait_us()
+ */
+void cap_touch_skip_idle_wait(uint32_t elapsed_us);
+
 /**
  * @brief SysTick中断处理函数 - 用于时间戳
  * 应在systick中断中每1ms调用一次
  */
 void cap_touch_systick_handler(void);
 
+/**
+ * @brief 获取触摸模块时间
+ *
+ * @return uint64_t 时间(微秒)，SysTick毫秒计时加上扫描节拍计时，与capture_data_t.timestamp同一时基
+ */
+uint64_t cap_touch_get_time_us(void);
+
+/**
+ * @brief 获取运行统计
+ *
+ * 捕获超时通常表示通道开路或电极电容过大，可用于判断传感器连接状态
+ *
+ * @param stats 返回的统计值
+ */
+void cap_touch_get_stats(cap_touch_stats_t *stats);
+
+#if CAP_TOUCH_TIMING_ENABLE
+/**
+ * @brief 获取扫描时序直方图
+ *
+ * 下一次充电在主循环的扫描节拍中开始，死区时间接近一个节拍(167us)说明报告率受轮询TIMER13限制；
+ * 扫描时间和帧周期分散到更高的区间说明捕获中断被其他中断推迟
+ *
+ * @param timing 返回的直方图
+ */
+void cap_touch_get_timing(cap_touch_timing_t *timing);
+
+/**
+ * @brief 清除扫描时序直方图
+ */
+void cap_touch_reset_timing(void);
+#endif
+
 /**
  * @brief 初始化触摸指示GPIO (PB0-PB5)
  *
@@ -0,0 +1,252 @@
+/**
+ * @file cap_touch_comp.c
+ * @brief 电容触摸温度/电源电压补偿模块实现 - GD32C2x1版本
+ * @version 1.0
+ * @date 2025-11-01
+ *
+ * 充电时间随电源电压和温度漂移(上拉电阻、输入阈值、引脚电容都有温漂)。
+ * 本模块以低占空比采样内部温度传感器和VREFINT，按线性模型计算补偿增益:
+ *
+ *   gain = 1 + kT * (T - T0) + kV * (VDD - VDD0)
+ *
+ * 参考条件(T0, VDD0)取启动后的第一次采样。触摸模块的基线以参考条件保存，
+ * 比较时乘以gain折算到当前条件，阈值因此无需为温漂预留余量。
+ *
+ * 采样流程:
+ * 1. TIMER15 CH0以 CAP_COMP_SAMPLE_HZ 产生比较事件，触发ADC插入组
+ * 2. 插入组依次转换温度传感器(通道13)和VREFINT(通道14)
+ * 3. ADC中断中滤波并更新增益，不占用扫描时间
+ */
+
+#include "cap_touch_comp.h"
+#include "systick.h"
+
+/** 采样频率(Hz)，TIMER15计数时钟为1kHz */
+#define CAP_COMP_SAMPLE_HZ 10
+
+/** 转换值IIR滤波强度 1/(1 << n) */
+#define CAP_COMP_FILTER_SHIFT 2
+
+/** 转换值滤波结果的定点位数 */
+#define CAP_COMP_RAW_FRAC_BITS 4
+
+/** ADC满量程 */
+#define CAP_COMP_ADC_FULL_SCALE 4095
+
+/** VREFINT典型电压(mV) */
+#define CAP_COMP_VREFINT_MV 1200
+
+/** 温度传感器参数(与Examples/ADC/ADC_temperature_Vref一致)
+ * 25°C时输出0.924V，斜率-2.52mV/°C
+ */
+#define CAP_COMP_TEMP_V25_MV      924
+#define CAP_COMP_TEMP_SLOPE_UV_C  2520
+
+/** 默认补偿系数(典型值，需按实际硬件标定)
+ * CAP_COMP_TEMP_PPM_PER_C    每升高1°C充电时间的相对变化
+ * CAP_COMP_VDD_PPM_PER_100MV 每升高100mV充电时间的相对变化
+ */
+#define CAP_COMP_TEMP_PPM_PER_C    800
+#define CAP_COMP_VDD_PPM_PER_100MV (-3000)
+
+/**
+ * @brief 补偿模块状态
+ */
+typedef struct {
+    uint32_t temp_q;            /*!< 温度传感器转换值(滤波后，Q4) */
+    uint32_t vref_q;            /*!< VREFINT转换值(滤波后，Q4) */
+    int16_t  temp_x10;          /*!< 当前温度(0.1°C) */
+    uint16_t vdd_mv;            /*!< 当前VDD(mV) */
+    int16_t  temp0_x10;         /*!< 参考温度(0.1°C) */
+    uint16_t vdd0_mv;           /*!< 参考VDD(mV) */
+    uint8_t  ref_ok;            /*!< 参考条件是否已建立 */
+    int32_t  temp_ppm;          /*!< 温度系数(ppm/°C) */
+    int32_t  vdd_ppm;           /*!< 电压系数(ppm/100mV) */
+    volatile uint32_t gain;     /*!< 补偿增益(Q16) */
+    volatile uint32_t inv_gain; /*!< 补偿增益倒数(Q16) */
+} cap_touch_comp_t;
+
+/** 补偿模块实例 */
+static cap_touch_comp_t g_comp = {.temp_ppm = CAP_COMP_TEMP_PPM_PER_C,
+                                  .vdd_ppm  = CAP_COMP_VDD_PPM_PER_100MV,
+                                  .gain     = CAP_COMP_GAIN_ONE,
+                                  .inv_gain = CAP_COMP_GAIN_ONE};
+
+/**
+ * @brief 根据当前温度和电压计算补偿增益
+ */
+static void cap_touch_comp_update_gain(void)
+{
+    int64_t ppm;
+    int64_t gain;
+
+    /* ppm * 10: 温度以0.1°C为单位，电压以mV为单位(系数为每100mV) */
+    ppm = (int64_t)g_comp.temp_ppm * (g_comp.temp_x10 - g_comp.temp0_x10) +
+          (int64_t)g_comp.vdd_ppm * ((int32_t)g_comp.vdd_mv - (int32_t)g_comp.vdd0_mv) / 10;
+
+    gain = (int64_t)CAP_COMP_GAIN_ONE + (ppm * (int64_t)CAP_COMP_GAIN_ONE) / 10000000;
+
+    /* 限制在0.5-2.0之间，防止异常采样造成误判 */
+    if (gain < (int64_t)(CAP_COMP_GAIN_ONE >> 1)) { gain = CAP_COMP_GAIN_ONE >> 1; }
+    if (gain > (int64_t)(CAP_COMP_GAIN_ONE << 1)) { gain = CAP_COMP_GAIN_ONE << 1; }
+
+    g_comp.gain     = (uint32_t)gain;
+    g_comp.inv_gain = (uint32_t)(((uint64_t)1U << (2 * CAP_COMP_GAIN_FRAC_BITS)) / (uint64_t)gain);
+}
+
+/**
+ * @brief ADC插入组转换完成回调函数
+ */
+void cap_touch_comp_adc_callback(uint16_t temp_raw, uint16_t vref_raw)
+{
+    uint32_t temp_q = (uint32_t)temp_raw << CAP_COMP_RAW_FRAC_BITS;
+    uint32_t vref_q = (uint32_t)vref_raw << CAP_COMP_RAW_FRAC_BITS;
+    int32_t  vt_mv;
+
+    if (vref_raw == 0) { return; }
+
+    /* 第一次采样直接作为滤波初值 */
+    if (!g_comp.ref_ok) {
+        g_comp.temp_q = temp_q;
+        g_comp.vref_q = vref_q;
+    }
+
+    g_comp.temp_q = (uint32_t)((int32_t)g_comp.temp_q + (((int32_t)temp_q - (int32_t)g_comp.temp_q) >> CAP_COMP_FILTER_SHIFT));
+    g_comp.vref_q = (uint32_t)((int32_t)g_comp.vref_q + (((int32_t)vref_q - (int32_t)g_comp.vref_q) >> CAP_COMP_FILTER_SHIFT));
+
+    /* VDD = VREFINT * 满量程 / VREFINT转换值 */
+    g_comp.vdd_mv = (uint16_t)((CAP_COMP_VREFINT_MV * CAP_COMP_ADC_FULL_SCALE * (1U << CAP_COMP_RAW_FRAC_BITS)) / g_comp.vref_q);
+
+    /* 温度传感器电压 = 转换值 * VDD / 满量程 */
+    vt_mv = (int32_t)((g_comp.temp_q * g_comp.vdd_mv) / (CAP_COMP_ADC_FULL_SCALE * (1U << CAP_COMP_RAW_FRAC_BITS)));
+    g_comp.temp_x10 = (int16_t)(250 + ((CAP_COMP_TEMP_V25_MV - vt_mv) * 10000) / CAP_COMP_TEMP_SLOPE_UV_C);
+
+    /* 第一次采样作为参考条件 */
+    if (!g_comp.ref_ok) {
+        g_comp.temp0_x10 = g_comp.temp_x10;
+        g_comp.vdd0_mv   = g_comp.vdd_mv;
+        g_comp.ref_ok    = 1;
+    }
+
+    cap_touch_comp_update_gain();
+}
+
+/**
+ * @brief 配置ADC插入组: 温度传感器 + VREFINT，TIMER15 CH0触发
+ */
+static void cap_touch_comp_adc_config(void)
+{
+    rcu_periph_clock_enable(RCU_ADC);
+    rcu_adc_clock_config(RCU_ADCSRC_CKSYS, RCU_ADCCK_DIV10);
+
+    adc_special_function_config(ADC_CONTINUOUS_MODE, DISABLE);
+    adc_special_function_config(ADC_SCAN_MODE, ENABLE);
+    adc_data_alignment_config(ADC_DATAALIGN_RIGHT);
+    adc_channel_length_config(ADC_INSERTED_CHANNEL, 2);
+
+    /* 内部通道输出阻抗高，使用最长采样时间 */
+    adc_inserted_channel_config(0U, ADC_CHANNEL_13, ADC_SAMPLETIME_160POINT5);
+    adc_inserted_channel_config(1U, ADC_CHANNEL_14, ADC_SAMPLETIME_160POINT5);
+
+    adc_external_trigger_source_config(ADC_INSERTED_CHANNEL, ADC_EXTTRIG_INSERTED_T15_CH0);
+    adc_external_trigger_config(ADC_INSERTED_CHANNEL, ENABLE);
+
+    adc_internal_channel_config(ADC_CHANNEL_INTERNAL_TEMPSENSOR, ENABLE);
+    adc_internal_channel_config(ADC_CHANNEL_INTERNAL_VREFINT, ENABLE);
+
+    adc_interrupt_flag_clear(ADC_INT_FLAG_EOC);
+    adc_interrupt_flag_clear(ADC_INT_FLAG_EOIC);
+    adc_interrupt_enable(ADC_INT_EOIC);
+
+    adc_enable();
+    delay_1ms(1U);
+}
+
+/**
+ * @brief 配置TIMER15: 1kHz计数，CH0每 1000/CAP_COMP_SAMPLE_HZ ms 产生一次比较事件
+ */
+static void cap_touch_comp_timer_config(void)
+{
+    timer_parameter_struct    timer_initpara;
+    timer_oc_parameter_struct timer_ocinitpara;
+    uint32_t                  period = 1000U / CAP_COMP_SAMPLE_HZ;
+
+    rcu_periph_clock_enable(RCU_TIMER15);
+    timer_deinit(TIMER15);
+
+    timer_initpara.prescaler         = 47999; /* 48MHz / 48000 = 1kHz */
+    timer_initpara.alignedmode       = TIMER_COUNTER_EDGE;
+    timer_initpara.counterdirection  = TIMER_COUNTER_UP;
+    timer_initpara.period            = period - 1U;
+    timer_initpara.clockdivision     = TIMER_CKDIV_DIV1;
+    timer_initpara.repetitioncounter = 0;
+    timer_init(TIMER15, &timer_initpara);
+
+    /* CH0 PWM模式仅用于产生ADC触发事件，引脚不复用到TIMER15，不对外输出 */
+    timer_channel_output_struct_para_init(&timer_ocinitpara);
+    timer_ocinitpara.outputstate = TIMER_CCX_ENABLE;
+    timer_channel_output_config(TIMER15, TIMER_CH_0, &timer_ocinitpara);
+    timer_channel_output_pulse_value_config(TIMER15, TIMER_CH_0, period / 2U);
+    timer_channel_output_mode_config(TIMER15, TIMER_CH_0, TIMER_OC_MODE_PWM0);
+    timer_channel_output_shadow_config(TIMER15, TIMER_CH_0, TIMER_OC_SHADOW_DISABLE);
+    timer_primary_output_config(TIMER15, ENABLE);
+
+    timer_enable(TIMER15);
+}
+
+/**
+ * @brief 初始化温度/电源电压补偿
+ */
+void cap_touch_comp_init(void)
+{
+    g_comp.ref_ok   = 0;
+    g_comp.gain     = CAP_COMP_GAIN_ONE;
+    g_comp.inv_gain = CAP_COMP_GAIN_ONE;
+
+    cap_touch_comp_adc_config();
+    nvic_irq_enable(ADC_IRQn, 3);
+    cap_touch_comp_timer_config();
+}
+
+/**
+ * @brief 设置补偿系数
+ */
+void cap_touch_comp_set_coeff(int32_t temp_ppm_per_c, int32_t vdd_ppm_per_100mv)
+{
+    g_comp.temp_ppm = temp_ppm_per_c;
+    g_comp.vdd_ppm  = vdd_ppm_per_100mv;
+
+    if (g_comp.ref_ok) { cap_touch_comp_update_gain(); }
+}
+
+/**
+ * @brief 获取当前补偿增益
+ */
+uint32_t cap_touch_comp_get_gain(void)
+{
+    return g_comp.gain;
+}
+
+/**
+ * @brief 获取当前补偿增益的倒数
+ */
+uint32_t cap_touch_comp_get_inv_gain(void)
+{
+    return g_comp.inv_gain;
+}
+
+/**
+ * @brief 获取芯片温度
+ */
+int16_t cap_touch_comp_get_temperature(void)
+{
+    return g_comp.temp_x10;
+}
+
+/**
+ * @brief 获取电源电压
+ */
+uint16_t cap_touch_comp_get_vdd(void)
+{
+    return g_comp.vdd_mv;
+}
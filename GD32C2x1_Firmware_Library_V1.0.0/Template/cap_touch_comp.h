@@ -0,0 +1,72 @@
+/**
+ * @file cap_touch_comp.h
+ * @brief 电容触摸温度/电源电压补偿模块头文件 - GD32C2x1版本
+ * @version 1.0
+ * @date 2025-11-01
+ */
+
+#ifndef CAP_TOUCH_COMP_H_
+#define CAP_TOUCH_COMP_H_
+
+#include "gd32c2x1.h"
+#include <stdint.h>
+
+/** 补偿增益的定点位数: 增益 1.0 = 1 << CAP_COMP_GAIN_FRAC_BITS */
+#define CAP_COMP_GAIN_FRAC_BITS 16
+#define CAP_COMP_GAIN_ONE       ((uint32_t)1U << CAP_COMP_GAIN_FRAC_BITS)
+
+/**
+ * @brief 初始化温度/电源电压补偿
+ *
+ * 配置ADC插入组转换内部温度传感器和VREFINT，由TIMER15 CH0以低频率触发，
+ * 转换完成后在ADC中断中更新补偿增益。需在SysTick中断禁用之前调用(内部使用delay_1ms)
+ */
+void cap_touch_comp_init(void);
+
+/**
+ * @brief ADC插入组转换完成回调函数
+ *
+ * @param temp_raw 温度传感器转换值(插入通道0)
+ * @param vref_raw VREFINT转换值(插入通道1)
+ *
+ * 需要在ADC中断处理函数中调用
+ */
+void cap_touch_comp_adc_callback(uint16_t temp_raw, uint16_t vref_raw);
+
+/**
+ * @brief 设置补偿系数
+ *
+ * @param temp_ppm_per_c 充电时间温度系数(ppm/°C)
+ * @param vdd_ppm_per_100mv 充电时间电源电压系数(ppm/100mV)
+ */
+void cap_touch_comp_set_coeff(int32_t temp_ppm_per_c, int32_t vdd_ppm_per_100mv);
+
+/**
+ * @brief 获取当前补偿增益
+ *
+ * @return uint32_t 当前条件下的计数值相对参考条件的比例(Q16)，未采样时为1.0
+ */
+uint32_t cap_touch_comp_get_gain(void);
+
+/**
+ * @brief 获取当前补偿增益的倒数
+ *
+ * @return uint32_t 1/增益(Q16)，用于把当前计数值折算到参考条件
+ */
+uint32_t cap_touch_comp_get_inv_gain(void);
+
+/**
+ * @brief 获取芯片温度
+ *
+ * @return int16_t 温度(0.1°C)
+ */
+int16_t cap_touch_comp_get_temperature(void);
+
+/**
+ * @brief 获取电源电压
+ *
+ * @return uint16_t VDD(mV)，未采样时为0
+ */
+uint16_t cap_touch_comp_get_vdd(void);
+
+#endif /* CAP_TOUCH_COMP_H_ */
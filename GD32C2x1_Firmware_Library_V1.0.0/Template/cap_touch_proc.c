@@ -0,0 +1,189 @@
+/**
+ * @file cap_touch_proc.c
+ * @brief 电容触摸数据处理 - 可移植部分实现
+ * @version 1.0
+ * @date 2025-11-01
+ */
+
+#include "cap_touch_proc.h"
+#include <string.h>
+
+/**
+ * @brief 以默认配置初始化
+ */
+void cap_touch_proc_init(cap_touch_proc_t *proc)
+{
+    memset(proc, 0, sizeof(*proc));
+
+    for (uint8_t i = 0; i < CAP_PROC_CHANNELS; i++) {
+        proc->track[i].threshold = CAP_PROC_THRESHOLD_DEFAULT;
+    }
+
+    proc->prox.threshold  = CAP_PROC_PROX_THRESHOLD_DEFAULT;
+    proc->baseline_shift   = CAP_PROC_BASELINE_SHIFT_DEFAULT;
+    proc->idle_pad_mask    = CAP_PROC_ALL_PADS;
+    proc->quiet_frames_max = CAP_PROC_QUIET_FRAMES_DEFAULT;
+}
+
+/**
+ * @brief 获取当前扫描模式下需要扫描的通道掩码
+ */
+uint8_t cap_touch_proc_scan_mask(const cap_touch_proc_t *proc)
+{
+    if (!proc->idle) { return CAP_PROC_ALL_PADS; }
+    if (proc->idle_pad_mask == 0 && !proc->prox.enabled) { return CAP_PROC_ALL_PADS; }
+    return proc->idle_pad_mask;
+}
+
+/**
+ * @brief 触摸判定：更新基线、增量和触摸状态
+ * @return uint8_t 是否有通道增量超过候选阈值
+ *
+ * 基线乘以温度/电压补偿增益后再与当前值比较，基线跟踪时当前值先折算到参考条件。
+ * 先计算所有通道的增量并判定保护通道，再在同一遍处理中完成触摸判定，
+ * 保护通道触发时本帧即屏蔽所有触摸通道，不增加延迟。
+ * 处于候选/触摸状态或被屏蔽的通道冻结基线，避免手指或水膜被基线吸收
+ */
+static uint8_t cap_touch_proc_detect(cap_touch_proc_t *proc, const uint32_t *values, uint8_t mask, uint32_t gain,
+                                     uint32_t inv_gain)
+{
+    uint8_t candidate = 0;
+    uint8_t touch     = proc->touch_mask;
+    uint8_t veto      = 0;
+
+    for (uint8_t i = 0; i < CAP_PROC_CHANNELS; i++) {
+        cap_proc_track_t *t = &proc->track[i];
+        uint32_t          v = values[i];
+
+        if (!(mask & (1U << i))) { continue; }
+
+        if (!t->baseline_ok) {
+            t->baseline_q  = cap_touch_proc_gain_apply(v << CAP_PROC_BASELINE_FRAC_BITS, inv_gain);
+            t->baseline_ok = 1;
+        }
+
+        t->delta = (int32_t)v - (int32_t)(cap_touch_proc_gain_apply(t->baseline_q, gain) >> CAP_PROC_BASELINE_FRAC_BITS);
+
+        if ((proc->guard_mask & (1U << i)) && t->delta >= (int32_t)t->threshold) { veto = 1; }
+    }
+
+    for (uint8_t i = 0; i < CAP_PROC_CHANNELS; i++) {
+        cap_proc_track_t *t = &proc->track[i];
+        uint32_t          v = values[i];
+
+        if (!(mask & (1U << i))) { continue; }
+
+        /* 触摸判定(带迟滞)，保护通道本身不产生触摸 */
+        if (veto || (proc->guard_mask & (1U << i))) {
+            t->touched = 0;
+        } else if (t->delta >= (int32_t)t->threshold) {
+            t->touched = 1;
+        } else if (t->delta < (int32_t)(t->threshold - (t->threshold >> 2))) {
+            t->touched = 0;
+        }
+
+        if (t->touched) {
+            touch |= (uint8_t)(1U << i);
+        } else {
+            touch &= (uint8_t)~(1U << i);
+        }
+
+        if (t->delta >= (int32_t)(t->threshold >> 1)) {
+            candidate = 1;
+        } else if (!veto) {
+            /* 无候选触摸时基线缓慢跟随(折算到参考条件) */
+            int32_t diff = (int32_t)cap_touch_proc_gain_apply(v << CAP_PROC_BASELINE_FRAC_BITS, inv_gain) - (int32_t)t->baseline_q;
+            t->baseline_q = (uint32_t)((int32_t)t->baseline_q + (diff >> proc->baseline_shift));
+        }
+    }
+
+    proc->guard_veto = veto;
+    proc->touch_mask = touch;
+    return candidate;
+}
+
+/**
+ * @brief 接近检测：滤波、基线跟踪和接近判定
+ * @return uint8_t 当前是否检测到接近
+ *
+ * 接近期间冻结基线
+ */
+static uint8_t cap_touch_proc_prox(cap_proc_prox_t *prox, uint32_t raw)
+{
+    uint32_t raw_q = raw << CAP_PROC_BASELINE_FRAC_BITS;
+    uint8_t  near  = prox->near;
+
+    if (!prox->baseline_ok) {
+        prox->filtered_q  = raw_q;
+        prox->baseline_q  = raw_q;
+        prox->baseline_ok = 1;
+    }
+
+    prox->filtered_q = (uint32_t)((int32_t)prox->filtered_q + (((int32_t)raw_q - (int32_t)prox->filtered_q) >> CAP_PROC_PROX_FILTER_SHIFT));
+    prox->delta      = ((int32_t)prox->filtered_q - (int32_t)prox->baseline_q) >> CAP_PROC_BASELINE_FRAC_BITS;
+
+    if (prox->delta >= (int32_t)prox->threshold) {
+        near = 1;
+    } else if (prox->delta < (int32_t)(prox->threshold - (prox->threshold >> 2))) {
+        near = 0;
+    }
+
+    if (!near) {
+        int32_t diff = (int32_t)prox->filtered_q - (int32_t)prox->baseline_q;
+        prox->baseline_q = (uint32_t)((int32_t)prox->baseline_q + (diff >> CAP_PROC_PROX_BASELINE_SHIFT));
+    }
+
+    return near;
+}
+
+/**
+ * @brief 处理一帧: 触摸判定、接近检测和扫描模式切换
+ *
+ * 空闲模式下检测到候选触摸或接近立即切换到活动模式，下一帧即扫描全部通道；
+ * 活动模式下连续 quiet_frames_max 帧无候选触摸后回到空闲模式
+ */
+uint8_t cap_touch_proc_frame(cap_touch_proc_t *proc, const uint32_t *values, uint8_t mask, uint32_t prox_raw,
+                             uint32_t gain, uint32_t inv_gain)
+{
+    uint8_t candidate = cap_touch_proc_detect(proc, values, mask, gain, inv_gain);
+    uint8_t changed   = 0;
+
+    if (proc->prox.enabled) {
+        uint8_t near = cap_touch_proc_prox(&proc->prox, prox_raw);
+
+        changed         = (uint8_t)(near != proc->prox.near);
+        proc->prox.near = near;
+        if (near) { candidate = 1; }
+    }
+
+    if (candidate) {
+        proc->idle         = 0;
+        proc->quiet_frames = 0;
+    } else if (!proc->idle && ++proc->quiet_frames >= proc->quiet_frames_max) {
+        proc->idle         = 1;
+        proc->quiet_frames = 0;
+    }
+
+    return changed;
+}
+
+/**
+ * @brief 所有通道和接近检测重新建立基线
+ */
+void cap_touch_proc_reset_baselines(cap_touch_proc_t *proc)
+{
+    for (uint8_t i = 0; i < CAP_PROC_CHANNELS; i++) {
+        proc->track[i].baseline_ok = 0;
+    }
+    proc->prox.baseline_ok = 0;
+}
+
+/**
+ * @brief 获取指定通道的基线值(折算到当前条件)
+ */
+uint32_t cap_touch_proc_get_baseline(const cap_touch_proc_t *proc, uint8_t channel, uint32_t gain)
+{
+    if (channel >= CAP_PROC_CHANNELS) { return 0; }
+
+    return cap_touch_proc_gain_apply(proc->track[channel].baseline_q, gain) >> CAP_PROC_BASELINE_FRAC_BITS;
+}
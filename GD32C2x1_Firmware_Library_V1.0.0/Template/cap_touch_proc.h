@@ -0,0 +1,154 @@
+/**
+ * @file cap_touch_proc.h
+ * @brief 电容触摸数据处理(基线、触摸判定、保护通道、接近检测、扫描速率) - 可移植部分
+ * @version 1.0
+ * @date 2025-11-01
+ *
+ * 本文件只依赖stdint，不访问外设: 输入为一帧各通道的捕获值(过采样后)，输出为
+ * 触摸掩码、保护通道屏蔽、接近状态和扫描模式。固件(cap_touch.c)和上位机回放工具
+ * (host/cap_replay.cpp)使用同一份代码，回放记录的原始数据即可得到与设备相同的判定结果。
+ */
+
+#ifndef CAP_TOUCH_PROC_H_
+#define CAP_TOUCH_PROC_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** 通道数量(与CAP_TOUCH_CHANNEL_COUNT一致) */
+#define CAP_PROC_CHANNELS 6
+
+/** 全部通道掩码 */
+#define CAP_PROC_ALL_PADS ((uint8_t)((1U << CAP_PROC_CHANNELS) - 1U))
+
+/** 补偿增益的定点位数(与CAP_COMP_GAIN_FRAC_BITS一致) */
+#define CAP_PROC_GAIN_FRAC_BITS 16
+#define CAP_PROC_GAIN_ONE       ((uint32_t)1U << CAP_PROC_GAIN_FRAC_BITS)
+
+/** 默认触摸阈值(相对基线的增量)，候选阈值为其1/2，释放阈值为其3/4 */
+#define CAP_PROC_THRESHOLD_DEFAULT 150
+
+/** 基线跟踪: 基线以Q4定点保存，每帧向当前值靠近 1/(1 << baseline_shift)
+ * 基线按温度/电压补偿的参考条件保存，比较时乘以补偿增益折算到当前条件
+ */
+#define CAP_PROC_BASELINE_FRAC_BITS     4
+#define CAP_PROC_BASELINE_SHIFT_DEFAULT 4
+
+/** 活动模式下连续无候选触摸多少帧后回到空闲模式 */
+#define CAP_PROC_QUIET_FRAMES_DEFAULT 500
+
+/** 接近检测默认配置
+ * CAP_PROC_PROX_FILTER_SHIFT     原始和值IIR滤波强度 1/(1 << n)
+ * CAP_PROC_PROX_BASELINE_SHIFT   接近基线跟踪速度 1/(1 << n)，远慢于触摸通道
+ * CAP_PROC_PROX_THRESHOLD_DEFAULT 接近阈值(相对基线的增量，释放阈值为其3/4)
+ */
+#define CAP_PROC_PROX_FILTER_SHIFT      3
+#define CAP_PROC_PROX_BASELINE_SHIFT    8
+#define CAP_PROC_PROX_THRESHOLD_DEFAULT 40
+
+/**
+ * @brief 单通道数据处理状态(基线/增量/触摸判定)
+ */
+typedef struct {
+    uint32_t baseline_q;  /*!< 基线值(Q4定点，参考条件) */
+    int32_t  delta;       /*!< 当前值相对基线的增量 */
+    uint16_t threshold;   /*!< 触摸阈值 */
+    uint8_t  baseline_ok; /*!< 基线是否已初始化 */
+    uint8_t  touched;     /*!< 当前触摸状态 */
+} cap_proc_track_t;
+
+/**
+ * @brief 接近检测数据处理状态
+ */
+typedef struct {
+    uint8_t  enabled;     /*!< 是否在每帧末尾进行接近检测 */
+    uint8_t  near;        /*!< 当前是否检测到接近 */
+    uint8_t  baseline_ok; /*!< 基线是否已初始化 */
+    uint16_t threshold;   /*!< 接近阈值 */
+    uint32_t filtered_q;  /*!< 滤波后的和值(Q4定点) */
+    uint32_t baseline_q;  /*!< 接近基线(Q4定点) */
+    int32_t  delta;       /*!< 滤波值相对基线的增量 */
+} cap_proc_prox_t;
+
+/**
+ * @brief 数据处理实例
+ */
+typedef struct {
+    cap_proc_track_t track[CAP_PROC_CHANNELS]; /*!< 各通道状态 */
+    cap_proc_prox_t  prox;                     /*!< 接近检测状态 */
+    uint8_t          guard_mask;               /*!< 保护通道掩码 */
+    uint8_t          baseline_shift;           /*!< 基线跟踪速度 */
+    uint8_t          idle_pad_mask;            /*!< 空闲模式下扫描的通道掩码 */
+    uint16_t         quiet_frames_max;         /*!< 回到空闲模式的无候选触摸帧数 */
+    uint16_t         quiet_frames;             /*!< 连续无候选触摸帧数 */
+    volatile uint8_t idle;                     /*!< 1: 空闲扫描模式 */
+    volatile uint8_t touch_mask;               /*!< 当前触摸通道掩码 */
+    volatile uint8_t guard_veto;               /*!< 保护通道屏蔽标志 */
+} cap_touch_proc_t;
+
+/**
+ * @brief 按补偿增益缩放数值
+ * @param value 待缩放的值
+ * @param gain 增益(Q16)
+ */
+static inline uint32_t cap_touch_proc_gain_apply(uint32_t value, uint32_t gain)
+{
+    return (uint32_t)(((uint64_t)value * gain) >> CAP_PROC_GAIN_FRAC_BITS);
+}
+
+/**
+ * @brief 以默认配置初始化(所有通道为触摸通道，接近检测关闭，活动模式)
+ *
+ * @param proc 数据处理实例
+ */
+void cap_touch_proc_init(cap_touch_proc_t *proc);
+
+/**
+ * @brief 获取当前扫描模式下需要扫描的通道掩码
+ *
+ * 空闲通道掩码为0时仅进行接近检测；若接近检测也被关闭则回退为扫描全部通道
+ *
+ * @param proc 数据处理实例
+ * @return uint8_t 通道掩码
+ */
+uint8_t cap_touch_proc_scan_mask(const cap_touch_proc_t *proc);
+
+/**
+ * @brief 处理一帧: 触摸判定、接近检测和扫描模式切换
+ *
+ * @param proc 数据处理实例
+ * @param values 各通道捕获值，只处理mask中的通道
+ * @param mask 本帧实际扫描的通道掩码(帧开始时的cap_touch_proc_scan_mask())
+ * @param prox_raw 接近检测并联通道捕获值之和，接近检测关闭时忽略
+ * @param gain 温度/电压补偿增益(Q16)，无补偿时为CAP_PROC_GAIN_ONE
+ * @param inv_gain 补偿增益的倒数(Q16)
+ * @return uint8_t 1: 接近状态发生变化
+ */
+uint8_t cap_touch_proc_frame(cap_touch_proc_t *proc, const uint32_t *values, uint8_t mask, uint32_t prox_raw,
+                             uint32_t gain, uint32_t inv_gain);
+
+/**
+ * @brief 所有通道和接近检测重新建立基线
+ *
+ * @param proc 数据处理实例
+ */
+void cap_touch_proc_reset_baselines(cap_touch_proc_t *proc);
+
+/**
+ * @brief 获取指定通道的基线值(折算到当前条件)
+ *
+ * @param proc 数据处理实例
+ * @param channel 通道号
+ * @param gain 补偿增益(Q16)
+ * @return uint32_t 基线值
+ */
+uint32_t cap_touch_proc_get_baseline(const cap_touch_proc_t *proc, uint8_t channel, uint32_t gain);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CAP_TOUCH_PROC_H_ */
@@ -0,0 +1,167 @@
+/**
+ * @file cap_uart.c
+ * @brief 电容触摸USART连续发送(循环DMA双缓冲)实现 - GD32C2x1版本
+ * @version 1.0
+ * @date 2025-11-01
+ *
+ * 半缓冲区切换:
+ * 1. DMA进入写入中的半缓冲区时，另一半已发送完毕: 清零后作为新的写入半缓冲区
+ * 2. 切换由半满/全满中断触发；写入方与DMA中断优先级相同，中断被推迟时
+ *    写入方根据DMA剩余传输数自行切换，切换只取决于DMA位置，重复调用无副作用
+ * 3. 每个半缓冲区开头保留CAP_UART_TX_GUARD个填充字节: DMA进入一个半缓冲区后
+ *    至少经过这些字节的发送时间才读到第一帧，在此之前开始的写入已经完成
+ */
+
+#include "cap_uart.h"
+#include <string.h>
+
+/** 发送环形缓冲区(两个半缓冲区) */
+__attribute__((aligned(4))) static uint8_t g_uart_tx_ring[2][CAP_UART_TX_HALF_SIZE];
+
+/** 写入中的半缓冲区和写入位置 */
+static uint8_t  g_uart_tx_half = 1;
+static uint16_t g_uart_tx_fill = CAP_UART_TX_GUARD;
+
+/** 丢弃的帧数 */
+static uint32_t g_uart_tx_dropped = 0;
+
+/**
+ * @brief 根据DMA位置切换写入的半缓冲区
+ */
+static void cap_uart_tx_sync(void)
+{
+    uint8_t reading = (dma_transfer_number_get(DMA_CH0) > CAP_UART_TX_HALF_SIZE) ? 0 : 1;
+
+    if (reading != g_uart_tx_half) { return; }
+
+    /* DMA已进入写入中的半缓冲区，另一半发送完毕 */
+    g_uart_tx_half ^= 1;
+    memset(g_uart_tx_ring[g_uart_tx_half], 0, CAP_UART_TX_HALF_SIZE);
+    g_uart_tx_fill = CAP_UART_TX_GUARD;
+}
+
+/**
+ * @brief 在空闲的半缓冲区中预留一帧空间
+ */
+uint8_t *cap_uart_tx_reserve(uint16_t length)
+{
+    cap_uart_tx_sync();
+
+    if (CAP_UART_TX_HALF_SIZE - g_uart_tx_fill < length) {
+        g_uart_tx_dropped++;
+        return NULL;
+    }
+
+    return &g_uart_tx_ring[g_uart_tx_half][g_uart_tx_fill];
+}
+
+/**
+ * @brief 提交预留的帧
+ */
+void cap_uart_tx_commit(uint16_t length)
+{
+    g_uart_tx_fill += length;
+}
+
+/**
+ * @brief 复制一个完整帧到发送缓冲区
+ */
+void cap_uart_tx_write(const uint8_t *frame, uint16_t length)
+{
+    uint32_t primask = __get_PRIMASK();
+    uint8_t *dst;
+
+    __disable_irq();
+
+    dst = cap_uart_tx_reserve(length);
+    if (dst != NULL) {
+        memcpy(dst, frame, length);
+        cap_uart_tx_commit(length);
+    }
+
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief DMA_CH0半满/全满中断处理函数
+ */
+void cap_uart_tx_dma_irq_handler(void)
+{
+    if (dma_interrupt_flag_get(DMA_CH0, DMA_INT_FLAG_HTF) == SET) { dma_interrupt_flag_clear(DMA_CH0, DMA_INT_FLAG_HTF); }
+    if (dma_interrupt_flag_get(DMA_CH0, DMA_INT_FLAG_FTF) == SET) { dma_interrupt_flag_clear(DMA_CH0, DMA_INT_FLAG_FTF); }
+
+    cap_uart_tx_sync();
+}
+
+/**
+ * @brief 初始化连续发送
+ */
+void cap_uart_tx_init(void)
+{
+    dma_parameter_struct dma_init_struct;
+
+    memset(g_uart_tx_ring, 0, sizeof(g_uart_tx_ring));
+
+    /* DMA从前半开始发送，先写入后半 */
+    g_uart_tx_half = 1;
+    g_uart_tx_fill = CAP_UART_TX_GUARD;
+
+    rcu_periph_clock_enable(RCU_DMA);
+    rcu_periph_clock_enable(RCU_DMAMUX);
+
+    dma_deinit(DMA_CH0);
+    dma_struct_para_init(&dma_init_struct);
+
+    dma_init_struct.request      = DMA_REQUEST_USART0_TX;          /* USART0_TX请求 */
+    dma_init_struct.direction    = DMA_MEMORY_TO_PERIPHERAL;       /* 内存到外设 */
+    dma_init_struct.memory_addr  = (uint32_t)g_uart_tx_ring;       /* 内存地址 */
+    dma_init_struct.memory_inc   = DMA_MEMORY_INCREASE_ENABLE;     /* 内存地址自增 */
+    dma_init_struct.memory_width = DMA_MEMORY_WIDTH_8BIT;          /* 内存数据宽度8位 */
+    dma_init_struct.number       = sizeof(g_uart_tx_ring);         /* 整个环形缓冲区 */
+    dma_init_struct.periph_addr  = (uint32_t)&USART_TDATA(USART0); /* 外设地址 */
+    dma_init_struct.periph_inc   = DMA_PERIPH_INCREASE_DISABLE;    /* 外设地址不变 */
+    dma_init_struct.periph_width = DMA_PERIPHERAL_WIDTH_8BIT;      /* 外设数据宽度8位 */
+    dma_init_struct.priority     = DMA_PRIORITY_ULTRA_HIGH;        /* 超高优先级 */
+
+    dma_init(DMA_CH0, &dma_init_struct);
+
+    /* 循环模式: 传输数减到0后自动重装，不需要在中断中重新配置 */
+    dma_circulation_enable(DMA_CH0);
+    dma_memory_to_memory_disable(DMA_CH0);
+    dmamux_synchronization_disable(DMAMUX_MUXCH0);
+
+    /* 半满: 前半发送完毕; 全满: 后半发送完毕 */
+    dma_interrupt_flag_clear(DMA_CH0, DMA_INT_FLAG_HTF);
+    dma_interrupt_flag_clear(DMA_CH0, DMA_INT_FLAG_FTF);
+    dma_interrupt_enable(DMA_CH0, DMA_INT_HTF | DMA_INT_FTF);
+    nvic_irq_enable(DMA_Channel0_IRQn, 3);
+
+    dma_channel_enable(DMA_CH0);
+}
+
+/**
+ * @brief 暂停连续发送
+ *
+ * 关闭DMA请求后发送数据寄存器中最多还有一个字节，等待发送完成标志
+ */
+void cap_uart_tx_pause(void)
+{
+    usart_dma_transmit_config(USART0, USART_TRANSMIT_DMA_DISABLE);
+    while (usart_flag_get(USART0, USART_FLAG_TC) == RESET) {}
+}
+
+/**
+ * @brief 恢复连续发送
+ */
+void cap_uart_tx_resume(void)
+{
+    usart_dma_transmit_config(USART0, USART_TRANSMIT_DMA_ENABLE);
+}
+
+/**
+ * @brief 获取因发送缓冲区空间不足而丢弃的帧数
+ */
+uint32_t cap_uart_tx_get_dropped(void)
+{
+    return g_uart_tx_dropped;
+}
@@ -0,0 +1,87 @@
+/**
+ * @file cap_uart.h
+ * @brief 电容触摸USART连续发送(循环DMA双缓冲)头文件 - GD32C2x1版本
+ * @version 1.0
+ * @date 2025-11-01
+ *
+ * DMA_CH0以循环模式不停地把发送环形缓冲区送到USART0，缓冲区分为前后两半:
+ * DMA发送一半时，数据帧直接写入另一半(不复制)，未写入的部分为填充字节0，
+ * 上位机解析时跳过(见cap_proto.h)。每个缓冲区只有半满和全满两次中断，
+ * 不再为每帧重新配置DMA。
+ */
+
+#ifndef CAP_UART_H_
+#define CAP_UART_H_
+
+#include "gd32c2x1.h"
+#include <stdint.h>
+
+/** 半缓冲区大小，至少能放下一个最大帧(CAP_PROTO_MAX_FRAME) */
+#define CAP_UART_TX_HALF_SIZE 512
+
+/** 每个半缓冲区开头保留的填充字节数 */
+#define CAP_UART_TX_GUARD 2
+
+/**
+ * @brief 初始化连续发送
+ *
+ * 配置DMA_CH0循环发送并使能半满/全满中断。需在usart_config()之后调用，
+ * 调用后USART0持续输出(无数据时为填充字节)
+ */
+void cap_uart_tx_init(void);
+
+/**
+ * @brief 在空闲的半缓冲区中预留一帧空间
+ *
+ * 只能在中断中或关中断时调用。预留后直接在返回的地址填写帧，再调用cap_uart_tx_commit()
+ *
+ * @param length 帧长度
+ * @return uint8_t* 帧地址；空间不足时返回NULL，该帧计为丢弃
+ */
+uint8_t *cap_uart_tx_reserve(uint16_t length);
+
+/**
+ * @brief 提交预留的帧
+ *
+ * @param length 帧的实际长度(不超过预留长度)
+ */
+void cap_uart_tx_commit(uint16_t length);
+
+/**
+ * @brief 复制一个完整帧到发送缓冲区
+ *
+ * 用于差分/批量编码器和命令应答，可在主循环中调用(内部关中断)。
+ * 可注册为命令通道的应答发送函数
+ *
+ * @param frame 完整帧
+ * @param length 帧长度
+ */
+void cap_uart_tx_write(const uint8_t *frame, uint16_t length);
+
+/**
+ * @brief DMA_CH0半满/全满中断处理函数
+ *
+ * 需要在DMA_Channel0_IRQHandler中调用
+ */
+void cap_uart_tx_dma_irq_handler(void);
+
+/**
+ * @brief 暂停连续发送: 停止DMA请求并等待正在发送的字节发送完毕
+ *
+ * 用于深度睡眠之前(USART时钟停止会截断正在发送的字节)，缓冲区中的帧在恢复后继续发送
+ */
+void cap_uart_tx_pause(void);
+
+/**
+ * @brief 恢复连续发送
+ */
+void cap_uart_tx_resume(void);
+
+/**
+ * @brief 获取因发送缓冲区空间不足而丢弃的帧数
+ *
+ * @return uint32_t 丢弃的帧数
+ */
+uint32_t cap_uart_tx_get_dropped(void);
+
+#endif /* CAP_UART_H_ */
@@ -35,7 +35,17 @@ OF SUCH DAMAGE.
 #include "gd32c2x1_it.h"
 #include "main.h"
 #include "systick.h"
+#include "cap_cmd.h"
+#include "cap_crc.h"
+#include "cap_fast.h"
+#include "cap_flash.h"
+#include "cap_i2c.h"
+#include "cap_lp.h"
+#include "cap_prof.h"
+#include "cap_spi.h"
 #include "cap_touch.h"
+#include "cap_touch_comp.h"
+#include "cap_uart.h"
 
 #define SRAM_ECC_ERROR_HANDLE(s)                                                                                                                                                                       \
     do {                                                                                                                                                                                               \
@@ -100,27 +110,30 @@ void PendSV_Handler(void)
 */
 void TIMER0_Channel_IRQHandler(void)
 {
+    CAP_PROF_ENTER(CAP_PROF_TIMER0_ISR);
+
     /* 处理捕获中断（正常情况） */
-    if (SET == timer_interrupt_flag_get(TIMER0, TIMER_INT_FLAG_CH0)) {
-        timer_interrupt_flag_clear(TIMER0, TIMER_INT_FLAG_CH0);
+    if (SET == cap_timer_int_flag_get(TIMER0, TIMER_INT_FLAG_CH0)) {
+        cap_timer_int_flag_clear(TIMER0, TIMER_INT_FLAG_CH0);
         cap_touch_timer_capture_callback(TIMER0, TIMER_CH_0);
     }
 
-    if (SET == timer_interrupt_flag_get(TIMER0, TIMER_INT_FLAG_CH1)) {
-        timer_interrupt_flag_clear(TIMER0, TIMER_INT_FLAG_CH1);
+    if (SET == cap_timer_int_flag_get(TIMER0, TIMER_INT_FLAG_CH1)) {
+        cap_timer_int_flag_clear(TIMER0, TIMER_INT_FLAG_CH1);
         cap_touch_timer_capture_callback(TIMER0, TIMER_CH_1);
     }
 
-    if (SET == timer_interrupt_flag_get(TIMER0, TIMER_INT_FLAG_CH2)) {
-        timer_interrupt_flag_clear(TIMER0, TIMER_INT_FLAG_CH2);
+    if (SET == cap_timer_int_flag_get(TIMER0, TIMER_INT_FLAG_CH2)) {
+        cap_timer_int_flag_clear(TIMER0, TIMER_INT_FLAG_CH2);
         cap_touch_timer_capture_callback(TIMER0, TIMER_CH_2);
     }
 
-    if (SET == timer_interrupt_flag_get(TIMER0, TIMER_INT_FLAG_CH3)) {
-        timer_interrupt_flag_clear(TIMER0, TIMER_INT_FLAG_CH3);
+    if (SET == cap_timer_int_flag_get(TIMER0, TIMER_INT_FLAG_CH3)) {
+        cap_timer_int_flag_clear(TIMER0, TIMER_INT_FLAG_CH3);
         cap_touch_timer_capture_callback(TIMER0, TIMER_CH_3);
     }
 
+    CAP_PROF_EXIT(CAP_PROF_TIMER0_ISR);
 } /*!
      \brief      this function handles TIMER2 interrupt
      \param[in]  none
@@ -129,16 +142,156 @@ void TIMER0_Channel_IRQHandler(void)
  */
 void TIMER2_IRQHandler(void)
 {
+    CAP_PROF_ENTER(CAP_PROF_TIMER2_ISR);
+
     /* 处理捕获中断（正常情况） */
-    if (SET == timer_interrupt_flag_get(TIMER2, TIMER_INT_FLAG_CH0)) {
-        timer_interrupt_flag_clear(TIMER2, TIMER_INT_FLAG_CH0);
+    if (SET == cap_timer_int_flag_get(TIMER2, TIMER_INT_FLAG_CH0)) {
+        cap_timer_int_flag_clear(TIMER2, TIMER_INT_FLAG_CH0);
         cap_touch_timer_capture_callback(TIMER2, TIMER_CH_0);
     }
 
-    if (SET == timer_interrupt_flag_get(TIMER2, TIMER_INT_FLAG_CH1)) {
-        timer_interrupt_flag_clear(TIMER2, TIMER_INT_FLAG_CH1);
+    if (SET == cap_timer_int_flag_get(TIMER2, TIMER_INT_FLAG_CH1)) {
+        cap_timer_int_flag_clear(TIMER2, TIMER_INT_FLAG_CH1);
         cap_touch_timer_capture_callback(TIMER2, TIMER_CH_1);
     }
+
+    CAP_PROF_EXIT(CAP_PROF_TIMER2_ISR);
+}
+
+/*!
+    \brief      this function handles ADC interrupt
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void ADC_IRQHandler(void)
+{
+    /* 插入组(温度传感器 + VREFINT)转换完成 */
+    if (SET == adc_interrupt_flag_get(ADC_INT_FLAG_EOIC)) {
+        adc_interrupt_flag_clear(ADC_INT_FLAG_EOIC);
+        cap_touch_comp_adc_callback(adc_inserted_data_read(ADC_INSERTED_CHANNEL_0), adc_inserted_data_read(ADC_INSERTED_CHANNEL_1));
+    }
+}
+
+/*!
+    \brief      this function handles USART0 interrupt
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void USART0_IRQHandler(void)
+{
+    /* 接收空闲: 命令数据已由DMA写入环形缓冲区，通知主循环解析 */
+    if (RESET != usart_interrupt_flag_get(USART0, USART_INT_FLAG_IDLE)) {
+        usart_interrupt_flag_clear(USART0, USART_INT_FLAG_IDLE);
+        cap_cmd_usart_idle_callback();
+    }
+}
+
+/*!
+    \brief      this function handles DMA channel 0 interrupt
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void DMA_Channel0_IRQHandler(void)
+{
+    /* USART连续发送: 半缓冲区发送完毕 */
+    cap_uart_tx_dma_irq_handler();
+}
+
+/*!
+    \brief      this function handles DMA channel 1 interrupt
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void DMA_Channel1_IRQHandler(void)
+{
+    /* SPI从机数据流: 接收完成即一次事务结束 */
+    cap_spi_dma_irq_handler();
+}
+
+/*!
+    \brief      this function handles DMA channel 2 interrupt
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void DMA_Channel2_IRQHandler(void)
+{
+    /* CRC异步计算: 一段传输完成 */
+    cap_crc_dma_irq_handler();
+}
+
+/*!
+    \brief      this function handles FMC interrupt
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void FMC_IRQHandler(void)
+{
+    /* Flash流式写入: 一次编程操作结束 */
+    cap_flash_irq_handler();
+}
+
+/*!
+    \brief      this function handles I2C0 event interrupt
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void I2C0_EV_IRQHandler(void)
+{
+    cap_i2c_event_irq_handler();
+}
+
+/*!
+    \brief      this function handles I2C0 error interrupt
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void I2C0_ER_IRQHandler(void)
+{
+    cap_i2c_error_irq_handler();
+}
+
+/*!
+    \brief      this function handles RTC alarm interrupt
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void RTC_Alarm_IRQHandler(void)
+{
+    /* 低功耗扫描: 深度睡眠闹钟 */
+    cap_lp_rtc_irq_handler();
+}
+
+/*!
+    \brief      this function handles EXTI line 4 interrupt
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void EXTI4_IRQHandler(void)
+{
+    /* 低功耗扫描: SPI片选唤醒 */
+    cap_lp_exti_irq_handler();
+}
+
+/*!
+    \brief      this function handles EXTI line 5 to 9 interrupt
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void EXTI5_9_IRQHandler(void)
+{
+    /* 低功耗扫描: USART接收/I2C数据线唤醒 */
+    cap_lp_exti_irq_handler();
 }
 
 // /*!
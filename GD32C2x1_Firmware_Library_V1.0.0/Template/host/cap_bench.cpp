@@ -0,0 +1,216 @@
+/**
+ * @file cap_bench.cpp
+ * @brief 电容触摸数据流解码器吞吐量测试(上位机)
+ * @version 1.0
+ * @date 2025-11-01
+ *
+ * 在内存中生成一段合成数据流并重复输入解码器，直到达到指定的总数据量(默认4GiB)，
+ * 输出解码速率及其相对串口(921600bps)和SPI链路速率的倍数，确认解码器不会成为瓶颈。
+ *
+ * 合成数据与固件输出一致: 连续的原始数据帧，夹杂循环DMA的填充字节，
+ * 并按固定间隔损坏一帧以覆盖CRC错误和重新同步的路径。结束时按已知的损坏帧数
+ * 检查解码结果(帧数和丢帧数)。
+ *
+ * 编译(Linux):
+ *   gcc -O2 -c ../cap_proto.c
+ *   g++ -O2 -std=c++17 -I.. cap_bench.cpp cap_stream.cpp cap_log.cpp cap_proto.o -o cap_bench
+ *
+ * 使用:
+ *   ./cap_bench                 # 4GiB v1数据流
+ *   ./cap_bench -g 8 -L         # 8GiB legacy数据流
+ *   ./cap_bench -o /tmp/b.caplog  # 同时写入记录文件
+ */
+
+#include "cap_log.h"
+#include "cap_stream.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+/** 一段合成数据中的帧数: 正好一个16位序号周期，重复输入时序号连续 */
+constexpr uint32_t kBlockFrames = 65536;
+
+/** 每隔多少帧损坏一帧 */
+constexpr uint32_t kCorruptInterval = 4096;
+
+/** 每隔多少帧插入一段填充字节，以及填充长度 */
+constexpr uint32_t kPadInterval = 20;
+constexpr uint32_t kPadBytes    = 2;
+
+/** 每次输入解码器的块大小(与cap_record的读取块相同) */
+constexpr size_t kChunkSize = 64 * 1024;
+
+/** 参考链路速率(字节/秒): USART 921600bps 8N1，SPI 12MHz */
+constexpr double kUsartBytesPerSec = 921600.0 / 10.0;
+constexpr double kSpiBytesPerSec   = 12e6 / 8.0;
+
+/**
+ * @brief 只计数的帧接收接口，避免优化掉解码结果
+ */
+class CountSink : public cap::FrameSink {
+public:
+    void on_frame(const cap::Frame &frame) override
+    {
+        frames++;
+        checksum += frame.data[frame.size - 1];
+    }
+
+    uint64_t frames   = 0;
+    uint64_t checksum = 0;
+};
+
+/**
+ * @brief 模拟的触摸值: 基线 + 慢变化，偶尔有触摸
+ */
+uint16_t synth_value(uint32_t frame, uint8_t channel)
+{
+    uint32_t value = 1000U + channel * 50U + (frame / 64U + channel) % 16U;
+
+    if ((frame / 2048U) % 8U == channel) { value += 300U; }
+    return static_cast<uint16_t>(value);
+}
+
+/**
+ * @brief 生成v1合成数据段
+ * @return uint32_t 损坏的帧数
+ */
+uint32_t build_v1(std::vector<uint8_t> &block)
+{
+    uint8_t  frame[CAP_PROTO_MAX_FRAME];
+    uint32_t corrupted = 0;
+
+    for (uint32_t n = 0; n < kBlockFrames; n++) {
+        auto *raw = reinterpret_cast<cap_proto_raw_t *>(cap_proto_payload(frame));
+
+        for (uint8_t i = 0; i < CAP_PROTO_CHANNELS; i++) {
+            raw->values[i] = synth_value(n, i);
+        }
+        raw->touch_mask = static_cast<uint8_t>(1U << ((n / 2048U) % 8U));
+        raw->flags      = 0;
+
+        uint16_t size = cap_proto_finalize(frame, CAP_PROTO_TYPE_RAW, sizeof(cap_proto_raw_t));
+
+        if (n % kCorruptInterval == kCorruptInterval / 2) {
+            frame[CAP_PROTO_HEADER_SIZE + 3] ^= 0x10;
+            corrupted++;
+        }
+        block.insert(block.end(), frame, frame + size);
+
+        if (n % kPadInterval == 0) { block.insert(block.end(), kPadBytes, 0); }
+    }
+
+    return corrupted;
+}
+
+/**
+ * @brief 生成legacy合成数据段
+ * @return uint32_t 损坏的帧数
+ */
+uint32_t build_legacy(std::vector<uint8_t> &block)
+{
+    uint32_t corrupted = 0;
+
+    for (uint32_t n = 0; n < kBlockFrames; n++) {
+        uint8_t  frame[cap::kLegacyFrameSize];
+        uint16_t sum = 0;
+
+        frame[0] = 0xA5;
+        frame[1] = 0xA5;
+        for (uint8_t i = 0; i < 6; i++) {
+            uint16_t value = synth_value(n, i);
+
+            frame[2 + i * 2] = static_cast<uint8_t>(value & 0xFF);
+            frame[3 + i * 2] = static_cast<uint8_t>(value >> 8);
+            sum              = static_cast<uint16_t>(sum + value);
+        }
+        frame[14] = static_cast<uint8_t>(sum & 0xFF);
+        frame[15] = static_cast<uint8_t>(sum >> 8);
+
+        if (n % kCorruptInterval == kCorruptInterval / 2) {
+            frame[5] ^= 0x10;
+            corrupted++;
+        }
+        block.insert(block.end(), frame, frame + sizeof(frame));
+    }
+
+    return corrupted;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    cap::StreamFormat format   = cap::StreamFormat::V1;
+    double            gib      = 4.0;
+    const char       *log_path = nullptr;
+    int               opt;
+
+    while ((opt = getopt(argc, argv, "g:Lo:h")) != -1) {
+        switch (opt) {
+        case 'g': gib = std::strtod(optarg, nullptr); break;
+        case 'L': format = cap::StreamFormat::Legacy; break;
+        case 'o': log_path = optarg; break;
+        default:
+            std::fprintf(stderr, "usage: %s [-g GiB] [-L] [-o log]\n", argv[0]);
+            return opt == 'h' ? 0 : 2;
+        }
+    }
+
+    std::vector<uint8_t> block;
+    uint32_t corrupted = (format == cap::StreamFormat::V1) ? build_v1(block) : build_legacy(block);
+
+    uint64_t total  = static_cast<uint64_t>(gib * 1024.0 * 1024.0 * 1024.0);
+    uint64_t blocks = (total + block.size() - 1) / block.size();
+
+    cap::StreamDecoder decoder(format);
+    CountSink          counter;
+    cap::LogWriter     writer;
+    cap::FrameSink    *sink = &counter;
+
+    if (log_path != nullptr) {
+        if (!writer.open(log_path, format)) {
+            std::perror(log_path);
+            return 1;
+        }
+        sink = &writer;
+    }
+
+    std::fprintf(stderr, "decoding %llu x %zu bytes (%.2f GiB), %s stream%s\n",
+                 static_cast<unsigned long long>(blocks), block.size(),
+                 static_cast<double>(blocks * block.size()) / (1024.0 * 1024.0 * 1024.0),
+                 format == cap::StreamFormat::V1 ? "v1" : "legacy", log_path != nullptr ? ", writing log" : "");
+
+    uint64_t start = cap::monotonic_ns();
+
+    for (uint64_t b = 0; b < blocks; b++) {
+        for (size_t off = 0; off < block.size(); off += kChunkSize) {
+            size_t n = block.size() - off < kChunkSize ? block.size() - off : kChunkSize;
+            decoder.feed(block.data() + off, n, cap::monotonic_ns(), sink);
+        }
+    }
+
+    double seconds = static_cast<double>(cap::monotonic_ns() - start) / 1e9;
+    writer.close();
+
+    const cap::StreamStats &s     = decoder.stats();
+    double                  rate  = static_cast<double>(s.bytes) / seconds;
+    uint64_t                good  = blocks * (kBlockFrames - corrupted);
+    uint64_t                bad   = blocks * corrupted;
+    bool                    lost_ok =
+        (format == cap::StreamFormat::Legacy) || s.lost == bad;
+    bool                    pass  = s.frames == good && s.crc_errors >= bad && lost_ok && !writer.failed();
+
+    decoder.report(stderr, false);
+    std::fprintf(stderr, "%.3f s, %.1f MB/s, %.2f M frames/s\n", seconds, rate / 1e6,
+                 static_cast<double>(s.frames) / seconds / 1e6);
+    std::fprintf(stderr, "%.0fx USART 921600 bps (%.1f h of capture per minute), %.0fx SPI 12 MHz\n",
+                 rate / kUsartBytesPerSec, rate / kUsartBytesPerSec / 60.0, rate / kSpiBytesPerSec);
+    std::fprintf(stderr, "check: expected %llu frames, %llu corrupted: %s\n", static_cast<unsigned long long>(good),
+                 static_cast<unsigned long long>(bad), pass ? "PASS" : "FAIL");
+
+    return pass ? 0 : 1;
+}
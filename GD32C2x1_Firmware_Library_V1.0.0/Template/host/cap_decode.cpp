@@ -0,0 +1,234 @@
+/**
+ * @file cap_decode.cpp
+ * @brief 电容触摸数据流上位机解码工具
+ * @version 1.0
+ * @date 2025-11-01
+ *
+ * 解析固件通过USART0发送的帧(原始数据帧、差分压缩帧和批量帧)，每次扫描输出一行CSV:
+ *
+ *   seq,scan,time_us,ch0,ch1,ch2,ch3,ch4,ch5,touch_mask,flags
+ *
+ * time_us仅批量帧带有，其它帧为空。遥测帧不输出CSV，每帧在stderr输出一行计数。
+ *
+ * 结束时在stderr输出帧数、CRC错误、丢弃字节数和序号间隔(丢帧)统计。
+ *
+ * 编译(Linux):
+ *   gcc -O2 -c ../cap_proto.c
+ *   g++ -O2 -std=c++17 -I.. cap_decode.cpp cap_proto.o -o cap_decode
+ *
+ * 使用:
+ *   stty -F /dev/ttyUSB0 921600 raw
+ *   ./cap_decode /dev/ttyUSB0 > log.csv
+ *   ./cap_decode capture.bin > log.csv
+ *   ./cap_decode < capture.bin
+ */
+
+#include "cap_proto.h"
+
+#include <cstdint>
+#include <cstdio>
+
+namespace {
+
+/** 差分压缩帧最多扫描次数(负载每次扫描至少 1 + 通道数 字节) */
+constexpr uint8_t kMaxScans = CAP_PROTO_MAX_PAYLOAD / (1 + CAP_PROTO_CHANNELS) + 1;
+
+/**
+ * @brief 解码统计
+ */
+struct DecodeStats {
+    uint64_t scans       = 0; /*!< 输出的扫描次数 */
+    uint64_t lost_frames = 0; /*!< 序号间隔推算的丢帧数 */
+    uint64_t bad_payload = 0; /*!< CRC正确但负载无法解码的帧数 */
+    uint64_t telemetry   = 0; /*!< 遥测帧数 */
+    uint64_t profile     = 0; /*!< 性能分析帧数 */
+    uint64_t timing      = 0; /*!< 扫描时序帧数 */
+    uint64_t unknown     = 0; /*!< 未知类型的帧数 */
+    bool     have_seq    = false;
+    uint16_t last_seq    = 0;
+};
+
+void print_scan(uint16_t seq, uint8_t index, const uint32_t *time_us, const cap_proto_raw_t &scan)
+{
+    if (time_us != nullptr) {
+        std::printf("%u,%u,%u", seq, index, *time_us);
+    } else {
+        std::printf("%u,%u,", seq, index);
+    }
+    for (uint16_t value : scan.values) {
+        std::printf(",%u", value);
+    }
+    std::printf(",0x%02X,0x%02X\n", scan.touch_mask, scan.flags);
+}
+
+void print_telemetry(const cap_proto_telemetry_t &t)
+{
+    /* 活动时间占比和每秒唤醒次数取相邻两个遥测帧的差值 */
+    static cap_proto_telemetry_t prev;
+    static bool                  have_prev = false;
+
+    std::fprintf(stderr,
+                 "telemetry: time_us %u, frames %u, scan overruns %u, capture timeouts %u, tx overflows %u, "
+                 "event overflows %u, dma restarts %u, cmd crc errors %u, active_us %u, wakeups %u",
+                 t.time_us, t.frames, t.scan_overruns, t.capture_timeouts, t.tx_overflows, t.event_overflows,
+                 t.dma_restarts, t.cmd_crc_errors, t.active_us, t.wakeups);
+
+    uint32_t dt = t.time_us - prev.time_us;
+    if (have_prev && dt != 0) {
+        std::fprintf(stderr, ", duty %.2f%%, wakeups/s %.1f", 100.0 * (uint32_t)(t.active_us - prev.active_us) / dt,
+                     1e6 * (uint32_t)(t.wakeups - prev.wakeups) / dt);
+    }
+    std::fprintf(stderr, "\n");
+
+    prev      = t;
+    have_prev = true;
+}
+
+void print_profile(const cap_proto_profile_t *entries, uint16_t count)
+{
+    static const char *const kRegionNames[CAP_PROTO_PROF_REGIONS] = {"timer0 isr", "timer2 isr", "finish capture",
+                                                                     "data ready"};
+
+    for (uint16_t i = 0; i < count; i++) {
+        const cap_proto_profile_t &e = entries[i];
+        const char *name = e.region < CAP_PROTO_PROF_REGIONS ? kRegionNames[e.region] : "unknown";
+
+        std::fprintf(stderr, "profile: %s, count %u, cycles min %u max %u avg %u\n", name, e.count, e.min_cycles,
+                     e.max_cycles, e.avg_cycles);
+    }
+}
+
+void print_histogram(const char *name, const uint32_t *bins)
+{
+    std::fprintf(stderr, "timing: %s", name);
+    for (uint8_t i = 0; i < CAP_PROTO_TIMING_BINS; i++) {
+        if (bins[i] == 0) { continue; }
+        /* 区间下限: 0, 1, 2, 4 ... 32768us，最后一个区间为65536us及以上 */
+        std::fprintf(stderr, " %uus:%u", i == 0 ? 0U : 1U << (i - 1), bins[i]);
+    }
+    std::fprintf(stderr, "\n");
+}
+
+void on_frame(const cap_proto_header_t *header, const uint8_t *payload, void *ctx)
+{
+    auto           *stats = static_cast<DecodeStats *>(ctx);
+    cap_proto_raw_t scans[kMaxScans];
+    uint32_t        times_us[kMaxScans];
+    bool            have_time = false;
+    uint8_t         count     = 0;
+
+    if (stats->have_seq) {
+        stats->lost_frames += static_cast<uint16_t>(header->seq - stats->last_seq - 1U);
+    }
+    stats->have_seq = true;
+    stats->last_seq = header->seq;
+
+    switch (header->type) {
+    case CAP_PROTO_TYPE_RAW:
+        if (header->length != sizeof(cap_proto_raw_t)) {
+            stats->bad_payload++;
+            return;
+        }
+        scans[0] = *reinterpret_cast<const cap_proto_raw_t *>(payload);
+        count    = 1;
+        break;
+
+    case CAP_PROTO_TYPE_DELTA:
+        count = cap_proto_delta_decode(payload, header->length, scans, kMaxScans);
+        if (count == 0) {
+            stats->bad_payload++;
+            return;
+        }
+        break;
+
+    case CAP_PROTO_TYPE_BATCH:
+        count = cap_proto_batch_decode(payload, header->length, scans, times_us, kMaxScans);
+        if (count == 0) {
+            stats->bad_payload++;
+            return;
+        }
+        have_time = true;
+        break;
+
+    case CAP_PROTO_TYPE_TELEMETRY:
+        if (header->length != sizeof(cap_proto_telemetry_t)) {
+            stats->bad_payload++;
+            return;
+        }
+        print_telemetry(*reinterpret_cast<const cap_proto_telemetry_t *>(payload));
+        stats->telemetry++;
+        return;
+
+    case CAP_PROTO_TYPE_PROFILE:
+        if (header->length % sizeof(cap_proto_profile_t) != 0) {
+            stats->bad_payload++;
+            return;
+        }
+        print_profile(reinterpret_cast<const cap_proto_profile_t *>(payload),
+                      static_cast<uint16_t>(header->length / sizeof(cap_proto_profile_t)));
+        stats->profile++;
+        return;
+
+    case CAP_PROTO_TYPE_TIMING:
+        if (header->length != sizeof(cap_proto_timing_t)) {
+            stats->bad_payload++;
+            return;
+        }
+        {
+            const auto *t = reinterpret_cast<const cap_proto_timing_t *>(payload);
+            print_histogram("scan", t->scan);
+            print_histogram("dead", t->dead);
+            print_histogram("period", t->period);
+        }
+        stats->timing++;
+        return;
+
+    default:
+        stats->unknown++;
+        return;
+    }
+
+    for (uint8_t i = 0; i < count; i++) {
+        print_scan(header->seq, i, have_time ? &times_us[i] : nullptr, scans[i]);
+    }
+    stats->scans += count;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    FILE *in = stdin;
+
+    if (argc > 1) {
+        in = std::fopen(argv[1], "rb");
+        if (in == nullptr) {
+            std::perror(argv[1]);
+            return 1;
+        }
+    }
+
+    static cap_proto_parser_t parser;
+    DecodeStats               stats;
+    uint8_t                   buf[4096];
+    size_t                    n;
+
+    cap_proto_parser_init(&parser);
+    std::printf("seq,scan,time_us,ch0,ch1,ch2,ch3,ch4,ch5,touch_mask,flags\n");
+
+    while ((n = std::fread(buf, 1, sizeof(buf), in)) > 0) {
+        cap_proto_parser_feed(&parser, buf, static_cast<uint32_t>(n), on_frame, &stats);
+    }
+
+    std::fprintf(stderr,
+                 "frames %u, scans %llu, crc errors %u, skipped bytes %u, lost frames %llu, "
+                 "bad payload %llu, telemetry %llu, profile %llu, timing %llu, unknown type %llu\n",
+                 parser.frames, static_cast<unsigned long long>(stats.scans), parser.crc_errors, parser.skipped,
+                 static_cast<unsigned long long>(stats.lost_frames),
+                 static_cast<unsigned long long>(stats.bad_payload), static_cast<unsigned long long>(stats.telemetry),
+                 static_cast<unsigned long long>(stats.profile), static_cast<unsigned long long>(stats.timing),
+                 static_cast<unsigned long long>(stats.unknown));
+
+    if (in != stdin) { std::fclose(in); }
+    return 0;
+}
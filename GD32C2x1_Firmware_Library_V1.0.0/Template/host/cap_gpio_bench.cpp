@@ -0,0 +1,356 @@
+/**
+ * @file cap_gpio_bench.cpp
+ * @brief GPIO模式/复用功能设置方法对比测试(上位机)
+ * @version 1.0
+ * @date 2025-11-01
+ *
+ * 比较三种把引脚掩码写入CTL/PUD/AFSEL的方法:
+ * - loop: 标准外设库 gpio_mode_set()/gpio_af_set() 的算法，逐个引脚测试掩码位(外部函数)
+ * - lut:  按4位一组查表展开掩码(16项表)
+ * - bits: cap_bits.h 的移位展开(固件 cap_fast.h 使用)
+ * 以及通道切换的组合操作(放电: 清输出 + 输出模式; 充电: 复用功能 + AF模式)。
+ *
+ * 先对全部65536个掩码、所有模式/上下拉/复用功能值和随机的寄存器初值检查三种方法结果一致，
+ * 再分别测量单引脚掩码(触摸通道切换)和随机多引脚掩码下每次调用的时间。
+ * 寄存器用内存中的结构体代替。上位机的时间只反映指令数的相对差别，
+ * 目标板上的周期数用 cap_prof.h 测量。
+ *
+ * 编译(Linux):
+ *   g++ -O2 -std=c++17 -I.. cap_gpio_bench.cpp -o cap_gpio_bench
+ *
+ * 使用:
+ *   ./cap_gpio_bench            # 默认每种方法2000万次
+ *   ./cap_gpio_bench -n 100     # 每种方法1亿次
+ */
+
+#include "cap_bits.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+/** GPIO模式值(与gd32c2x1_gpio.h一致) */
+constexpr uint32_t kModeOutput = 1;
+constexpr uint32_t kModeAf     = 2;
+
+/** 默认每种方法的调用次数(百万) */
+constexpr uint32_t kDefaultMillions = 20;
+
+/**
+ * @brief 代替GPIO外设的寄存器
+ */
+struct Port {
+    volatile uint32_t ctl;
+    volatile uint32_t pud;
+    volatile uint32_t afsel0;
+    volatile uint32_t afsel1;
+    volatile uint32_t bc;
+};
+
+/* ---------------- loop: 标准外设库算法(外部函数，不内联) ---------------- */
+
+__attribute__((noinline)) void loop_mode_set(Port *port, uint32_t mode, uint32_t pupd, uint32_t pin)
+{
+    uint32_t ctl = port->ctl;
+    uint32_t pud = port->pud;
+
+    for (uint32_t i = 0; i < 16U; i++) {
+        if (((1U << i) & (pin & 0xFFFFU)) != 0U) {
+            ctl &= ~(0x3U << (2U * i));
+            ctl |= (mode & 0x3U) << (2U * i);
+            pud &= ~(0x3U << (2U * i));
+            pud |= (pupd & 0x3U) << (2U * i);
+        }
+    }
+
+    port->ctl = ctl;
+    port->pud = pud;
+}
+
+__attribute__((noinline)) void loop_af_set(Port *port, uint32_t af, uint32_t pin)
+{
+    uint32_t afrl = port->afsel0;
+    uint32_t afrh = port->afsel1;
+
+    for (uint32_t i = 0; i < 8U; i++) {
+        if (((1U << i) & (pin & 0xFFFFU)) != 0U) {
+            afrl &= ~(0xFU << (4U * i));
+            afrl |= (af & 0xFU) << (4U * i);
+        }
+    }
+    for (uint32_t i = 8U; i < 16U; i++) {
+        if (((1U << i) & (pin & 0xFFFFU)) != 0U) {
+            afrh &= ~(0xFU << (4U * (i - 8U)));
+            afrh |= (af & 0xFU) << (4U * (i - 8U));
+        }
+    }
+
+    port->afsel0 = afrl;
+    port->afsel1 = afrh;
+}
+
+__attribute__((noinline)) void loop_bit_reset(Port *port, uint32_t pin)
+{
+    port->bc = pin & 0xFFFFU;
+}
+
+void loop_output_low(Port *port, uint32_t pin)
+{
+    loop_bit_reset(port, pin);
+    loop_mode_set(port, kModeOutput, 0, pin);
+}
+
+void loop_pins_af(Port *port, uint32_t af, uint32_t pin)
+{
+    loop_af_set(port, af, pin);
+    loop_mode_set(port, kModeAf, 0, pin);
+}
+
+/* ---------------- lut: 4位一组查表 ---------------- */
+
+/** 4位掩码展开为2位字段(8位)和4位字段(16位) */
+constexpr uint8_t kSpread2[16] = {0x00, 0x01, 0x04, 0x05, 0x10, 0x11, 0x14, 0x15,
+                                  0x40, 0x41, 0x44, 0x45, 0x50, 0x51, 0x54, 0x55};
+constexpr uint16_t kSpread4[16] = {0x0000, 0x0001, 0x0010, 0x0011, 0x0100, 0x0101, 0x0110, 0x0111,
+                                   0x1000, 0x1001, 0x1010, 0x1011, 0x1100, 0x1101, 0x1110, 0x1111};
+
+inline uint32_t lut_spread2(uint32_t pin)
+{
+    return static_cast<uint32_t>(kSpread2[pin & 0xFU]) | (static_cast<uint32_t>(kSpread2[(pin >> 4) & 0xFU]) << 8) |
+           (static_cast<uint32_t>(kSpread2[(pin >> 8) & 0xFU]) << 16) |
+           (static_cast<uint32_t>(kSpread2[(pin >> 12) & 0xFU]) << 24);
+}
+
+inline uint32_t lut_spread4(uint32_t pin)
+{
+    return static_cast<uint32_t>(kSpread4[pin & 0xFU]) | (static_cast<uint32_t>(kSpread4[(pin >> 4) & 0xFU]) << 16);
+}
+
+/* ---------------- 与 cap_fast.h 相同的写法，展开函数作为模板参数 ---------------- */
+
+template <uint32_t (*Spread2)(uint32_t)>
+inline void fast_mode_set(Port *port, uint32_t mode, uint32_t pupd, uint32_t pin)
+{
+    uint32_t field = Spread2(pin);
+
+    port->ctl = (port->ctl & ~(field * 0x3U)) | (field * (mode & 0x3U));
+    port->pud = (port->pud & ~(field * 0x3U)) | (field * (pupd & 0x3U));
+}
+
+template <uint32_t (*Spread4)(uint32_t)>
+inline void fast_af_set(Port *port, uint32_t af, uint32_t pin)
+{
+    af &= 0xFU;
+    if (pin & 0x00FFU) {
+        uint32_t field = Spread4(pin);
+        port->afsel0   = (port->afsel0 & ~(field * 0xFU)) | (field * af);
+    }
+    if (pin & 0xFF00U) {
+        uint32_t field = Spread4(pin >> 8);
+        port->afsel1   = (port->afsel1 & ~(field * 0xFU)) | (field * af);
+    }
+}
+
+template <uint32_t (*Spread2)(uint32_t)>
+inline void fast_output_low(Port *port, uint32_t pin)
+{
+    uint32_t field = Spread2(pin);
+
+    port->bc  = pin & 0xFFFFU;
+    port->ctl = (port->ctl & ~(field * 0x3U)) | (field * kModeOutput);
+}
+
+template <uint32_t (*Spread2)(uint32_t), uint32_t (*Spread4)(uint32_t)>
+inline void fast_pins_af(Port *port, uint32_t af, uint32_t pin)
+{
+    uint32_t field = Spread2(pin);
+
+    fast_af_set<Spread4>(port, af, pin);
+    port->ctl = (port->ctl & ~(field * 0x3U)) | (field * kModeAf);
+}
+
+/**
+ * @brief 测试方法
+ */
+struct Method {
+    const char *name;
+    void (*mode_set)(Port *, uint32_t, uint32_t, uint32_t);
+    void (*af_set)(Port *, uint32_t, uint32_t);
+    void (*output_low)(Port *, uint32_t);
+    void (*pins_af)(Port *, uint32_t, uint32_t);
+};
+
+const Method kMethods[] = {
+    {"loop", loop_mode_set, loop_af_set, loop_output_low, loop_pins_af},
+    {"lut", fast_mode_set<lut_spread2>, fast_af_set<lut_spread4>, fast_output_low<lut_spread2>,
+     fast_pins_af<lut_spread2, lut_spread4>},
+    {"bits", fast_mode_set<cap_bits_spread2>, fast_af_set<cap_bits_spread4>, fast_output_low<cap_bits_spread2>,
+     fast_pins_af<cap_bits_spread2, cap_bits_spread4>},
+};
+
+/** 伪随机数(xorshift32) */
+uint32_t next_random(uint32_t *state)
+{
+    uint32_t x = *state;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+bool same(const Port &a, const Port &b)
+{
+    return a.ctl == b.ctl && a.pud == b.pud && a.afsel0 == b.afsel0 && a.afsel1 == b.afsel1 && a.bc == b.bc;
+}
+
+void copy(Port *dst, const Port &src)
+{
+    dst->ctl    = src.ctl;
+    dst->pud    = src.pud;
+    dst->afsel0 = src.afsel0;
+    dst->afsel1 = src.afsel1;
+    dst->bc     = src.bc;
+}
+
+/**
+ * @brief 对所有掩码检查各方法与loop结果一致
+ * @return uint32_t 不一致的次数
+ */
+uint32_t verify()
+{
+    uint32_t seed       = 0x12345678U;
+    uint32_t mismatches = 0;
+
+    for (uint32_t pin = 0; pin <= 0xFFFFU; pin++) {
+        Port     init;
+        uint32_t mode = pin & 0x3U;
+        uint32_t pupd = (pin >> 2) & 0x3U;
+        uint32_t af   = (pin >> 4) & 0xFU;
+
+        init.ctl    = next_random(&seed);
+        init.pud    = next_random(&seed);
+        init.afsel0 = next_random(&seed);
+        init.afsel1 = next_random(&seed);
+        init.bc     = 0;
+
+        for (const Method &m : kMethods) {
+            Port ref, out;
+
+            copy(&ref, init);
+            copy(&out, init);
+            kMethods[0].mode_set(&ref, mode, pupd, pin);
+            kMethods[0].af_set(&ref, af, pin);
+            m.mode_set(&out, mode, pupd, pin);
+            m.af_set(&out, af, pin);
+            if (!same(ref, out)) { mismatches++; }
+
+            /* 组合操作不改上下拉，触摸引脚初始化时已配置为无上下拉 */
+            copy(&ref, init);
+            copy(&out, init);
+            ref.pud = 0;
+            out.pud = 0;
+            kMethods[0].output_low(&ref, pin);
+            m.output_low(&out, pin);
+            if (!same(ref, out)) { mismatches++; }
+
+            copy(&ref, init);
+            copy(&out, init);
+            ref.pud = 0;
+            out.pud = 0;
+            kMethods[0].pins_af(&ref, af, pin);
+            m.pins_af(&out, af, pin);
+            if (!same(ref, out)) { mismatches++; }
+        }
+    }
+
+    return mismatches;
+}
+
+uint64_t now_ns()
+{
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+            .count());
+}
+
+double ns_per_call(uint64_t start, uint64_t calls)
+{
+    return static_cast<double>(now_ns() - start) / static_cast<double>(calls);
+}
+
+/**
+ * @brief 测量一种方法: 模式设置、复用功能设置、通道切换(放电 + 充电)
+ */
+void bench(const Method &m, const std::vector<uint16_t> &pins, uint64_t calls, const char *label)
+{
+    Port     port  = {};
+    size_t   n     = pins.size();
+    uint64_t start = now_ns();
+
+    for (uint64_t i = 0; i < calls; i++) {
+        m.mode_set(&port, kModeAf, 0, pins[i % n]);
+    }
+    double mode_ns = ns_per_call(start, calls);
+
+    start = now_ns();
+    for (uint64_t i = 0; i < calls; i++) {
+        m.af_set(&port, 1, pins[i % n]);
+    }
+    double af_ns = ns_per_call(start, calls);
+
+    start = now_ns();
+    for (uint64_t i = 0; i < calls; i++) {
+        m.output_low(&port, pins[i % n]);
+        m.pins_af(&port, 1, pins[i % n]);
+    }
+    double switch_ns = ns_per_call(start, calls);
+
+    std::printf("%-6s %-8s mode_set %6.2f ns, af_set %6.2f ns, discharge+charge %6.2f ns\n", m.name, label, mode_ns,
+                af_ns, switch_ns);
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    uint64_t millions = kDefaultMillions;
+    int      opt;
+
+    while ((opt = getopt(argc, argv, "n:h")) != -1) {
+        switch (opt) {
+        case 'n': millions = std::strtoull(optarg, nullptr, 0); break;
+        default:
+            std::fprintf(stderr, "usage: %s [-n millions]\n", argv[0]);
+            return opt == 'h' ? 0 : 2;
+        }
+    }
+
+    uint32_t mismatches = verify();
+    std::printf("verify: 65536 masks x %zu methods, %u mismatches: %s\n", sizeof(kMethods) / sizeof(kMethods[0]),
+                mismatches, mismatches == 0 ? "PASS" : "FAIL");
+
+    /* 触摸通道切换: 单个引脚(PA0-PA3, PA6, PA7)；接近检测和通用场合: 随机多引脚 */
+    std::vector<uint16_t> single = {0x0001, 0x0002, 0x0004, 0x0008, 0x0040, 0x0080};
+    std::vector<uint16_t> multi(4096);
+    uint32_t              seed = 0xCAFEF00DU;
+
+    for (uint16_t &pin : multi) {
+        pin = static_cast<uint16_t>(next_random(&seed));
+    }
+
+    uint64_t calls = millions * 1000000U;
+    for (const Method &m : kMethods) {
+        bench(m, single, calls, "single");
+    }
+    for (const Method &m : kMethods) {
+        bench(m, multi, calls, "multi");
+    }
+
+    return mismatches == 0 ? 0 : 1;
+}
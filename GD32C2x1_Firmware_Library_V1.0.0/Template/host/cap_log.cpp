@@ -0,0 +1,167 @@
+/**
+ * @file cap_log.cpp
+ * @brief 电容触摸数据流记录文件(带索引)实现
+ * @version 1.0
+ * @date 2025-11-01
+ */
+
+#include "cap_log.h"
+
+#include <cstring>
+#include <ctime>
+#include <sys/types.h>
+
+namespace cap {
+
+namespace {
+
+constexpr char kLogMagic[8] = "CAPLOG1";
+constexpr char kIdxMagic[8] = "CAPIDX1";
+
+/** 写入缓冲区大小 */
+constexpr size_t kWriteBuffer = 1 << 20;
+
+} // namespace
+
+bool LogWriter::open(const std::string &path, StreamFormat format)
+{
+    LogHeader header;
+    timespec  ts;
+
+    close();
+    failed_  = false;
+    records_ = 0;
+
+    log_ = std::fopen(path.c_str(), "wb");
+    if (log_ == nullptr) { return false; }
+    idx_ = std::fopen((path + ".idx").c_str(), "wb");
+    if (idx_ == nullptr) {
+        close();
+        return false;
+    }
+    std::setvbuf(log_, nullptr, _IOFBF, kWriteBuffer);
+
+    clock_gettime(CLOCK_REALTIME, &ts);
+    std::memcpy(header.magic, kLogMagic, sizeof(header.magic));
+    header.version       = kLogVersion;
+    header.format        = static_cast<uint32_t>(format);
+    header.start_unix_ns = static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+    header.start_host_ns = monotonic_ns();
+
+    failed_ = std::fwrite(&header, sizeof(header), 1, log_) != 1 || std::fwrite(kIdxMagic, 8, 1, idx_) != 1;
+    offset_ = sizeof(header);
+    return !failed_;
+}
+
+void LogWriter::on_frame(const Frame &frame)
+{
+    LogRecord record;
+
+    if (log_ == nullptr || failed_) { return; }
+
+    if (records_ % kLogIndexInterval == 0) {
+        IndexEntry entry = {records_, offset_, frame.host_ns};
+        if (std::fwrite(&entry, sizeof(entry), 1, idx_) != 1) { failed_ = true; }
+    }
+
+    record.host_ns = frame.host_ns;
+    record.size    = frame.size;
+    if (std::fwrite(&record, sizeof(record), 1, log_) != 1 || std::fwrite(frame.data, frame.size, 1, log_) != 1) {
+        failed_ = true;
+    }
+
+    records_++;
+    offset_ += sizeof(record) + frame.size;
+}
+
+void LogWriter::close()
+{
+    if (log_ != nullptr && std::fclose(log_) != 0) { failed_ = true; }
+    if (idx_ != nullptr && std::fclose(idx_) != 0) { failed_ = true; }
+    log_ = nullptr;
+    idx_ = nullptr;
+}
+
+bool LogReader::open(const std::string &path)
+{
+    char magic[8];
+
+    close();
+
+    log_ = std::fopen(path.c_str(), "rb");
+    if (log_ == nullptr) { return false; }
+    if (std::fread(&header_, sizeof(header_), 1, log_) != 1 || std::memcmp(header_.magic, kLogMagic, 8) != 0 ||
+        header_.version != kLogVersion) {
+        close();
+        return false;
+    }
+
+    idx_ = std::fopen((path + ".idx").c_str(), "rb");
+    if (idx_ != nullptr) {
+        if (std::fread(magic, 8, 1, idx_) == 1 && std::memcmp(magic, kIdxMagic, 8) == 0 &&
+            fseeko(idx_, 0, SEEK_END) == 0) {
+            idx_count_ = (static_cast<uint64_t>(ftello(idx_)) - 8) / sizeof(IndexEntry);
+        } else {
+            std::fclose(idx_);
+            idx_ = nullptr;
+        }
+    }
+
+    return true;
+}
+
+bool LogReader::read_index(uint64_t i, IndexEntry &entry)
+{
+    return fseeko(idx_, static_cast<off_t>(8 + i * sizeof(IndexEntry)), SEEK_SET) == 0 &&
+           std::fread(&entry, sizeof(entry), 1, idx_) == 1;
+}
+
+bool LogReader::seek(uint64_t offset_ns)
+{
+    uint64_t   target = header_.start_host_ns + offset_ns;
+    uint64_t   lo     = 0;
+    uint64_t   hi     = idx_count_;
+    IndexEntry entry;
+
+    if (idx_ == nullptr || idx_count_ == 0) { return false; }
+
+    /* 最后一个接收时间不晚于目标的索引项 */
+    while (hi - lo > 1) {
+        uint64_t mid = lo + (hi - lo) / 2;
+
+        if (!read_index(mid, entry)) { return false; }
+        if (entry.host_ns <= target) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+
+    return read_index(lo, entry) && fseeko(log_, static_cast<off_t>(entry.offset), SEEK_SET) == 0;
+}
+
+bool LogReader::next(Frame &frame)
+{
+    LogRecord record;
+
+    if (log_ == nullptr || std::fread(&record, sizeof(record), 1, log_) != 1) { return false; }
+    if (record.size > sizeof(buf_) || std::fread(buf_, record.size, 1, log_) != 1) { return false; }
+
+    frame.type    = (format() == StreamFormat::Legacy) ? CAP_PROTO_TYPE_RAW : buf_[3];
+    frame.seq     = 0;
+    frame.host_ns = record.host_ns;
+    frame.data    = buf_;
+    frame.size    = record.size;
+    return true;
+}
+
+void LogReader::close()
+{
+    if (log_ != nullptr) { std::fclose(log_); }
+    if (idx_ != nullptr) { std::fclose(idx_); }
+    log_       = nullptr;
+    idx_       = nullptr;
+    idx_count_ = 0;
+}
+
+} // namespace cap
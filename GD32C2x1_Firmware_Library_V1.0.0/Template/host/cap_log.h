@@ -0,0 +1,141 @@
+/**
+ * @file cap_log.h
+ * @brief 电容触摸数据流记录文件(带索引)
+ * @version 1.0
+ * @date 2025-11-01
+ *
+ * 记录文件(.caplog)只保存校验正确的帧，每帧附带接收时间:
+ *
+ * | 内容       | 说明                                            |
+ * |------------|-------------------------------------------------|
+ * | LogHeader  | 文件头: 魔数、版本、数据流格式、开始时间         |
+ * | 记录...    | LogRecord(接收时间 + 帧长度) + 完整帧(原样保存) |
+ *
+ * 索引文件(.caplog.idx)每kLogIndexInterval条记录保存一个IndexEntry(记录号、
+ * 文件偏移、接收时间)，按时间定位时二分查找索引，不需要读入整个文件。
+ * 写入和读取都是流式的，内存占用与记录长度无关。
+ */
+
+#ifndef CAP_LOG_H_
+#define CAP_LOG_H_
+
+#include "cap_stream.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+namespace cap {
+
+/** 每多少条记录保存一个索引项 */
+constexpr uint32_t kLogIndexInterval = 1024;
+
+/** 记录文件版本 */
+constexpr uint32_t kLogVersion = 1;
+
+#pragma pack(push, 1)
+/**
+ * @brief 记录文件头
+ */
+struct LogHeader {
+    char     magic[8];      /*!< "CAPLOG1" */
+    uint32_t version;       /*!< kLogVersion */
+    uint32_t format;        /*!< StreamFormat */
+    uint64_t start_unix_ns; /*!< 开始记录的系统时间(纳秒) */
+    uint64_t start_host_ns; /*!< 开始记录的CLOCK_MONOTONIC时间，与记录的接收时间同一时基 */
+};
+
+/**
+ * @brief 记录头，后跟size字节的完整帧
+ */
+struct LogRecord {
+    uint64_t host_ns; /*!< 接收时间 */
+    uint16_t size;    /*!< 帧长度 */
+};
+
+/**
+ * @brief 索引项
+ */
+struct IndexEntry {
+    uint64_t record;  /*!< 记录号 */
+    uint64_t offset;  /*!< 记录在记录文件中的偏移 */
+    uint64_t host_ns; /*!< 记录的接收时间 */
+};
+#pragma pack(pop)
+
+/**
+ * @brief 记录文件写入，作为FrameSink接在解码器后面
+ */
+class LogWriter : public FrameSink {
+public:
+    ~LogWriter() override { close(); }
+
+    /**
+     * @brief 创建记录文件和索引文件(path + ".idx")
+     * @return true: 成功
+     */
+    bool open(const std::string &path, StreamFormat format);
+
+    void on_frame(const Frame &frame) override;
+
+    /**
+     * @brief 写入缓冲区中的数据并关闭文件
+     */
+    void close();
+
+    uint64_t records() const { return records_; }
+    bool     failed() const { return failed_; }
+
+private:
+    FILE    *log_     = nullptr;
+    FILE    *idx_     = nullptr;
+    uint64_t records_ = 0;
+    uint64_t offset_  = 0;
+    bool     failed_  = false;
+};
+
+/**
+ * @brief 记录文件读取
+ */
+class LogReader {
+public:
+    ~LogReader() { close(); }
+
+    /**
+     * @brief 打开记录文件，索引文件不存在时只能从头读取
+     * @return true: 成功
+     */
+    bool open(const std::string &path);
+
+    /**
+     * @brief 定位到开始记录后指定时间的第一条记录(按索引，精度为一个索引间隔)
+     * @return true: 成功
+     */
+    bool seek(uint64_t offset_ns);
+
+    /**
+     * @brief 读取下一条记录
+     *
+     * @param frame 返回的帧，data指向内部缓冲区，下一次调用前有效
+     * @return true: 成功; false: 文件结束或记录损坏
+     */
+    bool next(Frame &frame);
+
+    void close();
+
+    const LogHeader &header() const { return header_; }
+    StreamFormat     format() const { return static_cast<StreamFormat>(header_.format); }
+
+private:
+    bool read_index(uint64_t i, IndexEntry &entry);
+
+    FILE     *log_ = nullptr;
+    FILE     *idx_ = nullptr;
+    uint64_t  idx_count_ = 0;
+    LogHeader header_    = {};
+    uint8_t   buf_[CAP_PROTO_MAX_FRAME];
+};
+
+} // namespace cap
+
+#endif /* CAP_LOG_H_ */
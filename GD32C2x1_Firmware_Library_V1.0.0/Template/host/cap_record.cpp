@@ -0,0 +1,239 @@
+/**
+ * @file cap_record.cpp
+ * @brief 电容触摸数据流记录工具(上位机)
+ * @version 1.0
+ * @date 2025-11-01
+ *
+ * 从串口设备、文件或stdin读取数据流，校验并重新同步后:
+ * - 可选地把校验正确的帧写入带索引的记录文件(见cap_log.h)
+ * - 周期性和结束时在stderr输出帧率、丢帧率和间隔直方图
+ *
+ * 也可以读取记录文件重新统计(使用记录时的接收时间)，按索引从指定时间开始。
+ * 解码器和记录文件的内存占用固定，可以连续记录数小时。
+ *
+ * 编译(Linux):
+ *   gcc -O2 -c ../cap_proto.c
+ *   g++ -O2 -std=c++17 -I.. cap_record.cpp cap_stream.cpp cap_log.cpp cap_proto.o -o cap_record
+ *
+ * 使用:
+ *   ./cap_record -o run.caplog /dev/ttyUSB0       # 串口(自动配置为921600bps raw)
+ *   ./cap_record -L -o old.caplog /dev/ttyUSB0    # 早期固件的0xA5A5帧
+ *   ./cap_record capture.bin                      # 统计文件
+ *   ./cap_record -r run.caplog -s 3600            # 从记录文件第3600秒开始统计
+ */
+
+#include "cap_log.h"
+#include "cap_stream.h"
+
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace {
+
+/** 读取块大小 */
+constexpr size_t kReadSize = 64 * 1024;
+
+volatile std::sig_atomic_t g_stop = 0;
+
+void on_signal(int)
+{
+    g_stop = 1;
+}
+
+void usage(const char *prog)
+{
+    std::fprintf(stderr,
+                 "usage: %s [options] [input]\n"
+                 "  input       serial device, capture file or '-' for stdin (default)\n"
+                 "  -L          legacy 0xA5A5 cap_frame_t stream\n"
+                 "  -b baud     serial baud rate (default 921600)\n"
+                 "  -o log      write an indexed log (log and log.idx)\n"
+                 "  -r          input is a log written with -o\n"
+                 "  -s seconds  with -r: start this many seconds into the log\n"
+                 "  -p seconds  print statistics periodically (default 10, 0 = only at the end)\n"
+                 "  -w us       histogram bin width in microseconds (default 50)\n",
+                 prog);
+}
+
+speed_t baud_to_speed(long baud)
+{
+    switch (baud) {
+    case 115200: return B115200;
+    case 230400: return B230400;
+    case 460800: return B460800;
+    case 921600: return B921600;
+    case 1000000: return B1000000;
+    case 2000000: return B2000000;
+    default: return 0;
+    }
+}
+
+/**
+ * @brief 串口设备配置为raw模式
+ */
+bool serial_config(int fd, long baud)
+{
+    termios tio;
+    speed_t speed = baud_to_speed(baud);
+
+    if (speed == 0) {
+        std::fprintf(stderr, "unsupported baud rate %ld\n", baud);
+        return false;
+    }
+    if (tcgetattr(fd, &tio) != 0) { return false; }
+
+    cfmakeraw(&tio);
+    cfsetispeed(&tio, speed);
+    cfsetospeed(&tio, speed);
+    tio.c_cflag |= CLOCAL | CREAD;
+    tio.c_cc[VMIN]  = 1;
+    tio.c_cc[VTIME] = 0;
+
+    return tcsetattr(fd, TCSANOW, &tio) == 0;
+}
+
+/**
+ * @brief 周期性统计输出
+ */
+class Progress {
+public:
+    explicit Progress(double period_s) : period_ns_(static_cast<uint64_t>(period_s * 1e9)) {}
+
+    void poll(const cap::StreamDecoder &decoder)
+    {
+        uint64_t now = cap::monotonic_ns();
+
+        if (period_ns_ == 0) { return; }
+        if (last_ns_ == 0) { last_ns_ = now; }
+        if (now - last_ns_ < period_ns_) { return; }
+
+        const cap::StreamStats &s  = decoder.stats();
+        double                  dt = static_cast<double>(now - last_ns_) / 1e9;
+
+        std::fprintf(stderr, "[%llu frames] %.1f frames/s, +%llu lost, +%llu crc errors\n",
+                     static_cast<unsigned long long>(s.frames), static_cast<double>(s.frames - frames_) / dt,
+                     static_cast<unsigned long long>(s.lost - lost_),
+                     static_cast<unsigned long long>(s.crc_errors - crc_errors_));
+
+        last_ns_    = now;
+        frames_     = s.frames;
+        lost_       = s.lost;
+        crc_errors_ = s.crc_errors;
+    }
+
+private:
+    uint64_t period_ns_;
+    uint64_t last_ns_    = 0;
+    uint64_t frames_     = 0;
+    uint64_t lost_       = 0;
+    uint64_t crc_errors_ = 0;
+};
+
+int replay_log(const char *path, double start_s, uint32_t bin_us, Progress &progress)
+{
+    cap::LogReader reader;
+    cap::Frame     frame;
+
+    if (!reader.open(path)) {
+        std::fprintf(stderr, "%s: not a capture log\n", path);
+        return 1;
+    }
+    if (start_s > 0 && !reader.seek(static_cast<uint64_t>(start_s * 1e9))) {
+        std::fprintf(stderr, "%s: cannot seek (missing index?)\n", path);
+        return 1;
+    }
+
+    cap::StreamDecoder decoder(reader.format(), bin_us);
+
+    while (!g_stop && reader.next(frame)) {
+        decoder.feed_frame(frame.data, frame.size, frame.host_ns, nullptr);
+        progress.poll(decoder);
+    }
+
+    decoder.report(stderr, true);
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    cap::StreamFormat format   = cap::StreamFormat::V1;
+    long              baud     = 921600;
+    const char       *log_path = nullptr;
+    bool              replay   = false;
+    double            start_s  = 0;
+    double            period_s = 10;
+    uint32_t          bin_us   = 50;
+    int               opt;
+
+    while ((opt = getopt(argc, argv, "Lb:o:rs:p:w:h")) != -1) {
+        switch (opt) {
+        case 'L': format = cap::StreamFormat::Legacy; break;
+        case 'b': baud = std::strtol(optarg, nullptr, 0); break;
+        case 'o': log_path = optarg; break;
+        case 'r': replay = true; break;
+        case 's': start_s = std::strtod(optarg, nullptr); break;
+        case 'p': period_s = std::strtod(optarg, nullptr); break;
+        case 'w': bin_us = static_cast<uint32_t>(std::strtoul(optarg, nullptr, 0)); break;
+        default: usage(argv[0]); return opt == 'h' ? 0 : 2;
+        }
+    }
+
+    const char *input = (optind < argc) ? argv[optind] : "-";
+    Progress    progress(period_s);
+
+    std::signal(SIGINT, on_signal);
+    std::signal(SIGTERM, on_signal);
+
+    if (replay) { return replay_log(input, start_s, bin_us, progress); }
+
+    int fd = STDIN_FILENO;
+    if (std::strcmp(input, "-") != 0) {
+        fd = ::open(input, O_RDONLY | O_NOCTTY);
+        if (fd < 0) {
+            std::perror(input);
+            return 1;
+        }
+    }
+    if (isatty(fd) && !serial_config(fd, baud)) {
+        std::fprintf(stderr, "%s: serial configuration failed\n", input);
+        return 1;
+    }
+
+    cap::StreamDecoder decoder(format, bin_us);
+    cap::LogWriter     writer;
+
+    if (log_path != nullptr && !writer.open(log_path, format)) {
+        std::perror(log_path);
+        return 1;
+    }
+
+    static uint8_t buf[kReadSize];
+
+    while (!g_stop) {
+        ssize_t n = ::read(fd, buf, sizeof(buf));
+
+        if (n < 0 && errno == EINTR) { continue; }
+        if (n <= 0) { break; }
+
+        decoder.feed(buf, static_cast<size_t>(n), cap::monotonic_ns(), log_path != nullptr ? &writer : nullptr);
+        progress.poll(decoder);
+    }
+
+    writer.close();
+    if (fd != STDIN_FILENO) { ::close(fd); }
+
+    decoder.report(stderr, true);
+    if (log_path != nullptr) {
+        std::fprintf(stderr, "log: %llu records%s\n", static_cast<unsigned long long>(writer.records()),
+                     writer.failed() ? " (write error)" : "");
+    }
+
+    return writer.failed() ? 1 : 0;
+}
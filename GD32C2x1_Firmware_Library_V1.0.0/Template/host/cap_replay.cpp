@@ -0,0 +1,369 @@
+/**
+ * @file cap_replay.cpp
+ * @brief 电容触摸数据处理回放工具(上位机)
+ * @version 1.0
+ * @date 2025-11-01
+ *
+ * 把记录的原始数据(cap_record的.caplog记录文件，或直接保存的串口数据流)逐次扫描输入
+ * 与固件相同的数据处理代码(cap_touch_proc.c)，输出触摸事件并与golden文件比较。
+ * 用于在上位机上以远高于实时的速度验证新的阈值和滤波参数。
+ *
+ * 事件文件每行一个事件:
+ *
+ *   <扫描序号> press <通道>     触摸
+ *   <扫描序号> release <通道>   释放
+ *   <扫描序号> veto on|off      保护通道屏蔽
+ *   <扫描序号> mode idle|active 扫描模式切换
+ *
+ * 记录的数据帧中没有接近检测的并联捕获值，回放时不进行接近检测；温度/电压补偿增益
+ * 固定为1.0。v1数据帧带有设备的触摸掩码，结束时输出回放结果与设备结果一致的扫描比例
+ * (使用与设备相同的参数时应为100%)。
+ *
+ * 编译(Linux):
+ *   gcc -O2 -c ../cap_proto.c ../cap_touch_proc.c
+ *   g++ -O2 -std=c++17 -I.. cap_replay.cpp cap_stream.cpp cap_log.cpp cap_proto.o cap_touch_proc.o -o cap_replay
+ *
+ * 使用:
+ *   ./cap_replay -u sessions/run_*.caplog            # 生成golden文件(<输入>.events)
+ *   ./cap_replay -c sessions/run_*.caplog            # 与golden文件比较
+ *   ./cap_replay -t 120 -c sessions/run_*.caplog     # 修改阈值后比较
+ *   ./cap_replay -e run.caplog                   # 事件输出到stdout
+ */
+
+#include "cap_log.h"
+#include "cap_stream.h"
+#include "cap_touch_proc.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <unistd.h>
+
+namespace {
+
+/** 差分/批量帧最多扫描次数 */
+constexpr uint8_t kMaxScans = CAP_PROTO_MAX_PAYLOAD / (1 + CAP_PROTO_CHANNELS) + 1;
+
+/** golden文件扩展名 */
+constexpr const char *kGoldenSuffix = ".events";
+
+/**
+ * @brief 回放参数
+ */
+struct ReplayConfig {
+    int      threshold[CAP_PROC_CHANNELS]; /*!< <0: 使用默认值 */
+    int      baseline_shift = -1;
+    int      quiet_frames   = -1;
+    int      idle_mask      = -1;
+    int      guard_mask     = -1;
+    bool     legacy         = false;
+    bool     compare        = false;
+    bool     update         = false;
+    bool     print          = false;
+
+    ReplayConfig()
+    {
+        for (int &t : threshold) {
+            t = -1;
+        }
+    }
+};
+
+/**
+ * @brief 单个记录的回放: 解码数据帧并逐次扫描处理
+ */
+class Replay : public cap::FrameSink {
+public:
+    Replay(const ReplayConfig &config, FILE *events) : events_(events)
+    {
+        cap_touch_proc_init(&proc_);
+
+        for (uint8_t i = 0; i < CAP_PROC_CHANNELS; i++) {
+            if (config.threshold[i] > 0) { proc_.track[i].threshold = static_cast<uint16_t>(config.threshold[i]); }
+        }
+        if (config.baseline_shift >= 0) { proc_.baseline_shift = static_cast<uint8_t>(config.baseline_shift); }
+        if (config.quiet_frames > 0) { proc_.quiet_frames_max = static_cast<uint16_t>(config.quiet_frames); }
+        if (config.idle_mask >= 0) { proc_.idle_pad_mask = static_cast<uint8_t>(config.idle_mask) & CAP_PROC_ALL_PADS; }
+        if (config.guard_mask >= 0) { proc_.guard_mask = static_cast<uint8_t>(config.guard_mask) & CAP_PROC_ALL_PADS; }
+    }
+
+    void on_frame(const cap::Frame &frame) override
+    {
+        cap_proto_raw_t scans[kMaxScans];
+        uint32_t        times_us[kMaxScans];
+        uint8_t         count = 0;
+
+        if (frame.size == cap::kLegacyFrameSize && frame.data[0] == 0xA5 && frame.data[1] == 0xA5) {
+            /* legacy帧没有触摸掩码 */
+            std::memcpy(scans[0].values, frame.data + 2, sizeof(scans[0].values));
+            scan(scans[0], false);
+            return;
+        }
+
+        const uint8_t *payload = frame.data + CAP_PROTO_HEADER_SIZE;
+        uint16_t       length  = static_cast<uint16_t>(frame.size - CAP_PROTO_HEADER_SIZE - CAP_PROTO_CRC_SIZE);
+
+        switch (frame.type) {
+        case CAP_PROTO_TYPE_RAW:
+            if (length != sizeof(cap_proto_raw_t)) { return; }
+            std::memcpy(&scans[0], payload, sizeof(cap_proto_raw_t));
+            count = 1;
+            break;
+        case CAP_PROTO_TYPE_DELTA: count = cap_proto_delta_decode(payload, length, scans, kMaxScans); break;
+        case CAP_PROTO_TYPE_BATCH: count = cap_proto_batch_decode(payload, length, scans, times_us, kMaxScans); break;
+        default: return;
+        }
+
+        for (uint8_t i = 0; i < count; i++) {
+            scan(scans[i], true);
+        }
+    }
+
+    uint64_t scans() const { return scans_; }
+    uint64_t events() const { return events_count_; }
+    uint64_t compared() const { return compared_; }
+    uint64_t agreed() const { return agreed_; }
+
+private:
+    void event(const char *name, const char *arg)
+    {
+        events_count_++;
+        if (events_ != nullptr) {
+            std::fprintf(events_, "%llu %s %s\n", static_cast<unsigned long long>(scans_), name, arg);
+        }
+    }
+
+    void scan(const cap_proto_raw_t &raw, bool have_mask)
+    {
+        uint32_t values[CAP_PROC_CHANNELS];
+        uint8_t  touch = proc_.touch_mask;
+        uint8_t  veto  = proc_.guard_veto;
+        uint8_t  idle  = proc_.idle;
+
+        for (uint8_t i = 0; i < CAP_PROC_CHANNELS; i++) {
+            values[i] = raw.values[i];
+        }
+
+        cap_touch_proc_frame(&proc_, values, cap_touch_proc_scan_mask(&proc_), 0, CAP_PROC_GAIN_ONE,
+                             CAP_PROC_GAIN_ONE);
+
+        for (uint8_t i = 0; i < CAP_PROC_CHANNELS; i++) {
+            uint8_t bit = static_cast<uint8_t>(1U << i);
+            char    ch[4];
+
+            if ((touch ^ proc_.touch_mask) & bit) {
+                std::snprintf(ch, sizeof(ch), "%u", i);
+                event((proc_.touch_mask & bit) ? "press" : "release", ch);
+            }
+        }
+        if (veto != proc_.guard_veto) { event("veto", proc_.guard_veto ? "on" : "off"); }
+        if (idle != proc_.idle) { event("mode", proc_.idle ? "idle" : "active"); }
+
+        if (have_mask) {
+            compared_++;
+            if (raw.touch_mask == proc_.touch_mask) { agreed_++; }
+        }
+        scans_++;
+    }
+
+    cap_touch_proc_t proc_;
+    FILE            *events_;
+    uint64_t         scans_        = 0;
+    uint64_t         events_count_ = 0;
+    uint64_t         compared_     = 0;
+    uint64_t         agreed_       = 0;
+};
+
+/**
+ * @brief 逐行比较两个事件文件
+ * @return long 第一个不同行的行号(从1开始)，相同时返回0
+ */
+long compare_files(FILE *a, FILE *b)
+{
+    char line_a[128];
+    char line_b[128];
+    long line = 0;
+
+    while (true) {
+        bool more_a = std::fgets(line_a, sizeof(line_a), a) != nullptr;
+        bool more_b = std::fgets(line_b, sizeof(line_b), b) != nullptr;
+
+        line++;
+        if (!more_a && !more_b) { return 0; }
+        if (more_a != more_b || std::strcmp(line_a, line_b) != 0) { return line; }
+    }
+}
+
+/**
+ * @brief 回放一个输入文件
+ *
+ * @param path 输入文件(.caplog或数据流)
+ * @param span_ns 返回记录覆盖的时长(仅记录文件)
+ * @return int 0: 通过; 1: 与golden不同或读取失败
+ */
+int replay_file(const std::string &path, const ReplayConfig &config, uint64_t &scans, uint64_t &span_ns)
+{
+    FILE          *events = nullptr;
+    std::string    golden = path + kGoldenSuffix;
+    cap::LogReader reader;
+    int            result = 0;
+
+    if (config.update) {
+        events = std::fopen(golden.c_str(), "w");
+    } else if (config.compare) {
+        events = std::tmpfile();
+    } else if (config.print) {
+        events = stdout;
+    }
+    if ((config.update || config.compare) && events == nullptr) {
+        std::perror(golden.c_str());
+        return 1;
+    }
+
+    Replay replay(config, events);
+
+    if (reader.open(path)) {
+        cap::StreamDecoder decoder(reader.format());
+        cap::Frame         frame;
+        uint64_t           first = 0;
+        uint64_t           last  = 0;
+
+        while (reader.next(frame)) {
+            if (first == 0) { first = frame.host_ns; }
+            last = frame.host_ns;
+            decoder.feed_frame(frame.data, frame.size, frame.host_ns, &replay);
+        }
+        span_ns += last - first;
+    } else {
+        FILE *in = std::fopen(path.c_str(), "rb");
+        if (in == nullptr) {
+            std::perror(path.c_str());
+            if (events != nullptr && events != stdout) { std::fclose(events); }
+            return 1;
+        }
+
+        cap::StreamDecoder decoder(config.legacy ? cap::StreamFormat::Legacy : cap::StreamFormat::V1);
+        static uint8_t     buf[64 * 1024];
+        size_t             n;
+
+        while ((n = std::fread(buf, 1, sizeof(buf), in)) > 0) {
+            decoder.feed(buf, n, 0, &replay);
+        }
+        std::fclose(in);
+    }
+
+    const char *status = "-";
+
+    if (config.compare) {
+        FILE *expected = std::fopen(golden.c_str(), "r");
+
+        std::rewind(events);
+        if (expected == nullptr) {
+            status = "NO GOLDEN";
+            result = 1;
+        } else {
+            long line = compare_files(events, expected);
+            std::fclose(expected);
+            if (line != 0) {
+                std::fprintf(stderr, "%s: first difference at line %ld\n", golden.c_str(), line);
+                status = "FAIL";
+                result = 1;
+            } else {
+                status = "PASS";
+            }
+        }
+    } else if (config.update) {
+        status = "UPDATED";
+    }
+
+    if (events != nullptr && events != stdout) { std::fclose(events); }
+
+    std::fprintf(stderr, "%s: %llu scans, %llu events", path.c_str(), static_cast<unsigned long long>(replay.scans()),
+                 static_cast<unsigned long long>(replay.events()));
+    if (replay.compared() > 0) {
+        std::fprintf(stderr, ", device mask agreement %.3f%%",
+                     100.0 * static_cast<double>(replay.agreed()) / static_cast<double>(replay.compared()));
+    }
+    std::fprintf(stderr, ": %s\n", status);
+
+    scans += replay.scans();
+    return result;
+}
+
+void usage(const char *prog)
+{
+    std::fprintf(stderr,
+                 "usage: %s [options] input...\n"
+                 "  input         .caplog written by cap_record, or a raw stream capture\n"
+                 "  -c            compare events with <input>.events\n"
+                 "  -u            write events to <input>.events (update golden files)\n"
+                 "  -e            print events to stdout\n"
+                 "  -L            raw captures are legacy 0xA5A5 streams\n"
+                 "  -t [ch:]thr   touch threshold for all channels or one channel\n"
+                 "  -B shift      baseline tracking shift (default %u)\n"
+                 "  -q frames     quiet frames before idle mode (default %u)\n"
+                 "  -i mask       idle mode pad mask\n"
+                 "  -G mask       guard pad mask\n",
+                 prog, CAP_PROC_BASELINE_SHIFT_DEFAULT, CAP_PROC_QUIET_FRAMES_DEFAULT);
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    ReplayConfig config;
+    int          opt;
+
+    while ((opt = getopt(argc, argv, "cueLt:B:q:i:G:h")) != -1) {
+        switch (opt) {
+        case 'c': config.compare = true; break;
+        case 'u': config.update = true; break;
+        case 'e': config.print = true; break;
+        case 'L': config.legacy = true; break;
+        case 't': {
+            const char *colon = std::strchr(optarg, ':');
+            if (colon != nullptr) {
+                long ch = std::strtol(optarg, nullptr, 0);
+                if (ch < 0 || ch >= CAP_PROC_CHANNELS) {
+                    usage(argv[0]);
+                    return 2;
+                }
+                config.threshold[ch] = static_cast<int>(std::strtol(colon + 1, nullptr, 0));
+            } else {
+                for (int &t : config.threshold) {
+                    t = static_cast<int>(std::strtol(optarg, nullptr, 0));
+                }
+            }
+            break;
+        }
+        case 'B': config.baseline_shift = static_cast<int>(std::strtol(optarg, nullptr, 0)); break;
+        case 'q': config.quiet_frames = static_cast<int>(std::strtol(optarg, nullptr, 0)); break;
+        case 'i': config.idle_mask = static_cast<int>(std::strtol(optarg, nullptr, 0)); break;
+        case 'G': config.guard_mask = static_cast<int>(std::strtol(optarg, nullptr, 0)); break;
+        default: usage(argv[0]); return opt == 'h' ? 0 : 2;
+        }
+    }
+
+    if (optind >= argc || (config.compare && config.update)) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    uint64_t scans   = 0;
+    uint64_t span_ns = 0;
+    int      failed  = 0;
+    uint64_t start   = cap::monotonic_ns();
+
+    for (int i = optind; i < argc; i++) {
+        failed += replay_file(argv[i], config, scans, span_ns);
+    }
+
+    double seconds = static_cast<double>(cap::monotonic_ns() - start) / 1e9;
+
+    std::fprintf(stderr, "%d files, %d failed, %llu scans in %.3f s (%.2f M scans/s", argc - optind, failed,
+                 static_cast<unsigned long long>(scans), seconds, static_cast<double>(scans) / seconds / 1e6);
+    if (span_ns > 0) { std::fprintf(stderr, ", %.0fx real time", static_cast<double>(span_ns) / 1e9 / seconds); }
+    std::fprintf(stderr, ")\n");
+
+    return failed != 0 ? 1 : 0;
+}
@@ -0,0 +1,282 @@
+/**
+ * @file cap_stream.cpp
+ * @brief 电容触摸数据流解码器(上位机)实现
+ * @version 1.0
+ * @date 2025-11-01
+ */
+
+#include "cap_stream.h"
+
+#include <cstring>
+#include <ctime>
+
+namespace cap {
+
+namespace {
+
+/** 批量帧最多扫描次数(每次扫描至少 cap_proto_raw_t 字节) */
+constexpr uint8_t kMaxBatchScans = CAP_PROTO_MAX_PAYLOAD / sizeof(cap_proto_raw_t) + 1;
+
+bool is_data_type(uint8_t type)
+{
+    return type == CAP_PROTO_TYPE_RAW || type == CAP_PROTO_TYPE_DELTA || type == CAP_PROTO_TYPE_BATCH;
+}
+
+} // namespace
+
+uint64_t monotonic_ns()
+{
+    timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+void Histogram::add(uint64_t value)
+{
+    uint64_t bin = value / bin_width_;
+
+    bins_[bin < kBins ? bin : kBins - 1]++;
+    count_++;
+    sum_ += value;
+    if (value < min_) { min_ = value; }
+    if (value > max_) { max_ = value; }
+}
+
+void Histogram::print(FILE *out, const char *title, const char *unit) const
+{
+    uint64_t peak = 0;
+
+    std::fprintf(out, "%s: count %llu", title, static_cast<unsigned long long>(count_));
+    if (count_ == 0) {
+        std::fprintf(out, "\n");
+        return;
+    }
+    std::fprintf(out, ", min %llu %s, mean %.1f %s, max %llu %s\n", static_cast<unsigned long long>(min_), unit,
+                 static_cast<double>(sum_) / static_cast<double>(count_), unit, static_cast<unsigned long long>(max_),
+                 unit);
+
+    for (uint64_t n : bins_) {
+        if (n > peak) { peak = n; }
+    }
+
+    /* 只输出非空桶，柱长按最大桶归一化到40字符 */
+    for (uint32_t i = 0; i < kBins; i++) {
+        if (bins_[i] == 0) { continue; }
+
+        int bar = static_cast<int>(bins_[i] * 40 / peak);
+        if (i == kBins - 1) {
+            std::fprintf(out, "  >=%6u %s %12llu %.*s\n", i * bin_width_, unit,
+                         static_cast<unsigned long long>(bins_[i]), bar, "########################################");
+        } else {
+            std::fprintf(out, "  %6u-%-6u %s %10llu %.*s\n", i * bin_width_, (i + 1) * bin_width_ - 1, unit,
+                         static_cast<unsigned long long>(bins_[i]), bar, "########################################");
+        }
+    }
+}
+
+StreamDecoder::StreamDecoder(StreamFormat format, uint32_t bin_us)
+    : format_(format), arrival_(bin_us), scan_(bin_us)
+{
+    cap_proto_parser_init(&parser_);
+}
+
+void StreamDecoder::feed(const uint8_t *data, size_t length, uint64_t host_ns, FrameSink *sink)
+{
+    chunk_ns_   = host_ns;
+    chunk_sink_ = sink;
+    stats_.bytes += length;
+
+    if (format_ == StreamFormat::Legacy) {
+        feed_legacy(data, length);
+        stats_.crc_errors = legacy_crc_;
+        stats_.skipped    = legacy_skip_;
+        return;
+    }
+
+    /* 解析器计数为32位，按差值累加到64位统计 */
+    uint32_t crc_errors = parser_.crc_errors;
+    uint32_t skipped    = parser_.skipped;
+
+    while (length > 0) {
+        uint32_t n = length > 0x10000000U ? 0x10000000U : static_cast<uint32_t>(length);
+
+        cap_proto_parser_feed(&parser_, data, n, on_proto_frame, this);
+        data += n;
+        length -= n;
+    }
+
+    stats_.crc_errors += static_cast<uint32_t>(parser_.crc_errors - crc_errors);
+    stats_.skipped += static_cast<uint32_t>(parser_.skipped - skipped);
+}
+
+void StreamDecoder::feed_frame(const uint8_t *frame, uint16_t size, uint64_t host_ns, FrameSink *sink)
+{
+    chunk_ns_   = host_ns;
+    chunk_sink_ = sink;
+    stats_.bytes += size;
+
+    if (format_ == StreamFormat::Legacy) {
+        deliver(CAP_PROTO_TYPE_RAW, 0, frame, size);
+    } else {
+        const auto *header = reinterpret_cast<const cap_proto_header_t *>(frame);
+        deliver(header->type, header->seq, frame, size);
+    }
+}
+
+void StreamDecoder::on_proto_frame(const cap_proto_header_t *header, const uint8_t *payload, void *ctx)
+{
+    auto    *self = static_cast<StreamDecoder *>(ctx);
+    uint16_t size = static_cast<uint16_t>(CAP_PROTO_HEADER_SIZE + header->length + CAP_PROTO_CRC_SIZE);
+
+    (void)payload;
+    self->deliver(header->type, header->seq, reinterpret_cast<const uint8_t *>(header), size);
+}
+
+/**
+ * @brief 丢弃legacy缓冲区首字节，并移动到下一个可能的包头
+ */
+void StreamDecoder::legacy_slip()
+{
+    uint16_t i;
+
+    for (i = 1; i < legacy_fill_; i++) {
+        if (legacy_buf_[i] == 0xA5) { break; }
+    }
+
+    std::memmove(legacy_buf_, legacy_buf_ + i, legacy_fill_ - i);
+    legacy_fill_ = static_cast<uint16_t>(legacy_fill_ - i);
+    legacy_skip_ += i;
+}
+
+void StreamDecoder::feed_legacy(const uint8_t *data, size_t length)
+{
+    while (length--) {
+        uint8_t byte = *data++;
+
+        if (legacy_fill_ == 0 && byte != 0xA5) {
+            legacy_skip_++;
+            continue;
+        }
+
+        legacy_buf_[legacy_fill_++] = byte;
+
+        while (legacy_fill_ > 0) {
+            if (legacy_fill_ >= 2 && legacy_buf_[1] != 0xA5) {
+                legacy_slip();
+                continue;
+            }
+            if (legacy_fill_ < kLegacyFrameSize) { break; }
+
+            uint16_t sum = 0;
+            uint16_t checksum;
+
+            for (uint16_t i = 2; i < 14; i += 2) {
+                sum = static_cast<uint16_t>(sum + (legacy_buf_[i] | (legacy_buf_[i + 1] << 8)));
+            }
+            checksum = static_cast<uint16_t>(legacy_buf_[14] | (legacy_buf_[15] << 8));
+
+            if (sum != checksum) {
+                legacy_crc_++;
+                legacy_slip();
+                continue;
+            }
+
+            deliver(CAP_PROTO_TYPE_RAW, 0, legacy_buf_, kLegacyFrameSize);
+            legacy_fill_ = 0;
+        }
+    }
+}
+
+void StreamDecoder::deliver(uint8_t type, uint16_t seq16, const uint8_t *data, uint16_t size)
+{
+    Frame frame;
+
+    /* 展开16位帧序号: 相对上一帧前进不超过半个周期，否则认为设备复位 */
+    if (format_ == StreamFormat::Legacy) {
+        seq_ = have_seq_ ? seq_ + 1 : 0;
+    } else if (!have_seq_) {
+        seq_ = seq16;
+    } else {
+        uint16_t diff = static_cast<uint16_t>(seq16 - static_cast<uint16_t>(seq_));
+
+        if (diff == 0 || diff >= 0x8000U) {
+            stats_.seq_resets++;
+            seq_ = (seq_ & ~0xFFFFULL) + 0x10000ULL + seq16;
+        } else {
+            stats_.lost += diff - 1U;
+            seq_ += diff;
+        }
+    }
+    have_seq_ = true;
+
+    if (stats_.frames == 0) { stats_.first_ns = chunk_ns_; }
+    stats_.last_ns = chunk_ns_;
+    stats_.frames++;
+    stats_.types[type]++;
+
+    if (is_data_type(type)) {
+        if (last_data_ns_ != 0) { arrival_.add((chunk_ns_ - last_data_ns_) / 1000U); }
+        last_data_ns_ = chunk_ns_;
+    }
+
+    /* 批量帧带设备时间戳，统计扫描间隔 */
+    if (type == CAP_PROTO_TYPE_BATCH && format_ == StreamFormat::V1) {
+        cap_proto_raw_t scans[kMaxBatchScans];
+        uint32_t        times_us[kMaxBatchScans];
+        uint16_t        length = static_cast<uint16_t>(size - CAP_PROTO_HEADER_SIZE - CAP_PROTO_CRC_SIZE);
+        uint8_t         count =
+            cap_proto_batch_decode(data + CAP_PROTO_HEADER_SIZE, length, scans, times_us, kMaxBatchScans);
+
+        for (uint8_t i = 0; i < count; i++) {
+            if (have_scan_us_) { scan_.add(static_cast<uint32_t>(times_us[i] - last_scan_us_)); }
+            have_scan_us_ = true;
+            last_scan_us_ = times_us[i];
+        }
+    }
+
+    if (chunk_sink_ != nullptr) {
+        frame.type    = type;
+        frame.seq     = seq_;
+        frame.host_ns = chunk_ns_;
+        frame.data    = data;
+        frame.size    = size;
+        chunk_sink_->on_frame(frame);
+    }
+}
+
+void StreamDecoder::report(FILE *out, bool histograms) const
+{
+    double seconds = static_cast<double>(stats_.last_ns - stats_.first_ns) / 1e9;
+    double total   = static_cast<double>(stats_.frames + stats_.lost);
+
+    std::fprintf(out, "bytes %llu, frames %llu, crc errors %llu, skipped bytes %llu\n",
+                 static_cast<unsigned long long>(stats_.bytes), static_cast<unsigned long long>(stats_.frames),
+                 static_cast<unsigned long long>(stats_.crc_errors), static_cast<unsigned long long>(stats_.skipped));
+
+    if (format_ == StreamFormat::V1) {
+        std::fprintf(out, "lost frames %llu (%.4f%%), seq resets %llu\n", static_cast<unsigned long long>(stats_.lost),
+                     total > 0 ? 100.0 * static_cast<double>(stats_.lost) / total : 0.0,
+                     static_cast<unsigned long long>(stats_.seq_resets));
+        std::fprintf(out, "types: raw %llu, delta %llu, batch %llu, telemetry %llu, ack %llu\n",
+                     static_cast<unsigned long long>(stats_.types[CAP_PROTO_TYPE_RAW]),
+                     static_cast<unsigned long long>(stats_.types[CAP_PROTO_TYPE_DELTA]),
+                     static_cast<unsigned long long>(stats_.types[CAP_PROTO_TYPE_BATCH]),
+                     static_cast<unsigned long long>(stats_.types[CAP_PROTO_TYPE_TELEMETRY]),
+                     static_cast<unsigned long long>(stats_.types[CAP_PROTO_TYPE_CMD_ACK]));
+    } else {
+        std::fprintf(out, "lost frames: n/a (legacy frames carry no sequence number)\n");
+    }
+
+    if (seconds > 0) {
+        std::fprintf(out, "duration %.3f s, %.1f frames/s, %.1f bytes/s\n", seconds,
+                     static_cast<double>(stats_.frames) / seconds, static_cast<double>(stats_.bytes) / seconds);
+    }
+
+    if (histograms) {
+        arrival_.print(out, "data frame arrival interval", "us");
+        if (scan_.count() > 0) { scan_.print(out, "scan interval (batch timestamps)", "us"); }
+    }
+}
+
+} // namespace cap
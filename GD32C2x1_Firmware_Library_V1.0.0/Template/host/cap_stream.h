@@ -0,0 +1,168 @@
+/**
+ * @file cap_stream.h
+ * @brief 电容触摸数据流解码器(上位机) - 帧校验、重新同步、丢帧和间隔统计
+ * @version 1.0
+ * @date 2025-11-01
+ *
+ * 支持两种数据流:
+ * - v1: cap_proto.h定义的帧(0xA5 0x5A同步字 + CRC-16)，帧序号用于统计丢帧
+ * - legacy: 早期固件的16字节cap_frame_t(0xA5A5包头 + 6个uint16 + 累加校验)，没有帧序号
+ *
+ * 解码器只保存一帧的缓冲区和固定大小的统计，内存占用与数据量无关，可用于长时间采集。
+ */
+
+#ifndef CAP_STREAM_H_
+#define CAP_STREAM_H_
+
+#include "cap_proto.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+namespace cap {
+
+/** 数据流格式 */
+enum class StreamFormat : uint32_t {
+    V1     = 0, /*!< cap_proto帧 */
+    Legacy = 1  /*!< 早期固件的cap_frame_t */
+};
+
+/** legacy帧: 0xA5A5(小端) + 6个uint16 + 6个uint16的累加和 */
+constexpr uint16_t kLegacyHeader    = 0xA5A5;
+constexpr uint16_t kLegacyFrameSize = 16;
+
+/**
+ * @brief 解码出的一帧
+ */
+struct Frame {
+    uint8_t        type;    /*!< CAP_PROTO_TYPE_xxx，legacy帧为CAP_PROTO_TYPE_RAW */
+    uint64_t       seq;     /*!< 展开的帧序号(不回绕)，legacy帧为帧计数 */
+    uint64_t       host_ns; /*!< 接收时间(纳秒，CLOCK_MONOTONIC) */
+    const uint8_t *data;    /*!< 完整帧(回调返回后失效) */
+    uint16_t       size;    /*!< 帧长度 */
+};
+
+/**
+ * @brief 帧接收接口
+ */
+class FrameSink {
+public:
+    virtual ~FrameSink() = default;
+    virtual void on_frame(const Frame &frame) = 0;
+};
+
+/**
+ * @brief 线性分桶直方图，超出范围的值计入最后一个桶
+ */
+class Histogram {
+public:
+    static constexpr uint32_t kBins = 64;
+
+    explicit Histogram(uint32_t bin_width) : bin_width_(bin_width == 0 ? 1 : bin_width) {}
+
+    void add(uint64_t value);
+    void print(FILE *out, const char *title, const char *unit) const;
+
+    uint64_t count() const { return count_; }
+
+private:
+    uint32_t bin_width_;
+    uint64_t bins_[kBins] = {};
+    uint64_t count_       = 0;
+    uint64_t sum_         = 0;
+    uint64_t min_         = UINT64_MAX;
+    uint64_t max_         = 0;
+};
+
+/**
+ * @brief 解码统计
+ */
+struct StreamStats {
+    uint64_t bytes        = 0; /*!< 输入字节数 */
+    uint64_t frames       = 0; /*!< 校验正确的帧数 */
+    uint64_t crc_errors   = 0; /*!< 校验错误次数 */
+    uint64_t skipped      = 0; /*!< 重新同步时丢弃的字节数(含填充字节) */
+    uint64_t lost         = 0; /*!< 帧序号间隔推算的丢帧数(仅v1) */
+    uint64_t seq_resets   = 0; /*!< 帧序号倒退(设备复位)的次数 */
+    uint64_t first_ns     = 0; /*!< 第一帧的接收时间 */
+    uint64_t last_ns      = 0; /*!< 最后一帧的接收时间 */
+    uint64_t types[256]   = {}; /*!< 各帧类型的帧数 */
+};
+
+/**
+ * @brief 数据流解码器
+ *
+ * 按块输入接收数据，每个校验正确的帧回调一次FrameSink。同时统计帧率、丢帧，
+ * 以及数据帧的到达间隔和批量帧中设备时间戳的扫描间隔直方图。
+ */
+class StreamDecoder {
+public:
+    /**
+     * @param format 数据流格式
+     * @param bin_us 间隔直方图的桶宽(微秒)
+     */
+    explicit StreamDecoder(StreamFormat format, uint32_t bin_us = 50);
+
+    /**
+     * @brief 输入一块接收数据
+     *
+     * @param data 数据
+     * @param length 长度
+     * @param host_ns 接收时间，同一块中的帧使用相同的接收时间
+     * @param sink 帧接收接口，可为nullptr
+     */
+    void feed(const uint8_t *data, size_t length, uint64_t host_ns, FrameSink *sink);
+
+    /**
+     * @brief 输入一个已校验的完整帧(例如从记录文件回放)
+     */
+    void feed_frame(const uint8_t *frame, uint16_t size, uint64_t host_ns, FrameSink *sink);
+
+    /**
+     * @brief 输出统计和直方图
+     *
+     * @param out 输出文件
+     * @param histograms 是否输出直方图
+     */
+    void report(FILE *out, bool histograms) const;
+
+    StreamFormat       format() const { return format_; }
+    const StreamStats &stats() const { return stats_; }
+
+private:
+    static void on_proto_frame(const cap_proto_header_t *header, const uint8_t *payload, void *ctx);
+
+    void feed_legacy(const uint8_t *data, size_t length);
+    void legacy_slip();
+    void deliver(uint8_t type, uint16_t seq16, const uint8_t *data, uint16_t size);
+
+    StreamFormat       format_;
+    cap_proto_parser_t parser_;
+    uint8_t            legacy_buf_[kLegacyFrameSize];
+    uint16_t           legacy_fill_ = 0;
+    uint64_t           legacy_crc_  = 0;
+    uint64_t           legacy_skip_ = 0;
+
+    StreamStats stats_;
+    bool        have_seq_    = false;
+    uint64_t    seq_         = 0;
+    uint64_t    last_data_ns_ = 0;
+    bool        have_scan_us_ = false;
+    uint32_t    last_scan_us_ = 0;
+    Histogram   arrival_;
+    Histogram   scan_;
+
+    /* feed()期间的当前块参数 */
+    uint64_t   chunk_ns_   = 0;
+    FrameSink *chunk_sink_ = nullptr;
+};
+
+/**
+ * @brief 读取CLOCK_MONOTONIC时间(纳秒)
+ */
+uint64_t monotonic_ns();
+
+} // namespace cap
+
+#endif /* CAP_STREAM_H_ */
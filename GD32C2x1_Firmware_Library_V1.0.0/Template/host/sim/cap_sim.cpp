@@ -0,0 +1,1944 @@
+/**
+ * @file cap_sim.cpp
+ * @brief GD32C2x1寄存器级外设仿真器实现(上位机)
+ * @version 1.0
+ * @date 2025-11-01
+ *
+ * 寄存器文件是按总线划分的静态数组。固件每次经过REG32等宏访问寄存器时:
+ * 1. 提交上一次访问: 与访问时的快照比较，变化的字交给外设模型的写处理
+ *    (写1清零、写0清零、置位/清零寄存器等在这里实现)
+ * 2. 推进CPU时间，依次处理到期的外设事件(计数器更新/比较、引脚充电越过
+ *    阈值、USART移位完成、ADC转换完成、SysTick回绕)，然后检查中断
+ * 3. 读处理: 计数器、输入状态、DMA剩余数等按当前时间刷新到寄存器文件
+ * 4. 记录本次访问并返回寄存器文件中的地址
+ *
+ * 同一地址被连续轮询而没有任何写入时，直接快进到下一个外设事件，
+ * 快进的时间计为空闲周期(用于估算CPU负载)。
+ */
+
+#include "cap_sim.h"
+#include "gd32c2x1.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <sys/mman.h>
+#include <ucontext.h>
+
+namespace cap {
+namespace sim {
+uint32_t *word(uint32_t addr);
+} // namespace sim
+} // namespace cap
+
+/* 仿真器内部直接读写寄存器文件，不经过访问钩子 */
+#undef REG32
+#define REG32(addr) (*cap::sim::word((uint32_t)(addr)))
+
+namespace cap {
+namespace sim {
+namespace {
+
+constexpr uint64_t kNever = ~0ULL;
+
+/* 内核时序(周期) */
+constexpr uint32_t kExceptionEntryCycles = 15U;
+constexpr uint32_t kExceptionExitCycles = 12U;
+constexpr uint32_t kDmaItemCycles = 4U;
+constexpr uint32_t kFlashSize = 0x10000U;
+constexpr uint32_t kFlashDwCycles = 1920U;      /* 双字编程约40us */
+constexpr uint32_t kFlashRowCycles = 7680U;     /* 快速编程一行约160us */
+constexpr uint32_t kFlashEraseCycles = 144000U; /* 页擦除约3ms */
+constexpr uint32_t kAdcChannelCycles = 1730U; /* (160.5 + 12.5)个ADC时钟，ADC时钟 = CK_SYS / 10 */
+constexpr uint32_t kRtcClockCycles = 1500U;      /* RTC时钟IRC32K(32kHz) */
+constexpr uint32_t kDeepsleepWakeCycles = 480U;  /* 深度睡眠唤醒约10us */
+
+/* 同一代码位置连续读同一地址、没有写入达到该次数时认为在轮询，快进 */
+constexpr uint32_t kPollSkip = 3U;
+
+/* 引脚输入阈值(相对VDD)，与cap_touch_comp的默认温漂/电压系数一起决定充电时间 */
+constexpr double kInputThreshold = 0.6;
+constexpr double kDriftTempPpm = 800.0;
+constexpr double kDriftVddPpm = 3000.0;
+
+constexpr int kIrqMin = -16;
+constexpr int kIrqCount = 48;
+
+/* ---------------- 寄存器文件 ---------------- */
+
+struct Region {
+    uint32_t base;
+    uint32_t size;
+    uint32_t *mem;
+};
+
+uint32_t g_apb[0x18000 / 4];
+uint32_t g_ahb1[0x4000 / 4];
+uint32_t g_ahb2[0x1800 / 4];
+uint32_t g_scs[0x1000 / 4];
+
+const Region kRegions[] = {
+    {APB_BUS_BASE, sizeof(g_apb), g_apb},
+    {AHB1_BUS_BASE, sizeof(g_ahb1), g_ahb1},
+    {AHB2_BUS_BASE, sizeof(g_ahb2), g_ahb2},
+    {SCS_BASE, sizeof(g_scs), g_scs},
+    {FLASH_BASE, kFlashSize, reinterpret_cast<uint32_t *>((uintptr_t)FLASH_BASE)},
+};
+
+uint32_t *find(uint32_t addr)
+{
+    for (const Region &r : kRegions) {
+        if (addr - r.base < r.size) { return &r.mem[(addr - r.base) >> 2]; }
+    }
+    return nullptr;
+}
+
+/* 寄存器文件中的地址反查外设地址(DMA把寄存器地址作为uint32_t写入) */
+bool storage_to_periph(uint32_t host, uint32_t *addr)
+{
+    for (const Region &r : kRegions) {
+        uint32_t mem = (uint32_t)(uintptr_t)r.mem;
+        if (host - mem < r.size) {
+            *addr = r.base + (host - mem);
+            return true;
+        }
+    }
+    return false;
+}
+
+/* ---------------- 仿真状态 ---------------- */
+
+struct Pending {
+    uint32_t addr;   /*!< 字对齐地址 */
+    uint32_t words;  /*!< 覆盖的字数 */
+    uint32_t snap[4];
+    uint8_t width;   /*!< 访问宽度(字节) */
+    bool force;      /*!< 窄写入的数据寄存器: 写入相同的值也要处理 */
+    uint8_t age;
+};
+
+constexpr int kMaxPending = 6;
+
+struct Timer {
+    uint32_t base;
+    int irq_cc;
+    int irq_up;
+    bool running;
+    uint64_t t0;
+    uint32_t cnt0;
+    uint32_t div;
+    uint32_t period;
+    uint64_t upd;   /*!< 下一次更新事件 */
+    uint64_t next;  /*!< 下一次事件(更新或比较) */
+};
+
+struct Pin {
+    bool loaded;
+    double r;
+    double c;
+    bool driven;
+    bool level;
+    double v0;
+    uint64_t t0;
+    double tau;      /*!< 周期 */
+    uint64_t cross;
+};
+
+struct DmaChan {
+    bool active;
+    uint32_t total;     /*!< 使能时的传输数(CNT寄存器读出的是剩余数) */
+    uint32_t remaining;
+    uint32_t index;
+    uint64_t next; /*!< M2M下一次传输时间 */
+};
+
+struct Usart {
+    bool busy;
+    bool full;
+    uint8_t tdata;
+    uint8_t shift;
+    uint64_t end;
+};
+
+struct SysTickState {
+    bool running;
+    uint64_t t0;
+    uint64_t next;
+    bool pending;
+};
+
+struct Rtc {
+    bool running;   /*!< 时钟使能且不在初始化模式 */
+    uint64_t t0;    /*!< 亚秒计数器从同步预分频值开始计数的时间 */
+    uint32_t tick;  /*!< 亚秒计数一次的周期数 */
+    uint32_t syn;   /*!< 同步预分频值 */
+    uint64_t alarm; /*!< 下一次闹钟时间 */
+};
+
+uint64_t g_now;
+uint64_t g_until;
+uint64_t g_next_event = kNever;
+bool g_event_dirty = true;
+uint32_t g_access_cycles = 8U;
+
+Pending g_pending[kMaxPending];
+int g_npending;
+uint32_t g_last_addr;
+const void *g_last_site;
+uint32_t g_poll;
+
+/* 中断 */
+uint32_t g_primask;
+uint64_t g_irq_enabled; /*!< 下标IRQn */
+uint8_t g_prio[kIrqCount];
+uint32_t g_active_prio = 0x100U;
+uint32_t g_isr_depth;
+bool g_irq_dirty = true;
+
+Timer g_timers[] = {
+    {TIMER0, TIMER0_Channel_IRQn, TIMER0_TRG_CMT_UP_BRK_IRQn, false, 0, 0, 1, 0x10000, kNever, kNever},
+    {TIMER2, TIMER2_IRQn, TIMER2_IRQn, false, 0, 0, 1, 0x10000, kNever, kNever},
+    {TIMER13, TIMER13_IRQn, TIMER13_IRQn, false, 0, 0, 1, 0x10000, kNever, kNever},
+    {TIMER15, TIMER15_IRQn, TIMER15_IRQn, false, 0, 0, 1, 0x10000, kNever, kNever},
+    {TIMER16, TIMER16_IRQn, TIMER16_IRQn, false, 0, 0, 1, 0x10000, kNever, kNever},
+};
+
+Pin g_pins[6 * 16];
+DmaChan g_dma[3];
+Usart g_usart;
+SysTickState g_systick;
+Rtc g_rtc;
+uint32_t g_gpio_in[6]; /*!< EXTI边沿检测用的上一次输入状态 */
+uint32_t g_crc;
+uint64_t g_adc_end = kNever;
+
+struct Fmc {
+    uint64_t end;       /*!< 当前操作结束时间 */
+    bool erase;         /*!< 当前操作为页擦除 */
+    uint32_t page;
+    uint32_t key;       /*!< 解锁序列中已写入的密钥数 */
+    uint32_t row_words; /*!< 快速编程已写入的字数 */
+};
+
+Fmc g_fmc;
+
+double g_vdd = 3.3;
+double g_temp = 25.0;
+double g_noise;
+std::mt19937 g_rng;
+
+cap_sim_tx_callback_t g_tx_cb;
+void *g_tx_arg;
+cap_sim_stats_t g_stats;
+
+/* 协程 */
+ucontext_t g_host_ctx;
+ucontext_t g_fw_ctx;
+alignas(16) uint8_t g_fw_stack[512 * 1024];
+void (*g_entry)(void);
+bool g_finished;
+bool g_faulted;
+
+void yield()
+{
+    swapcontext(&g_fw_ctx, &g_host_ctx);
+}
+
+void fault(const char *what, uint32_t addr)
+{
+    fprintf(stderr, "sim: fault at %.6f s: %s (0x%08X)\n", (double)g_now / CAP_SIM_CORE_HZ, what, (unsigned)addr);
+    g_faulted = true;
+    for (;;) { yield(); }
+}
+
+} // namespace
+
+uint32_t *word(uint32_t addr)
+{
+    uint32_t *p = find(addr & ~3U);
+    if (p == nullptr) { fault("unmapped register", addr); }
+    return p;
+}
+
+namespace {
+
+void mark_dirty()
+{
+    g_event_dirty = true;
+    g_irq_dirty = true;
+}
+
+/* ---------------- TIMER ---------------- */
+
+Timer *timer_of(uint32_t base)
+{
+    for (Timer &t : g_timers) {
+        if (t.base == base) { return &t; }
+    }
+    return nullptr;
+}
+
+uint32_t timer_count(const Timer &t, uint64_t now)
+{
+    if (!t.running) { return t.cnt0; }
+    uint64_t ticks = (now - t.t0) / t.div;
+    if (t.cnt0 >= t.period) { return (uint32_t)((t.cnt0 + ticks) & 0xFFFFU); }
+    return (uint32_t)((t.cnt0 + ticks) % t.period);
+}
+
+/* 计数器重新以当前值为起点(PSC/CAR立即生效，不模拟影子寄存器) */
+void timer_rebase(Timer &t, uint32_t cnt)
+{
+    t.cnt0 = cnt & 0xFFFFU;
+    t.t0 = g_now;
+    t.div = (REG32(t.base + 0x28U) & 0xFFFFU) + 1U;
+    t.period = (REG32(t.base + 0x2CU) & 0xFFFFU) + 1U;
+    t.running = (REG32(t.base + 0x00U) & TIMER_CTL0_CEN) != 0U;
+    mark_dirty();
+}
+
+bool timer_channel_output(const Timer &t, int ch)
+{
+    uint32_t chctl = REG32(t.base + ((ch < 2) ? 0x18U : 0x1CU));
+    return ((chctl >> ((ch & 1) * 8)) & 3U) == 0U;
+}
+
+uint64_t timer_next(Timer &t)
+{
+    if (!t.running) {
+        t.upd = kNever;
+        return kNever;
+    }
+    /* 计数值大于CAR时先计到0xFFFF再回绕 */
+    uint32_t top = (t.cnt0 < t.period) ? t.period : 0x10000U;
+    t.upd = t.t0 + (uint64_t)(top - t.cnt0) * t.div;
+    uint64_t best = t.upd;
+    if (t.cnt0 < t.period) {
+        for (int ch = 0; ch < 4; ch++) {
+            if (!timer_channel_output(t, ch)) { continue; }
+            uint32_t cv = REG32(t.base + 0x34U + 4U * ch) & 0xFFFFU;
+            if (cv >= t.period) { continue; }
+            uint64_t dt = (cv > t.cnt0) ? (cv - t.cnt0) : (t.period - t.cnt0 + cv);
+            uint64_t at = t.t0 + dt * t.div;
+            if (at > g_now && at < best) { best = at; }
+        }
+    }
+    return best;
+}
+
+void adc_trigger(uint32_t source);
+
+void timer_event(Timer &t)
+{
+    if (g_now >= t.upd) {
+        REG32(t.base + 0x10U) |= TIMER_INTF_UPIF;
+        t.cnt0 = 0U;
+        t.t0 = t.upd;
+    }
+    uint32_t cnt = timer_count(t, g_now);
+    for (int ch = 0; ch < 4; ch++) {
+        if (!timer_channel_output(t, ch)) { continue; }
+        if ((REG32(t.base + 0x34U + 4U * ch) & 0xFFFFU) != cnt) { continue; }
+        REG32(t.base + 0x10U) |= (TIMER_INTF_CH0IF << ch);
+        if (t.base == TIMER15 && ch == 0) { adc_trigger(5U); }
+        if (t.base == TIMER0 && ch == 3) { adc_trigger(1U); }
+        if (t.base == TIMER13 && ch == 0) { adc_trigger(2U); }
+    }
+    mark_dirty();
+}
+
+void timer_write(Timer &t, uint32_t off, uint32_t old, uint32_t val)
+{
+    switch (off) {
+    case 0x00U: /* CTL0 */
+        if ((old ^ val) & TIMER_CTL0_CEN) { timer_rebase(t, timer_count(t, g_now)); }
+        mark_dirty();
+        break;
+    case 0x10U: /* INTF: 写0清零 */
+        REG32(t.base + off) = old & val;
+        g_irq_dirty = true;
+        break;
+    case 0x14U: /* SWEVG */
+        if (val & TIMER_SWEVG_UPG) {
+            timer_rebase(t, 0U);
+            if ((REG32(t.base) & TIMER_CTL0_UPS) == 0U) { REG32(t.base + 0x10U) |= TIMER_INTF_UPIF; }
+        }
+        REG32(t.base + off) = 0U;
+        break;
+    case 0x24U: /* CNT */
+    case 0x28U: /* PSC */
+    case 0x2CU: /* CAR */
+        timer_rebase(t, (off == 0x24U) ? val : timer_count(t, g_now));
+        break;
+    default:
+        mark_dirty();
+        break;
+    }
+}
+
+/* ---------------- GPIO与RC负载引脚 ---------------- */
+
+struct CaptureMap {
+    uint8_t pin;
+    uint8_t af;
+    uint32_t timer;
+    uint8_t ch;
+};
+
+/* 触摸引脚的复用映射(与cap_touch.c的g_touch_pads一致) */
+const CaptureMap kCaptureMap[] = {
+    {CAP_SIM_PIN(0, 0), 5, TIMER0, 0}, {CAP_SIM_PIN(0, 1), 5, TIMER0, 1},
+    {CAP_SIM_PIN(0, 2), 5, TIMER0, 2}, {CAP_SIM_PIN(0, 3), 5, TIMER0, 3},
+    {CAP_SIM_PIN(0, 6), 1, TIMER2, 0}, {CAP_SIM_PIN(0, 7), 1, TIMER2, 1},
+};
+
+uint32_t gpio_base(int port)
+{
+    return GPIO_BASE + 0x400U * (uint32_t)port;
+}
+
+double drift()
+{
+    return (1.0 + kDriftTempPpm * 1e-6 * (g_temp - 25.0)) * (1.0 - kDriftVddPpm * 1e-6 * (g_vdd - 3.3) / 0.1);
+}
+
+double pin_voltage(const Pin &p, uint64_t now)
+{
+    if (p.driven) { return p.level ? g_vdd : 0.0; }
+    if (p.r <= 0.0) { return p.v0; }
+    return g_vdd - (g_vdd - p.v0) * std::exp(-(double)(now - p.t0) / p.tau);
+}
+
+void timer_capture(int pin, bool rising)
+{
+    int port = pin / 16;
+    int n = pin % 16;
+    uint32_t base = gpio_base(port);
+    if (((REG32(base) >> (2 * n)) & 3U) != 2U) { return; }
+    uint32_t af = (REG32(base + ((n < 8) ? 0x20U : 0x24U)) >> (4 * (n & 7))) & 0xFU;
+
+    for (const CaptureMap &m : kCaptureMap) {
+        if (m.pin != pin || m.af != af) { continue; }
+        Timer *t = timer_of(m.timer);
+        uint32_t chctl = REG32(m.timer + ((m.ch < 2) ? 0x18U : 0x1CU)) >> ((m.ch & 1) * 8);
+        uint32_t chctl2 = REG32(m.timer + 0x20U) >> (4 * m.ch);
+        if ((chctl & 3U) != 1U || (chctl2 & 1U) == 0U) { return; }
+        bool falling_pol = (chctl2 & 2U) != 0U;
+        bool both = falling_pol && (chctl2 & 8U) != 0U;
+        if (!both && falling_pol == rising) { return; }
+
+        REG32(m.timer + 0x34U + 4U * m.ch) = timer_count(*t, g_now);
+        uint32_t &intf = REG32(m.timer + 0x10U);
+        if (intf & (TIMER_INTF_CH0IF << m.ch)) {
+            intf |= (TIMER_INTF_CH0OF << m.ch);
+            g_stats.capture_overruns++;
+        }
+        intf |= (TIMER_INTF_CH0IF << m.ch);
+        g_stats.captures++;
+        g_irq_dirty = true;
+        return;
+    }
+}
+
+/* 引脚开始向VDD充电(不驱动时)，计算越过输入阈值的时间 */
+void pin_release(Pin &p, uint64_t now)
+{
+    p.v0 = pin_voltage(p, now);
+    p.t0 = now;
+    p.driven = false;
+    p.cross = kNever;
+    if (p.r <= 0.0) { return; }
+    double c = p.c;
+    if (g_noise > 0.0) { c += std::normal_distribution<double>(0.0, g_noise)(g_rng); }
+    if (c < 0.1) { c = 0.1; }
+    p.tau = p.r * c * 1e-12 * drift() * CAP_SIM_CORE_HZ;
+    double vth = kInputThreshold * g_vdd;
+    if (p.v0 < vth) {
+        p.cross = now + 1U + (uint64_t)(p.tau * std::log((g_vdd - p.v0) / (g_vdd - vth)));
+    }
+}
+
+void exti_gpio_edges(int port);
+
+void gpio_update(int port)
+{
+    uint32_t base = gpio_base(port);
+    uint32_t ctl = REG32(base);
+    uint32_t octl = REG32(base + 0x14U);
+    for (int n = 0; n < 16; n++) {
+        Pin &p = g_pins[port * 16 + n];
+        if (!p.loaded) { continue; }
+        bool drive = ((ctl >> (2 * n)) & 3U) == 1U;
+        bool level = ((octl >> n) & 1U) != 0U;
+        if (drive) {
+            bool was_high = pin_voltage(p, g_now) >= kInputThreshold * g_vdd;
+            p.v0 = level ? g_vdd : 0.0;
+            p.driven = true;
+            p.level = level;
+            p.cross = kNever;
+            if (was_high && !level) { timer_capture(port * 16 + n, false); }
+        } else if (p.driven) {
+            pin_release(p, g_now);
+        }
+    }
+    exti_gpio_edges(port);
+    mark_dirty();
+}
+
+uint32_t gpio_input(int port)
+{
+    uint32_t base = gpio_base(port);
+    uint32_t ctl = REG32(base);
+    uint32_t octl = REG32(base + 0x14U);
+    uint32_t pud = REG32(base + 0x0CU);
+    uint32_t in = 0U;
+    for (int n = 0; n < 16; n++) {
+        const Pin &p = g_pins[port * 16 + n];
+        bool high;
+        if (p.loaded) {
+            high = pin_voltage(p, g_now) >= kInputThreshold * g_vdd;
+        } else if (((ctl >> (2 * n)) & 3U) == 1U) {
+            high = ((octl >> n) & 1U) != 0U;
+        } else {
+            high = ((pud >> (2 * n)) & 3U) == 1U;
+        }
+        if (high) { in |= 1U << n; }
+    }
+    return in;
+}
+
+void gpio_write(int port, uint32_t off, uint32_t old, uint32_t val)
+{
+    uint32_t base = gpio_base(port);
+    uint32_t &octl = REG32(base + 0x14U);
+    switch (off) {
+    case 0x10U: /* ISTAT只读 */
+        REG32(base + off) = old;
+        return;
+    case 0x18U: /* BOP */
+        octl = (octl | (val & 0xFFFFU)) & ~(val >> 16);
+        REG32(base + off) = 0U;
+        break;
+    case 0x28U: /* BC */
+        octl &= ~(val & 0xFFFFU);
+        REG32(base + off) = 0U;
+        break;
+    case 0x2CU: /* TG */
+        octl ^= (val & 0xFFFFU);
+        REG32(base + off) = 0U;
+        break;
+    case 0x00U:
+    case 0x0CU:
+    case 0x14U:
+    case 0x20U:
+    case 0x24U:
+        break;
+    default:
+        return;
+    }
+    gpio_update(port);
+}
+
+/* ---------------- DMA ---------------- */
+
+uint32_t dma_reg(int ch, uint32_t off)
+{
+    return DMA_BASE + 0x08U + 0x14U * (uint32_t)ch + off;
+}
+
+void periph_write(uint32_t addr, uint32_t old, uint32_t val, uint32_t width);
+void periph_read(uint32_t addr);
+
+/* DMA总线地址: 外设地址、寄存器文件中的地址或上位机内存 */
+bool bus_decode(uint32_t addr, uint32_t *periph)
+{
+    if (find(addr) != nullptr) {
+        *periph = addr;
+        return true;
+    }
+    return storage_to_periph(addr, periph);
+}
+
+uint32_t bus_read(uint32_t addr, uint32_t width)
+{
+    uint32_t periph = 0U;
+    if (bus_decode(addr, &periph)) {
+        periph_read(periph & ~3U);
+        uint32_t w = REG32(periph);
+        uint32_t shift = (periph & 3U) * 8U;
+        return (width == 4U) ? w : ((w >> shift) & ((1U << (width * 8U)) - 1U));
+    }
+    uint32_t v = 0U;
+    std::memcpy(&v, reinterpret_cast<const void *>((uintptr_t)addr), width);
+    return v;
+}
+
+void bus_write(uint32_t addr, uint32_t width, uint32_t v)
+{
+    uint32_t periph = 0U;
+    if (bus_decode(addr, &periph)) {
+        uint32_t &w = REG32(periph);
+        uint32_t old = w;
+        if (width == 4U) {
+            w = v;
+        } else {
+            uint32_t shift = (periph & 3U) * 8U;
+            uint32_t mask = ((1U << (width * 8U)) - 1U) << shift;
+            w = (w & ~mask) | ((v << shift) & mask);
+        }
+        periph_write(periph & ~3U, old, w, width);
+        return;
+    }
+    std::memcpy(reinterpret_cast<void *>((uintptr_t)addr), &v, width);
+}
+
+void dma_flag(int ch, uint32_t flags)
+{
+    REG32(DMA_BASE) |= (flags | DMA_INTF_GIF) << (4 * ch);
+    g_irq_dirty = true;
+}
+
+/* 执行一次传输 */
+void dma_transfer(int ch)
+{
+    DmaChan &d = g_dma[ch];
+    uint32_t ctl = REG32(dma_reg(ch, 0x00U));
+    uint32_t total = d.total;
+    uint32_t pw = 1U << ((ctl >> 8) & 3U);
+    uint32_t mw = 1U << ((ctl >> 10) & 3U);
+    uint32_t paddr = REG32(dma_reg(ch, 0x08U)) + ((ctl & DMA_CHXCTL_PNAGA) ? d.index * pw : 0U);
+    uint32_t maddr = REG32(dma_reg(ch, 0x0CU)) + ((ctl & DMA_CHXCTL_MNAGA) ? d.index * mw : 0U);
+
+    if (ctl & DMA_CHXCTL_DIR) {
+        bus_write(paddr, pw, bus_read(maddr, mw));
+    } else {
+        bus_write(maddr, mw, bus_read(paddr, pw));
+    }
+
+    d.index++;
+    d.remaining--;
+    if (d.remaining == total / 2U) { dma_flag(ch, DMA_INTF_HTFIF); }
+    if (d.remaining == 0U) {
+        dma_flag(ch, DMA_INTF_FTFIF);
+        if (ctl & DMA_CHXCTL_CMEN) {
+            d.remaining = total;
+            d.index = 0U;
+        } else {
+            d.active = false;
+        }
+    }
+}
+
+/* 外设DMA请求，返回是否有通道响应 */
+bool dma_request(uint32_t muxid)
+{
+    for (int ch = 0; ch < 3; ch++) {
+        if (!g_dma[ch].active) { continue; }
+        if ((REG32(dma_reg(ch, 0x00U)) & DMA_CHXCTL_M2M) != 0U) { continue; }
+        if ((REG32(DMAMUX_BASE + 4U * ch) & DMAMUX_RM_CHXCFG_MUXID) != muxid) { continue; }
+        dma_transfer(ch);
+        return true;
+    }
+    return false;
+}
+
+void usart_pump();
+
+void dma_write(uint32_t off, uint32_t old, uint32_t val)
+{
+    if (off == 0x04U) { /* INTC */
+        for (int ch = 0; ch < 3; ch++) {
+            uint32_t c = (val >> (4 * ch)) & 0xFU;
+            if (c & DMA_INTC_GIFC) { c = 0xFU; }
+            REG32(DMA_BASE) &= ~(c << (4 * ch));
+        }
+        REG32(DMA_BASE + off) = 0U;
+        g_irq_dirty = true;
+        return;
+    }
+    if (off == 0x00U) { /* INTF只读 */
+        REG32(DMA_BASE) = old;
+        return;
+    }
+    if (off < 0x08U || off >= 0x08U + 3U * 0x14U) { return; }
+    int ch = (int)((off - 0x08U) / 0x14U);
+    if ((off - 0x08U) % 0x14U != 0U) { return; }
+    DmaChan &d = g_dma[ch];
+    if ((val & DMA_CHXCTL_CHEN) && !(old & DMA_CHXCTL_CHEN)) {
+        d.total = REG32(dma_reg(ch, 0x04U)) & 0xFFFFU;
+        d.remaining = d.total;
+        d.index = 0U;
+        d.active = d.remaining != 0U;
+        d.next = (d.active && (val & DMA_CHXCTL_M2M)) ? g_now + kDmaItemCycles : kNever;
+        mark_dirty();
+        usart_pump();
+    } else if (!(val & DMA_CHXCTL_CHEN)) {
+        d.active = false;
+        d.next = kNever;
+        mark_dirty();
+    }
+    g_irq_dirty = true;
+}
+
+/* ---------------- USART0 ---------------- */
+
+bool usart_enabled()
+{
+    uint32_t ctl0 = REG32(USART0);
+    return (ctl0 & USART_CTL0_UEN) && (ctl0 & USART_CTL0_TEN);
+}
+
+void usart_load()
+{
+    if (g_usart.busy || !g_usart.full || !usart_enabled()) { return; }
+    uint32_t bit = REG32(USART0 + 0x0CU) & 0xFFFFU;
+    g_usart.shift = g_usart.tdata;
+    g_usart.full = false;
+    g_usart.busy = true;
+    g_usart.end = g_now + 10U * (uint64_t)(bit ? bit : 1U);
+    uint32_t &stat = REG32(USART0 + 0x1CU);
+    stat = (stat | USART_STAT_TBE) & ~USART_STAT_TC;
+    mark_dirty();
+}
+
+void usart_tdata(uint8_t v)
+{
+    g_usart.tdata = v;
+    g_usart.full = true;
+    REG32(USART0 + 0x1CU) &= ~(USART_STAT_TBE | USART_STAT_TC);
+    usart_load();
+    g_irq_dirty = true;
+}
+
+/* 发送缓冲空且使能了DMA发送时向DMA请求数据 */
+void usart_pump()
+{
+    while ((REG32(USART0 + 0x1CU) & USART_STAT_TBE) && (REG32(USART0 + 0x08U) & USART_CTL2_DENT) && usart_enabled()) {
+        if (!dma_request(DMA_REQUEST_USART0_TX)) { break; }
+    }
+}
+
+void usart_event()
+{
+    g_usart.busy = false;
+    g_stats.tx_bytes++;
+    if (g_tx_cb != nullptr) { g_tx_cb(g_usart.shift, g_tx_arg); }
+    usart_load();
+    usart_pump();
+    if (!g_usart.busy) { REG32(USART0 + 0x1CU) |= USART_STAT_TC; }
+    mark_dirty();
+}
+
+void usart_write(uint32_t off, uint32_t old, uint32_t val)
+{
+    switch (off) {
+    case 0x1CU: /* STAT只读 */
+        REG32(USART0 + off) = old;
+        return;
+    case 0x20U: /* INTC */
+        REG32(USART0 + 0x1CU) &= ~(val & (USART_INTC_IDLEC | USART_INTC_TCC | USART_INTC_OREC | USART_INTC_FEC));
+        REG32(USART0 + off) = 0U;
+        break;
+    case 0x28U: /* TDATA */
+        usart_tdata((uint8_t)val);
+        REG32(USART0 + off) = 0xFFFFFFFFU;
+        break;
+    default:
+        break;
+    }
+    usart_load();
+    usart_pump();
+    g_irq_dirty = true;
+}
+
+/* ---------------- CRC ---------------- */
+
+uint32_t crc_width()
+{
+    static const uint32_t kWidth[] = {32U, 16U, 8U, 7U};
+    return kWidth[(REG32(CRC_BASE + 0x08U) >> 3) & 3U];
+}
+
+uint32_t reverse_bits(uint32_t v, uint32_t bits)
+{
+    uint32_t r = 0U;
+    for (uint32_t i = 0U; i < bits; i++) { r |= ((v >> i) & 1U) << (bits - 1U - i); }
+    return r;
+}
+
+void crc_publish()
+{
+    uint32_t w = crc_width();
+    REG32(CRC_BASE) = (REG32(CRC_BASE + 0x08U) & CRC_CTL_REV_O) ? reverse_bits(g_crc, w) : g_crc;
+}
+
+void crc_reset()
+{
+    uint32_t w = crc_width();
+    g_crc = REG32(CRC_BASE + 0x10U) & ((w == 32U) ? 0xFFFFFFFFU : ((1U << w) - 1U));
+    crc_publish();
+}
+
+void crc_input(uint32_t data, uint32_t bytes)
+{
+    uint32_t ctl = REG32(CRC_BASE + 0x08U);
+    uint32_t w = crc_width();
+    uint32_t mask = (w == 32U) ? 0xFFFFFFFFU : ((1U << w) - 1U);
+    uint32_t poly = REG32(CRC_BASE + 0x14U) & mask;
+    uint32_t bits = bytes * 8U;
+
+    switch ((ctl >> 5) & 3U) {
+    case 1U:
+        for (uint32_t i = 0U; i < bytes; i++) {
+            uint32_t b = (data >> (8U * i)) & 0xFFU;
+            data = (data & ~(0xFFU << (8U * i))) | (reverse_bits(b, 8U) << (8U * i));
+        }
+        break;
+    case 2U:
+        for (uint32_t i = 0U; i < bytes; i += 2U) {
+            uint32_t h = (data >> (8U * i)) & 0xFFFFU;
+            data = (data & ~(0xFFFFU << (8U * i))) | (reverse_bits(h, 16U) << (8U * i));
+        }
+        break;
+    case 3U:
+        data = reverse_bits(data, bits);
+        break;
+    default:
+        break;
+    }
+
+    for (uint32_t i = 0U; i < bits; i++) {
+        uint32_t in = (data >> (bits - 1U - i)) & 1U;
+        uint32_t top = (g_crc >> (w - 1U)) & 1U;
+        g_crc = (g_crc << 1) & mask;
+        if (top ^ in) { g_crc ^= poly; }
+    }
+    crc_publish();
+}
+
+/* ---------------- ADC ---------------- */
+
+void adc_trigger(uint32_t source)
+{
+    uint32_t ctl1 = REG32(ADC_BASE + 0x08U);
+    if (!(ctl1 & ADC_CTL1_ADCON) || g_adc_end != kNever) { return; }
+    if (source != 7U && (!(ctl1 & ADC_CTL1_ETEIC) || ((ctl1 >> 12) & 7U) != source)) { return; }
+    uint32_t len = ((REG32(ADC_BASE + 0x38U) >> 20) & 3U) + 1U;
+    REG32(ADC_BASE) |= ADC_STAT_STIC;
+    g_adc_end = g_now + (uint64_t)len * kAdcChannelCycles;
+    mark_dirty();
+}
+
+uint32_t adc_sample(uint32_t ch)
+{
+    double v = 0.0;
+    if (ch == 13U) { v = 0.924 - 0.00252 * (g_temp - 25.0); }
+    if (ch == 14U) { v = 1.2; }
+    double raw = v / g_vdd * 4095.0 + 0.5;
+    return (raw > 4095.0) ? 4095U : (uint32_t)raw;
+}
+
+void adc_event()
+{
+    uint32_t isq = REG32(ADC_BASE + 0x38U);
+    uint32_t il = (isq >> 20) & 3U;
+    for (uint32_t r = 0U; r <= il; r++) {
+        uint32_t ch = (isq >> (15U - (il - r) * 5U)) & 0x1FU;
+        REG32(ADC_BASE + 0x3CU + 4U * r) = adc_sample(ch);
+    }
+    REG32(ADC_BASE) |= ADC_STAT_EOIC | ADC_STAT_EOC;
+    g_adc_end = kNever;
+    mark_dirty();
+}
+
+void adc_write(uint32_t off, uint32_t old, uint32_t val)
+{
+    if (off == 0x00U) { /* STAT: 写0清零 */
+        REG32(ADC_BASE) = old & val;
+    } else if (off == 0x08U) {
+        REG32(ADC_BASE + off) &= ~ADC_CTL1_SWICST;
+        if ((val & ADC_CTL1_SWICST) && ((val >> 12) & 7U) == 7U) { adc_trigger(7U); }
+    }
+    g_irq_dirty = true;
+}
+
+/* ---------------- FMC ---------------- */
+
+constexpr uint32_t kFmcStat = FMC_BASE + 0x10U;
+constexpr uint32_t kFmcCtl = FMC_BASE + 0x14U;
+
+void fmc_start(uint32_t cycles)
+{
+    REG32(kFmcStat) |= FMC_STAT_BUSY;
+    g_fmc.end = g_now + cycles;
+    mark_dirty();
+}
+
+/* 编程/擦除错误: 使能错误中断时同时置位OPRERR */
+void fmc_error(uint32_t flag)
+{
+    REG32(kFmcStat) |= flag | ((REG32(kFmcCtl) & FMC_CTL_ERRIE) ? FMC_STAT_OPRERR : 0U);
+    g_irq_dirty = true;
+}
+
+void fmc_event()
+{
+    if (g_fmc.erase) {
+        std::memset(reinterpret_cast<void *>((uintptr_t)(FLASH_BASE + g_fmc.page * 0x400U)), 0xFF, 0x400U);
+    }
+    REG32(kFmcStat) = (REG32(kFmcStat) & ~FMC_STAT_BUSY) | FMC_STAT_ENDF;
+    g_fmc.end = kNever;
+    g_fmc.erase = false;
+    g_irq_dirty = true;
+    mark_dirty();
+}
+
+void fmc_write(uint32_t off, uint32_t old, uint32_t val)
+{
+    uint32_t &ctl = REG32(kFmcCtl);
+    switch (off) {
+    case 0x08U: /* KEY: 按顺序写入两个密钥后解锁 */
+        if (val == FMC_UNLOCK_KEY0) {
+            g_fmc.key = 1U;
+        } else if (val == FMC_UNLOCK_KEY1 && g_fmc.key == 1U) {
+            ctl &= ~FMC_CTL_LK;
+            g_fmc.key = 0U;
+        } else {
+            g_fmc.key = 0U;
+        }
+        REG32(FMC_BASE + off) = 0U;
+        break;
+    case 0x10U: /* STAT: BUSY只读，其他写1清零 */
+        REG32(kFmcStat) = old & ~(val & ~FMC_STAT_BUSY);
+        break;
+    case 0x14U: /* CTL: 锁定时只能保持锁定 */
+        if (old & FMC_CTL_LK) {
+            ctl = old;
+            break;
+        }
+        if ((val & FMC_CTL_FSTPG) && !(old & FMC_CTL_FSTPG)) { g_fmc.row_words = 0U; }
+        if (val & FMC_CTL_START) {
+            ctl &= ~FMC_CTL_START;
+            if (REG32(kFmcStat) & FMC_STAT_BUSY) {
+                fmc_error(FMC_STAT_PGSERR);
+            } else if (val & FMC_CTL_PER) {
+                g_fmc.erase = true;
+                g_fmc.page = ((val & FMC_CTL_PN) >> CTL_PN_OFFSET) % (kFlashSize / 0x400U);
+                fmc_start(kFlashEraseCycles);
+            }
+        }
+        break;
+    default:
+        break;
+    }
+    g_irq_dirty = true;
+}
+
+/* Flash字写入: PG时写入双字的高位字开始编程，FSTPG时写满一行开始编程 */
+void flash_write(uint32_t addr, uint32_t old, uint32_t val)
+{
+    uint32_t ctl = REG32(kFmcCtl);
+    REG32(addr) = old;
+    /* 读访问和写入值相同的访问无法区分，不在编程模式时按读处理 */
+    if (val == old && !(ctl & (FMC_CTL_PG | FMC_CTL_FSTPG))) { return; }
+    if ((ctl & FMC_CTL_LK) || !(ctl & (FMC_CTL_PG | FMC_CTL_FSTPG)) || (REG32(kFmcStat) & FMC_STAT_BUSY)) {
+        fmc_error(FMC_STAT_PGSERR);
+        return;
+    }
+    if (ctl & FMC_CTL_FSTPG) {
+        if ((addr & (DOUBLEWORD_CNT_IN_ROW * 8U - 1U)) != 4U * g_fmc.row_words) {
+            fmc_error(FMC_STAT_PGAERR);
+            return;
+        }
+    }
+    if (old != 0xFFFFFFFFU) {
+        fmc_error(FMC_STAT_PGERR);
+        return;
+    }
+    REG32(addr) = val;
+    if (ctl & FMC_CTL_FSTPG) {
+        if (++g_fmc.row_words == DOUBLEWORD_CNT_IN_ROW * 2U) {
+            g_fmc.row_words = 0U;
+            fmc_start(kFlashRowCycles);
+        }
+    } else if (addr & 4U) {
+        fmc_start(kFlashDwCycles);
+    }
+}
+
+/* ---------------- RCU ---------------- */
+
+void reset_block(uint32_t base, uint32_t size);
+void rtc_update();
+
+struct ResetBit {
+    uint32_t reg;
+    uint32_t bit;
+    uint32_t base;
+};
+
+const ResetBit kResetBits[] = {
+    {0x24U, 9U, ADC_BASE},   {0x24U, 10U, TIMER0},  {0x24U, 11U, TIMER2},  {0x24U, 12U, SPI0},
+    {0x24U, 14U, USART0},    {0x24U, 16U, TIMER13}, {0x24U, 17U, TIMER15}, {0x24U, 18U, TIMER16},
+    {0x24U, 21U, I2C0},      {0x10U, 12U, CRC_BASE},
+};
+
+void rcu_write(uint32_t off, uint32_t old, uint32_t val)
+{
+    uint32_t &r = REG32(RCU_BASE + off);
+    switch (off) {
+    case 0x00U:
+        r = (val & ~(RCU_CTL0_IRC48MSTB | RCU_CTL0_HXTALSTB)) | ((val & RCU_CTL0_IRC48MEN) << 1) |
+            ((val & RCU_CTL0_HXTALEN) << 1);
+        break;
+    case 0x08U:
+        r = (val & ~RCU_CFG0_SCSS) | ((val & RCU_CFG0_SCS) << 2);
+        break;
+    case 0x70U:
+        r = (val & ~RCU_CTL1_LXTALSTB) | ((val & RCU_CTL1_LXTALEN) << 1);
+        rtc_update();
+        break;
+    case 0x74U:
+        r = (val & ~RCU_RSTSCK_IRC32KSTB) | ((val & RCU_RSTSCK_IRC32KEN) << 1);
+        break;
+    case 0x10U:
+    case 0x24U:
+        for (const ResetBit &b : kResetBits) {
+            if (b.reg == off && (val & ~old & (1U << b.bit))) { reset_block(b.base, 0x400U); }
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+/* ---------------- SysTick ---------------- */
+
+uint64_t systick_next()
+{
+    if (!g_systick.running) { return kNever; }
+    uint64_t period = (uint64_t)(REG32(SysTick_BASE + 0x04U) & SysTick_LOAD_RELOAD_Msk) + 1U;
+    return g_systick.t0 + ((g_now - g_systick.t0) / period + 1U) * period;
+}
+
+void systick_event()
+{
+    REG32(SysTick_BASE) |= SysTick_CTRL_COUNTFLAG_Msk;
+    if (REG32(SysTick_BASE) & SysTick_CTRL_TICKINT_Msk) { g_systick.pending = true; }
+    mark_dirty();
+}
+
+void systick_write(uint32_t off, uint32_t old, uint32_t val)
+{
+    if (off == 0x00U) {
+        bool en = (val & SysTick_CTRL_ENABLE_Msk) != 0U;
+        if (en && !(old & SysTick_CTRL_ENABLE_Msk)) { g_systick.t0 = g_now; }
+        g_systick.running = en;
+    } else if (off == 0x08U) {
+        g_systick.t0 = g_now;
+        REG32(SysTick_BASE) &= ~SysTick_CTRL_COUNTFLAG_Msk;
+    }
+    mark_dirty();
+}
+
+/* ---------------- EXTI ---------------- */
+
+/* EXTI线的触发沿: 挂起标志置位(中断由INTEN决定) */
+void exti_line(uint32_t line, bool rising)
+{
+    uint32_t bit = 1U << line;
+    if (REG32(EXTI_BASE + (rising ? 0x08U : 0x0CU)) & bit) {
+        REG32(EXTI_BASE + 0x14U) |= bit;
+        g_irq_dirty = true;
+    }
+}
+
+/* GPIO输入变化在SYSCFG选择的EXTI线上产生边沿(EXTI0-15都未使能触发沿时只记录输入) */
+void exti_gpio_edges(int port)
+{
+    uint32_t in = gpio_input(port);
+    uint32_t changed = in ^ g_gpio_in[port];
+    g_gpio_in[port] = in;
+    if (((REG32(EXTI_BASE + 0x08U) | REG32(EXTI_BASE + 0x0CU)) & changed & 0xFFFFU) == 0U) { return; }
+    for (uint32_t n = 0; n < 16U; n++) {
+        if (!(changed & (1U << n))) { continue; }
+        uint32_t sel = (REG32(SYSCFG_BASE + 0x08U + 4U * (n / 4U)) >> (4U * (n % 4U))) & 0xFU;
+        if (sel == (uint32_t)port) { exti_line(n, (in >> n) & 1U); }
+    }
+}
+
+void exti_write(uint32_t off, uint32_t old, uint32_t val)
+{
+    uint32_t &pd = REG32(EXTI_BASE + 0x14U);
+    if (off == 0x14U) { /* PD写1清零 */
+        pd = old & ~val;
+    } else if (off == 0x10U) { /* SWIEV */
+        pd |= val & ~old & (REG32(EXTI_BASE) | REG32(EXTI_BASE + 0x04U));
+    }
+    g_irq_dirty = true;
+}
+
+/* ---------------- RTC ---------------- */
+
+uint32_t rtc_ss(uint64_t now)
+{
+    if (!g_rtc.running) { return g_rtc.syn; }
+    return g_rtc.syn - (uint32_t)(((now - g_rtc.t0) / g_rtc.tick) % (g_rtc.syn + 1U));
+}
+
+/* 下一次闹钟: 只模拟屏蔽日期和时间、比较亚秒计数器(全部或低位)的闹钟 */
+uint64_t rtc_alarm_next()
+{
+    if (!g_rtc.running || !(REG32(RTC_BASE + 0x08U) & RTC_CTL_ALRM0EN)) { return kNever; }
+    if ((REG32(RTC_BASE + 0x1CU) & RTC_ALARM_ALL_MASK) != RTC_ALARM_ALL_MASK) { return kNever; }
+    uint32_t alrmss = REG32(RTC_BASE + 0x44U);
+    uint32_t bits = (alrmss >> 24) & 0xFU;
+    uint32_t mask = (bits >= 15U) ? 0x7FFFU : ((1U << bits) - 1U);
+    uint32_t period = g_rtc.syn + 1U;
+    uint64_t n = (g_now - g_rtc.t0) / g_rtc.tick;
+    for (uint64_t k = n + 1U; k <= n + period; k++) {
+        /* 不比较亚秒计数器时每秒(亚秒计数器重装)一次 */
+        uint32_t ss = g_rtc.syn - (uint32_t)(k % period);
+        if ((mask == 0U) ? (ss == g_rtc.syn) : ((ss & mask) == (alrmss & mask))) { return g_rtc.t0 + k * g_rtc.tick; }
+    }
+    return kNever;
+}
+
+/* RTC时钟(RCU_CTL1)、初始化模式或预分频变化: 亚秒计数器从同步预分频值重新开始 */
+void rtc_update()
+{
+    uint32_t ctl1 = REG32(RCU_BASE + 0x70U);
+    bool clock = (ctl1 & RCU_CTL1_RTCEN) && (ctl1 & RCU_CTL1_RTCSRC) == RCU_RTCSRC_IRC32K;
+    bool running = clock && !(REG32(RTC_BASE + 0x0CU) & RTC_STAT_INITM);
+    uint32_t psc = REG32(RTC_BASE + 0x10U);
+    if (running && !g_rtc.running) {
+        g_rtc.t0 = g_now;
+        g_rtc.tick = kRtcClockCycles * (((psc >> 16) & 0x7FU) + 1U);
+        g_rtc.syn = psc & 0x7FFFU;
+    }
+    g_rtc.running = running;
+    g_rtc.alarm = rtc_alarm_next();
+    mark_dirty();
+}
+
+void rtc_event()
+{
+    REG32(RTC_BASE + 0x0CU) |= RTC_STAT_ALRM0F;
+    if (REG32(RTC_BASE + 0x08U) & RTC_CTL_ALRM0IE) { exti_line(16U, true); }
+    g_rtc.alarm = rtc_alarm_next();
+    mark_dirty();
+}
+
+void rtc_write(uint32_t off, uint32_t old, uint32_t val)
+{
+    switch (off) {
+    case 0x0CU: /* STAT: INITM置位后立即进入初始化模式 */
+        REG32(RTC_BASE + off) = (val & ~RTC_STAT_INITF) | ((val & RTC_STAT_INITM) ? RTC_STAT_INITF : 0U);
+        break;
+    case 0x28U: /* SS只读 */
+        REG32(RTC_BASE + off) = old;
+        return;
+    default:
+        break;
+    }
+    rtc_update();
+}
+
+void rtc_read(uint32_t off)
+{
+    if (off == 0x28U) {
+        REG32(RTC_BASE + off) = rtc_ss(g_now);
+    } else if (off == 0x0CU) {
+        /* 影子寄存器总是已同步，闹钟关闭后立即可写 */
+        uint32_t &stat = REG32(RTC_BASE + off);
+        stat |= RTC_STAT_RSYNF;
+        stat = (REG32(RTC_BASE + 0x08U) & RTC_CTL_ALRM0EN) ? (stat & ~RTC_STAT_ALRM0WF) : (stat | RTC_STAT_ALRM0WF);
+    }
+}
+
+/* ---------------- 深度睡眠 ---------------- */
+
+/* 时钟停止的外设(定时器、DMA、USART、ADC、FMC、SysTick)的时间向后平移 */
+void deepsleep_shift(uint64_t dt)
+{
+    for (Timer &t : g_timers) {
+        if (t.running) { t.t0 += dt; }
+    }
+    for (DmaChan &d : g_dma) {
+        if (d.next != kNever) { d.next += dt; }
+    }
+    if (g_usart.busy) { g_usart.end += dt; }
+    if (g_adc_end != kNever) { g_adc_end += dt; }
+    if (g_fmc.end != kNever) { g_fmc.end += dt; }
+    g_systick.t0 += dt;
+    mark_dirty();
+}
+
+int pending_irq();
+void check_until();
+
+/* 深度睡眠: 只有RTC和引脚(EXTI)运行，直到EXTI中断挂起，唤醒后加上唤醒时间 */
+void deepsleep()
+{
+    uint64_t start = g_now;
+    while (pending_irq() == kIrqMin) {
+        uint64_t ev = g_rtc.alarm;
+        for (const Pin &p : g_pins) {
+            if (p.loaded && !p.driven && p.cross < ev) { ev = p.cross; }
+        }
+        g_now = (ev < g_until) ? ev : g_until;
+        if (g_rtc.alarm <= g_now) { rtc_event(); }
+        for (int i = 0; i < (int)(sizeof(g_pins) / sizeof(g_pins[0])); i++) {
+            Pin &p = g_pins[i];
+            if (p.loaded && !p.driven && p.cross <= g_now) {
+                /* 定时器时钟停止，不捕获 */
+                p.cross = kNever;
+                exti_gpio_edges(i / 16);
+            }
+        }
+        g_irq_dirty = true;
+        check_until();
+    }
+    g_now += kDeepsleepWakeCycles;
+    deepsleep_shift(g_now - start);
+    g_stats.deepsleep_cycles += g_now - start;
+    g_stats.deepsleeps++;
+}
+
+/* ---------------- 复位值 ---------------- */
+
+void reset_block(uint32_t base, uint32_t size)
+{
+    for (uint32_t a = base; a < base + size; a += 4U) { REG32(a) = 0U; }
+
+    if (base == USART0) {
+        REG32(USART0 + 0x1CU) = USART_STAT_TBE | USART_STAT_TC;
+        REG32(USART0 + 0x28U) = 0xFFFFFFFFU;
+        g_usart = Usart{};
+    } else if (base == CRC_BASE) {
+        REG32(CRC_BASE + 0x10U) = 0xFFFFFFFFU;
+        REG32(CRC_BASE + 0x14U) = 0x04C11DB7U;
+        crc_reset();
+    } else if (base == ADC_BASE) {
+        g_adc_end = kNever;
+    } else if (Timer *t = timer_of(base)) {
+        t->running = false;
+        t->cnt0 = 0U;
+        t->div = 1U;
+        t->period = 0x10000U;
+        REG32(base + 0x2CU) = 0xFFFFU;
+    }
+    mark_dirty();
+}
+
+/* ---------------- 读写分发 ---------------- */
+
+void periph_read(uint32_t addr)
+{
+    if (addr - GPIO_BASE < 0x1800U) {
+        if ((addr & 0x3FFU) == 0x10U) { REG32(addr) = gpio_input((int)((addr - GPIO_BASE) >> 10)); }
+        return;
+    }
+    if (addr - RTC_BASE < 0x400U) {
+        rtc_read(addr - RTC_BASE);
+        return;
+    }
+    if (addr - APB_BUS_BASE < 0x18000U) {
+        if ((addr & 0x3FFU) == 0x24U) {
+            if (Timer *t = timer_of(addr & ~0x3FFU)) { REG32(addr) = timer_count(*t, g_now); }
+        }
+        return;
+    }
+    if (addr - DMA_BASE < 0x08U + 3U * 0x14U && addr >= DMA_BASE + 0x08U) {
+        uint32_t off = addr - DMA_BASE - 0x08U;
+        int ch = (int)(off / 0x14U);
+        if (off % 0x14U == 0x04U && g_dma[ch].active) {
+            REG32(addr) = (REG32(addr) & ~0xFFFFU) | g_dma[ch].remaining;
+        }
+        return;
+    }
+    if (addr == SysTick_BASE + 0x08U && g_systick.running) {
+        uint64_t period = (uint64_t)(REG32(SysTick_BASE + 0x04U) & SysTick_LOAD_RELOAD_Msk) + 1U;
+        REG32(addr) = (uint32_t)(period - 1U - (g_now - g_systick.t0) % period);
+    }
+}
+
+void periph_write(uint32_t addr, uint32_t old, uint32_t val, uint32_t width)
+{
+    if (addr - GPIO_BASE < 0x1800U) {
+        gpio_write((int)((addr - GPIO_BASE) >> 10), addr & 0x3FFU, old, val);
+        return;
+    }
+    if (addr - CRC_BASE < 0x400U) {
+        uint32_t off = addr - CRC_BASE;
+        if (off == 0x00U) {
+            REG32(addr) = old;
+            crc_input((width >= 4U) ? val : (val & ((1U << (8U * width)) - 1U)), (width >= 4U) ? 4U : width);
+        } else if (off == 0x08U && (val & CRC_CTL_RST)) {
+            REG32(addr) = val & ~CRC_CTL_RST;
+            crc_reset();
+        } else if (off == 0x08U) {
+            crc_publish();
+        }
+        return;
+    }
+    if (addr - FLASH_BASE < kFlashSize) {
+        flash_write(addr, old, val);
+        return;
+    }
+    if (addr - FMC_BASE < 0x400U) {
+        fmc_write(addr - FMC_BASE, old, val);
+        return;
+    }
+    if (addr - RCU_BASE < 0x400U) {
+        rcu_write(addr - RCU_BASE, old, val);
+        return;
+    }
+    if (addr - DMA_BASE < 0x400U) {
+        dma_write(addr - DMA_BASE, old, val);
+        return;
+    }
+    if (addr - SysTick_BASE < 0x10U) {
+        systick_write(addr - SysTick_BASE, old, val);
+        return;
+    }
+    if (addr - USART0 < 0x400U) {
+        usart_write(addr - USART0, old, val);
+        return;
+    }
+    if (addr - ADC_BASE < 0x400U) {
+        adc_write(addr - ADC_BASE, old, val);
+        return;
+    }
+    if (addr - RTC_BASE < 0x400U) {
+        rtc_write(addr - RTC_BASE, old, val);
+        return;
+    }
+    if (addr - EXTI_BASE < 0x400U) {
+        exti_write(addr - EXTI_BASE, old, val);
+        return;
+    }
+    if (addr - SYSCFG_BASE < 0x400U) {
+        for (int port = 0; port < 6; port++) { g_gpio_in[port] = gpio_input(port); }
+        return;
+    }
+    if (Timer *t = timer_of(addr & ~0x3FFU)) {
+        timer_write(*t, addr & 0x3FFU, old, val);
+        return;
+    }
+}
+
+/* CRC数据寄存器的8/16位写入: 输入宽度由访问宽度决定；Flash编程: 写入0xFFFFFFFF也计入一次编程 */
+bool narrow_data_write(uint32_t addr, uint32_t width)
+{
+    return (width < 4U && (addr & ~3U) == CRC_BASE) || (addr - FLASH_BASE < kFlashSize);
+}
+
+/* ---------------- 事件调度 ---------------- */
+
+uint64_t next_event()
+{
+    if (!g_event_dirty) { return g_next_event; }
+    uint64_t best = kNever;
+    for (Timer &t : g_timers) {
+        t.next = timer_next(t);
+        if (t.next < best) { best = t.next; }
+    }
+    for (const Pin &p : g_pins) {
+        if (p.loaded && !p.driven && p.cross < best) { best = p.cross; }
+    }
+    for (const DmaChan &d : g_dma) {
+        if (d.active && d.next < best) { best = d.next; }
+    }
+    if (g_usart.busy && g_usart.end < best) { best = g_usart.end; }
+    if (g_adc_end < best) { best = g_adc_end; }
+    if (g_fmc.end < best) { best = g_fmc.end; }
+    if (g_rtc.alarm < best) { best = g_rtc.alarm; }
+    g_systick.next = systick_next();
+    if (g_systick.next < best) { best = g_systick.next; }
+    g_next_event = best;
+    g_event_dirty = false;
+    return best;
+}
+
+void run_events()
+{
+    for (Timer &t : g_timers) {
+        if (t.next <= g_now) { timer_event(t); }
+    }
+    for (int i = 0; i < (int)(sizeof(g_pins) / sizeof(g_pins[0])); i++) {
+        Pin &p = g_pins[i];
+        if (p.loaded && !p.driven && p.cross <= g_now) {
+            p.cross = kNever;
+            timer_capture(i, true);
+            exti_gpio_edges(i / 16);
+            mark_dirty();
+        }
+    }
+    for (int ch = 0; ch < 3; ch++) {
+        if (g_dma[ch].active && g_dma[ch].next <= g_now) {
+            dma_transfer(ch);
+            g_dma[ch].next = g_dma[ch].active ? g_now + kDmaItemCycles : kNever;
+            mark_dirty();
+        }
+    }
+    if (g_usart.busy && g_usart.end <= g_now) { usart_event(); }
+    if (g_adc_end <= g_now) { adc_event(); }
+    if (g_fmc.end <= g_now) { fmc_event(); }
+    if (g_rtc.alarm <= g_now) { rtc_event(); }
+    if (g_systick.next <= g_now) { systick_event(); }
+}
+
+/* 推进时间到target，处理途中到期的事件(不分发中断) */
+void advance_to(uint64_t target)
+{
+    for (;;) {
+        uint64_t ev = next_event();
+        if (ev > target) { break; }
+        if (ev > g_now) { g_now = ev; }
+        run_events();
+        g_event_dirty = true;
+    }
+    g_now = target;
+}
+
+void advance(uint64_t cycles)
+{
+    advance_to(g_now + cycles);
+}
+
+/* ---------------- NVIC ---------------- */
+
+using Handler = void (*)(void);
+
+} // namespace
+} // namespace sim
+} // namespace cap
+
+extern "C" {
+void SysTick_Handler(void) __attribute__((weak));
+void DMA_Channel0_IRQHandler(void) __attribute__((weak));
+void DMA_Channel1_IRQHandler(void) __attribute__((weak));
+void DMA_Channel2_IRQHandler(void) __attribute__((weak));
+void FMC_IRQHandler(void) __attribute__((weak));
+void ADC_IRQHandler(void) __attribute__((weak));
+void USART0_IRQHandler(void) __attribute__((weak));
+void TIMER0_TRG_CMT_UP_BRK_IRQHandler(void) __attribute__((weak));
+void TIMER0_Channel_IRQHandler(void) __attribute__((weak));
+void TIMER2_IRQHandler(void) __attribute__((weak));
+void TIMER13_IRQHandler(void) __attribute__((weak));
+void TIMER15_IRQHandler(void) __attribute__((weak));
+void TIMER16_IRQHandler(void) __attribute__((weak));
+void RTC_Alarm_IRQHandler(void) __attribute__((weak));
+void EXTI0_IRQHandler(void) __attribute__((weak));
+void EXTI1_IRQHandler(void) __attribute__((weak));
+void EXTI2_IRQHandler(void) __attribute__((weak));
+void EXTI3_IRQHandler(void) __attribute__((weak));
+void EXTI4_IRQHandler(void) __attribute__((weak));
+void EXTI5_9_IRQHandler(void) __attribute__((weak));
+void EXTI10_15_IRQHandler(void) __attribute__((weak));
+}
+
+namespace cap {
+namespace sim {
+namespace {
+
+Handler handler_of(int irq)
+{
+    switch (irq) {
+    case SysTick_IRQn: return SysTick_Handler;
+    case DMA_Channel0_IRQn: return DMA_Channel0_IRQHandler;
+    case DMA_Channel1_IRQn: return DMA_Channel1_IRQHandler;
+    case DMA_Channel2_IRQn: return DMA_Channel2_IRQHandler;
+    case FMC_IRQn: return FMC_IRQHandler;
+    case ADC_IRQn: return ADC_IRQHandler;
+    case USART0_IRQn: return USART0_IRQHandler;
+    case TIMER0_TRG_CMT_UP_BRK_IRQn: return TIMER0_TRG_CMT_UP_BRK_IRQHandler;
+    case TIMER0_Channel_IRQn: return TIMER0_Channel_IRQHandler;
+    case TIMER2_IRQn: return TIMER2_IRQHandler;
+    case TIMER13_IRQn: return TIMER13_IRQHandler;
+    case TIMER15_IRQn: return TIMER15_IRQHandler;
+    case TIMER16_IRQn: return TIMER16_IRQHandler;
+    case RTC_Alarm_IRQn: return RTC_Alarm_IRQHandler;
+    case EXTI0_IRQn: return EXTI0_IRQHandler;
+    case EXTI1_IRQn: return EXTI1_IRQHandler;
+    case EXTI2_IRQn: return EXTI2_IRQHandler;
+    case EXTI3_IRQn: return EXTI3_IRQHandler;
+    case EXTI4_IRQn: return EXTI4_IRQHandler;
+    case EXTI5_9_IRQn: return EXTI5_9_IRQHandler;
+    case EXTI10_15_IRQn: return EXTI10_15_IRQHandler;
+    default: return nullptr;
+    }
+}
+
+bool timer_irq_level(uint32_t base, uint32_t mask)
+{
+    return (REG32(base + 0x10U) & REG32(base + 0x0CU) & mask) != 0U;
+}
+
+bool exti_irq_level(uint32_t lines)
+{
+    return (REG32(EXTI_BASE + 0x14U) & REG32(EXTI_BASE) & lines) != 0U;
+}
+
+/* 外设中断请求电平 */
+bool irq_level(int irq)
+{
+    switch (irq) {
+    case SysTick_IRQn:
+        return g_systick.pending;
+    case DMA_Channel0_IRQn:
+    case DMA_Channel1_IRQn:
+    case DMA_Channel2_IRQn: {
+        int ch = irq - DMA_Channel0_IRQn;
+        return (((REG32(DMA_BASE) >> (4 * ch)) & REG32(dma_reg(ch, 0x00U))) & 0xEU) != 0U;
+    }
+    case FMC_IRQn: {
+        uint32_t stat = REG32(kFmcStat);
+        uint32_t ctl = REG32(kFmcCtl);
+        return ((stat & FMC_STAT_ENDF) && (ctl & FMC_CTL_ENDIE)) || ((stat & FMC_STAT_OPRERR) && (ctl & FMC_CTL_ERRIE));
+    }
+    case ADC_IRQn: {
+        uint32_t stat = REG32(ADC_BASE);
+        uint32_t ctl0 = REG32(ADC_BASE + 0x04U);
+        return ((stat & ADC_STAT_EOC) && (ctl0 & ADC_CTL0_EOCIE)) || ((stat & ADC_STAT_EOIC) && (ctl0 & ADC_CTL0_EOICIE));
+    }
+    case USART0_IRQn: {
+        uint32_t stat = REG32(USART0 + 0x1CU);
+        uint32_t ctl0 = REG32(USART0);
+        return (stat & ctl0 & (USART_STAT_TBE | USART_STAT_TC | USART_STAT_RBNE | USART_STAT_IDLEF)) != 0U;
+    }
+    case TIMER0_TRG_CMT_UP_BRK_IRQn:
+        return timer_irq_level(TIMER0, TIMER_INTF_UPIF | TIMER_INTF_CMTIF | TIMER_INTF_TRGIF | TIMER_INTF_BRK0IF | TIMER_INTF_BRK1IF);
+    case TIMER0_Channel_IRQn:
+        return timer_irq_level(TIMER0, TIMER_INTF_CH0IF | TIMER_INTF_CH1IF | TIMER_INTF_CH2IF | TIMER_INTF_CH3IF);
+    case TIMER2_IRQn: return timer_irq_level(TIMER2, 0xFFU);
+    case TIMER13_IRQn: return timer_irq_level(TIMER13, 0xFFU);
+    case TIMER15_IRQn: return timer_irq_level(TIMER15, 0xFFU);
+    case TIMER16_IRQn: return timer_irq_level(TIMER16, 0xFFU);
+    case RTC_Alarm_IRQn: return exti_irq_level(1U << 16);
+    case EXTI0_IRQn:
+    case EXTI1_IRQn:
+    case EXTI2_IRQn:
+    case EXTI3_IRQn:
+    case EXTI4_IRQn: return exti_irq_level(1U << (irq - EXTI0_IRQn));
+    case EXTI5_9_IRQn: return exti_irq_level(0x03E0U);
+    case EXTI10_15_IRQn: return exti_irq_level(0xFC00U);
+    default: return false;
+    }
+}
+
+/* 优先级最高(数值最小、同级时编号最小)的可抢占请求，无则返回kIrqMin */
+int pending_irq()
+{
+    int best = kIrqMin;
+    uint32_t best_prio = g_active_prio;
+    if (g_systick.pending && g_prio[SysTick_IRQn - kIrqMin] < best_prio) {
+        best = SysTick_IRQn;
+        best_prio = g_prio[SysTick_IRQn - kIrqMin];
+    }
+    for (uint64_t m = g_irq_enabled; m != 0U; m &= m - 1U) {
+        int irq = __builtin_ctzll(m);
+        uint32_t prio = g_prio[irq - kIrqMin];
+        if (prio < best_prio && irq_level(irq)) {
+            best = irq;
+            best_prio = prio;
+        }
+    }
+    return best;
+}
+
+bool commit();
+void refresh_pending();
+
+void dispatch()
+{
+    if (g_primask || !g_irq_dirty) { return; }
+    for (;;) {
+        int irq = pending_irq();
+        if (irq == kIrqMin) { break; }
+        Handler h = handler_of(irq);
+        if (h == nullptr) { fault("no handler for enabled interrupt", (uint32_t)irq); }
+
+        uint64_t start = g_now;
+        uint32_t saved = g_active_prio;
+        g_active_prio = g_prio[irq - kIrqMin];
+        if (irq == SysTick_IRQn) { g_systick.pending = false; }
+        g_stats.irqs[irq - kIrqMin]++;
+        g_isr_depth++;
+        advance(kExceptionEntryCycles);
+        h();
+        /* 异常返回前提交处理函数最后的写入 */
+        commit();
+        advance(kExceptionExitCycles);
+        g_isr_depth--;
+        g_active_prio = saved;
+        if (g_isr_depth == 0U) { g_stats.isr_cycles += g_now - start; }
+        g_irq_dirty = true;
+        refresh_pending();
+        if (g_primask) { return; }
+    }
+    g_irq_dirty = false;
+}
+
+/* ---------------- 访问钩子 ---------------- */
+
+/* 提交挂起的访问，返回是否有写入 */
+bool commit()
+{
+    bool wrote = false;
+    int keep = 0;
+    for (int i = 0; i < g_npending; i++) {
+        Pending &p = g_pending[i];
+        bool changed = false;
+        for (uint32_t w = 0; w < p.words; w++) {
+            uint32_t addr = p.addr + 4U * w;
+            uint32_t now = REG32(addr);
+            if (now == p.snap[w] && !p.force) { continue; }
+            changed = true;
+            periph_write(addr, p.snap[w], now, p.width);
+            /* 其他挂起访问以写入后的值为快照，避免重复处理 */
+            for (int j = i + 1; j < g_npending; j++) {
+                Pending &q = g_pending[j];
+                if (addr - q.addr < 4U * q.words) { q.snap[(addr - q.addr) >> 2] = REG32(addr); }
+            }
+        }
+        if (changed) {
+            wrote = true;
+        } else if (++p.age < 2U) {
+            g_pending[keep++] = p;
+        }
+    }
+    g_npending = keep;
+    return wrote;
+}
+
+void refresh_pending()
+{
+    for (int i = 0; i < g_npending; i++) {
+        Pending &p = g_pending[i];
+        for (uint32_t w = 0; w < p.words; w++) { p.snap[w] = REG32(p.addr + 4U * w); }
+    }
+}
+
+void push_pending(uint32_t addr, uint32_t words, uint32_t width)
+{
+    for (int i = 0; i < g_npending; i++) {
+        if (g_pending[i].addr == addr) {
+            g_pending[i] = g_pending[--g_npending];
+            break;
+        }
+    }
+    if (g_npending == kMaxPending) {
+        std::memmove(&g_pending[0], &g_pending[1], sizeof(g_pending[0]) * (kMaxPending - 1));
+        g_npending--;
+    }
+    Pending &p = g_pending[g_npending++];
+    p.addr = addr;
+    p.words = words;
+    p.width = (uint8_t)width;
+    p.force = narrow_data_write(addr, width);
+    p.age = 0U;
+    for (uint32_t w = 0; w < words; w++) { p.snap[w] = REG32(addr + 4U * w); }
+}
+
+void check_until()
+{
+    while (g_now >= g_until) { yield(); }
+}
+
+/* 一次寄存器访问: 提交、推进时间、分发中断、读处理 */
+uint32_t *access(uint32_t addr, uint32_t bytes, uint32_t width, const void *site)
+{
+    uint32_t base = addr & ~3U;
+    uint32_t words = ((addr & 3U) + bytes + 3U) / 4U;
+    if (words > 4U) { words = 4U; }
+    uint32_t *p = find(base);
+    if (p == nullptr) { fault("unmapped register", addr); }
+
+    g_stats.accesses++;
+    bool wrote = commit();
+    if (wrote) { g_irq_dirty = true; }
+
+    if (!wrote && base == g_last_addr && site == g_last_site && g_isr_depth == 0U) {
+        if (++g_poll >= kPollSkip) {
+            /* 轮询: 快进到下一个事件 */
+            uint64_t ev = next_event();
+            uint64_t target = (ev < g_until) ? ev : g_until;
+            if (target > g_now) {
+                g_stats.idle_cycles += target - g_now;
+                advance_to(target);
+            }
+            g_poll = 0U;
+        }
+    } else {
+        g_poll = 0U;
+    }
+    g_last_addr = base;
+    g_last_site = site;
+
+    advance(g_access_cycles);
+    dispatch();
+    check_until();
+
+    for (uint32_t w = 0; w < words; w++) { periph_read(base + 4U * w); }
+    refresh_pending();
+    push_pending(base, words, width);
+    return p;
+}
+
+/* Flash映射到固件使用的地址(固件和DMA直接按地址读取)，复位时为擦除状态 */
+void flash_reset()
+{
+    static bool mapped = false;
+    void *base = reinterpret_cast<void *>((uintptr_t)FLASH_BASE);
+    if (!mapped) {
+        void *p = mmap(base, kFlashSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+        if (p != base) {
+            std::fprintf(stderr, "sim: cannot map flash at 0x%08X\n", (unsigned)FLASH_BASE);
+            std::abort();
+        }
+        mapped = true;
+    }
+    std::memset(base, 0xFF, kFlashSize);
+}
+
+void fw_main()
+{
+    g_entry();
+    g_finished = true;
+    for (;;) { yield(); }
+}
+
+void reset_all()
+{
+    std::memset(g_apb, 0, sizeof(g_apb));
+    std::memset(g_ahb1, 0, sizeof(g_ahb1));
+    std::memset(g_ahb2, 0, sizeof(g_ahb2));
+    std::memset(g_scs, 0, sizeof(g_scs));
+    flash_reset();
+    g_now = 0U;
+    g_npending = 0;
+    g_last_addr = 0U;
+    g_last_site = nullptr;
+    g_poll = 0U;
+    g_primask = 0U;
+    g_irq_enabled = 0U;
+    std::memset(g_prio, 0, sizeof(g_prio));
+    g_active_prio = 0x100U;
+    g_isr_depth = 0U;
+    g_systick = SysTickState{};
+    g_adc_end = kNever;
+    g_fmc = Fmc{kNever, false, 0U, 0U, 0U};
+    g_rtc = Rtc{false, 0U, kRtcClockCycles * 128U, 0xFFU, kNever};
+    REG32(RTC_BASE + 0x10U) = 0x007F00FFU;
+    REG32(kFmcCtl) = FMC_CTL_LK | FMC_CTL_OBLK;
+    for (DmaChan &d : g_dma) { d = DmaChan{false, 0U, 0U, 0U, kNever}; }
+    for (Timer &t : g_timers) { reset_block(t.base, 0x400U); }
+    reset_block(USART0, 0x400U);
+    reset_block(CRC_BASE, 0x400U);
+    REG32(RCU_BASE) = RCU_CTL0_IRC48MEN | RCU_CTL0_IRC48MSTB;
+    REG32(RCU_BASE + 0x74U) = RCU_RSTSCK_IRC32KEN | RCU_RSTSCK_IRC32KSTB;
+    REG32(SCB_BASE) = 0x411CD200U;
+    REG32(GPIO_BASE) = 0xEBFFFFFFU; /* PA13/PA14为SWD复用，其他为模拟 */
+    for (int port = 1; port < 6; port++) { REG32(GPIO_BASE + 0x400U * port) = 0xFFFFFFFFU; }
+    for (Pin &p : g_pins) {
+        p.driven = false;
+        p.v0 = 0.0;
+        p.t0 = 0U;
+        p.cross = kNever;
+    }
+    for (int port = 0; port < 6; port++) { gpio_update(port); }
+    for (int port = 0; port < 6; port++) { g_gpio_in[port] = gpio_input(port); }
+    std::memset(&g_stats, 0, sizeof(g_stats));
+    mark_dirty();
+}
+
+} // namespace
+} // namespace sim
+} // namespace cap
+
+using namespace cap::sim;
+
+extern "C" {
+
+volatile uint32_t *cap_sim_reg32(uint32_t addr)
+{
+    return access(addr, 4U, 4U, __builtin_return_address(0));
+}
+
+volatile uint16_t *cap_sim_reg16(uint32_t addr)
+{
+    return reinterpret_cast<uint16_t *>(reinterpret_cast<uint8_t *>(access(addr, 2U, 2U, __builtin_return_address(0))) + (addr & 3U));
+}
+
+volatile uint8_t *cap_sim_reg8(uint32_t addr)
+{
+    return reinterpret_cast<uint8_t *>(access(addr, 1U, 1U, __builtin_return_address(0))) + (addr & 3U);
+}
+
+volatile uint64_t *cap_sim_reg64(uint32_t addr)
+{
+    return reinterpret_cast<uint64_t *>(access(addr, 8U, 8U, __builtin_return_address(0)));
+}
+
+void *cap_sim_core(uint32_t addr, uint32_t size)
+{
+    (void)size;
+    /* 结构体指针只有一次钩子调用，挂起该结构体开头的最多4个字(SysTick全部寄存器) */
+    return access(addr, (size < 16U) ? size : 16U, 4U, __builtin_return_address(0));
+}
+
+void cap_sim_primask_set(uint32_t primask)
+{
+    commit();
+    g_primask = primask;
+    if (!primask) {
+        g_irq_dirty = true;
+        dispatch();
+    }
+    refresh_pending();
+}
+
+uint32_t cap_sim_primask_get(void)
+{
+    return g_primask;
+}
+
+void cap_sim_wfi(void)
+{
+    commit();
+    if ((REG32(SCB_BASE + 0x10U) & SCB_SCR_SLEEPDEEP_Msk) && pending_irq() == kIrqMin) { deepsleep(); }
+    for (;;) {
+        if (pending_irq() != kIrqMin) { break; }
+        uint64_t ev = next_event();
+        uint64_t target = (ev < g_until) ? ev : g_until;
+        if (target > g_now) {
+            g_stats.idle_cycles += target - g_now;
+            advance_to(target);
+        }
+        g_irq_dirty = true;
+        check_until();
+    }
+    dispatch();
+    refresh_pending();
+}
+
+void cap_sim_cycles(uint32_t cycles)
+{
+    advance(cycles);
+    dispatch();
+    check_until();
+}
+
+void cap_sim_nvic_enable(int32_t irq, uint32_t enable)
+{
+    if (irq < 0 || irq >= 32) { return; }
+    commit();
+    if (enable) {
+        g_irq_enabled |= 1ULL << irq;
+    } else {
+        g_irq_enabled &= ~(1ULL << irq);
+    }
+    g_irq_dirty = true;
+    dispatch();
+    refresh_pending();
+}
+
+void cap_sim_nvic_priority(int32_t irq, uint32_t priority)
+{
+    if (irq >= kIrqMin && irq < kIrqCount + kIrqMin) { g_prio[irq - kIrqMin] = (uint8_t)(priority & 3U); }
+    g_irq_dirty = true;
+}
+
+uint32_t cap_sim_nvic_pending(int32_t irq)
+{
+    if (irq == SysTick_IRQn) { return g_systick.pending ? 1U : 0U; }
+    return (irq >= 0 && irq_level(irq)) ? 1U : 0U;
+}
+
+void cap_sim_fault(const char *what)
+{
+    fault(what, 0U);
+}
+
+void cap_sim_start(void (*entry)(void))
+{
+    reset_all();
+    g_entry = entry;
+    g_finished = false;
+    g_faulted = false;
+    getcontext(&g_fw_ctx);
+    g_fw_ctx.uc_stack.ss_sp = g_fw_stack;
+    g_fw_ctx.uc_stack.ss_size = sizeof(g_fw_stack);
+    g_fw_ctx.uc_link = nullptr;
+    makecontext(&g_fw_ctx, fw_main, 0);
+}
+
+int cap_sim_run(uint64_t until_ns)
+{
+    if (g_finished || g_faulted) { return -1; }
+    g_until = (uint64_t)((double)until_ns * (CAP_SIM_CORE_HZ / 1e9));
+    if (g_until <= g_now) { return 0; }
+    swapcontext(&g_host_ctx, &g_fw_ctx);
+    g_stats.cycles = g_now;
+    return (g_finished || g_faulted) ? -1 : 0;
+}
+
+uint64_t cap_sim_time_ns(void)
+{
+    return (uint64_t)((double)g_now * (1e9 / CAP_SIM_CORE_HZ));
+}
+
+void cap_sim_set_access_cycles(uint32_t cycles)
+{
+    g_access_cycles = (cycles != 0U) ? cycles : 1U;
+}
+
+void cap_sim_pin_load(uint8_t pin, double r_ohm, double c_pf)
+{
+    Pin &p = g_pins[pin % (sizeof(g_pins) / sizeof(g_pins[0]))];
+    p.loaded = true;
+    p.r = r_ohm;
+    p.c = c_pf;
+    gpio_update(pin / 16);
+    if (!p.driven) { pin_release(p, g_now); }
+}
+
+void cap_sim_pin_capacitance(uint8_t pin, double c_pf)
+{
+    g_pins[pin % (sizeof(g_pins) / sizeof(g_pins[0]))].c = c_pf;
+}
+
+void cap_sim_set_noise(double c_rms_pf, uint32_t seed)
+{
+    g_noise = c_rms_pf;
+    g_rng.seed(seed);
+}
+
+void cap_sim_set_supply(double vdd, double temperature_c)
+{
+    g_vdd = vdd;
+    g_temp = temperature_c;
+}
+
+void cap_sim_set_tx_callback(cap_sim_tx_callback_t callback, void *arg)
+{
+    g_tx_cb = callback;
+    g_tx_arg = arg;
+}
+
+uint16_t cap_sim_gpio_output(uint8_t port)
+{
+    return (uint16_t)REG32(gpio_base(port) + 0x14U);
+}
+
+void cap_sim_get_stats(cap_sim_stats_t *stats)
+{
+    g_stats.cycles = g_now;
+    *stats = g_stats;
+}
+
+} /* extern "C" */
@@ -0,0 +1,148 @@
+/**
+ * @file cap_sim.h
+ * @brief GD32C2x1寄存器级外设仿真器(上位机)
+ * @version 1.0
+ * @date 2025-11-01
+ *
+ * 固件源文件不做修改，在Linux上编译为仿真程序:
+ * - cap_sim_regs.h 把REG32/REG16/REG8重定义为 cap_sim_reg32() 等访问函数，
+ *   core_cm23.h 把SysTick/NVIC/SCB和内核指令接到仿真器
+ * - 每次寄存器访问推进CPU时间，访问写入的值在下一次访问时生效(写1清零、
+ *   写0清零等语义由各外设模型处理)，并检查中断、在固件的调用栈上执行中断处理函数
+ * - 固件运行在独立的协程中(低地址静态栈，兼容固件中指针与uint32_t的互相转换)，
+ *   测试驱动按仿真时间分段运行，在两段之间注入电容、温度等激励
+ *
+ * 模拟的外设: TIMER(计数、更新、比较、输入捕获)、GPIO(模式、输出、输入状态、
+ * 复用)、带RC负载的引脚(充电到输入阈值时产生边沿)、DMA/DMAMUX(请求、
+ * 循环模式、半满/全满中断)、USART(按波特率发送，DMA发送)、CRC、ADC插入组
+ * (温度传感器/VREFINT)、RCU(振荡器就绪、外设复位)、SysTick、NVIC(优先级、
+ * PRIMASK、WFI)、Flash(64KB，映射到0x08000000，复位时为擦除状态)和FMC(解锁、双字/快速编程、页擦除、
+ * 操作时间、结束/错误中断)、RTC(IRC32K时钟的亚秒计数器、亚秒闹钟)、EXTI(GPIO边沿、RTC闹钟线、
+ * 挂起标志和中断)和深度睡眠(SLEEPDEEP置位时WFI停止内核和上述外设时钟，只有RTC和EXTI运行，
+ * EXTI中断唤醒)。未模拟的寄存器按普通存储器处理。
+ *
+ * 需要以 -no-pie 链接: 固件把缓冲区地址转换为uint32_t写入DMA寄存器。
+ */
+
+#ifndef CAP_SIM_H_
+#define CAP_SIM_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** 仿真的CPU时钟(Hz) */
+#define CAP_SIM_CORE_HZ 48000000U
+
+/** 引脚编号: 端口(0 = GPIOA, 1 = GPIOB, 2 = GPIOC, 3 = GPIOD, 5 = GPIOF) * 16 + 引脚号 */
+#define CAP_SIM_PIN(port, pin) ((uint8_t)((port) * 16U + (pin)))
+
+/**
+ * @brief 运行统计
+ */
+typedef struct {
+    uint64_t cycles;          /*!< 仿真的CPU周期数 */
+    uint64_t idle_cycles;     /*!< 其中等待的周期数(WFI、轮询寄存器时快进) */
+    uint64_t isr_cycles;      /*!< 其中中断处理函数执行的周期数 */
+    uint64_t accesses;        /*!< 寄存器访问次数 */
+    uint64_t irqs[48];        /*!< 各中断的执行次数(下标为IRQn + 16) */
+    uint64_t tx_bytes;        /*!< USART0发送的字节数 */
+    uint64_t captures;        /*!< 定时器输入捕获次数 */
+    uint64_t capture_overruns; /*!< 捕获标志未清除时再次捕获的次数 */
+    uint64_t deepsleep_cycles; /*!< 深度睡眠的周期数(不计入cycles中的空闲周期) */
+    uint64_t deepsleeps;       /*!< 深度睡眠次数 */
+} cap_sim_stats_t;
+
+/** USART发送数据输出回调 */
+typedef void (*cap_sim_tx_callback_t)(uint8_t data, void *arg);
+
+/* 寄存器访问(由cap_sim_regs.h和core_cm23.h调用) */
+volatile uint32_t *cap_sim_reg32(uint32_t addr);
+volatile uint16_t *cap_sim_reg16(uint32_t addr);
+volatile uint8_t  *cap_sim_reg8(uint32_t addr);
+volatile uint64_t *cap_sim_reg64(uint32_t addr);
+void              *cap_sim_core(uint32_t addr, uint32_t size);
+
+/* 内核(由core_cm23.h调用) */
+void     cap_sim_primask_set(uint32_t primask);
+uint32_t cap_sim_primask_get(void);
+void     cap_sim_wfi(void);
+void     cap_sim_cycles(uint32_t cycles);
+void     cap_sim_nvic_enable(int32_t irq, uint32_t enable);
+void     cap_sim_nvic_priority(int32_t irq, uint32_t priority);
+uint32_t cap_sim_nvic_pending(int32_t irq);
+void     cap_sim_fault(const char *what);
+
+/**
+ * @brief 复位所有外设和时间，并准备在协程中运行固件入口函数
+ *
+ * @param entry 固件入口(通常依次调用SystemInit和main)
+ */
+void cap_sim_start(void (*entry)(void));
+
+/**
+ * @brief 运行固件直到指定的仿真时间
+ *
+ * @param until_ns 仿真时间(纳秒)
+ * @return int 0: 到达指定时间; -1: 固件故障或入口函数返回
+ */
+int cap_sim_run(uint64_t until_ns);
+
+/**
+ * @brief 当前仿真时间(纳秒)
+ */
+uint64_t cap_sim_time_ns(void);
+
+/**
+ * @brief 每次寄存器访问消耗的CPU周期数(默认8，近似访问之间执行的指令)
+ */
+void cap_sim_set_access_cycles(uint32_t cycles);
+
+/**
+ * @brief 设置引脚负载: 上拉电阻到VDD和对地电容
+ *
+ * @param pin 引脚编号(CAP_SIM_PIN)
+ * @param r_ohm 上拉电阻(欧姆)，0为无上拉
+ * @param c_pf 电容(pF)
+ */
+void cap_sim_pin_load(uint8_t pin, double r_ohm, double c_pf);
+
+/**
+ * @brief 修改引脚电容(触摸时增加)，下一次充电开始时生效
+ */
+void cap_sim_pin_capacitance(uint8_t pin, double c_pf);
+
+/**
+ * @brief 每次充电的电容噪声(高斯，均方根值pF)
+ */
+void cap_sim_set_noise(double c_rms_pf, uint32_t seed);
+
+/**
+ * @brief 设置电源电压(V)和芯片温度(°C)，影响输入阈值对应的充电时间和ADC转换值
+ */
+void cap_sim_set_supply(double vdd, double temperature_c);
+
+/**
+ * @brief 注册USART0发送数据的输出回调
+ */
+void cap_sim_set_tx_callback(cap_sim_tx_callback_t callback, void *arg);
+
+/**
+ * @brief 读取GPIO端口的输出寄存器(用于观察指示灯等输出)
+ *
+ * @param port 端口(0 = GPIOA ...)
+ */
+uint16_t cap_sim_gpio_output(uint8_t port);
+
+/**
+ * @brief 获取运行统计
+ */
+void cap_sim_get_stats(cap_sim_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CAP_SIM_H_ */
@@ -0,0 +1,28 @@
+/**
+ * @file cap_sim_regs.h
+ * @brief 仿真构建的寄存器访问宏(编译固件源文件时以 -include 强制包含)
+ * @version 1.0
+ * @date 2025-11-01
+ *
+ * 先包含gd32c2x1.h(此后其他文件再包含时直接跳过)，再把寄存器访问宏
+ * 重定义为仿真器的访问函数。外设头文件中的寄存器宏在使用处展开，
+ * 因此固件和标准外设库的所有寄存器访问都经过仿真器。
+ */
+
+#ifndef CAP_SIM_REGS_H_
+#define CAP_SIM_REGS_H_
+
+#include "gd32c2x1.h"
+#include "cap_sim.h"
+
+#undef REG64
+#undef REG32
+#undef REG16
+#undef REG8
+
+#define REG64(addr) (*cap_sim_reg64((uint32_t)(addr)))
+#define REG32(addr) (*cap_sim_reg32((uint32_t)(addr)))
+#define REG16(addr) (*cap_sim_reg16((uint32_t)(addr)))
+#define REG8(addr)  (*cap_sim_reg8((uint32_t)(addr)))
+
+#endif /* CAP_SIM_REGS_H_ */
@@ -0,0 +1,311 @@
+/**
+ * @file cap_sim_run.cpp
+ * @brief 固件寄存器级仿真运行工具(上位机)
+ * @version 1.0
+ * @date 2025-11-01
+ *
+ * 在仿真器上运行未修改的固件(main.c的完整扫描循环)，按脚本注入触摸电容、噪声、
+ * 温度和电压，并检查触摸掩码。USART0发送的数据流实时解码(校验仿真的硬件CRC和
+ * 帧格式)，也可以保存后交给cap_decode/cap_record/cap_replay。
+ *
+ * 脚本每行一条命令，按时间顺序:
+ *
+ *   <毫秒> pad <通道> <pF>        通道电容(默认20pF)
+ *   <毫秒> touch <通道> [<pF>]    触摸: 通道电容增加(默认5pF)
+ *   <毫秒> release <通道>         释放
+ *   <毫秒> res <通道> <千欧>      充电电阻(默认4700千欧)
+ *   <毫秒> noise <pF>             每次充电的电容噪声(均方根值)
+ *   <毫秒> temp <°C>              芯片温度
+ *   <毫秒> vdd <V>                电源电压
+ *   <毫秒> expect <掩码>          检查cap_touch_get_touch_mask()
+ *   <毫秒> end                    结束
+ *
+ * 编译(Linux，在本目录):
+ *   FW=../../../Firmware
+ *   CFLAGS="-O2 -DUSE_STDPERIPH_DRIVER -DGD32C231 -I. -I../.. -I$FW/CMSIS/GD/GD32C2x1/Include
+ *           -I$FW/GD32C2x1_standard_peripheral/Include -include cap_sim_regs.h
+ *           -Wno-pointer-to-int-cast -Wno-int-to-pointer-cast"
+ *   for f in ../../cap_*.c ../../gd32c2x1_it.c cap_sim_systick.c \
+ *            $FW/CMSIS/GD/GD32C2x1/Source/system_gd32c2x1.c $FW/GD32C2x1_standard_peripheral/Source/gd32c2x1_*.c; do
+ *       gcc $CFLAGS -c $f; done
+ *   gcc $CFLAGS -Dmain=cap_sim_firmware_main -c ../../main.c
+ *   g++ -O2 -std=c++17 -DUSE_STDPERIPH_DRIVER -DGD32C231 -I. -I.. -I../.. -I$FW/CMSIS/GD/GD32C2x1/Include
+ *       -I$FW/GD32C2x1_standard_peripheral/Include -c cap_sim.cpp cap_sim_run.cpp ../cap_stream.cpp
+ *   g++ -no-pie *.o -lm -o cap_sim_run
+ *
+ * (systick.c由cap_sim_systick.c替代；固件把指针转换为uint32_t，必须以-no-pie链接。)
+ *
+ * 使用:
+ *   ./cap_sim_run touch_demo.sim
+ *   ./cap_sim_run -o stream.bin touch_demo.sim && ../cap_replay -e stream.bin
+ */
+
+#include "cap_sim.h"
+#include "cap_stream.h"
+
+extern "C" {
+#include "cap_touch.h"
+int cap_sim_firmware_main(void);
+}
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+/** 触摸通道引脚(与cap_touch.c的g_touch_pads一致) */
+const uint8_t kPadPins[] = {
+    CAP_SIM_PIN(0, 0), CAP_SIM_PIN(0, 1), CAP_SIM_PIN(0, 2), CAP_SIM_PIN(0, 3), CAP_SIM_PIN(0, 6), CAP_SIM_PIN(0, 7),
+};
+constexpr int kPads = sizeof(kPadPins) / sizeof(kPadPins[0]);
+
+/** 默认负载 */
+constexpr double kDefaultR       = 4.7e6;
+constexpr double kDefaultC       = 20.0;
+constexpr double kDefaultTouchPf = 5.0;
+
+/** 指示灯端口(GPIOB PB0-PB5) */
+constexpr uint8_t kIndicatorPort = 1;
+
+/**
+ * @brief 脚本命令
+ */
+struct Command {
+    double      ms;
+    std::string op;
+    double      a = 0.0;
+    double      b = NAN;
+    int         line;
+};
+
+/**
+ * @brief 数据流输出: 实时解码，可选保存
+ */
+struct TxSink {
+    cap::StreamDecoder decoder{cap::StreamFormat::V1};
+    FILE              *out = nullptr;
+    uint8_t            buf[256];
+    size_t             fill = 0;
+
+    void flush()
+    {
+        if (fill == 0) { return; }
+        decoder.feed(buf, fill, cap_sim_time_ns(), nullptr);
+        if (out != nullptr) { std::fwrite(buf, 1, fill, out); }
+        fill = 0;
+    }
+
+    static void on_byte(uint8_t data, void *arg)
+    {
+        TxSink *sink = static_cast<TxSink *>(arg);
+        sink->buf[sink->fill++] = data;
+        if (sink->fill == sizeof(sink->buf)) { sink->flush(); }
+    }
+};
+
+void firmware_entry(void)
+{
+    SystemInit();
+    cap_sim_firmware_main();
+}
+
+void usage(const char *prog)
+{
+    std::fprintf(stderr,
+                 "usage: %s [-o stream.bin] [-a access_cycles] [-s seed] [-v] script.sim\n"
+                 "  -o  save the USART0 stream (- for stdout)\n"
+                 "  -a  CPU cycles per register access (default 8)\n"
+                 "  -s  noise seed\n"
+                 "  -v  print every expectation\n",
+                 prog);
+}
+
+bool load_script(const char *path, std::vector<Command> &script)
+{
+    FILE *f = std::fopen(path, "r");
+    if (f == nullptr) {
+        std::perror(path);
+        return false;
+    }
+
+    char   line[256];
+    int    n    = 0;
+    double last = 0.0;
+    bool   ok   = true;
+    while (std::fgets(line, sizeof(line), f) != nullptr) {
+        n++;
+        char *hash = std::strchr(line, '#');
+        if (hash != nullptr) { *hash = '\0'; }
+
+        Command cmd;
+        char    op[32];
+        int     fields = std::sscanf(line, "%lf %31s %lf %lf", &cmd.ms, op, &cmd.a, &cmd.b);
+        if (fields <= 0) { continue; }
+        if (fields < 2 || cmd.ms < last) {
+            std::fprintf(stderr, "%s:%d: bad line\n", path, n);
+            ok = false;
+            break;
+        }
+        cmd.op   = op;
+        cmd.line = n;
+        if (fields < 4) { cmd.b = NAN; }
+        if ((cmd.op == "pad" || cmd.op == "touch" || cmd.op == "release" || cmd.op == "res") &&
+            (cmd.a < 0 || cmd.a >= kPads || ((cmd.op == "pad" || cmd.op == "res") && fields < 4))) {
+            std::fprintf(stderr, "%s:%d: bad channel or value\n", path, n);
+            ok = false;
+            break;
+        }
+        last = cmd.ms;
+        script.push_back(cmd);
+    }
+    std::fclose(f);
+    return ok;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    const char *out_path = nullptr;
+    uint32_t    seed     = 1;
+    bool        verbose  = false;
+    int         opt;
+
+    while ((opt = getopt(argc, argv, "o:a:s:vh")) != -1) {
+        switch (opt) {
+        case 'o': out_path = optarg; break;
+        case 'a': cap_sim_set_access_cycles(static_cast<uint32_t>(std::strtoul(optarg, nullptr, 0))); break;
+        case 's': seed = static_cast<uint32_t>(std::strtoul(optarg, nullptr, 0)); break;
+        case 'v': verbose = true; break;
+        default: usage(argv[0]); return opt == 'h' ? 0 : 2;
+        }
+    }
+    if (optind + 1 != argc) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    std::vector<Command> script;
+    if (!load_script(argv[optind], script)) { return 2; }
+
+    TxSink sink;
+    if (out_path != nullptr) {
+        sink.out = (std::strcmp(out_path, "-") == 0) ? stdout : std::fopen(out_path, "wb");
+        if (sink.out == nullptr) {
+            std::perror(out_path);
+            return 2;
+        }
+    }
+
+    double pad_c[kPads];
+    double pad_r[kPads];
+    double touch_c[kPads] = {};
+    double noise          = 0.0;
+    double vdd            = 3.3;
+    double temp           = 25.0;
+
+    cap_sim_start(firmware_entry);
+    cap_sim_set_tx_callback(TxSink::on_byte, &sink);
+    cap_sim_set_noise(noise, seed);
+    cap_sim_set_supply(vdd, temp);
+    for (int i = 0; i < kPads; i++) {
+        pad_c[i] = kDefaultC;
+        pad_r[i] = kDefaultR;
+        cap_sim_pin_load(kPadPins[i], pad_r[i], pad_c[i]);
+    }
+
+    int      expects = 0;
+    int      failed  = 0;
+    bool     faulted = false;
+    uint64_t start   = cap::monotonic_ns();
+
+    for (const Command &cmd : script) {
+        if (cap_sim_run(static_cast<uint64_t>(cmd.ms * 1e6)) != 0) {
+            faulted = true;
+            break;
+        }
+
+        int ch = static_cast<int>(cmd.a);
+        if (cmd.op == "pad") {
+            pad_c[ch] = cmd.b;
+        } else if (cmd.op == "touch") {
+            touch_c[ch] = std::isnan(cmd.b) ? kDefaultTouchPf : cmd.b;
+        } else if (cmd.op == "release") {
+            touch_c[ch] = 0.0;
+        } else if (cmd.op == "res") {
+            pad_r[ch] = cmd.b * 1e3;
+            cap_sim_pin_load(kPadPins[ch], pad_r[ch], pad_c[ch] + touch_c[ch]);
+        } else if (cmd.op == "noise") {
+            noise = cmd.a;
+            cap_sim_set_noise(noise, seed);
+        } else if (cmd.op == "temp") {
+            temp = cmd.a;
+            cap_sim_set_supply(vdd, temp);
+        } else if (cmd.op == "vdd") {
+            vdd = cmd.a;
+            cap_sim_set_supply(vdd, temp);
+        } else if (cmd.op == "expect") {
+            uint8_t mask = cap_touch_get_touch_mask();
+            bool    ok   = mask == static_cast<uint8_t>(cmd.a);
+            expects++;
+            if (!ok) { failed++; }
+            if (!ok || verbose) {
+                std::fprintf(stderr, "%8.1f ms line %d: touch mask 0x%02X, expected 0x%02X, leds 0x%02X %s\n", cmd.ms,
+                             cmd.line, mask, static_cast<unsigned>(cmd.a),
+                             cap_sim_gpio_output(kIndicatorPort) & 0x3FU, ok ? "ok" : "FAIL");
+            }
+        } else if (cmd.op == "end") {
+            break;
+        } else {
+            std::fprintf(stderr, "line %d: unknown command '%s'\n", cmd.line, cmd.op.c_str());
+            return 2;
+        }
+
+        if (cmd.op == "pad" || cmd.op == "touch" || cmd.op == "release") {
+            cap_sim_pin_capacitance(kPadPins[ch], pad_c[ch] + touch_c[ch]);
+        }
+    }
+
+    double wall = static_cast<double>(cap::monotonic_ns() - start) / 1e9;
+    sink.flush();
+    if (sink.out != nullptr && sink.out != stdout) { std::fclose(sink.out); }
+
+    cap_sim_stats_t stats;
+    cap_sim_get_stats(&stats);
+    double sim_s  = static_cast<double>(stats.cycles) / CAP_SIM_CORE_HZ;
+    double cycles = stats.cycles ? static_cast<double>(stats.cycles) : 1.0;
+
+    std::fprintf(stderr, "simulated %.3f s in %.3f s (%.1fx real time), %llu register accesses\n", sim_s, wall,
+                 sim_s / wall, static_cast<unsigned long long>(stats.accesses));
+    std::fprintf(stderr, "cpu load %.1f%% (isr %.1f%%), captures %llu, capture overruns %llu, tx %llu bytes\n",
+                 100.0 * (1.0 - static_cast<double>(stats.idle_cycles + stats.deepsleep_cycles) / cycles),
+                 100.0 * static_cast<double>(stats.isr_cycles) / cycles,
+                 static_cast<unsigned long long>(stats.captures),
+                 static_cast<unsigned long long>(stats.capture_overruns),
+                 static_cast<unsigned long long>(stats.tx_bytes));
+    if (stats.deepsleeps != 0) {
+        std::fprintf(stderr, "deep sleep %.1f%%, %llu wakeups (%.1f/s)\n",
+                     100.0 * static_cast<double>(stats.deepsleep_cycles) / cycles,
+                     static_cast<unsigned long long>(stats.deepsleeps), static_cast<double>(stats.deepsleeps) / sim_s);
+    }
+    std::fprintf(stderr, "interrupts:");
+    for (int i = 0; i < 48; i++) {
+        if (stats.irqs[i] != 0) {
+            std::fprintf(stderr, " %d:%llu", i - 16, static_cast<unsigned long long>(stats.irqs[i]));
+        }
+    }
+    std::fprintf(stderr, "\n");
+    cap_touch_stats_t touch;
+    cap_touch_get_stats(&touch);
+    std::fprintf(stderr, "firmware: %lu frames, %lu capture timeouts\n", static_cast<unsigned long>(touch.frames),
+                 static_cast<unsigned long>(touch.capture_timeouts));
+    sink.decoder.report(stderr, false);
+
+    std::fprintf(stderr, "%d expectations, %d failed%s\n", expects, failed, faulted ? ", firmware FAULT" : "");
+    return (failed != 0 || faulted) ? 1 : 0;
+}
@@ -0,0 +1,47 @@
+/**
+ * @file cap_sim_systick.c
+ * @brief 仿真构建的SysTick延时(替代Template/systick.c)
+ * @version 1.0
+ * @date 2025-11-01
+ *
+ * systick.c的delay_1ms在RAM变量上忙等，仿真器看不到这种等待，
+ * 仿真构建在等待时执行WFI。其他行为与systick.c一致。
+ */
+
+#include "systick.h"
+#include "cap_touch.h"
+
+static volatile uint32_t delay_time = 0;
+
+void systick_config(void)
+{
+    /* setup systick timer for 1ms interrupts */
+    if (SysTick_Config(SystemCoreClock / 1000U)){
+        /* capture error */
+        while (1){
+        }
+    }
+    /* configure the systick handler priority */
+    NVIC_SetPriority(SysTick_IRQn, 0x00U);
+}
+
+void delay_1ms(uint32_t count)
+{
+    delay_time = count;
+    while(0U != delay_time){
+        __WFI();
+    }
+}
+
+void delay_decrement(void)
+{
+    if (0U != delay_time){
+        delay_time--;
+    }
+}
+
+void SysTick_Handler(void)
+{
+    delay_decrement();
+    cap_touch_systick_handler();  /* 更新触摸模块时间戳 */
+}
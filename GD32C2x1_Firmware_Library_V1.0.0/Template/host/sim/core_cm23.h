@@ -0,0 +1,195 @@
+/**
+ * @file core_cm23.h
+ * @brief Cortex-M23内核接口(上位机仿真版本)
+ * @version 1.0
+ * @date 2025-11-01
+ *
+ * 替代CMSIS的core_cm23.h，只用于上位机仿真构建(本目录在包含路径中位于CMSIS之前)。
+ * SysTick/NVIC/SCB寄存器映射到仿真器的寄存器文件，中断屏蔽、WFI等内核指令
+ * 由仿真器实现，见 cap_sim.h。
+ */
+
+#ifndef CORE_CM23_H_
+#define CORE_CM23_H_
+
+#include "cap_sim.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define __CM23_CMSIS_VERSION_MAIN 5U
+#define __CM23_CMSIS_VERSION_SUB  0U
+
+#define __I     volatile const
+#define __O     volatile
+#define __IO    volatile
+#define __IM    volatile const
+#define __OM    volatile
+#define __IOM   volatile
+
+#define __ASM                  __asm
+#define __INLINE               inline
+#define __STATIC_INLINE        static inline
+#define __STATIC_FORCEINLINE   static inline
+#define __NO_RETURN            __attribute__((__noreturn__))
+#define __USED                 __attribute__((used))
+#define __WEAK                 __attribute__((weak))
+#define __PACKED               __attribute__((packed))
+#define __PACKED_STRUCT        struct __attribute__((packed))
+#define __ALIGNED(x)           __attribute__((aligned(x)))
+
+/**
+ * @brief SysTick寄存器
+ */
+typedef struct {
+    __IOM uint32_t CTRL;
+    __IOM uint32_t LOAD;
+    __IOM uint32_t VAL;
+    __IM  uint32_t CALIB;
+} SysTick_Type;
+
+#define SysTick_CTRL_COUNTFLAG_Msk (1UL << 16U)
+#define SysTick_CTRL_CLKSOURCE_Msk (1UL << 2U)
+#define SysTick_CTRL_TICKINT_Msk   (1UL << 1U)
+#define SysTick_CTRL_ENABLE_Msk    (1UL)
+#define SysTick_LOAD_RELOAD_Msk    (0xFFFFFFUL)
+#define SysTick_VAL_CURRENT_Msk    (0xFFFFFFUL)
+
+/**
+ * @brief NVIC寄存器(ARMv8-M基础版布局)
+ */
+typedef struct {
+    __IOM uint32_t ISER[16];
+    uint32_t       RESERVED0[16];
+    __IOM uint32_t ICER[16];
+    uint32_t       RESERVED1[16];
+    __IOM uint32_t ISPR[16];
+    uint32_t       RESERVED2[16];
+    __IOM uint32_t ICPR[16];
+    uint32_t       RESERVED3[16];
+    __IOM uint32_t IABR[16];
+    uint32_t       RESERVED4[16];
+    __IOM uint32_t ITNS[16];
+    uint32_t       RESERVED5[16];
+    __IOM uint32_t IPR[124];
+} NVIC_Type;
+
+/**
+ * @brief 系统控制块寄存器
+ */
+typedef struct {
+    __IM  uint32_t CPUID;
+    __IOM uint32_t ICSR;
+    __IOM uint32_t VTOR;
+    __IOM uint32_t AIRCR;
+    __IOM uint32_t SCR;
+    __IOM uint32_t CCR;
+    uint32_t       RESERVED1;
+    __IOM uint32_t SHPR[2U];
+    __IOM uint32_t SHCSR;
+} SCB_Type;
+
+#define SCB_SCR_SEVONPEND_Msk   (1UL << 4U)
+#define SCB_SCR_SLEEPDEEP_Msk   (1UL << 2U)
+#define SCB_SCR_SLEEPONEXIT_Msk (1UL << 1U)
+
+#define SCS_BASE     (0xE000E000UL)
+#define SysTick_BASE (SCS_BASE + 0x0010UL)
+#define NVIC_BASE    (SCS_BASE + 0x0100UL)
+#define SCB_BASE     (SCS_BASE + 0x0D00UL)
+
+/* 每次通过指针访问都经过仿真器，访问结束后的写入在下一次寄存器访问时生效 */
+#define SysTick ((SysTick_Type *)cap_sim_core(SysTick_BASE, sizeof(SysTick_Type)))
+#define NVIC    ((NVIC_Type *)cap_sim_core(NVIC_BASE, sizeof(NVIC_Type)))
+#define SCB     ((SCB_Type *)cap_sim_core(SCB_BASE, sizeof(SCB_Type)))
+
+/* 内核指令 */
+__STATIC_INLINE void __enable_irq(void)
+{
+    cap_sim_primask_set(0U);
+}
+
+__STATIC_INLINE void __disable_irq(void)
+{
+    cap_sim_primask_set(1U);
+}
+
+__STATIC_INLINE uint32_t __get_PRIMASK(void)
+{
+    return cap_sim_primask_get();
+}
+
+__STATIC_INLINE void __set_PRIMASK(uint32_t priMask)
+{
+    cap_sim_primask_set(priMask & 1U);
+}
+
+__STATIC_INLINE void __WFI(void)
+{
+    cap_sim_wfi();
+}
+
+__STATIC_INLINE void __WFE(void)
+{
+    cap_sim_wfi();
+}
+
+__STATIC_INLINE void __SEV(void) {}
+__STATIC_INLINE void __ISB(void) {}
+__STATIC_INLINE void __DSB(void) {}
+__STATIC_INLINE void __DMB(void) {}
+
+__STATIC_INLINE void __NOP(void)
+{
+    cap_sim_cycles(1U);
+}
+
+/* NVIC: 使能/优先级直接交给仿真器的中断控制器 */
+__STATIC_INLINE void NVIC_EnableIRQ(IRQn_Type IRQn)
+{
+    cap_sim_nvic_enable((int32_t)IRQn, 1U);
+}
+
+__STATIC_INLINE void NVIC_DisableIRQ(IRQn_Type IRQn)
+{
+    cap_sim_nvic_enable((int32_t)IRQn, 0U);
+}
+
+__STATIC_INLINE void NVIC_SetPriority(IRQn_Type IRQn, uint32_t priority)
+{
+    cap_sim_nvic_priority((int32_t)IRQn, priority);
+}
+
+__STATIC_INLINE uint32_t NVIC_GetPendingIRQ(IRQn_Type IRQn)
+{
+    return cap_sim_nvic_pending((int32_t)IRQn);
+}
+
+__STATIC_INLINE void NVIC_ClearPendingIRQ(IRQn_Type IRQn)
+{
+    (void)IRQn;
+}
+
+__STATIC_INLINE void NVIC_SystemReset(void)
+{
+    cap_sim_fault("NVIC_SystemReset");
+}
+
+__STATIC_INLINE uint32_t SysTick_Config(uint32_t ticks)
+{
+    if ((ticks - 1UL) > SysTick_LOAD_RELOAD_Msk) { return 1UL; }
+
+    SysTick->LOAD = (uint32_t)(ticks - 1UL);
+    NVIC_SetPriority(SysTick_IRQn, (1UL << __NVIC_PRIO_BITS) - 1UL);
+    SysTick->VAL  = 0UL;
+    SysTick->CTRL = SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_TICKINT_Msk | SysTick_CTRL_ENABLE_Msk;
+    return 0UL;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CORE_CM23_H_ */
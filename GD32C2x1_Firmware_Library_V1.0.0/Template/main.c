@@ -5,41 +5,134 @@
  * @date 2025-11-01
  */
 
+#include "cap_cmd.h"
+#include "cap_crc.h"
+#include "cap_fast.h"
+#include "cap_i2c.h"
+#include "cap_kv.h"
+#include "cap_lp.h"
+#include "cap_prof.h"
+#include "cap_proto.h"
+#include "cap_spi.h"
 #include "cap_touch.h"
+#include "cap_touch_comp.h"
+#include "cap_uart.h"
 #include "gd32c2x1.h"
 #include "systick.h"
 
 /* 触摸检测阈值 - 根据实际情况调整 */
 #define TOUCH_THRESHOLD      150 /* 触摸阈值，超过此值认为被触摸 */
 
-/* DMA发送缓冲区大小 */
-#define DMA_SEND_BUFFER_SIZE 32
+/* 主机唤醒引脚: 检测到接近时输出高电平 */
+#define HOST_WAKE_PORT       GPIOA
+#define HOST_WAKE_PIN        GPIO_PIN_8
+#define HOST_WAKE_RCU        RCU_GPIOA
 
-typedef struct {
-    uint16_t header;   /* 包头: 0xA5A5 */
-    uint16_t data[6];  /* 6个数据 */
-    uint16_t checksum; /* 累加校验值 */
-} __attribute__((packed)) cap_frame_t;
-/* 32字节对齐的全局DMA发送缓冲区 */
-__attribute__((aligned(32))) static cap_frame_t g_dma_send_buffer;
+/* 主机数据链路: USART数据流和命令通道(默认)，或SPI从机(高速原始数据导出，占用USART的DMA通道) */
+#define HOST_LINK_USART      0
+#define HOST_LINK_SPI        1
+#define HOST_LINK            HOST_LINK_USART
+
+/* 启动时校验的固件映像范围(Flash中键值存储保留页之前的部分)，CRC-32按32位字计算，可通过参数0x17读取 */
+#define IMAGE_CRC_BASE       FLASH_BASE
+#define IMAGE_CRC_SIZE       (CAP_KV_BASE - FLASH_BASE)
+
+/* 原始数据帧长度 */
+#define RAW_FRAME_SIZE       (CAP_PROTO_HEADER_SIZE + sizeof(cap_proto_raw_t) + CAP_PROTO_CRC_SIZE)
+
+/* 数据流模式 */
+typedef enum {
+    STREAM_MODE_RAW = 0, /* 每次扫描发送一个原始数据帧 */
+    STREAM_MODE_DELTA,   /* 多次扫描差分压缩后合并为一帧 */
+    STREAM_MODE_BATCH    /* 多次扫描(带时间差)合并为一帧 */
+} stream_mode_t;
+
+/* 默认数据流模式 */
+#define STREAM_MODE_DEFAULT             STREAM_MODE_RAW
+
+/* 差分/批量模式默认参数: 每帧最多扫描次数，第一次扫描到发送的最大延迟(微秒) */
+#define STREAM_BATCH_SCANS_DEFAULT      16
+#define STREAM_BATCH_LATENCY_US_DEFAULT 20000
+
+/* 低功耗扫描默认使能: 空闲扫描的帧间等待期间深度睡眠(参数0x19) */
+#define LOW_POWER_DEFAULT               0
+
+/* 遥测帧默认周期(毫秒)，0为不发送 */
+#define TELEMETRY_PERIOD_MS_DEFAULT     1000
+
+/* 遥测帧长度 */
+#define TELEMETRY_FRAME_SIZE            (CAP_PROTO_HEADER_SIZE + sizeof(cap_proto_telemetry_t) + CAP_PROTO_CRC_SIZE)
+
+/* 扫描时序帧长度 */
+#define TIMING_FRAME_SIZE               (CAP_PROTO_HEADER_SIZE + sizeof(cap_proto_timing_t) + CAP_PROTO_CRC_SIZE)
+
+/* 差分/批量编码缓冲区，帧完成后复制到发送缓冲区(原始数据帧直接写入发送缓冲区，见 cap_uart.h) */
+__attribute__((aligned(4))) static uint8_t g_stream_frame[CAP_PROTO_MAX_FRAME];
+
+static uint8_t               g_stream_enabled   = 1;
+static stream_mode_t         g_stream_mode      = STREAM_MODE_DEFAULT;
+static uint8_t               g_batch_scans      = STREAM_BATCH_SCANS_DEFAULT;
+static uint32_t              g_batch_latency_us = STREAM_BATCH_LATENCY_US_DEFAULT;
+static uint64_t              g_stream_first_us  = 0; /* 待发送帧中第一次扫描的时间戳 */
+static cap_proto_delta_enc_t g_delta_enc;
+static cap_proto_batch_enc_t g_batch_enc;
+
+static uint32_t              g_telemetry_period_ms = TELEMETRY_PERIOD_MS_DEFAULT;
+static uint64_t              g_telemetry_last_us   = 0; /* 上一个遥测帧的发送时间 */
+static uint32_t              g_scan_overruns       = 0; /* 处理时间超过扫描节拍的次数 */
+static uint32_t              g_image_crc           = 0; /* 启动时计算的固件映像CRC */
+
+static uint8_t               g_lp_ready   = 0;                 /* RTC闹钟已初始化，可以深度睡眠 */
+static uint8_t               g_lp_enabled = LOW_POWER_DEFAULT; /* 低功耗扫描使能 */
 
 /* 触摸数据就绪回调函数 */
 void on_touch_data_ready(capture_data_t *data);
 
+/* 接近状态变化回调函数 */
+void on_proximity_changed(cap_bool_t near);
+
+/* 数据流帧缓存 */
+static uint8_t stream_pending(void);
+static void    stream_begin(void);
+static void    stream_flush(void);
+
+/* 切换数据流模式 */
+void stream_mode_set(stream_mode_t mode);
+
+/* 配置差分/批量模式的每帧扫描次数和最大延迟 */
+void stream_batch_config(uint8_t scans, uint32_t max_latency_us);
+
+/* 检查待发送帧是否超过最大延迟 */
+void stream_poll(void);
+
+/* 按周期发送遥测帧 */
+void telemetry_poll(void);
+#if CAP_PROF_ENABLE
+static void profile_send(void);
+#endif
+#if CAP_TOUCH_TIMING_ENABLE
+static void timing_send(void);
+#endif
+
+/* 空闲扫描帧间深度睡眠 */
+static void low_power_poll(void);
+
+/* 命令通道: 数据流参数处理 */
+uint8_t on_stream_param(uint8_t set, cap_proto_param_t *param);
+
+/* 保存/删除Flash中的校准 */
+static uint8_t calib_save(uint32_t save);
+
+/* 主机唤醒引脚配置 */
+void host_wake_gpio_config(void);
+
 /* USART配置 */
 void usart_config(void);
 
-/* DMA配置 */
-void dma_config(void);
-
 /* USART发送函数 */
 void usart_send_byte(uint8_t data);
 void usart_send_buffer(uint8_t *buffer, uint16_t length);
 
-/* DMA发送函数 */
-void    usart_send_buffer_dma(uint8_t *buffer, uint16_t length);
-uint8_t usart_dma_is_busy(void);
-
 void timer13_cap_touch_config(void);
 
 /**
@@ -47,26 +140,84 @@ void timer13_cap_touch_config(void);
  */
 int main(void)
 {
-    capture_data_t touch_data;
+    capture_data_t    touch_data;
+    cap_touch_calib_t calib;
 
     /* 配置系统滴答定时器 */
     systick_config();
 
-    // /* 配置DMA */
-    dma_config();
+    /* 初始化帧协议(硬件CRC) */
+    cap_proto_init();
 
+    /* 启动固件映像校验: DMA_CH2把Flash写入CRC单元，CPU继续初始化 */
+    cap_crc_start(&cap_crc_config_crc32, (const void *)IMAGE_CRC_BASE, IMAGE_CRC_SIZE, INPUT_FORMAT_WORD, NULL, NULL);
+
+#if CAP_PROF_ENABLE
+    /* 启动性能分析周期计数器(TIMER16) */
+    cap_prof_init();
+#endif
+
+#if HOST_LINK == HOST_LINK_SPI
+    /* 初始化SPI从机数据流，命令在同一事务中接收，应答放入数据页 */
+    cap_spi_init();
+    cap_cmd_register_send(cap_spi_send);
+    cap_cmd_register_param_handler(on_stream_param);
+#else
     // /* 配置USART用于数据输出 */
     usart_config();
 
+    /* 启动循环DMA连续发送 */
+    cap_uart_tx_init();
+
+    /* 选择数据流模式 */
+    stream_mode_set(STREAM_MODE_DEFAULT);
+
+    /* 初始化串口命令通道(DMA循环接收 + 空闲中断) */
+    cap_cmd_register_send(cap_uart_tx_write);
+    cap_cmd_register_param_handler(on_stream_param);
+    cap_cmd_init();
+#endif
+
+    /* DMA_CH2交给I2C寄存器接口之前等待映像校验完成(完成中断或SysTick唤醒) */
+    while (cap_crc_busy()) { __WFI(); }
+    g_image_crc = cap_crc_result();
+
+    /* 初始化I2C从机寄存器接口(主机SoC通过I2C读取触摸数据) */
+    cap_i2c_init();
+
     /* 注册数据就绪回调函数 */
     cap_touch_register_data_ready_callback(on_touch_data_ready);
 
+    /* 配置主机唤醒引脚并注册接近回调函数 */
+    host_wake_gpio_config();
+    cap_touch_register_proximity_callback(on_proximity_changed);
+
     /* 初始化电容触摸模块 */
     cap_touch_init();
 
+    /* 初始化温度/电源电压补偿(需在禁用SysTick中断之前) */
+    cap_touch_comp_init();
+
+    /* 恢复Flash中保存的校准(基线、阈值和量程配置)，没有保存时从第一帧建立基线 */
+    if (cap_kv_init() && cap_kv_get(CAP_KV_KEY_TOUCH_CALIB, &calib, sizeof(calib))) {
+        cap_touch_set_calibration(&calib);
+    }
+
     /* 初始化触摸指示GPIO (PB0-PB5) */
     cap_touch_gpio_indicator_init();
 
+    /* 使能接近检测(通道0-3并联) */
+    cap_touch_proximity_enable(CAP_TRUE);
+
+    /* 低功耗扫描: RTC闹钟唤醒深度睡眠，主机链路的起始沿(数据线/片选下降沿)也唤醒 */
+    g_lp_ready = cap_lp_init();
+    cap_lp_wake_pin_add(GPIOB, GPIO_PIN_9); /* I2C0_SDA */
+#if HOST_LINK == HOST_LINK_SPI
+    cap_lp_wake_pin_add(GPIOA, CAP_SPI_NSS_PIN);
+#else
+    cap_lp_wake_pin_add(GPIOB, GPIO_PIN_7); /* USART0_RX */
+#endif
+
     /* 禁用 SysTick 中断 (直接操作寄存器) */
     SysTick->CTRL &= ~SysTick_CTRL_TICKINT_Msk; /* 清除TICKINT位，禁用SysTick中断 */
 
@@ -75,12 +226,35 @@ int main(void)
 
     while (1) {
         /* 轮询检测TIMER13更新事件标志 */
-        if (timer_flag_get(TIMER13, TIMER_FLAG_UP) != RESET) {
+        if (cap_timer_flag_get(TIMER13, TIMER_FLAG_UP) != RESET) {
             /* 清除标志 */
-            timer_flag_clear(TIMER13, TIMER_FLAG_UP);
+            cap_timer_int_flag_clear(TIMER13, TIMER_FLAG_UP);
 
             /* 执行触摸检测处理函数 */
             cap_touch_process();
+
+#if HOST_LINK == HOST_LINK_SPI
+            /* 解析SPI事务中的命令，数据页按最大延迟提交 */
+            cap_spi_poll();
+#else
+            /* 空闲扫描时批量帧按最大延迟发送 */
+            stream_poll();
+
+            /* 解析并执行串口命令 */
+            cap_cmd_poll();
+#endif
+
+            /* 应用主机通过I2C写入的配置 */
+            cap_i2c_poll();
+
+            /* 发送链路健康遥测 */
+            telemetry_poll();
+
+            /* 处理期间下一个节拍已经到来: 扫描时序被拉长 */
+            if (cap_timer_flag_get(TIMER13, TIMER_FLAG_UP) != RESET) { g_scan_overruns++; }
+
+            /* 空闲扫描帧间等待期间深度睡眠 */
+            if (g_lp_enabled) { low_power_poll(); }
         }
 
         /* 可选: 进入低功耗等待中断 (注意:轮询模式下不建议使用WFI) */
@@ -97,15 +271,6 @@ uint16_t sum_check(uint8_t *data, uint16_t len)
     return sum & 0xFFFF;  // 0x01 & oxff   0000 0001
 }
 
-static uint16_t cap_calculate_checksum(const uint16_t *data, uint32_t len)
-{
-    uint16_t sum = 0;
-    for (uint32_t i = 0; i < len; i++) {
-        sum += data[i];
-    }
-    return sum;
-}
-
 /**
  * @brief 触摸数据就绪回调函数
  *
@@ -120,20 +285,389 @@ void on_touch_data_ready(capture_data_t *data)
 
     cap_test_gpio_toggle();
 
-    /* 准备数据到全局DMA缓冲区 */
-    g_dma_send_buffer.header = 0xA5A5;
+    /* 更新I2C寄存器快照 */
+    cap_i2c_update(data);
+
+    if (!g_stream_enabled) { return; }
+
+#if HOST_LINK == HOST_LINK_SPI
+    /* SPI数据流只发送原始数据帧，直接在数据页中填写负载 */
+    cap_proto_raw_t *raw = cap_spi_raw_begin();
+#else
+    uint8_t         *frame = NULL;
+    cap_proto_raw_t  scan;
+    cap_proto_raw_t *raw = &scan;
+
+    /* 原始数据帧直接在发送缓冲区中填写负载，差分模式先交给编码器 */
+    if (g_stream_mode == STREAM_MODE_RAW) {
+        frame = cap_uart_tx_reserve(RAW_FRAME_SIZE);
+        if (frame == NULL) {
+            /* 丢弃的帧也占用序号，上位机从序号间隔发现丢失 */
+            cap_proto_seq_skip(1);
+            return;
+        }
+        raw = (cap_proto_raw_t *)cap_proto_payload(frame);
+    }
+#endif
+
+    for (uint8_t i = 0; i < CAP_PROTO_CHANNELS; i++) {
+        raw->values[i] = (uint16_t)data->values[i];
+    }
+
+    raw->touch_mask = cap_touch_get_touch_mask();
+    raw->flags      = 0;
+    if (cap_touch_get_scan_mode() == CAP_SCAN_IDLE) { raw->flags |= CAP_PROTO_FLAG_IDLE; }
+    if (cap_touch_is_proximity()) { raw->flags |= CAP_PROTO_FLAG_PROXIMITY; }
+    if (cap_touch_is_guard_veto()) { raw->flags |= CAP_PROTO_FLAG_GUARD; }
+
+#if HOST_LINK == HOST_LINK_SPI
+    cap_spi_raw_commit();
+#else
+    if (g_stream_mode == STREAM_MODE_RAW) {
+        /* 填写帧头并计算CRC，DMA到达时自动发送 */
+        cap_uart_tx_commit(cap_proto_finalize(frame, CAP_PROTO_TYPE_RAW, sizeof(cap_proto_raw_t)));
+        return;
+    }
+
+    if (stream_pending() == 0) { g_stream_first_us = data->timestamp; }
+
+    /* 帧满时发送，否则继续累积 */
+    if (g_stream_mode == STREAM_MODE_DELTA) {
+        if (cap_proto_delta_add(&g_delta_enc, raw)) { stream_flush(); }
+    } else {
+        if (cap_proto_batch_add(&g_batch_enc, raw, (uint32_t)data->timestamp)) { stream_flush(); }
+    }
+#endif
+}
+
+/**
+ * @brief 获取待发送帧中的扫描次数
+ */
+static uint8_t stream_pending(void)
+{
+    switch (g_stream_mode) {
+    case STREAM_MODE_DELTA:
+        return g_delta_enc.count;
+    case STREAM_MODE_BATCH:
+        return g_batch_enc.count;
+    default:
+        return 0;
+    }
+}
+
+/**
+ * @brief 开始一个新的差分/批量帧
+ */
+static void stream_begin(void)
+{
+    cap_proto_delta_begin(&g_delta_enc, g_stream_frame, g_batch_scans);
+    cap_proto_batch_begin(&g_batch_enc, g_stream_frame, g_batch_scans);
+}
+
+/**
+ * @brief 发送待发送的差分/批量帧，并开始新帧
+ */
+static void stream_flush(void)
+{
+    uint16_t length;
+
+    if (stream_pending() == 0) { return; }
+
+    if (g_stream_mode == STREAM_MODE_DELTA) {
+        length = cap_proto_delta_finish(&g_delta_enc);
+    } else {
+        length = cap_proto_batch_finish(&g_batch_enc);
+    }
+
+    cap_uart_tx_write(g_stream_frame, length);
+    stream_begin();
+}
+
+/**
+ * @brief 切换数据流模式
+ *
+ * 未发送完的帧先发送出去，差分模式的新帧从关键帧开始
+ */
+void stream_mode_set(stream_mode_t mode)
+{
+    stream_flush();
+
+    g_stream_mode = mode;
+    stream_begin();
+}
+
+/**
+ * @brief 配置差分/批量模式的每帧扫描次数和最大延迟
+ *
+ * @param scans 每帧最多扫描次数K(1-255)，DMA启动次数和帧头开销降为1/K；负载空间不足时提前发送
+ * @param max_latency_us 帧中第一次扫描到发送的最大延迟(微秒)，在空闲扫描时限制数据延迟
+ */
+void stream_batch_config(uint8_t scans, uint32_t max_latency_us)
+{
+    stream_flush();
+
+    g_batch_scans      = (scans == 0) ? 1 : scans;
+    g_batch_latency_us = max_latency_us;
+    stream_begin();
+}
+
+/**
+ * @brief 检查待发送帧是否超过最大延迟，在主循环中每个扫描节拍调用
+ */
+void stream_poll(void)
+{
+    if (!g_stream_enabled || stream_pending() == 0) { return; }
+
+    /* 关中断，避免与数据就绪回调同时修改编码器 */
+    __disable_irq();
+    if (stream_pending() != 0 && cap_touch_get_time_us() - g_stream_first_us >= g_batch_latency_us) { stream_flush(); }
+    __enable_irq();
+}
+
+/**
+ * @brief 按周期发送遥测帧，在主循环中每个扫描节拍调用
+ *
+ * 遥测帧与数据流相互独立，数据流停止时仍然发送
+ */
+void telemetry_poll(void)
+{
+    __attribute__((aligned(4))) uint8_t frame[TELEMETRY_FRAME_SIZE];
+    cap_proto_telemetry_t *telemetry = (cap_proto_telemetry_t *)cap_proto_payload(frame);
+    cap_touch_stats_t      stats;
+    cap_lp_stats_t         lp_stats;
+    uint64_t               now = cap_touch_get_time_us();
+
+    if (g_telemetry_period_ms == 0) { return; }
+    if (now - g_telemetry_last_us < (uint64_t)g_telemetry_period_ms * 1000U) { return; }
+    g_telemetry_last_us = now;
+
+    cap_touch_get_stats(&stats);
+    cap_lp_get_stats(&lp_stats);
+
+    telemetry->time_us          = (uint32_t)now;
+    telemetry->frames           = stats.frames;
+    telemetry->scan_overruns    = g_scan_overruns;
+    telemetry->capture_timeouts = stats.capture_timeouts;
+    telemetry->event_overflows  = cap_i2c_get_event_overflows();
+    telemetry->cmd_crc_errors   = cap_cmd_get_crc_errors();
+    telemetry->active_us        = (uint32_t)(now - lp_stats.sleep_us);
+    telemetry->wakeups          = lp_stats.wakeups;
+
+#if HOST_LINK == HOST_LINK_SPI
+    /* 主机多传输字节后复位SPI、重新启动DMA的次数 */
+    telemetry->tx_overflows = cap_spi_get_dropped_pages();
+    telemetry->dma_restarts = cap_spi_get_resyncs();
+    cap_spi_send(frame, cap_proto_finalize(frame, CAP_PROTO_TYPE_TELEMETRY, sizeof(cap_proto_telemetry_t)));
+#else
+    /* 循环DMA发送和接收从不重新启动 */
+    telemetry->tx_overflows = cap_uart_tx_get_dropped();
+    telemetry->dma_restarts = 0;
+    cap_uart_tx_write(frame, cap_proto_finalize(frame, CAP_PROTO_TYPE_TELEMETRY, sizeof(cap_proto_telemetry_t)));
+#endif
+
+#if CAP_PROF_ENABLE
+    profile_send();
+#endif
+#if CAP_TOUCH_TIMING_ENABLE
+    timing_send();
+#endif
+}
+
+#if CAP_PROF_ENABLE
+/**
+ * @brief 发送性能分析帧(各区段的执行周期数)，紧跟在遥测帧之后
+ */
+static void profile_send(void)
+{
+    __attribute__((aligned(4))) uint8_t frame[CAP_PROF_FRAME_SIZE];
+    uint16_t length = cap_prof_report((cap_proto_profile_t *)cap_proto_payload(frame));
+
+#if HOST_LINK == HOST_LINK_SPI
+    cap_spi_send(frame, cap_proto_finalize(frame, CAP_PROTO_TYPE_PROFILE, length));
+#else
+    cap_uart_tx_write(frame, cap_proto_finalize(frame, CAP_PROTO_TYPE_PROFILE, length));
+#endif
+}
+#endif
+
+#if CAP_TOUCH_TIMING_ENABLE
+/**
+ * @brief 发送扫描时序帧(扫描时间、死区时间和帧周期直方图)，紧跟在遥测帧之后
+ */
+static void timing_send(void)
+{
+    __attribute__((aligned(4))) uint8_t frame[TIMING_FRAME_SIZE];
+    cap_proto_timing_t *payload = (cap_proto_timing_t *)cap_proto_payload(frame);
+    cap_touch_timing_t  timing;
+
+    cap_touch_get_timing(&timing);
+
+    for (uint8_t i = 0; i < CAP_PROTO_TIMING_BINS; i++) {
+        payload->scan[i]   = timing.scan[i];
+        payload->dead[i]   = timing.dead[i];
+        payload->period[i] = timing.period[i];
+    }
+
+#if HOST_LINK == HOST_LINK_SPI
+    cap_spi_send(frame, cap_proto_finalize(frame, CAP_PROTO_TYPE_TIMING, sizeof(cap_proto_timing_t)));
+#else
+    cap_uart_tx_write(frame, cap_proto_finalize(frame, CAP_PROTO_TYPE_TIMING, sizeof(cap_proto_timing_t)));
+#endif
+}
+#endif
+
+/**
+ * @brief 空闲扫描帧间等待期间深度睡眠，在主循环中每个扫描节拍处理之后调用
+ *
+ * 提前CAP_LP_WAKEUP_US唤醒，睡眠时间计入扫描时间，由之后的节拍开始下一帧。
+ * 全速扫描(有候选触摸或接近)时等待时间为0，不睡眠
+ */
+static void low_power_poll(void)
+{
+    uint32_t wait_us = cap_touch_get_idle_wait_us();
+
+    if (wait_us < CAP_LP_MIN_SLEEP_US + CAP_LP_WAKEUP_US || cap_lp_link_active()) { return; }
+
+#if HOST_LINK == HOST_LINK_SPI
+    cap_touch_skip_idle_wait(cap_lp_sleep(wait_us - CAP_LP_WAKEUP_US));
+#else
+    /* 睡眠期间USART时钟停止: 先发送完正在发送的字节，唤醒后继续发送缓冲区 */
+    cap_uart_tx_pause();
+    cap_touch_skip_idle_wait(cap_lp_sleep(wait_us - CAP_LP_WAKEUP_US));
+    cap_uart_tx_resume();
+#endif
+}
+
+/**
+ * @brief 保存当前校准到Flash或删除已保存的校准
+ *
+ * 擦除/编程期间CPU暂停取指，扫描中断延迟(整理时一页擦除约3ms)
+ *
+ * @param save 1: 保存; 0: 删除
+ * @return uint8_t 1: 成功; 0: Flash擦除/编程失败
+ */
+static uint8_t calib_save(uint32_t save)
+{
+    cap_touch_calib_t calib;
+
+    if (!save) { return cap_kv_delete(CAP_KV_KEY_TOUCH_CALIB); }
 
-    g_dma_send_buffer.data[0] = data->values[0]; /* 低字节 */
-    g_dma_send_buffer.data[1] = data->values[1]; /* 低字节 */
-    g_dma_send_buffer.data[2] = data->values[2]; /* 低字节 */
-    g_dma_send_buffer.data[3] = data->values[3]; /* 低字节 */
-    g_dma_send_buffer.data[4] = data->values[4]; /* 低字节 */
-    g_dma_send_buffer.data[5] = data->values[5]; /* 低字节 */
+    cap_touch_get_calibration(&calib);
+    return cap_kv_set(CAP_KV_KEY_TOUCH_CALIB, &calib, sizeof(calib));
+}
+
+/**
+ * @brief 命令通道中数据流参数的读取和设置
+ *
+ * @param set 1: 设置参数; 0: 读取参数
+ * @param param 参数，返回时value填写当前值
+ * @return uint8_t CAP_PROTO_STATUS_xxx
+ */
+uint8_t on_stream_param(uint8_t set, cap_proto_param_t *param)
+{
+    switch (param->param) {
+    case CAP_PROTO_PARAM_STREAM_ENABLE:
+        if (set) {
+            /* 停止前先发送未完成的帧 */
+            if (!param->value) { stream_flush(); }
+            g_stream_enabled = param->value ? 1 : 0;
+        }
+        param->value = g_stream_enabled;
+        break;
+
+    case CAP_PROTO_PARAM_STREAM_MODE:
+        if (set) {
+            if (param->value > STREAM_MODE_BATCH) { return CAP_PROTO_STATUS_INVALID_VALUE; }
+#if HOST_LINK == HOST_LINK_SPI
+            /* SPI数据流只支持原始数据帧 */
+            if (param->value != STREAM_MODE_RAW) { return CAP_PROTO_STATUS_INVALID_VALUE; }
+#endif
+            stream_mode_set((stream_mode_t)param->value);
+        }
+        param->value = g_stream_mode;
+        break;
+
+    case CAP_PROTO_PARAM_STREAM_BATCH_SCANS:
+        if (set) {
+            if (param->value == 0 || param->value > 0xFF) { return CAP_PROTO_STATUS_INVALID_VALUE; }
+            stream_batch_config((uint8_t)param->value, g_batch_latency_us);
+        }
+        param->value = g_batch_scans;
+        break;
+
+    case CAP_PROTO_PARAM_STREAM_LATENCY_US:
+        if (set) { stream_batch_config(g_batch_scans, param->value); }
+        param->value = g_batch_latency_us;
+        break;
+
+    case CAP_PROTO_PARAM_TELEMETRY_MS:
+        if (set) { g_telemetry_period_ms = param->value; }
+        param->value = g_telemetry_period_ms;
+        break;
+
+#if CAP_PROF_ENABLE
+    case CAP_PROTO_PARAM_PROFILE_RESET:
+        if (set) { cap_prof_reset(); }
+        param->value = 0;
+        break;
+#endif
+
+#if CAP_TOUCH_TIMING_ENABLE
+    case CAP_PROTO_PARAM_TIMING_RESET:
+        if (set) { cap_touch_reset_timing(); }
+        param->value = 0;
+        break;
+#endif
+
+    case CAP_PROTO_PARAM_IMAGE_CRC:
+        if (set) { return CAP_PROTO_STATUS_INVALID_VALUE; }
+        param->value = g_image_crc;
+        break;
+
+    case CAP_PROTO_PARAM_CALIB_SAVE:
+        if (set) {
+            if (param->value > 1) { return CAP_PROTO_STATUS_INVALID_VALUE; }
+            if (!calib_save(param->value)) { return CAP_PROTO_STATUS_FAILED; }
+        }
+        param->value = (cap_kv_find(CAP_KV_KEY_TOUCH_CALIB, NULL) != NULL) ? 1 : 0;
+        break;
+
+    case CAP_PROTO_PARAM_LOW_POWER:
+        if (set) {
+            if (param->value > 1) { return CAP_PROTO_STATUS_INVALID_VALUE; }
+            if (param->value && !g_lp_ready) { return CAP_PROTO_STATUS_FAILED; }
+            g_lp_enabled = (uint8_t)param->value;
+        }
+        param->value = g_lp_enabled;
+        break;
+
+    default:
+        return CAP_PROTO_STATUS_UNKNOWN_PARAM;
+    }
+
+    return CAP_PROTO_STATUS_OK;
+}
+
+/**
+ * @brief 接近状态变化回调函数
+ *
+ * 检测到接近时拉高主机唤醒引脚，接近解除时拉低
+ */
+void on_proximity_changed(cap_bool_t near)
+{
+    gpio_bit_write(HOST_WAKE_PORT, HOST_WAKE_PIN, near ? SET : RESET);
+}
 
-    g_dma_send_buffer.checksum = cap_calculate_checksum(&g_dma_send_buffer.data[0], 6);
+/**
+ * @brief 配置主机唤醒引脚为推挽输出，初始为低电平
+ */
+void host_wake_gpio_config(void)
+{
+    rcu_periph_clock_enable(HOST_WAKE_RCU);
 
-    /* 使用DMA发送 */
-    usart_send_buffer_dma((uint8_t *)&g_dma_send_buffer, 16);
+    gpio_bit_write(HOST_WAKE_PORT, HOST_WAKE_PIN, RESET);
+    gpio_mode_set(HOST_WAKE_PORT, GPIO_MODE_OUTPUT, GPIO_PUPD_NONE, HOST_WAKE_PIN);
+    gpio_output_options_set(HOST_WAKE_PORT, GPIO_OTYPE_PP, GPIO_OSPEED_LEVEL_0, HOST_WAKE_PIN);
 }
 
 /**
@@ -195,78 +729,6 @@ void usart_config(void)
     USART_INTC(USART0) = 0xFFFFFFFF;
 }
 
-/**
- * @brief 配置DMA用于USART发送
- */
-void dma_config(void)
-{
-    dma_parameter_struct dma_init_struct;
-
-    /* 使能DMA和DMAMUX时钟 */
-    rcu_periph_clock_enable(RCU_DMA);
-    rcu_periph_clock_enable(RCU_DMAMUX);
-
-    /* 复位DMA通道0 (用于USART0_TX) */
-    dma_deinit(DMA_CH0);
-    dma_struct_para_init(&dma_init_struct);
-
-    /* 配置DMA参数 */
-    dma_init_struct.request      = DMA_REQUEST_USART0_TX;          /* USART0_TX请求 */
-    dma_init_struct.direction    = DMA_MEMORY_TO_PERIPHERAL;       /* 内存到外设 */
-    dma_init_struct.memory_addr  = (uint32_t)&g_dma_send_buffer;   /* 内存地址 */
-    dma_init_struct.memory_inc   = DMA_MEMORY_INCREASE_ENABLE;     /* 内存地址自增 */
-    dma_init_struct.memory_width = DMA_MEMORY_WIDTH_8BIT;          /* 内存数据宽度8位 */
-    dma_init_struct.number       = 0;                              /* 传输数量(稍后设置) */
-    dma_init_struct.periph_addr  = (uint32_t)&USART_TDATA(USART0); /* 外设地址 */
-    dma_init_struct.periph_inc   = DMA_PERIPH_INCREASE_DISABLE;    /* 外设地址不变 */
-    dma_init_struct.periph_width = DMA_PERIPHERAL_WIDTH_8BIT;      /* 外设数据宽度8位 */
-    dma_init_struct.priority     = DMA_PRIORITY_ULTRA_HIGH;        /* 超高优先级 */
-
-    dma_init(DMA_CH0, &dma_init_struct);
-
-    /* 配置DMA模式 */
-    dma_circulation_disable(DMA_CH0);      /* 非循环模式 */
-    dma_memory_to_memory_disable(DMA_CH0); /* 非内存到内存模式 */
-
-    /* 禁用DMAMUX同步模式 */
-    dmamux_synchronization_disable(DMAMUX_MUXCH0);
-}
-
-/**
- * @brief 通过DMA发送数据缓冲区(非阻塞)
- * @param buffer 要发送的数据缓冲区
- * @param length 要发送的数据长度
- * @note 调用前确保上次传输已完成
- */
-void usart_send_buffer_dma(uint8_t *buffer, uint16_t length)
-{
-    /* 等待上次传输完成 */
-    // while (dma_flag_get(DMA_CH0, DMA_FLAG_FTF) == RESET)
-    //     ;
-
-    /* 清除传输完成标志 */
-    dma_flag_clear(DMA_CH0, DMA_FLAG_FTF);
-
-    /* 禁用DMA通道 */
-    dma_channel_disable(DMA_CH0);
-
-    /* 配置传输数量和内存地址 */
-    dma_transfer_number_config(DMA_CH0, length);
-    dma_memory_address_config(DMA_CH0, (uint32_t)buffer);
-
-    /* 启动DMA传输 */
-    dma_channel_enable(DMA_CH0);
-}
-
-/**
- * @brief 检查DMA是否正在发送
- * @return 1:忙碌 0:空闲
- */
-uint8_t usart_dma_is_busy(void)
-{
-    return (dma_flag_get(DMA_CH0, DMA_FLAG_FTF) == RESET) ? 1 : 0;
-}
-
 /**
  * @brief 配置定时器13为167us周期定时器，用于触摸检测
  *